@@ -1,9 +1,35 @@
 #include "harpocrates.hpp"
+#include "harpocrates_aead.hpp"
+#include "harpocrates_archive.hpp"
+#include "harpocrates_array.hpp"
+#include "harpocrates_bitsliced.hpp"
+#include "harpocrates_cache.hpp"
+#include "harpocrates_context.hpp"
+#include "harpocrates_ctr.hpp"
+#include "harpocrates_dispatch.hpp"
+#include "harpocrates_expanded.hpp"
+#include "harpocrates_fixed.hpp"
+#include "harpocrates_kdf.hpp"
+#include "harpocrates_iov.hpp"
+#include "harpocrates_keystore.hpp"
+#include "harpocrates_multibuffer.hpp"
+#include "harpocrates_multikey.hpp"
+#include "harpocrates_pagecache.hpp"
+#include "harpocrates_parallel.hpp"
+#include "harpocrates_simd.hpp"
+#include "harpocrates_stream.hpp"
+#include "harpocrates_uring.hpp"
+#include "harpocrates_xts.hpp"
 #include "utils.hpp"
 #include <benchmark/benchmark.h>
 #include <cassert>
+#include <cstdio>
 #include <string.h>
 
+#if defined __x86_64__
+#include <x86intrin.h>
+#endif
+
 // Benchmark Harpocrates single message block ( 16 -bytes ) encryption routine
 // on CPU
 static void
@@ -92,9 +118,2431 @@ harpocrates_decrypt(benchmark::State& state)
   std::free(dec);
 }
 
-// register function for benchmarking
-BENCHMARK(harpocrates_encrypt);
-BENCHMARK(harpocrates_decrypt);
+// Benchmark Harpocrates bulk message block encryption routine on CPU, where
+// # -of 16 -bytes message blocks encrypted per call is passed as argument
+static void
+harpocrates_encrypt_blocks(benchmark::State& state)
+{
+  constexpr size_t lut_len = 256;
+
+  const size_t n_blocks = static_cast<size_t>(state.range(0));
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+
+  random_data(txt, ct_len);
+  memset(enc, 0, ct_len);
+  memset(dec, 0, ct_len);
+
+  for (auto _ : state) {
+    harpocrates::encrypt_blocks(lut, txt, enc, n_blocks);
+
+    benchmark::DoNotOptimize(enc);
+    benchmark::ClobberMemory();
+  }
+
+  harpocrates::decrypt_blocks(inv_lut, enc, dec, n_blocks);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  const size_t total_data = ct_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+// Benchmark Harpocrates bulk message block decryption routine on CPU, where
+// # -of 16 -bytes message blocks decrypted per call is passed as argument
+static void
+harpocrates_decrypt_blocks(benchmark::State& state)
+{
+  constexpr size_t lut_len = 256;
+
+  const size_t n_blocks = static_cast<size_t>(state.range(0));
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+
+  random_data(txt, ct_len);
+  memset(enc, 0, ct_len);
+  memset(dec, 0, ct_len);
+
+  harpocrates::encrypt_blocks(lut, txt, enc, n_blocks);
+
+  for (auto _ : state) {
+    harpocrates::decrypt_blocks(inv_lut, enc, dec, n_blocks);
+
+    benchmark::DoNotOptimize(dec);
+    benchmark::ClobberMemory();
+  }
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  const size_t total_data = ct_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+// Benchmark Harpocrates bulk message block encryption ( or decryption, when
+// `decrypt` is true ) routine on CPU, under look up table given in Appendix B
+// of specification, which is either known at compile time ( when `fixed` is
+// true, see `harpocrates_fixed` ) or passed at run time, where # -of 16 -bytes
+// message blocks processed per call is passed as argument
+//
+// Also reports # -of CPU cycles ( time stamp counter ticks ) spent per message
+// block, on x86_64
+template<const bool fixed, const bool decrypt>
+static void
+harpocrates_fixed_blocks(benchmark::State& state)
+{
+  constexpr size_t lut_len = 256;
+
+  const size_t n_blocks = static_cast<size_t>(state.range(0));
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  memcpy(lut, KAT_LUT.data(), lut_len);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+
+  random_data(txt, ct_len);
+  memset(dec, 0, ct_len);
+
+  harpocrates::encrypt_blocks(lut, txt, enc, n_blocks);
+
+  const uint8_t* const in = decrypt ? enc : txt;
+  uint8_t* const out = decrypt ? dec : enc;
+
+#if defined __x86_64__
+  const uint64_t start = __rdtsc();
+#endif
+
+  for (auto _ : state) {
+    if constexpr (fixed && decrypt) {
+      harpocrates_fixed::decrypt_blocks<KAT_LUT>(in, out, n_blocks);
+    } else if constexpr (fixed) {
+      harpocrates_fixed::encrypt_blocks<KAT_LUT>(in, out, n_blocks);
+    } else if constexpr (decrypt) {
+      harpocrates::decrypt_blocks(inv_lut, in, out, n_blocks);
+    } else {
+      harpocrates::encrypt_blocks(lut, in, out, n_blocks);
+    }
+
+    benchmark::DoNotOptimize(out);
+    benchmark::ClobberMemory();
+  }
+
+#if defined __x86_64__
+  const uint64_t cycles = __rdtsc() - start;
+  const size_t total_blocks = n_blocks * state.iterations();
+
+  state.counters["cycles/block"] =
+    static_cast<double>(cycles) / static_cast<double>(total_blocks);
+#endif
+
+  harpocrates::decrypt_blocks(inv_lut, enc, dec, n_blocks);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  const size_t total_data = ct_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+// Benchmark Harpocrates bulk message block encryption routine on CPU, using
+// expanded row substitution tables, where # -of 16 -bytes message blocks
+// encrypted per call is passed as argument
+static void
+harpocrates_expanded_encrypt_blocks(benchmark::State& state)
+{
+  constexpr size_t lut_len = 256;
+  constexpr size_t tbl_len = harpocrates_expanded::TABLE_LEN * sizeof(uint16_t);
+
+  const size_t n_blocks = static_cast<size_t>(state.range(0));
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint16_t* tbl = static_cast<uint16_t*>(std::malloc(tbl_len));
+  uint16_t* inv_tbl = static_cast<uint16_t*>(std::malloc(tbl_len));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+  harpocrates_expanded::expand_lut(lut, tbl);
+  harpocrates_expanded::expand_lut(inv_lut, inv_tbl);
+
+  random_data(txt, ct_len);
+  memset(enc, 0, ct_len);
+  memset(dec, 0, ct_len);
+
+  for (auto _ : state) {
+    harpocrates_expanded::encrypt_blocks(lut, tbl, txt, enc, n_blocks);
+
+    benchmark::DoNotOptimize(enc);
+    benchmark::ClobberMemory();
+  }
+
+  harpocrates_expanded::decrypt_blocks(inv_lut, inv_tbl, enc, dec, n_blocks);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  const size_t total_data = ct_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(tbl);
+  std::free(inv_tbl);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+// Benchmark Harpocrates bulk message block decryption routine on CPU, using
+// expanded row substitution tables, where # -of 16 -bytes message blocks
+// decrypted per call is passed as argument
+static void
+harpocrates_expanded_decrypt_blocks(benchmark::State& state)
+{
+  constexpr size_t lut_len = 256;
+  constexpr size_t tbl_len = harpocrates_expanded::TABLE_LEN * sizeof(uint16_t);
+
+  const size_t n_blocks = static_cast<size_t>(state.range(0));
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint16_t* tbl = static_cast<uint16_t*>(std::malloc(tbl_len));
+  uint16_t* inv_tbl = static_cast<uint16_t*>(std::malloc(tbl_len));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+  harpocrates_expanded::expand_lut(lut, tbl);
+  harpocrates_expanded::expand_lut(inv_lut, inv_tbl);
+
+  random_data(txt, ct_len);
+  memset(enc, 0, ct_len);
+  memset(dec, 0, ct_len);
+
+  harpocrates_expanded::encrypt_blocks(lut, tbl, txt, enc, n_blocks);
+
+  for (auto _ : state) {
+    harpocrates_expanded::decrypt_blocks(inv_lut, inv_tbl, enc, dec, n_blocks);
+
+    benchmark::DoNotOptimize(dec);
+    benchmark::ClobberMemory();
+  }
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  const size_t total_data = ct_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(tbl);
+  std::free(inv_tbl);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+// Benchmark one-time computation of expanded row substitution tables, from
+// 256 -bytes look up table
+static void
+harpocrates_expand_lut(benchmark::State& state)
+{
+  constexpr size_t lut_len = 256;
+  constexpr size_t tbl_len = harpocrates_expanded::TABLE_LEN * sizeof(uint16_t);
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint16_t* tbl = static_cast<uint16_t*>(std::malloc(tbl_len));
+
+  harpocrates_utils::generate_lut(lut);
+
+  for (auto _ : state) {
+    harpocrates_expanded::expand_lut(lut, tbl);
+
+    benchmark::DoNotOptimize(tbl);
+    benchmark::ClobberMemory();
+  }
+
+  std::free(lut);
+  std::free(tbl);
+}
+
+// Benchmark bitsliced Harpocrates bulk message block encryption routine on
+// CPU, using word type W, where # -of 16 -bytes message blocks encrypted per
+// call is passed as argument
+template<typename W>
+static void
+harpocrates_bitsliced_encrypt_blocks(benchmark::State& state)
+{
+  using namespace harpocrates_bitsliced;
+
+  constexpr size_t lut_len = 256;
+
+  const size_t n_blocks = static_cast<size_t>(state.range(0));
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  sbox_t sbox;
+  sbox_t inv_sbox;
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+  compile_lut(lut, &sbox);
+  compile_lut(inv_lut, &inv_sbox);
+
+  random_data(txt, ct_len);
+  memset(enc, 0, ct_len);
+  memset(dec, 0, ct_len);
+
+  for (auto _ : state) {
+    encrypt_blocks<W>(sbox, txt, enc, n_blocks);
+
+    benchmark::DoNotOptimize(enc);
+    benchmark::ClobberMemory();
+  }
+
+  decrypt_blocks<W>(inv_sbox, enc, dec, n_blocks);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  const size_t total_data = ct_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+// Benchmark bitsliced Harpocrates bulk message block decryption routine on
+// CPU, using word type W, where # -of 16 -bytes message blocks decrypted per
+// call is passed as argument
+template<typename W>
+static void
+harpocrates_bitsliced_decrypt_blocks(benchmark::State& state)
+{
+  using namespace harpocrates_bitsliced;
+
+  constexpr size_t lut_len = 256;
+
+  const size_t n_blocks = static_cast<size_t>(state.range(0));
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  sbox_t sbox;
+  sbox_t inv_sbox;
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+  compile_lut(lut, &sbox);
+  compile_lut(inv_lut, &inv_sbox);
+
+  random_data(txt, ct_len);
+  memset(enc, 0, ct_len);
+  memset(dec, 0, ct_len);
+
+  encrypt_blocks<W>(sbox, txt, enc, n_blocks);
+
+  for (auto _ : state) {
+    decrypt_blocks<W>(inv_sbox, enc, dec, n_blocks);
+
+    benchmark::DoNotOptimize(dec);
+    benchmark::ClobberMemory();
+  }
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  const size_t total_data = ct_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+#if defined __x86_64__
+// Benchmark Harpocrates bulk message block encryption routine on CPU, using
+// AVX2 byte-sliced kernel, where # -of 16 -bytes message blocks encrypted
+// per call is passed as argument
+static void
+harpocrates_avx2_encrypt_blocks(benchmark::State& state)
+{
+  if (!__builtin_cpu_supports("avx2")) {
+    state.SkipWithError("CPU doesn't support AVX2");
+    return;
+  }
+
+  constexpr size_t lut_len = 256;
+
+  const size_t n_blocks = static_cast<size_t>(state.range(0));
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+
+  random_data(txt, ct_len);
+  memset(enc, 0, ct_len);
+  memset(dec, 0, ct_len);
+
+  for (auto _ : state) {
+    harpocrates_simd::avx2::encrypt_blocks(lut, txt, enc, n_blocks);
+
+    benchmark::DoNotOptimize(enc);
+    benchmark::ClobberMemory();
+  }
+
+  harpocrates_simd::avx2::decrypt_blocks(inv_lut, enc, dec, n_blocks);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  const size_t total_data = ct_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+// Benchmark Harpocrates bulk message block decryption routine on CPU, using
+// AVX2 byte-sliced kernel, where # -of 16 -bytes message blocks decrypted
+// per call is passed as argument
+static void
+harpocrates_avx2_decrypt_blocks(benchmark::State& state)
+{
+  if (!__builtin_cpu_supports("avx2")) {
+    state.SkipWithError("CPU doesn't support AVX2");
+    return;
+  }
+
+  constexpr size_t lut_len = 256;
+
+  const size_t n_blocks = static_cast<size_t>(state.range(0));
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+
+  random_data(txt, ct_len);
+  memset(enc, 0, ct_len);
+  memset(dec, 0, ct_len);
+
+  harpocrates_simd::avx2::encrypt_blocks(lut, txt, enc, n_blocks);
+
+  for (auto _ : state) {
+    harpocrates_simd::avx2::decrypt_blocks(inv_lut, enc, dec, n_blocks);
+
+    benchmark::DoNotOptimize(dec);
+    benchmark::ClobberMemory();
+  }
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  const size_t total_data = ct_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+// Benchmark Harpocrates bulk message block encryption routine on CPU, using
+// AVX-512 VBMI byte-sliced kernel, where # -of 16 -bytes message blocks
+// encrypted per call is passed as argument
+static void
+harpocrates_avx512_encrypt_blocks(benchmark::State& state)
+{
+  if (!(__builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512vbmi"))) {
+    state.SkipWithError("CPU doesn't support AVX-512 VBMI");
+    return;
+  }
+
+  constexpr size_t lut_len = 256;
+
+  const size_t n_blocks = static_cast<size_t>(state.range(0));
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+
+  random_data(txt, ct_len);
+  memset(enc, 0, ct_len);
+  memset(dec, 0, ct_len);
+
+  for (auto _ : state) {
+    harpocrates_simd::avx512::encrypt_blocks(lut, txt, enc, n_blocks);
+
+    benchmark::DoNotOptimize(enc);
+    benchmark::ClobberMemory();
+  }
+
+  harpocrates_simd::avx512::decrypt_blocks(inv_lut, enc, dec, n_blocks);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  const size_t total_data = ct_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+// Benchmark Harpocrates bulk message block decryption routine on CPU, using
+// AVX-512 VBMI byte-sliced kernel, where # -of 16 -bytes message blocks
+// decrypted per call is passed as argument
+static void
+harpocrates_avx512_decrypt_blocks(benchmark::State& state)
+{
+  if (!(__builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512vbmi"))) {
+    state.SkipWithError("CPU doesn't support AVX-512 VBMI");
+    return;
+  }
+
+  constexpr size_t lut_len = 256;
+
+  const size_t n_blocks = static_cast<size_t>(state.range(0));
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+
+  random_data(txt, ct_len);
+  memset(enc, 0, ct_len);
+  memset(dec, 0, ct_len);
+
+  harpocrates_simd::avx512::encrypt_blocks(lut, txt, enc, n_blocks);
+
+  for (auto _ : state) {
+    harpocrates_simd::avx512::decrypt_blocks(inv_lut, enc, dec, n_blocks);
+
+    benchmark::DoNotOptimize(dec);
+    benchmark::ClobberMemory();
+  }
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  const size_t total_data = ct_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+#endif
+
+// Benchmark Harpocrates bulk message block encryption routine on CPU, using
+// kernel selected at run time ( reported as label ), where # -of 16 -bytes
+// message blocks encrypted per call is passed as argument
+static void
+harpocrates_dispatch_encrypt_blocks(benchmark::State& state)
+{
+  constexpr size_t lut_len = 256;
+
+  const size_t n_blocks = static_cast<size_t>(state.range(0));
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+
+  random_data(txt, ct_len);
+  memset(enc, 0, ct_len);
+  memset(dec, 0, ct_len);
+
+  for (auto _ : state) {
+    harpocrates_dispatch::encrypt_blocks(lut, txt, enc, n_blocks);
+
+    benchmark::DoNotOptimize(enc);
+    benchmark::ClobberMemory();
+  }
+
+  harpocrates_dispatch::decrypt_blocks(inv_lut, enc, dec, n_blocks);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  const size_t total_data = ct_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+// Benchmark multi-threaded Harpocrates bulk message block encryption routine on
+// CPU, where # -of 16 -bytes message blocks encrypted per call & # -of worker
+// threads are passed as arguments
+static void
+harpocrates_parallel_encrypt_blocks(benchmark::State& state)
+{
+  constexpr size_t lut_len = 256;
+
+  const size_t n_blocks = static_cast<size_t>(state.range(0));
+  const size_t n_threads = static_cast<size_t>(state.range(1));
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  harpocrates_parallel::thread_pool pool(n_threads);
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+
+  random_data(txt, ct_len);
+  memset(enc, 0, ct_len);
+  memset(dec, 0, ct_len);
+
+  for (auto _ : state) {
+    harpocrates_parallel::encrypt_blocks(pool, lut, txt, enc, n_blocks);
+
+    benchmark::DoNotOptimize(enc);
+    benchmark::ClobberMemory();
+  }
+
+  harpocrates_parallel::decrypt_blocks(pool, inv_lut, enc, dec, n_blocks);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  const size_t total_data = ct_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+// Benchmark multi-threaded Harpocrates bulk message block decryption routine on
+// CPU, where # -of 16 -bytes message blocks decrypted per call & # -of worker
+// threads are passed as arguments
+static void
+harpocrates_parallel_decrypt_blocks(benchmark::State& state)
+{
+  constexpr size_t lut_len = 256;
+
+  const size_t n_blocks = static_cast<size_t>(state.range(0));
+  const size_t n_threads = static_cast<size_t>(state.range(1));
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  harpocrates_parallel::thread_pool pool(n_threads);
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+
+  random_data(txt, ct_len);
+  memset(enc, 0, ct_len);
+  memset(dec, 0, ct_len);
+
+  harpocrates_parallel::encrypt_blocks(pool, lut, txt, enc, n_blocks);
+
+  for (auto _ : state) {
+    harpocrates_parallel::decrypt_blocks(pool, inv_lut, enc, dec, n_blocks);
+
+    benchmark::DoNotOptimize(dec);
+    benchmark::ClobberMemory();
+  }
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  const size_t total_data = ct_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+// Benchmark multi-threaded re-encryption of N message blocks, from old look up
+// table to new one, either using fused routine ( when `fused` is true ) or by
+// decrypting into temporary buffer & then encrypting it, where # -of 16 -bytes
+// message blocks & # -of worker threads are passed as arguments
+template<const bool fused>
+static void
+harpocrates_transcrypt_blocks(benchmark::State& state)
+{
+  constexpr size_t lut_len = 256;
+
+  const size_t n_blocks = static_cast<size_t>(state.range(0));
+  const size_t n_threads = static_cast<size_t>(state.range(1));
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  harpocrates_parallel::thread_pool pool(n_threads);
+
+  uint8_t* old_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* old_inv_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* new_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* tmp = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* out = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  harpocrates_utils::generate_lut(old_lut);
+  harpocrates_utils::generate_inv_lut(old_lut, old_inv_lut);
+  harpocrates_utils::generate_lut(new_lut);
+
+  random_data(txt, ct_len);
+  memset(tmp, 0, ct_len);
+  memset(out, 0, ct_len);
+
+  harpocrates_parallel::encrypt_blocks(pool, old_lut, txt, enc, n_blocks);
+
+  for (auto _ : state) {
+    if constexpr (fused) {
+      harpocrates_parallel::transcrypt_blocks(
+        pool, old_inv_lut, new_lut, enc, out, n_blocks);
+    } else {
+      harpocrates_parallel::decrypt_blocks(
+        pool, old_inv_lut, enc, tmp, n_blocks);
+      harpocrates_parallel::encrypt_blocks(pool, new_lut, tmp, out, n_blocks);
+    }
+
+    benchmark::DoNotOptimize(out);
+    benchmark::ClobberMemory();
+  }
+
+  harpocrates_parallel::encrypt_blocks(pool, new_lut, txt, enc, n_blocks);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((enc[i] ^ out[i]) == 0);
+  }
+
+  const size_t total_data = ct_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+
+  std::free(old_lut);
+  std::free(old_inv_lut);
+  std::free(new_lut);
+  std::free(txt);
+  std::free(enc);
+  std::free(tmp);
+  std::free(out);
+}
+
+// Benchmark Harpocrates counter mode encryption routine on CPU, where byte
+// length of message is passed as argument; decryption is same routine
+static void
+harpocrates_ctr_crypt(benchmark::State& state)
+{
+  using namespace harpocrates_ctr;
+
+  constexpr size_t lut_len = 256;
+
+  const size_t msg_len = static_cast<size_t>(state.range(0));
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* nonce = static_cast<uint8_t*>(std::malloc(NONCE_LEN));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(msg_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(msg_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(msg_len));
+
+  harpocrates_utils::generate_lut(lut);
+
+  random_data(nonce, NONCE_LEN);
+  random_data(txt, msg_len);
+  memset(enc, 0, msg_len);
+  memset(dec, 0, msg_len);
+
+  for (auto _ : state) {
+    crypt(lut, nonce, 0, txt, enc, msg_len);
+
+    benchmark::DoNotOptimize(enc);
+    benchmark::ClobberMemory();
+  }
+
+  crypt(lut, nonce, 0, enc, dec, msg_len);
+
+  for (size_t i = 0; i < msg_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  const size_t total_data = msg_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+
+  std::free(lut);
+  std::free(nonce);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+// Benchmark multi-threaded Harpocrates counter mode encryption routine on CPU,
+// where byte length of message & # -of worker threads are passed as arguments
+static void
+harpocrates_parallel_ctr_crypt(benchmark::State& state)
+{
+  using namespace harpocrates_ctr;
+
+  constexpr size_t lut_len = 256;
+
+  const size_t msg_len = static_cast<size_t>(state.range(0));
+  const size_t n_threads = static_cast<size_t>(state.range(1));
+
+  harpocrates_parallel::thread_pool pool(n_threads);
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* nonce = static_cast<uint8_t*>(std::malloc(NONCE_LEN));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(msg_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(msg_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(msg_len));
+
+  harpocrates_utils::generate_lut(lut);
+
+  random_data(nonce, NONCE_LEN);
+  random_data(txt, msg_len);
+  memset(enc, 0, msg_len);
+  memset(dec, 0, msg_len);
+
+  for (auto _ : state) {
+    crypt(pool, lut, nonce, 0, txt, enc, msg_len);
+
+    benchmark::DoNotOptimize(enc);
+    benchmark::ClobberMemory();
+  }
+
+  crypt(pool, lut, nonce, 0, enc, dec, msg_len);
+
+  for (size_t i = 0; i < msg_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  const size_t total_data = msg_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+
+  std::free(lut);
+  std::free(nonce);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+// Benchmark multi-threaded re-encryption of N bytes of message, encrypted in
+// counter mode, from old look up table & nonce to new ones, either using fused
+// routine ( when `fused` is true ) or by decrypting into temporary buffer &
+// then encrypting it, where byte length of message & # -of worker threads are
+// passed as arguments
+template<const bool fused>
+static void
+harpocrates_ctr_transcrypt(benchmark::State& state)
+{
+  using namespace harpocrates_ctr;
+
+  constexpr size_t lut_len = 256;
+
+  const size_t msg_len = static_cast<size_t>(state.range(0));
+  const size_t n_threads = static_cast<size_t>(state.range(1));
+
+  harpocrates_parallel::thread_pool pool(n_threads);
+
+  uint8_t* old_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* new_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* old_nonce = static_cast<uint8_t*>(std::malloc(NONCE_LEN));
+  uint8_t* new_nonce = static_cast<uint8_t*>(std::malloc(NONCE_LEN));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(msg_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(msg_len));
+  uint8_t* tmp = static_cast<uint8_t*>(std::malloc(msg_len));
+  uint8_t* out = static_cast<uint8_t*>(std::malloc(msg_len));
+
+  harpocrates_utils::generate_lut(old_lut);
+  harpocrates_utils::generate_lut(new_lut);
+
+  random_data(old_nonce, NONCE_LEN);
+  random_data(new_nonce, NONCE_LEN);
+  random_data(txt, msg_len);
+  memset(tmp, 0, msg_len);
+  memset(out, 0, msg_len);
+
+  crypt(pool, old_lut, old_nonce, 0, txt, enc, msg_len);
+
+  for (auto _ : state) {
+    if constexpr (fused) {
+      transcrypt(
+        pool, old_lut, old_nonce, new_lut, new_nonce, 0, enc, out, msg_len);
+    } else {
+      crypt(pool, old_lut, old_nonce, 0, enc, tmp, msg_len);
+      crypt(pool, new_lut, new_nonce, 0, tmp, out, msg_len);
+    }
+
+    benchmark::DoNotOptimize(out);
+    benchmark::ClobberMemory();
+  }
+
+  crypt(pool, new_lut, new_nonce, 0, txt, enc, msg_len);
+
+  for (size_t i = 0; i < msg_len; i++) {
+    assert((enc[i] ^ out[i]) == 0);
+  }
+
+  const size_t total_data = msg_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+
+  std::free(old_lut);
+  std::free(new_lut);
+  std::free(old_nonce);
+  std::free(new_nonce);
+  std::free(txt);
+  std::free(enc);
+  std::free(tmp);
+  std::free(out);
+}
+
+// Benchmark latency of decrypting a single sector, picked at random from 64 MB
+// of encrypted sectors, using Harpocrates in XTS-like mode, where byte length
+// of sector is passed as argument
+static void
+harpocrates_xts_random_read(benchmark::State& state)
+{
+  using namespace harpocrates_xts;
+
+  constexpr size_t lut_len = 256;
+  constexpr size_t dev_len = 1ul << 26;
+
+  const size_t sector_len = static_cast<size_t>(state.range(0));
+  const size_t n_sectors = dev_len / sector_len;
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* tweak_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* dev = static_cast<uint8_t*>(std::malloc(dev_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(sector_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+  harpocrates_utils::generate_lut(tweak_lut);
+
+  random_data(dev, dev_len);
+  memset(dec, 0, sector_len);
+
+  std::mt19937_64 gen(n_sectors);
+  std::uniform_int_distribution<size_t> dis(0, n_sectors - 1);
+
+  for (auto _ : state) {
+    const size_t s = dis(gen);
+    const uint8_t* const enc = dev + s * sector_len;
+
+    decrypt_sectors(inv_lut, tweak_lut, s, enc, dec, sector_len, 1);
+
+    benchmark::DoNotOptimize(dec);
+    benchmark::ClobberMemory();
+  }
+
+  const size_t total_data = sector_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(tweak_lut);
+  std::free(dev);
+  std::free(dec);
+}
+
+// Benchmark sequential encryption throughput of Harpocrates in XTS-like mode,
+// encrypting 16 MB of consecutive sectors per call, where byte length of
+// sector & # -of worker threads are passed as arguments
+static void
+harpocrates_xts_encrypt_sectors(benchmark::State& state)
+{
+  using namespace harpocrates_xts;
+
+  constexpr size_t lut_len = 256;
+  constexpr size_t dev_len = 1ul << 24;
+
+  const size_t sector_len = static_cast<size_t>(state.range(0));
+  const size_t n_threads = static_cast<size_t>(state.range(1));
+  const size_t n_sectors = dev_len / sector_len;
+
+  harpocrates_parallel::thread_pool pool(n_threads);
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* tweak_lut = static_cast<uint8_t*>(std::malloc(lut_len));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(dev_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(dev_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(dev_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+  harpocrates_utils::generate_lut(tweak_lut);
+
+  random_data(txt, dev_len);
+  memset(enc, 0, dev_len);
+  memset(dec, 0, dev_len);
+
+  for (auto _ : state) {
+    encrypt_sectors(pool, lut, tweak_lut, 0, txt, enc, sector_len, n_sectors);
+
+    benchmark::DoNotOptimize(enc);
+    benchmark::ClobberMemory();
+  }
+
+  decrypt_sectors(pool, inv_lut, tweak_lut, 0, enc, dec, sector_len, n_sectors);
+
+  for (size_t i = 0; i < dev_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  const size_t total_data = dev_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(tweak_lut);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+// Prepares temporary input & output files, for benchmarking file encryption
+// pipelines, where input file holds `len` random bytes
+static void
+prepare_files(char* const in_path,
+              char* const out_path,
+              int* const in_fd,
+              int* const out_fd,
+              uint8_t* const txt,
+              const size_t len)
+{
+  *in_fd = ::mkstemp(in_path);
+  *out_fd = ::mkstemp(out_path);
+  assert(*in_fd >= 0 && *out_fd >= 0);
+
+  random_data(txt, len);
+
+  const ssize_t n = ::pwrite(*in_fd, txt, len, 0);
+  assert(n == static_cast<ssize_t>(len));
+}
+
+// Asserts that output file holds counter mode encryption of `txt`, before
+// removing temporary files
+static void
+check_files(char* const in_path,
+            char* const out_path,
+            const int in_fd,
+            const int out_fd,
+            const uint8_t* const lut,
+            const uint8_t* const nonce,
+            const uint8_t* const txt,
+            const size_t len)
+{
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(len));
+
+  const ssize_t n = ::pread(out_fd, enc, len, 0);
+  assert(n == static_cast<ssize_t>(len));
+
+  harpocrates_ctr::crypt(lut, nonce, 0, enc, dec, len);
+
+  for (size_t i = 0; i < len; i++) {
+    assert((txt[i] ^ dec[i]) == 0);
+  }
+
+  ::close(in_fd);
+  ::close(out_fd);
+  std::remove(in_path);
+  std::remove(out_path);
+
+  std::free(enc);
+  std::free(dec);
+}
+
+// Benchmark Harpocrates file encryption pipeline, which overlaps reads,
+// counter mode encryption & writes using io_uring, where byte length of file &
+// # -of buffers in flight are passed as arguments
+//
+// Files live in page cache, so this measures how well I/O submission overlaps
+// with encryption, rather than speed of storage device.
+static void
+harpocrates_uring_crypt_file(benchmark::State& state)
+{
+  using namespace harpocrates_uring;
+
+  const size_t len = static_cast<size_t>(state.range(0));
+  const size_t depth = static_cast<size_t>(state.range(1));
+
+  ring r;
+  if (!r.open()) {
+    state.SkipWithError("io_uring isn't available");
+    return;
+  }
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* nonce = static_cast<uint8_t*>(std::malloc(8));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(len));
+
+  harpocrates_utils::generate_lut(lut);
+  random_data(nonce, 8);
+
+  char in_path[] = "/tmp/harpocrates_in_XXXXXX";
+  char out_path[] = "/tmp/harpocrates_out_XXXXXX";
+  int in_fd, out_fd;
+
+  prepare_files(in_path, out_path, &in_fd, &out_fd, txt, len);
+
+  for (auto _ : state) {
+    const bool ok =
+      sync_wait(r, crypt_file(r, lut, nonce, in_fd, out_fd, depth));
+
+    benchmark::DoNotOptimize(ok);
+  }
+
+  check_files(in_path, out_path, in_fd, out_fd, lut, nonce, txt, len);
+
+  const size_t total_data = len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+
+  std::free(lut);
+  std::free(nonce);
+  std::free(txt);
+}
+
+// Benchmark Harpocrates file encryption using synchronous read -> encrypt ->
+// write loop, where byte length of file is passed as argument; baseline for
+// `harpocrates_uring_crypt_file`
+static void
+harpocrates_sync_crypt_file(benchmark::State& state)
+{
+  using namespace harpocrates_uring;
+
+  const size_t len = static_cast<size_t>(state.range(0));
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* nonce = static_cast<uint8_t*>(std::malloc(8));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(len));
+
+  harpocrates_utils::generate_lut(lut);
+  random_data(nonce, 8);
+
+  char in_path[] = "/tmp/harpocrates_in_XXXXXX";
+  char out_path[] = "/tmp/harpocrates_out_XXXXXX";
+  int in_fd, out_fd;
+
+  prepare_files(in_path, out_path, &in_fd, &out_fd, txt, len);
+
+  for (auto _ : state) {
+    const bool ok = crypt_file_sync(lut, nonce, in_fd, out_fd);
+
+    benchmark::DoNotOptimize(ok);
+  }
+
+  check_files(in_path, out_path, in_fd, out_fd, lut, nonce, txt, len);
+
+  const size_t total_data = len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+
+  std::free(lut);
+  std::free(nonce);
+  std::free(txt);
+}
+
+// Writes `len` random bytes to temporary archive, split into chunks of
+// `chunk_len` -bytes, under given look up table
+static void
+prepare_archive(char* const path,
+                const uint8_t* const lut,
+                uint8_t* const txt,
+                const size_t len,
+                const size_t chunk_len)
+{
+  const int fd = ::mkstemp(path);
+  assert(fd >= 0);
+  ::close(fd);
+
+  random_data(txt, len);
+
+  harpocrates_archive::writer w;
+
+  const bool ok_open = w.open(path, lut, chunk_len);
+  const bool ok_write = ok_open && w.write(txt, len);
+  const bool ok_close = ok_write && w.close();
+  assert(ok_close);
+}
+
+// Benchmark latency of reading a randomly chosen byte range from 4 MB
+// encrypted message, whose byte length is passed as argument, when message is
+// stored as random-access archive of 64 KB chunks ( `from_start` is false ),
+// or when it's encrypted as a single counter mode stream, which is decrypted
+// from start, up to end of range ( baseline )
+template<const bool from_start>
+static void
+harpocrates_archive_random_read(benchmark::State& state)
+{
+  constexpr size_t msg_len = 1ul << 22;
+
+  const size_t range_len = static_cast<size_t>(state.range(0));
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* nonce = static_cast<uint8_t*>(std::malloc(8));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(msg_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(msg_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(msg_len));
+
+  harpocrates_utils::generate_lut(lut);
+  random_data(nonce, 8);
+
+  char path[] = "/tmp/harpocrates_archive_XXXXXX";
+  prepare_archive(path, lut, txt, msg_len, harpocrates_archive::CHUNK_LEN);
+  harpocrates_ctr::crypt(lut, nonce, 0, txt, enc, msg_len);
+
+  harpocrates_archive::reader rd;
+  const bool ok_open = rd.open(path);
+  assert(ok_open);
+
+  std::mt19937_64 gen(range_len);
+  std::uniform_int_distribution<size_t> dis(0, msg_len - range_len);
+
+  for (auto _ : state) {
+    const size_t off = dis(gen);
+
+    if constexpr (from_start) {
+      harpocrates_ctr::crypt(lut, nonce, 0, enc, dec, off + range_len);
+    } else {
+      rd.read(lut, off, dec + off, range_len);
+    }
+
+    benchmark::DoNotOptimize(dec);
+    benchmark::ClobberMemory();
+  }
+
+  const size_t off = dis(gen);
+  const bool ok_read = rd.read(lut, off, dec, range_len);
+  assert(ok_read);
+  assert(std::memcmp(txt + off, dec, range_len) == 0);
+
+  rd.close();
+  std::remove(path);
+
+  const size_t total_data = range_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+
+  std::free(lut);
+  std::free(nonce);
+  std::free(txt);
+  std::free(enc);
+  std::free(dec);
+}
+
+// Benchmark reading 64 randomly chosen byte ranges, each of 4 KB, from 64 MB
+// random-access archive, in a single call, where byte length of chunks & #
+// -of worker threads are passed as arguments
+static void
+harpocrates_archive_read_ranges(benchmark::State& state)
+{
+  using namespace harpocrates_archive;
+
+  constexpr size_t msg_len = 1ul << 26;
+  constexpr size_t n_ranges = 64;
+  constexpr size_t range_len = 4096;
+
+  const size_t chunk_len = static_cast<size_t>(state.range(0));
+  const size_t n_threads = static_cast<size_t>(state.range(1));
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(msg_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(n_ranges * range_len));
+
+  harpocrates_utils::generate_lut(lut);
+
+  char path[] = "/tmp/harpocrates_archive_XXXXXX";
+  prepare_archive(path, lut, txt, msg_len, chunk_len);
+
+  reader rd;
+  const bool ok_open = rd.open(path);
+  assert(ok_open);
+
+  harpocrates_parallel::thread_pool pool(n_threads);
+
+  std::mt19937_64 gen(chunk_len);
+  std::uniform_int_distribution<size_t> dis(0, msg_len - range_len);
+
+  range_t ranges[n_ranges];
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (size_t i = 0; i < n_ranges; i++) {
+      ranges[i] = { dis(gen), dec + i * range_len, range_len };
+    }
+    state.ResumeTiming();
+
+    rd.read(pool, lut, ranges, n_ranges);
+
+    benchmark::DoNotOptimize(dec);
+    benchmark::ClobberMemory();
+  }
+
+  for (size_t i = 0; i < n_ranges; i++) {
+    const range_t& r = ranges[i];
+    assert(std::memcmp(txt + r.offset, r.out, r.len) == 0);
+  }
+
+  rd.close();
+  std::remove(path);
+
+  const size_t total_data = n_ranges * range_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+
+  std::free(lut);
+  std::free(txt);
+  std::free(dec);
+}
+
+// Benchmark reading randomly chosen 4 KB pages, out of first `hot` pages (
+// passed as argument ) of 16 MB file, encrypted page by page, through page
+// cache holding 1024 decrypted pages ( `cached` is true ), or by reading &
+// decrypting page on every access ( baseline )
+template<const bool cached>
+static void
+harpocrates_pagecache_read(benchmark::State& state)
+{
+  using namespace harpocrates_pagecache;
+
+  constexpr size_t n_pages = 4096;
+  constexpr size_t capacity = 1024;
+  constexpr size_t file_len = n_pages * PAGE_LEN;
+
+  const size_t hot = static_cast<size_t>(state.range(0));
+
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* tweak_lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(file_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(PAGE_LEN));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+  harpocrates_utils::generate_lut(tweak_lut);
+  random_data(txt, file_len);
+
+  char path[] = "/tmp/harpocrates_pagecache_XXXXXX";
+  const int fd = ::mkstemp(path);
+  assert(fd >= 0);
+
+  {
+    page_cache cache(lut, tweak_lut, capacity);
+
+    const bool ok_open = cache.open(path);
+    const bool ok_write = ok_open && cache.write(0, txt, file_len);
+    const bool ok_close = ok_write && cache.close();
+    assert(ok_close);
+  }
+
+  page_cache cache(lut, tweak_lut, capacity);
+  const bool ok_open = cache.open(path);
+  assert(ok_open);
+
+  std::mt19937_64 gen(hot);
+  std::uniform_int_distribution<size_t> dis(0, hot - 1);
+
+  size_t page = 0;
+
+  for (auto _ : state) {
+    page = dis(gen);
+    const uint64_t off = page * PAGE_LEN;
+
+    if constexpr (cached) {
+      cache.read(off, dec, PAGE_LEN);
+    } else {
+      const ssize_t n = ::pread(fd, dec, PAGE_LEN, static_cast<off_t>(off));
+      benchmark::DoNotOptimize(n);
+
+      harpocrates_xts::decrypt_sectors(
+        inv_lut, tweak_lut, page, dec, dec, PAGE_LEN, 1);
+    }
+
+    benchmark::DoNotOptimize(dec);
+    benchmark::ClobberMemory();
+  }
+
+  assert(std::memcmp(txt + page * PAGE_LEN, dec, PAGE_LEN) == 0);
+
+  if constexpr (cached) {
+    const stats_t st = cache.stats();
+    const double total = static_cast<double>(st.hits + st.misses);
+
+    state.counters["hit_rate"] = static_cast<double>(st.hits) / total;
+  }
+
+  cache.close();
+  ::close(fd);
+  std::remove(path);
+
+  const size_t total_data = PAGE_LEN * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(tweak_lut);
+  std::free(txt);
+  std::free(dec);
+}
+
+// Benchmark partial scan ( summing leading elements ) of encrypted array of 1M
+// 32 -bit elements ( i.e. 4 MB ), decrypting lazily, `group_blocks` blocks at
+// a time, where percentage of elements scanned is passed as argument
+template<const size_t group_blocks>
+static void
+harpocrates_array_scan(benchmark::State& state)
+{
+  constexpr size_t n = 1ul << 20;
+
+  const size_t cnt = (n * static_cast<size_t>(state.range(0))) / 100;
+
+  uint8_t lut[256];
+  std::vector<uint32_t> txt(n);
+
+  harpocrates_utils::generate_lut(lut);
+  random_data(reinterpret_cast<uint8_t*>(txt.data()), n * sizeof(uint32_t));
+
+  const harpocrates_array::encrypted_array<uint32_t, group_blocks> arr(
+    lut, std::span<const uint32_t>(txt));
+
+  uint64_t sum = 0;
+
+  for (auto _ : state) {
+    sum = 0;
+    for (const uint32_t v : arr.view() | std::views::take(cnt)) {
+      sum += v;
+    }
+
+    benchmark::DoNotOptimize(sum);
+  }
+
+  uint64_t expected = 0;
+  for (size_t i = 0; i < cnt; i++) {
+    expected += txt[i];
+  }
+  assert(sum == expected);
+
+  const size_t total_data = cnt * sizeof(uint32_t) * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+}
+
+// Benchmark partial scan of encrypted array, same as above, but decrypting
+// whole array up front, into a second buffer, before scanning it ( baseline )
+static void
+harpocrates_array_scan_upfront(benchmark::State& state)
+{
+  constexpr size_t n = 1ul << 20;
+
+  const size_t cnt = (n * static_cast<size_t>(state.range(0))) / 100;
+
+  uint8_t lut[256];
+  std::vector<uint32_t> txt(n);
+  std::vector<uint32_t> dec(n);
+
+  harpocrates_utils::generate_lut(lut);
+  random_data(reinterpret_cast<uint8_t*>(txt.data()), n * sizeof(uint32_t));
+
+  const harpocrates_array::encrypted_array<uint32_t> arr(
+    lut, std::span<const uint32_t>(txt));
+
+  uint64_t sum = 0;
+
+  for (auto _ : state) {
+    arr.decrypt(dec.data());
+
+    sum = 0;
+    for (size_t i = 0; i < cnt; i++) {
+      sum += dec[i];
+    }
+
+    benchmark::DoNotOptimize(sum);
+  }
+
+  uint64_t expected = 0;
+  for (size_t i = 0; i < cnt; i++) {
+    expected += txt[i];
+  }
+  assert(sum == expected);
+
+  const size_t total_data = cnt * sizeof(uint32_t) * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+}
+
+// Benchmark authenticated encryption ( CTR + PMAC ) of N -bytes message, with
+// 64 -bytes associated data, using M worker threads, each sealing/ opening
+// chunks of cipher text blocks
+template<const bool seal>
+static void
+harpocrates_aead_crypt(benchmark::State& state)
+{
+  using namespace harpocrates_aead;
+
+  constexpr size_t ad_len = 64;
+
+  const size_t len = static_cast<size_t>(state.range(0));
+  const size_t n_threads = static_cast<size_t>(state.range(1));
+
+  harpocrates_parallel::thread_pool pool(n_threads);
+
+  uint8_t enc_lut[256];
+  uint8_t mac_lut[256];
+  uint8_t nonce[NONCE_LEN];
+  uint8_t ad[ad_len];
+  uint8_t tag[TAG_LEN];
+
+  harpocrates_utils::generate_lut(enc_lut);
+  harpocrates_utils::generate_lut(mac_lut);
+  random_data(nonce, sizeof(nonce));
+  random_data(ad, sizeof(ad));
+
+  std::vector<uint8_t> txt(len);
+  std::vector<uint8_t> enc(len);
+  std::vector<uint8_t> dec(len);
+
+  random_data(txt.data(), len);
+
+  const aead cipher(enc_lut, mac_lut);
+  cipher.seal(pool, nonce, ad, ad_len, txt.data(), enc.data(), len, tag);
+
+  bool ok = true;
+
+  for (auto _ : state) {
+    if constexpr (seal) {
+      cipher.seal(pool, nonce, ad, ad_len, txt.data(), enc.data(), len, tag);
+    } else {
+      ok &= cipher.open(
+        pool, nonce, ad, ad_len, enc.data(), dec.data(), len, tag);
+    }
+
+    benchmark::DoNotOptimize(enc);
+    benchmark::DoNotOptimize(dec);
+    benchmark::ClobberMemory();
+  }
+
+  assert(ok);
+  if constexpr (!seal) {
+    assert(std::memcmp(txt.data(), dec.data(), len) == 0);
+  }
+
+  const size_t total_data = len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+}
+
+// Benchmark computation of message authentication code over N -bytes message,
+// either using PMAC, whose block cipher calls are independent & go through
+// bulk kernel, or using CBC-MAC, whose block cipher calls are chained, so that
+// they can only be made one block at a time
+template<const bool parallel>
+static void
+harpocrates_mac(benchmark::State& state)
+{
+  constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+  const size_t len = static_cast<size_t>(state.range(0));
+
+  uint8_t lut[256];
+  uint8_t tag[blk_len];
+
+  harpocrates_utils::generate_lut(lut);
+
+  std::vector<uint8_t> msg(len);
+  random_data(msg.data(), len);
+
+  const harpocrates_aead::pmac mac(lut);
+
+  for (auto _ : state) {
+    if constexpr (parallel) {
+      mac.tag(msg.data(), len, tag);
+    } else {
+      uint8_t acc[blk_len] = {};
+
+      for (size_t off = 0; off < len; off += blk_len) {
+        uint8_t blk[blk_len];
+
+        for (size_t k = 0; k < blk_len; k++) {
+          blk[k] = acc[k] ^ msg[off + k];
+        }
+        harpocrates_dispatch::encrypt(lut, blk, acc);
+      }
+
+      std::memcpy(tag, acc, blk_len);
+    }
+
+    benchmark::DoNotOptimize(tag);
+    benchmark::ClobberMemory();
+  }
+
+  const size_t total_data = len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+}
+
+// Benchmark generation of look up table, by shuffling it using freshly seeded
+// random number generator; baseline for `harpocrates_derive_lut`
+static void
+harpocrates_generate_lut(benchmark::State& state)
+{
+  uint8_t lut[256];
+
+  for (auto _ : state) {
+    harpocrates_utils::generate_lut(lut);
+
+    benchmark::DoNotOptimize(lut);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Benchmark derivation of look up table from 16 -bytes or 32 -bytes secret key
+// & identifier, where each iteration derives look up table of next identifier
+template<const size_t key_len>
+static void
+harpocrates_derive_lut(benchmark::State& state)
+{
+  uint8_t key[key_len];
+  uint8_t lut[256];
+
+  random_data(key, key_len);
+
+  uint64_t id = 0;
+  for (auto _ : state) {
+    harpocrates_kdf::derive_lut<key_len>(key, id++, lut);
+
+    benchmark::DoNotOptimize(lut);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Benchmark derivation of cipher context ( i.e. look up table & all tables
+// derived from it, except expanded ones ) from 32 -bytes secret key &
+// identifier, as done for each tenant, at startup or on key rotation
+static void
+harpocrates_derive_context(benchmark::State& state)
+{
+  using namespace harpocrates_context;
+
+  uint8_t key[32];
+  random_data(key, sizeof(key));
+
+  uint64_t id = 0;
+  for (auto _ : state) {
+    context ctx = context::derive<32>(key, id++);
+
+    benchmark::DoNotOptimize(ctx.tables());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Benchmark cold start of a service, which needs cipher contexts of N keys,
+// by regenerating them, i.e. deriving look up table & all tables derived from
+// it ( including expanded ones, when asked for ), where # -of keys & whether
+// expanded tables are needed are passed as arguments
+static void
+harpocrates_regenerate_contexts(benchmark::State& state)
+{
+  using namespace harpocrates_context;
+
+  const size_t n_keys = static_cast<size_t>(state.range(0));
+  const bool expanded = state.range(1) != 0;
+
+  uint8_t key[32];
+  uint8_t blk[16];
+  uint8_t enc[16];
+
+  random_data(key, sizeof(key));
+  random_data(blk, sizeof(blk));
+
+  for (auto _ : state) {
+    std::vector<context> ctxs;
+    ctxs.reserve(n_keys);
+
+    for (size_t i = 0; i < n_keys; i++) {
+      ctxs.push_back(context::derive<32>(key, i));
+      if (expanded) {
+        ctxs.back().expand();
+      }
+
+      ctxs.back().encrypt(blk, enc);
+    }
+
+    benchmark::DoNotOptimize(enc);
+    benchmark::ClobberMemory();
+  }
+
+  state.SetItemsProcessed(static_cast<int64_t>(n_keys * state.iterations()));
+}
+
+// Benchmark cold start of a service, which needs cipher contexts of N keys, by
+// opening keystore, holding their precomputed tables, & looking up context of
+// each key, where # -of keys & whether expanded tables are stored are passed as
+// arguments
+//
+// Before each iteration, pages of keystore are dropped from page cache, so
+// that they're read from storage, same as at boot.
+static void
+harpocrates_keystore_cold_start(benchmark::State& state)
+{
+  using namespace harpocrates_keystore;
+
+  const size_t n_keys = static_cast<size_t>(state.range(0));
+  const bool expanded = state.range(1) != 0;
+
+  uint8_t key[32];
+  uint8_t blk[16];
+  uint8_t enc[16];
+
+  random_data(key, sizeof(key));
+  random_data(blk, sizeof(blk));
+
+  std::vector<uint8_t> luts(n_keys * 256);
+  std::vector<key_entry_t> keys(n_keys);
+
+  for (size_t i = 0; i < n_keys; i++) {
+    harpocrates_kdf::derive_lut<32>(key, i, luts.data() + i * 256);
+    keys[i] = { i, luts.data() + i * 256 };
+  }
+
+  char path[] = "/tmp/harpocrates_keystore_XXXXXX";
+  const int fd = ::mkstemp(path);
+  const bool built = build(path, keys.data(), n_keys, expanded);
+  assert(fd >= 0 && built);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    const int dfd = ::open(path, O_RDONLY);
+    ::posix_fadvise(dfd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(dfd);
+    state.ResumeTiming();
+
+    keystore ks;
+    const bool ok = ks.open(path);
+    assert(ok);
+
+    for (size_t i = 0; i < n_keys; i++) {
+      const harpocrates_context::context_view view = ks.find(i);
+
+      if (expanded) {
+        view.encrypt_blocks_expanded(blk, enc, 1);
+      } else {
+        view.encrypt(blk, enc);
+      }
+    }
+
+    benchmark::DoNotOptimize(ok);
+    benchmark::DoNotOptimize(enc);
+    benchmark::ClobberMemory();
+  }
+
+  ::close(fd);
+  std::remove(path);
+
+  state.SetItemsProcessed(static_cast<int64_t>(n_keys * state.iterations()));
+}
+
+// Benchmark serving 4 KB encryption requests of many tenants, each with own
+// key, whose cipher context is looked up in bounded cache, where requests go
+// to a few hot tenants ( 7 out of 8 requests ) or to any of N tenants ( passed
+// as argument ), while cache budget ( in MB, passed as argument ) decides how
+// many of them stay cached &, with kernels processing one block at a time,
+// how many of them keep expanded tables
+static void
+harpocrates_cache_encrypt(benchmark::State& state)
+{
+  using namespace harpocrates_cache;
+
+  constexpr size_t n_blocks = 256;
+  constexpr size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+  constexpr uint64_t n_hot = 8;
+
+  const uint64_t n_tenants = static_cast<uint64_t>(state.range(0));
+  const size_t budget = static_cast<size_t>(state.range(1)) << 20;
+
+  uint8_t key[32];
+  random_data(key, sizeof(key));
+
+  std::vector<uint8_t> txt(ct_len);
+  std::vector<uint8_t> enc(ct_len);
+  random_data(txt.data(), ct_len);
+
+  context_cache cache(budget, [&key](const uint64_t id, uint8_t* const lut) {
+    harpocrates_kdf::derive_lut<32>(key, id, lut);
+    return true;
+  });
+
+  uint64_t req = 0;
+  for (auto _ : state) {
+    // cheap mixing of request counter, for picking tenant
+    const uint64_t r = (req++) * 0x9e3779b97f4a7c15ul;
+    const uint64_t id =
+      (r >> 61) != 0 ? (r >> 32) % n_hot : (r >> 8) % n_tenants;
+
+    const auto ctx = cache.get(id);
+    if (ctx->has_expanded()) {
+      ctx->encrypt_blocks_expanded(txt.data(), enc.data(), n_blocks);
+    } else {
+      ctx->encrypt_blocks(txt.data(), enc.data(), n_blocks);
+    }
+
+    benchmark::DoNotOptimize(enc.data());
+    benchmark::ClobberMemory();
+  }
+
+  const stats_t st = cache.stats();
+  const double lookups = static_cast<double>(st.hits + st.misses);
+
+  state.counters["hit_ratio"] = static_cast<double>(st.hits) / lookups;
+  state.counters["expanded"] = static_cast<double>(st.expansions);
+  state.counters["evicted"] = static_cast<double>(st.evictions);
+
+  const size_t total_data = ct_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+}
+
+// Benchmark encryption of 4096 message blocks, made of small records ( each
+// of R blocks ) of many tenants, each under its own look up table, either using
+// multi-key batch routine ( when `batched` is true ) or by calling bulk
+// encryption routine for each record, where # -of tenants & R are passed as
+// arguments
+template<const bool batched>
+static void
+harpocrates_multikey_encrypt_blocks(benchmark::State& state)
+{
+  constexpr size_t n_blocks = 4096;
+  constexpr size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  const size_t n_keys = static_cast<size_t>(state.range(0));
+  const size_t rec_blocks = static_cast<size_t>(state.range(1));
+  const size_t n_recs = n_blocks / rec_blocks;
+
+  std::vector<uint8_t> luts(n_keys * 256);
+  std::vector<const uint8_t*> rec_luts(n_recs);
+  std::vector<const uint8_t*> blk_luts(n_blocks);
+  std::vector<uint8_t> txt(ct_len);
+  std::vector<uint8_t> enc(ct_len);
+
+  for (size_t i = 0; i < n_keys; i++) {
+    harpocrates_utils::generate_lut(luts.data() + i * 256);
+  }
+
+  std::vector<uint8_t> sel(n_recs * 2);
+  random_data(sel.data(), sel.size());
+  random_data(txt.data(), ct_len);
+
+  for (size_t i = 0; i < n_recs; i++) {
+    const size_t k = ((sel[2 * i] << 8) | sel[2 * i + 1]) % n_keys;
+    rec_luts[i] = luts.data() + k * 256;
+
+    for (size_t j = 0; j < rec_blocks; j++) {
+      blk_luts[i * rec_blocks + j] = rec_luts[i];
+    }
+  }
+
+  for (auto _ : state) {
+    if constexpr (batched) {
+      harpocrates_multikey::encrypt_blocks(
+        blk_luts.data(), txt.data(), enc.data(), n_blocks);
+    } else {
+      for (size_t i = 0; i < n_recs; i++) {
+        const size_t off = i * rec_blocks * harpocrates_common::BLOCK_LEN;
+        harpocrates_dispatch::encrypt_blocks(
+          rec_luts[i], txt.data() + off, enc.data() + off, rec_blocks);
+      }
+    }
+
+    benchmark::DoNotOptimize(enc.data());
+    benchmark::ClobberMemory();
+  }
+
+  const size_t total_data = ct_len * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+}
+
+// Prepares 256 jobs, whose message lengths are powers of 2, picked uniformly at
+// random from [64, max_len] bytes, laid out one after another in `txt`/ `enc`
+static inline std::vector<harpocrates_multibuffer::job_t>
+multibuffer_jobs(std::vector<uint8_t>& txt,
+                 std::vector<uint8_t>& enc,
+                 const size_t max_len)
+{
+  constexpr size_t n_jobs = 256;
+
+  const size_t n_lens = static_cast<size_t>(std::countr_zero(max_len)) - 5;
+
+  std::vector<uint8_t> sel(n_jobs);
+  random_data(sel.data(), n_jobs);
+
+  std::vector<size_t> lens(n_jobs);
+  size_t total = 0;
+
+  for (size_t i = 0; i < n_jobs; i++) {
+    lens[i] = 64ul << (sel[i] % n_lens);
+    total += lens[i];
+  }
+
+  txt.resize(total);
+  enc.resize(total);
+  random_data(txt.data(), total);
+
+  std::vector<harpocrates_multibuffer::job_t> jobs(n_jobs);
+
+  size_t off = 0;
+  for (size_t i = 0; i < n_jobs; i++) {
+    jobs[i] = { txt.data() + off, enc.data() + off, lens[i] };
+    off += lens[i];
+  }
+
+  return jobs;
+}
+
+// Benchmark encryption of 256 messages of different lengths ( see
+// `multibuffer_jobs` ), either using multi-buffer API ( when `batched` is true
+// ) or by calling bulk encryption routine for each message, where longest
+// message length is passed as argument
+template<const bool batched>
+static void
+harpocrates_multibuffer_encrypt_jobs(benchmark::State& state)
+{
+  const size_t max_len = static_cast<size_t>(state.range(0));
+
+  uint8_t lut[256];
+  harpocrates_utils::generate_lut(lut);
+
+  std::vector<uint8_t> txt;
+  std::vector<uint8_t> enc;
+  const auto jobs = multibuffer_jobs(txt, enc, max_len);
+
+  for (auto _ : state) {
+    if constexpr (batched) {
+      harpocrates_multibuffer::encrypt_jobs(lut, jobs.data(), jobs.size());
+    } else {
+      for (const auto& job : jobs) {
+        harpocrates_dispatch::encrypt_blocks(
+          lut, job.in, job.out, job.len / harpocrates_common::BLOCK_LEN);
+      }
+    }
+
+    benchmark::DoNotOptimize(enc.data());
+    benchmark::ClobberMemory();
+  }
+
+  const size_t total_data = txt.size() * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+}
+
+// Benchmark encryption of 256 messages of different lengths ( see
+// `multibuffer_jobs` ) in counter mode, either using multi-buffer API ( when
+// `batched` is true ) or by calling `harpocrates_ctr::crypt` for each message,
+// where longest message length is passed as argument
+template<const bool batched>
+static void
+harpocrates_multibuffer_ctr_jobs(benchmark::State& state)
+{
+  const size_t max_len = static_cast<size_t>(state.range(0));
+
+  uint8_t lut[256];
+  uint8_t nonce[harpocrates_ctr::NONCE_LEN];
+
+  harpocrates_utils::generate_lut(lut);
+  random_data(nonce, sizeof(nonce));
+
+  std::vector<uint8_t> txt;
+  std::vector<uint8_t> enc;
+  const auto jobs = multibuffer_jobs(txt, enc, max_len);
+
+  std::vector<harpocrates_multibuffer::ctr_job_t> ctr_jobs;
+  for (const auto& job : jobs) {
+    ctr_jobs.push_back({ nonce, 0, job.in, job.out, job.len });
+  }
+
+  for (auto _ : state) {
+    if constexpr (batched) {
+      harpocrates_multibuffer::crypt_jobs(
+        lut, ctr_jobs.data(), ctr_jobs.size());
+    } else {
+      for (const auto& job : ctr_jobs) {
+        harpocrates_ctr::crypt(lut, job.nonce, 0, job.in, job.out, job.len);
+      }
+    }
+
+    benchmark::DoNotOptimize(enc.data());
+    benchmark::ClobberMemory();
+  }
+
+  const size_t total_data = txt.size() * state.iterations();
+  state.SetBytesProcessed(static_cast<int64_t>(total_data));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+}
+
+// Benchmark encryption of 64 KB message, held in segments of random lengths (
+// at most N -bytes, passed as argument ), written into differently segmented
+// output, either using scatter-gather routine ( when `direct` is true ) or by
+// copying segments into flat buffer, encrypting it & copying it back out
+template<const bool direct>
+static void
+harpocrates_iov_encrypt(benchmark::State& state)
+{
+  constexpr size_t msg_len = 1ul << 16;
+  constexpr size_t n_blocks = msg_len / harpocrates_common::BLOCK_LEN;
+
+  const size_t max_seg = static_cast<size_t>(state.range(0));
+
+  uint8_t lut[256];
+  harpocrates_utils::generate_lut(lut);
+
+  std::vector<uint8_t> txt(msg_len);
+  std::vector<uint8_t> enc(msg_len);
+  std::vector<uint8_t> flat(msg_len);
+
+  random_data(txt.data(), msg_len);
+
+  // splits buffer into segments of lengths in [1, max_seg]
+  auto segments = [max_seg](uint8_t* const buf) {
+    std::vector<uint8_t> r(msg_len);
+    random_data(r.data(), msg_len);
+
+    std::vector<iovec> segs;
+    for (size_t off = 0, i = 0; off < msg_len; i++) {
+      const size_t len = std::min(1 + (r[i] * max_seg) / 256, msg_len - off);
+
+      segs.push_back({ buf + off, len });
+      off += len;
+    }
+
+    return segs;
+  };
+
+  const auto in = segments(txt.data());
+  const auto out = segments(enc.data());
+
+  for (auto _ : state) {
+    if constexpr (direct) {
+      harpocrates_iov::encrypt_iov(lut, in, out);
+    } else {
+      size_t off = 0;
+      for (const iovec& s : in) {
+        std::memcpy(flat.data() + off, s.iov_base, s.iov_len);
+        off += s.iov_len;
+      }
+
+      harpocrates_dispatch::encrypt_blocks(
+        lut, flat.data(), flat.data(), n_blocks);
+
+      off = 0;
+      for (const iovec& s : out) {
+        std::memcpy(s.iov_base, flat.data() + off, s.iov_len);
+        off += s.iov_len;
+      }
+    }
+
+    benchmark::DoNotOptimize(enc.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(msg_len * state.iterations()));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+}
+
+// Benchmark incremental encryption of 1 MB stream in counter mode, which is
+// passed to stream encryptor in pieces of N -bytes ( passed as argument ), as
+// they'd arrive from socket reads
+static void
+harpocrates_ctr_stream(benchmark::State& state)
+{
+  constexpr size_t msg_len = 1ul << 20;
+
+  const size_t piece = static_cast<size_t>(state.range(0));
+
+  uint8_t lut[256];
+  uint8_t nonce[harpocrates_ctr::NONCE_LEN];
+
+  harpocrates_utils::generate_lut(lut);
+  random_data(nonce, sizeof(nonce));
+
+  std::vector<uint8_t> txt(msg_len);
+  std::vector<uint8_t> enc(msg_len);
+  random_data(txt.data(), msg_len);
+
+  for (auto _ : state) {
+    harpocrates_stream::ctr_stream s(lut, nonce);
+
+    for (size_t off = 0; off < msg_len; off += piece) {
+      const size_t len = std::min(piece, msg_len - off);
+      s.update(txt.data() + off, enc.data() + off, len);
+    }
+
+    benchmark::DoNotOptimize(s.finalize());
+    benchmark::DoNotOptimize(enc.data());
+    benchmark::ClobberMemory();
+  }
+
+  state.SetBytesProcessed(static_cast<int64_t>(msg_len * state.iterations()));
+  state.SetLabel(harpocrates_dispatch::selected_kernel_name());
+}
+
+// register function for benchmarking
+BENCHMARK(harpocrates_encrypt);
+BENCHMARK(harpocrates_decrypt);
+BENCHMARK(harpocrates_encrypt_blocks)->RangeMultiplier(4)->Range(1, 1 << 12);
+BENCHMARK(harpocrates_decrypt_blocks)->RangeMultiplier(4)->Range(1, 1 << 12);
+BENCHMARK_TEMPLATE(harpocrates_fixed_blocks, false, false)
+  ->RangeMultiplier(8)
+  ->Range(1, 1 << 12);
+BENCHMARK_TEMPLATE(harpocrates_fixed_blocks, true, false)
+  ->RangeMultiplier(8)
+  ->Range(1, 1 << 12);
+BENCHMARK_TEMPLATE(harpocrates_fixed_blocks, false, true)
+  ->RangeMultiplier(8)
+  ->Range(1, 1 << 12);
+BENCHMARK_TEMPLATE(harpocrates_fixed_blocks, true, true)
+  ->RangeMultiplier(8)
+  ->Range(1, 1 << 12);
+BENCHMARK(harpocrates_expanded_encrypt_blocks)
+  ->RangeMultiplier(4)
+  ->Range(1, 1 << 12);
+BENCHMARK(harpocrates_expanded_decrypt_blocks)
+  ->RangeMultiplier(4)
+  ->Range(1, 1 << 12);
+BENCHMARK(harpocrates_expand_lut);
+BENCHMARK(harpocrates_dispatch_encrypt_blocks)
+  ->RangeMultiplier(4)
+  ->Range(1, 1 << 12);
+BENCHMARK(harpocrates_parallel_encrypt_blocks)
+  ->ArgsProduct({ { 1 << 12, 1 << 16, 1 << 20 }, { 1, 2, 4, 8, 16, 32, 64 } })
+  ->ArgNames({ "blocks", "threads" })
+  ->UseRealTime();
+BENCHMARK(harpocrates_parallel_decrypt_blocks)
+  ->ArgsProduct({ { 1 << 12, 1 << 16, 1 << 20 }, { 1, 2, 4, 8, 16, 32, 64 } })
+  ->ArgNames({ "blocks", "threads" })
+  ->UseRealTime();
+BENCHMARK_TEMPLATE(harpocrates_transcrypt_blocks, false)
+  ->ArgsProduct({ { 1 << 6, 1 << 12, 1 << 20 }, { 1, 4 } })
+  ->ArgNames({ "blocks", "threads" })
+  ->UseRealTime();
+BENCHMARK_TEMPLATE(harpocrates_transcrypt_blocks, true)
+  ->ArgsProduct({ { 1 << 6, 1 << 12, 1 << 20 }, { 1, 4 } })
+  ->ArgNames({ "blocks", "threads" })
+  ->UseRealTime();
+BENCHMARK(harpocrates_ctr_crypt)->RangeMultiplier(8)->Range(1 << 6, 1 << 24);
+BENCHMARK(harpocrates_parallel_ctr_crypt)
+  ->ArgsProduct({ { 1 << 20, 1 << 24 }, { 1, 2, 4, 8, 16, 32, 64 } })
+  ->ArgNames({ "bytes", "threads" })
+  ->UseRealTime();
+BENCHMARK_TEMPLATE(harpocrates_ctr_transcrypt, false)
+  ->ArgsProduct({ { 1 << 12, 1 << 24 }, { 1, 4 } })
+  ->ArgNames({ "bytes", "threads" })
+  ->UseRealTime();
+BENCHMARK_TEMPLATE(harpocrates_ctr_transcrypt, true)
+  ->ArgsProduct({ { 1 << 12, 1 << 24 }, { 1, 4 } })
+  ->ArgNames({ "bytes", "threads" })
+  ->UseRealTime();
+BENCHMARK(harpocrates_ctr_stream)
+  ->Arg(64)
+  ->Arg(1500)
+  ->Arg(1 << 16)
+  ->ArgName("piece");
+BENCHMARK(harpocrates_xts_random_read)->Arg(512)->Arg(4096);
+BENCHMARK(harpocrates_xts_encrypt_sectors)
+  ->ArgsProduct({ { 512, 4096 }, { 1, 2, 4, 8, 16, 32, 64 } })
+  ->ArgNames({ "sector", "threads" })
+  ->UseRealTime();
+BENCHMARK(harpocrates_generate_lut);
+BENCHMARK_TEMPLATE(harpocrates_derive_lut, 16);
+BENCHMARK_TEMPLATE(harpocrates_derive_lut, 32);
+BENCHMARK(harpocrates_derive_context);
+BENCHMARK(harpocrates_regenerate_contexts)
+  ->Args({ 1024, 0 })
+  ->Args({ 64, 1 })
+  ->ArgNames({ "keys", "expanded" })
+  ->UseRealTime();
+BENCHMARK(harpocrates_keystore_cold_start)
+  ->Args({ 1024, 0 })
+  ->Args({ 64, 1 })
+  ->ArgNames({ "keys", "expanded" })
+  ->UseRealTime();
+BENCHMARK(harpocrates_cache_encrypt)
+  ->ArgsProduct({ { 1 << 10, 1 << 16 }, { 1, 64 } })
+  ->ArgNames({ "tenants", "budget_mb" });
+BENCHMARK_TEMPLATE(harpocrates_multikey_encrypt_blocks, false)
+  ->ArgsProduct({ { 4, 64, 1024 }, { 1, 4, 64 } })
+  ->ArgNames({ "tenants", "record_blocks" });
+BENCHMARK_TEMPLATE(harpocrates_multikey_encrypt_blocks, true)
+  ->ArgsProduct({ { 4, 64, 1024 }, { 1, 4, 64 } })
+  ->ArgNames({ "tenants", "record_blocks" });
+BENCHMARK_TEMPLATE(harpocrates_multibuffer_encrypt_jobs, false)
+  ->Arg(1 << 10)
+  ->Arg(1 << 16)
+  ->ArgName("max_len");
+BENCHMARK_TEMPLATE(harpocrates_multibuffer_encrypt_jobs, true)
+  ->Arg(1 << 10)
+  ->Arg(1 << 16)
+  ->ArgName("max_len");
+BENCHMARK_TEMPLATE(harpocrates_multibuffer_ctr_jobs, false)
+  ->Arg(1 << 10)
+  ->Arg(1 << 16)
+  ->ArgName("max_len");
+BENCHMARK_TEMPLATE(harpocrates_multibuffer_ctr_jobs, true)
+  ->Arg(1 << 10)
+  ->Arg(1 << 16)
+  ->ArgName("max_len");
+BENCHMARK_TEMPLATE(harpocrates_iov_encrypt, false)
+  ->Arg(64)
+  ->Arg(1500)
+  ->Arg(9000)
+  ->ArgName("max_seg");
+BENCHMARK_TEMPLATE(harpocrates_iov_encrypt, true)
+  ->Arg(64)
+  ->Arg(1500)
+  ->Arg(9000)
+  ->ArgName("max_seg");
+BENCHMARK(harpocrates_uring_crypt_file)
+  ->ArgsProduct({ { 1 << 26 }, { 1, 2, 4, 8, 16 } })
+  ->ArgNames({ "bytes", "depth" })
+  ->UseRealTime();
+BENCHMARK(harpocrates_sync_crypt_file)
+  ->Arg(1 << 26)
+  ->ArgName("bytes")
+  ->UseRealTime();
+BENCHMARK_TEMPLATE(harpocrates_archive_random_read, false)
+  ->Arg(64)
+  ->Arg(4096)
+  ->Arg(1 << 16)
+  ->ArgName("range");
+BENCHMARK_TEMPLATE(harpocrates_archive_random_read, true)
+  ->Arg(64)
+  ->Arg(4096)
+  ->Arg(1 << 16)
+  ->ArgName("range");
+BENCHMARK(harpocrates_archive_read_ranges)
+  ->ArgsProduct({ { 1 << 12, 1 << 16 }, { 1, 4 } })
+  ->ArgNames({ "chunk", "threads" })
+  ->UseRealTime();
+BENCHMARK_TEMPLATE(harpocrates_pagecache_read, true)
+  ->Arg(256)
+  ->Arg(4096)
+  ->ArgName("hot");
+BENCHMARK_TEMPLATE(harpocrates_pagecache_read, false)
+  ->Arg(256)
+  ->Arg(4096)
+  ->ArgName("hot");
+BENCHMARK_TEMPLATE(harpocrates_array_scan, 1)
+  ->Arg(1)
+  ->Arg(10)
+  ->Arg(100)
+  ->ArgName("percent");
+BENCHMARK_TEMPLATE(harpocrates_array_scan, 8)
+  ->Arg(1)
+  ->Arg(10)
+  ->Arg(100)
+  ->ArgName("percent");
+BENCHMARK_TEMPLATE(harpocrates_array_scan, 64)
+  ->Arg(1)
+  ->Arg(10)
+  ->Arg(100)
+  ->ArgName("percent");
+BENCHMARK(harpocrates_array_scan_upfront)
+  ->Arg(1)
+  ->Arg(10)
+  ->Arg(100)
+  ->ArgName("percent");
+BENCHMARK_TEMPLATE(harpocrates_aead_crypt, true)
+  ->ArgsProduct({ { 1 << 12, 1 << 24 }, { 1, 4 } })
+  ->ArgNames({ "bytes", "threads" })
+  ->UseRealTime();
+BENCHMARK_TEMPLATE(harpocrates_aead_crypt, false)
+  ->ArgsProduct({ { 1 << 12, 1 << 24 }, { 1, 4 } })
+  ->ArgNames({ "bytes", "threads" })
+  ->UseRealTime();
+BENCHMARK_TEMPLATE(harpocrates_mac, true)->Arg(1 << 12)->Arg(1 << 20);
+BENCHMARK_TEMPLATE(harpocrates_mac, false)->Arg(1 << 12)->Arg(1 << 20);
+
+using harpocrates_bitsliced::word128;
+using harpocrates_bitsliced::word256;
+using harpocrates_bitsliced::word64;
+
+BENCHMARK_TEMPLATE(harpocrates_bitsliced_encrypt_blocks, word64)
+  ->RangeMultiplier(4)
+  ->Range(64, 1 << 12);
+BENCHMARK_TEMPLATE(harpocrates_bitsliced_decrypt_blocks, word64)
+  ->RangeMultiplier(4)
+  ->Range(64, 1 << 12);
+BENCHMARK_TEMPLATE(harpocrates_bitsliced_encrypt_blocks, word128)
+  ->RangeMultiplier(4)
+  ->Range(128, 1 << 12);
+BENCHMARK_TEMPLATE(harpocrates_bitsliced_decrypt_blocks, word128)
+  ->RangeMultiplier(4)
+  ->Range(128, 1 << 12);
+BENCHMARK_TEMPLATE(harpocrates_bitsliced_encrypt_blocks, word256)
+  ->RangeMultiplier(4)
+  ->Range(256, 1 << 12);
+BENCHMARK_TEMPLATE(harpocrates_bitsliced_decrypt_blocks, word256)
+  ->RangeMultiplier(4)
+  ->Range(256, 1 << 12);
+
+#if defined __x86_64__
+BENCHMARK(harpocrates_avx2_encrypt_blocks)
+  ->RangeMultiplier(4)
+  ->Range(1, 1 << 12);
+BENCHMARK(harpocrates_avx2_decrypt_blocks)
+  ->RangeMultiplier(4)
+  ->Range(1, 1 << 12);
+BENCHMARK(harpocrates_avx512_encrypt_blocks)
+  ->RangeMultiplier(4)
+  ->Range(1, 1 << 12);
+BENCHMARK(harpocrates_avx512_decrypt_blocks)
+  ->RangeMultiplier(4)
+  ->Range(1, 1 << 12);
+#endif
 
 // main function to make it executable
 BENCHMARK_MAIN();
@@ -0,0 +1,412 @@
+#include "harpocrates_file.hpp"
+#include "harpocrates_keystore.hpp"
+#include "harpocrates_utils.hpp"
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// Command-line tool for encrypting/ decrypting whole files, using Harpocrates
+// in counter mode, over memory mapped files ( see `harpocrates_file` ) &
+// building keystores of precomputed cipher contexts ( see
+// `harpocrates_keystore` )
+//
+// Compile it with
+//
+// make cli/a.out
+//
+// Usage
+//
+// ./cli/a.out genlut <lut>
+// ./cli/a.out encrypt [-t threads] <lut> <nonce> <input> [output]
+// ./cli/a.out decrypt [-t threads] <lut> <nonce> <input> [output]
+// ./cli/a.out rekey [-t threads] <lut> <nonce> <new_lut> <new_nonce> <input>
+//   [output]
+// ./cli/a.out keystore [-x] <keystore> <key> <first_id> <count>
+//
+// where `lut` is a file holding 256 -bytes look up table, `nonce` is 8 -bytes
+// nonce, as 16 hex digits & `input` is encrypted/ decrypted in-place, when
+// `output` isn't given.
+//
+// `rekey` re-encrypts file, which was encrypted under `lut` & `nonce`, so that
+// it's encrypted under `new_lut` & `new_nonce`, in a single pass, without
+// writing decrypted bytes anywhere ( see `harpocrates_ctr::transcrypt` ).
+//
+// `keystore` derives look up tables of `count` keys, with identifiers starting
+// at `first_id`, from secret key, read from file `key` ( or from standard
+// input, when it's - ), which holds 16 or 32 raw bytes, storing their
+// precomputed tables ( & expanded tables, when -x is given ) in `keystore`
+// file. Key is never passed on command line, where other processes could read
+// it.
+
+static void
+usage(const char* const prog)
+{
+  std::cerr << "Usage:" << std::endl
+            << "  " << prog << " genlut <lut>" << std::endl
+            << "  " << prog
+            << " encrypt [-t threads] <lut> <nonce> <input> [output]"
+            << std::endl
+            << "  " << prog
+            << " decrypt [-t threads] <lut> <nonce> <input> [output]"
+            << std::endl
+            << "  " << prog
+            << " rekey [-t threads] <lut> <nonce> <new_lut> <new_nonce> <input>"
+               " [output]"
+            << std::endl
+            << "  " << prog
+            << " keystore [-x] <keystore> <key> <first_id> <count>"
+            << std::endl;
+}
+
+// Parses 2N hex digits into N bytes, rejecting anything other than hex digits
+// ( such as signs or blanks, which `strtoul` would accept )
+static bool
+from_hex(const char* const hex, uint8_t* const bytes, const size_t len)
+{
+  if (std::strlen(hex) != (len << 1)) {
+    return false;
+  }
+
+  for (size_t i = 0; i < (len << 1); i++) {
+    if (!std::isxdigit(static_cast<unsigned char>(hex[i]))) {
+      return false;
+    }
+  }
+
+  for (size_t i = 0; i < len; i++) {
+    const std::string byte(hex + (i << 1), 2);
+    const unsigned long v = std::strtoul(byte.c_str(), nullptr, 16);
+
+    bytes[i] = static_cast<uint8_t>(v);
+  }
+
+  return true;
+}
+
+// Parses unsigned integer ( decimal, or hex/ octal when prefixed ), rejecting
+// signs, blanks, trailing characters & values which don't fit in 64 -bit
+static bool
+parse_u64(const char* const str, uint64_t* const v)
+{
+  if (!std::isdigit(static_cast<unsigned char>(str[0]))) {
+    return false;
+  }
+
+  char* end = nullptr;
+  errno = 0;
+
+  const unsigned long long x = std::strtoull(str, &end, 0);
+  if (errno != 0 || *end != '\0') {
+    return false;
+  }
+
+  *v = static_cast<uint64_t>(x);
+  return true;
+}
+
+// Reads 16 -bytes or 32 -bytes secret key from file ( or from standard input,
+// when path is "-" ), returning its byte length or 0, on failure
+static size_t
+read_key(const char* const path, uint8_t* const key)
+{
+  const bool from_stdin = std::strcmp(path, "-") == 0;
+
+  FILE* const fp = from_stdin ? stdin : std::fopen(path, "rb");
+  if (fp == nullptr) {
+    return 0;
+  }
+
+  uint8_t buf[33];
+  const size_t n = std::fread(buf, 1, sizeof(buf), fp);
+  const bool failed = std::ferror(fp) != 0;
+
+  if (!from_stdin) {
+    std::fclose(fp);
+  }
+
+  size_t key_len = 0;
+  if (!failed && (n == 16 || n == 32)) {
+    std::memcpy(key, buf, n);
+    key_len = n;
+  }
+
+  harpocrates_utils::secure_zero(buf, sizeof(buf));
+
+  if (key_len == 0) {
+    errno = failed ? EIO : EINVAL;
+  }
+  return key_len;
+}
+
+// Reads 256 -bytes look up table from file, checking that it's a permutation
+static bool
+read_lut(const char* const path, uint8_t* const lut)
+{
+  FILE* const fp = std::fopen(path, "rb");
+  if (fp == nullptr) {
+    return false;
+  }
+
+  const size_t n = std::fread(lut, 1, 256, fp);
+  const bool eof = std::fgetc(fp) == EOF;
+  std::fclose(fp);
+
+  if (n != 256 || !eof) {
+    errno = EINVAL;
+    return false;
+  }
+
+  bool seen[256] = {};
+  for (size_t i = 0; i < 256; i++) {
+    if (seen[lut[i]]) {
+      errno = EINVAL;
+      return false;
+    }
+    seen[lut[i]] = true;
+  }
+
+  return true;
+}
+
+// Generates random look up table & writes it to file, which must not exist
+// yet & is created readable only by its owner, as look up table is secret key
+static bool
+write_lut(const char* const path)
+{
+  uint8_t lut[256];
+  harpocrates_utils::generate_lut(lut);
+
+  const int fd = ::open(path, O_CREAT | O_EXCL | O_WRONLY, 0600);
+  if (fd < 0) {
+    return false;
+  }
+
+  FILE* const fp = ::fdopen(fd, "wb");
+  if (fp == nullptr) {
+    ::close(fd);
+    return false;
+  }
+
+  const size_t n = std::fwrite(lut, 1, sizeof(lut), fp);
+  return (std::fclose(fp) == 0) && (n == sizeof(lut));
+}
+
+// Most keys stored in one keystore, by command-line tool, so that a mistyped
+// count fails fast, instead of exhausting memory
+constexpr uint64_t MAX_KEYS = 1ul << 24;
+
+// Derives look up tables of `count` keys, from secret key, storing them in
+// keystore
+static int
+build_keystore(const char* const prog, const int argc, char** const argv)
+{
+  int argi = 0;
+  bool expanded = false;
+
+  if (argi < argc && std::strcmp(argv[argi], "-x") == 0) {
+    expanded = true;
+    argi++;
+  }
+
+  if (argc - argi != 4) {
+    usage(prog);
+    return EXIT_FAILURE;
+  }
+
+  const char* const ks_path = argv[argi];
+  const char* const key_path = argv[argi + 1];
+
+  uint64_t first_id = 0;
+  uint64_t count = 0;
+
+  if (!parse_u64(argv[argi + 2], &first_id)) {
+    std::cerr << "first_id must be an unsigned 64 -bit integer" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!parse_u64(argv[argi + 3], &count) || count == 0 || count > MAX_KEYS ||
+      count - 1 > UINT64_MAX - first_id) {
+    std::cerr << "count must be in [1, " << MAX_KEYS
+              << "], without identifiers overflowing 64 -bit" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  uint8_t key[32];
+  const size_t key_len = read_key(key_path, key);
+
+  if (key_len == 0) {
+    std::cerr << key_path << ": " << std::strerror(errno)
+              << " ( key must be 16 or 32 raw bytes )" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<uint8_t> luts(count * 256);
+  std::vector<harpocrates_keystore::key_entry_t> keys(count);
+
+  for (size_t i = 0; i < count; i++) {
+    uint8_t* const lut = luts.data() + i * 256;
+
+    if (key_len == 16) {
+      harpocrates_kdf::derive_lut<16>(key, first_id + i, lut);
+    } else {
+      harpocrates_kdf::derive_lut<32>(key, first_id + i, lut);
+    }
+
+    keys[i] = { first_id + i, lut };
+  }
+
+  const bool ok =
+    harpocrates_keystore::build(ks_path, keys.data(), count, expanded);
+  const int err = errno;
+
+  harpocrates_utils::secure_zero(key, sizeof(key));
+  harpocrates_utils::secure_zero(luts.data(), luts.size());
+
+  if (!ok) {
+    std::cerr << ks_path << ": " << std::strerror(err) << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+// Re-encrypts file, encrypted under old look up table & nonce, under new ones
+static int
+rekey(const char* const prog, const int argc, char** const argv)
+{
+  int argi = 0;
+  size_t n_threads = 0;
+
+  if (argi + 1 < argc && std::strcmp(argv[argi], "-t") == 0) {
+    n_threads = std::strtoul(argv[argi + 1], nullptr, 10);
+    argi += 2;
+  }
+
+  const int n_args = argc - argi;
+  if (n_args != 5 && n_args != 6) {
+    usage(prog);
+    return EXIT_FAILURE;
+  }
+
+  const char* const in_path = argv[argi + 4];
+  const char* const out_path = n_args == 6 ? argv[argi + 5] : nullptr;
+
+  uint8_t luts[2][256];
+  uint8_t nonces[2][harpocrates_ctr::NONCE_LEN];
+
+  for (size_t i = 0; i < 2; i++) {
+    const char* const lut_path = argv[argi + 2 * i];
+    const char* const nonce_hex = argv[argi + 2 * i + 1];
+
+    if (!read_lut(lut_path, luts[i])) {
+      std::cerr << lut_path << ": " << std::strerror(errno) << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    if (!from_hex(nonce_hex, nonces[i], sizeof(nonces[i]))) {
+      std::cerr << "nonce must be " << (sizeof(nonces[i]) << 1)
+                << " hex digits" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  harpocrates_parallel::thread_pool pool(n_threads);
+
+  if (!harpocrates_file::transcrypt_file(
+        pool, luts[0], nonces[0], luts[1], nonces[1], in_path, out_path)) {
+    std::cerr << "rekey " << in_path << ": " << std::strerror(errno)
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int
+main(int argc, char** argv)
+{
+  if (argc < 2) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const std::string cmd = argv[1];
+
+  if (cmd == "genlut") {
+    if (argc != 3) {
+      usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+
+    if (!write_lut(argv[2])) {
+      std::cerr << argv[2] << ": " << std::strerror(errno) << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+  }
+
+  if (cmd == "keystore") {
+    return build_keystore(argv[0], argc - 2, argv + 2);
+  }
+
+  if (cmd == "rekey") {
+    return rekey(argv[0], argc - 2, argv + 2);
+  }
+
+  if (cmd != "encrypt" && cmd != "decrypt") {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  int argi = 2;
+  size_t n_threads = 0;
+
+  if (argi + 1 < argc && std::strcmp(argv[argi], "-t") == 0) {
+    n_threads = std::strtoul(argv[argi + 1], nullptr, 10);
+    argi += 2;
+  }
+
+  const int n_args = argc - argi;
+  if (n_args != 3 && n_args != 4) {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const char* const lut_path = argv[argi];
+  const char* const nonce_hex = argv[argi + 1];
+  const char* const in_path = argv[argi + 2];
+  const char* const out_path = n_args == 4 ? argv[argi + 3] : nullptr;
+
+  uint8_t lut[256];
+  uint8_t nonce[harpocrates_ctr::NONCE_LEN];
+
+  if (!read_lut(lut_path, lut)) {
+    std::cerr << lut_path << ": " << std::strerror(errno) << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  if (!from_hex(nonce_hex, nonce, sizeof(nonce))) {
+    std::cerr << "nonce must be " << (sizeof(nonce) << 1) << " hex digits"
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // in counter mode, decryption is same as encryption
+  harpocrates_parallel::thread_pool pool(n_threads);
+
+  if (!harpocrates_file::crypt_file(pool, lut, nonce, in_path, out_path)) {
+    std::cerr << cmd << " " << in_path << ": " << std::strerror(errno)
+              << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -15,6 +15,11 @@ namespace harpocrates {
 //
 // Output:
 // - enc: 16 encrypted output bytes
+//
+// Column substitution step is performed using `colsub`, which defaults to
+// fastest variant enabled at compile time
+template<const harpocrates_utils::column_substitution_t colsub =
+           harpocrates_utils::transposed_column_substitution>
 static inline void
 encrypt(const uint8_t* const __restrict lut, // look up table
         const uint8_t* const __restrict txt, // input plain text
@@ -44,7 +49,7 @@ encrypt(const uint8_t* const __restrict lut, // look up table
   for (size_t i = 0; i < harpocrates_common::N_ROUNDS; i++) {
     harpocrates_utils::left_to_right_convoluted_substitution(state, lut);
     harpocrates_utils::add_rc(state, i);
-    harpocrates_utils::column_substitution(state, lut);
+    colsub(state, lut);
     harpocrates_utils::right_to_left_convoluted_substitution(state, lut);
   }
 
@@ -81,7 +86,10 @@ encrypt(const uint8_t* const __restrict lut, // look up table
 //
 // inv_lut = harpocrates_utils::generate_inv_lut(lut)
 //
-// where `lut` is the same look up table used during encryption.
+// where `lut` is the same look up table used during encryption. Column
+// substitution step is performed using `colsub` ( see `encrypt` ).
+template<const harpocrates_utils::column_substitution_t colsub =
+           harpocrates_utils::transposed_column_substitution>
 static inline void
 decrypt(const uint8_t* const __restrict inv_lut, // inverse look up table
         const uint8_t* const __restrict enc,     // input encrypted bytes
@@ -112,7 +120,7 @@ decrypt(const uint8_t* const __restrict inv_lut, // inverse look up table
     using namespace harpocrates_utils;
 
     left_to_right_convoluted_substitution(state, inv_lut);
-    column_substitution(state, inv_lut);
+    colsub(state, inv_lut);
     add_rc(state, harpocrates_common::N_ROUNDS - (i + 1));
     right_to_left_convoluted_substitution(state, inv_lut);
   }
@@ -134,4 +142,369 @@ decrypt(const uint8_t* const __restrict inv_lut, // inverse look up table
   }
 }
 
+// Given `lanes` -many consecutive 16 -bytes message blocks & look up table
+// ( read `lut` ), this routine encrypts all of them together, by interleaving
+// their state matrices, so that each round step works on `lanes x 8` rows,
+// which are independent of each other, hiding latency of dependent look ups
+//
+// Input:
+// - lut: Look up table holding 256 elements
+// - txt: lanes x 16 input bytes, to be encrypted
+//
+// Output:
+// - enc: lanes x 16 encrypted output bytes
+//
+// Note, all input bytes are read before any output byte is written, so `txt`
+// and `enc` may point to same memory ( i.e. in-place encryption )
+template<const size_t lanes,
+         const harpocrates_utils::column_substitution_t colsub =
+           harpocrates_utils::transposed_column_substitution>
+static inline void
+encrypt_lanes(const uint8_t* const __restrict lut, // look up table
+              const uint8_t* const txt,            // input plain text
+              uint8_t* const enc                   // output encrypted bytes
+)
+{
+  constexpr size_t n_rows = harpocrates_common::N_ROWS * lanes;
+  constexpr size_t itr_cnt = n_rows >> 1;
+
+  uint16_t state[n_rows] = { 0u };
+
+#if defined __clang__
+#pragma unroll 4
+#elif defined __GNUG__
+#pragma GCC ivdep
+#pragma GCC unroll 4
+#endif
+  for (size_t i = 0; i < itr_cnt; i++) {
+    const size_t b_off = i << 2;
+    const size_t r_off = i << 1;
+
+    state[r_off ^ 0] = (static_cast<uint16_t>(txt[b_off ^ 0]) << 8) |
+                       static_cast<uint16_t>(txt[b_off ^ 1]);
+    state[r_off ^ 1] = (static_cast<uint16_t>(txt[b_off ^ 2]) << 8) |
+                       static_cast<uint16_t>(txt[b_off ^ 3]);
+  }
+
+  for (size_t i = 0; i < harpocrates_common::N_ROUNDS; i++) {
+    using namespace harpocrates_utils;
+
+    left_to_right_convoluted_substitution<n_rows>(state, lut);
+
+    for (size_t j = 0; j < lanes; j++) {
+      const size_t off = j * harpocrates_common::N_ROWS;
+
+      add_rc(state + off, i);
+      colsub(state + off, lut);
+    }
+
+    right_to_left_convoluted_substitution<n_rows>(state, lut);
+  }
+
+#if defined __clang__
+#pragma unroll 4
+#elif defined __GNUG__
+#pragma GCC ivdep
+#pragma GCC unroll 4
+#endif
+  for (size_t i = 0; i < itr_cnt; i++) {
+    const size_t b_off = i << 2;
+    const size_t r_off = i << 1;
+
+    enc[b_off ^ 0] = static_cast<uint8_t>(state[r_off ^ 0] >> 8);
+    enc[b_off ^ 1] = static_cast<uint8_t>(state[r_off ^ 0]);
+    enc[b_off ^ 2] = static_cast<uint8_t>(state[r_off ^ 1] >> 8);
+    enc[b_off ^ 3] = static_cast<uint8_t>(state[r_off ^ 1]);
+  }
+}
+
+// Given `lanes` -many consecutive 16 -bytes encrypted message blocks & inverse
+// look up table ( read `inv_lut` ), this routine decrypts all of them together,
+// by interleaving their state matrices, so that each round step works on
+// `lanes x 8` rows, which are independent of each other
+//
+// Input:
+// - inv_lut: Inverse Look up table holding 256 elements
+// - enc: lanes x 16 encrypted input bytes
+//
+// Output:
+// - dec: lanes x 16 decrypted output bytes
+//
+// Note, `enc` and `dec` may point to same memory ( i.e. in-place decryption )
+template<const size_t lanes,
+         const harpocrates_utils::column_substitution_t colsub =
+           harpocrates_utils::transposed_column_substitution>
+static inline void
+decrypt_lanes(const uint8_t* const __restrict inv_lut, // inverse look up table
+              const uint8_t* const enc,                // input encrypted bytes
+              uint8_t* const dec                       // output decrypted bytes
+)
+{
+  constexpr size_t n_rows = harpocrates_common::N_ROWS * lanes;
+  constexpr size_t itr_cnt = n_rows >> 1;
+
+  uint16_t state[n_rows] = { 0u };
+
+#if defined __clang__
+#pragma unroll 4
+#elif defined __GNUG__
+#pragma GCC ivdep
+#pragma GCC unroll 4
+#endif
+  for (size_t i = 0; i < itr_cnt; i++) {
+    const size_t b_off = i << 2;
+    const size_t r_off = i << 1;
+
+    state[r_off ^ 0] = (static_cast<uint16_t>(enc[b_off ^ 0]) << 8) |
+                       static_cast<uint16_t>(enc[b_off ^ 1]);
+    state[r_off ^ 1] = (static_cast<uint16_t>(enc[b_off ^ 2]) << 8) |
+                       static_cast<uint16_t>(enc[b_off ^ 3]);
+  }
+
+  for (size_t i = 0; i < harpocrates_common::N_ROUNDS; i++) {
+    using namespace harpocrates_utils;
+
+    left_to_right_convoluted_substitution<n_rows>(state, inv_lut);
+
+    for (size_t j = 0; j < lanes; j++) {
+      const size_t off = j * harpocrates_common::N_ROWS;
+
+      colsub(state + off, inv_lut);
+      add_rc(state + off, harpocrates_common::N_ROUNDS - (i + 1));
+    }
+
+    right_to_left_convoluted_substitution<n_rows>(state, inv_lut);
+  }
+
+#if defined __clang__
+#pragma unroll 4
+#elif defined __GNUG__
+#pragma GCC ivdep
+#pragma GCC unroll 4
+#endif
+  for (size_t i = 0; i < itr_cnt; i++) {
+    const size_t b_off = i << 2;
+    const size_t r_off = i << 1;
+
+    dec[b_off ^ 0] = static_cast<uint8_t>(state[r_off ^ 0] >> 8);
+    dec[b_off ^ 1] = static_cast<uint8_t>(state[r_off ^ 0]);
+    dec[b_off ^ 2] = static_cast<uint8_t>(state[r_off ^ 1] >> 8);
+    dec[b_off ^ 3] = static_cast<uint8_t>(state[r_off ^ 1]);
+  }
+}
+
+// Given N -many consecutive 16 -bytes message blocks & look up table ( read
+// `lut` ), this routine encrypts all of them, processing N_LANES blocks at a
+// time ( see encrypt_lanes ), while trailing blocks are encrypted one by one
+//
+// `txt` and `enc` may point to same memory ( i.e. in-place encryption )
+//
+// Input:
+// - lut: Look up table holding 256 elements
+// - txt: N x 16 input bytes, to be encrypted
+// - n_blocks: N, # -of message blocks
+//
+// Output:
+// - enc: N x 16 encrypted output bytes
+template<const harpocrates_utils::column_substitution_t colsub =
+           harpocrates_utils::transposed_column_substitution>
+static inline void
+encrypt_blocks(const uint8_t* const __restrict lut, // look up table
+               const uint8_t* const txt,            // input plain text
+               uint8_t* const enc,                  // output encrypted bytes
+               const size_t n_blocks                // # -of message blocks
+)
+{
+  constexpr size_t lanes = harpocrates_common::N_LANES;
+  constexpr size_t chunk_len = lanes * harpocrates_common::BLOCK_LEN;
+
+  const size_t n_chunks = n_blocks / lanes;
+
+  for (size_t i = 0; i < n_chunks; i++) {
+    const size_t off = i * chunk_len;
+    encrypt_lanes<lanes, colsub>(lut, txt + off, enc + off);
+  }
+
+  for (size_t i = n_chunks * lanes; i < n_blocks; i++) {
+    const size_t off = i * harpocrates_common::BLOCK_LEN;
+    encrypt_lanes<1, colsub>(lut, txt + off, enc + off);
+  }
+}
+
+// Given N -many consecutive 16 -bytes encrypted message blocks & inverse look
+// up table ( read `inv_lut` ), this routine decrypts all of them, processing
+// N_LANES blocks at a time ( see decrypt_lanes ), while trailing blocks are
+// decrypted one by one
+//
+// `enc` and `dec` may point to same memory ( i.e. in-place decryption )
+//
+// Input:
+// - inv_lut: Inverse Look up table holding 256 elements
+// - enc: N x 16 encrypted input bytes
+// - n_blocks: N, # -of message blocks
+//
+// Output:
+// - dec: N x 16 decrypted output bytes
+template<const harpocrates_utils::column_substitution_t colsub =
+           harpocrates_utils::transposed_column_substitution>
+static inline void
+decrypt_blocks(const uint8_t* const __restrict inv_lut, // inverse look up table
+               const uint8_t* const enc,                // input encrypted bytes
+               uint8_t* const dec,                      // decrypted bytes
+               const size_t n_blocks                    // # -of message blocks
+)
+{
+  constexpr size_t lanes = harpocrates_common::N_LANES;
+  constexpr size_t chunk_len = lanes * harpocrates_common::BLOCK_LEN;
+
+  const size_t n_chunks = n_blocks / lanes;
+
+  for (size_t i = 0; i < n_chunks; i++) {
+    const size_t off = i * chunk_len;
+    decrypt_lanes<lanes, colsub>(inv_lut, enc + off, dec + off);
+  }
+
+  for (size_t i = n_chunks * lanes; i < n_blocks; i++) {
+    const size_t off = i * harpocrates_common::BLOCK_LEN;
+    decrypt_lanes<1, colsub>(inv_lut, enc + off, dec + off);
+  }
+}
+
+// Given `lanes` -many consecutive 16 -bytes message blocks, encrypted under old
+// look up table, inverse of that table ( read `inv_lut` ) & new look up table
+// ( read `lut` ), this routine re-encrypts all of them under new table, by
+// running decryption rounds & then encryption rounds on same interleaved state
+// matrices ( see `encrypt_lanes` ), so that decrypted blocks are never written
+// to memory
+//
+// Input:
+// - inv_lut: Inverse of old look up table
+// - lut: New look up table
+// - enc: lanes x 16 input bytes, encrypted under old look up table
+//
+// Output:
+// - out: lanes x 16 output bytes, encrypted under new look up table
+//
+// Note, `enc` and `out` may point to same memory ( i.e. in-place )
+template<const size_t lanes,
+         const harpocrates_utils::column_substitution_t colsub =
+           harpocrates_utils::transposed_column_substitution>
+static inline void
+transcrypt_lanes(const uint8_t* const __restrict inv_lut, // old inverse table
+                 const uint8_t* const __restrict lut,     // new look up table
+                 const uint8_t* const enc,                // encrypted bytes
+                 uint8_t* const out                       // re-encrypted bytes
+)
+{
+  constexpr size_t n_rows = harpocrates_common::N_ROWS * lanes;
+  constexpr size_t itr_cnt = n_rows >> 1;
+
+  uint16_t state[n_rows] = { 0u };
+
+#if defined __clang__
+#pragma unroll 4
+#elif defined __GNUG__
+#pragma GCC ivdep
+#pragma GCC unroll 4
+#endif
+  for (size_t i = 0; i < itr_cnt; i++) {
+    const size_t b_off = i << 2;
+    const size_t r_off = i << 1;
+
+    state[r_off ^ 0] = (static_cast<uint16_t>(enc[b_off ^ 0]) << 8) |
+                       static_cast<uint16_t>(enc[b_off ^ 1]);
+    state[r_off ^ 1] = (static_cast<uint16_t>(enc[b_off ^ 2]) << 8) |
+                       static_cast<uint16_t>(enc[b_off ^ 3]);
+  }
+
+  for (size_t i = 0; i < harpocrates_common::N_ROUNDS; i++) {
+    using namespace harpocrates_utils;
+
+    left_to_right_convoluted_substitution<n_rows>(state, inv_lut);
+
+    for (size_t j = 0; j < lanes; j++) {
+      const size_t off = j * harpocrates_common::N_ROWS;
+
+      colsub(state + off, inv_lut);
+      add_rc(state + off, harpocrates_common::N_ROUNDS - (i + 1));
+    }
+
+    right_to_left_convoluted_substitution<n_rows>(state, inv_lut);
+  }
+
+  for (size_t i = 0; i < harpocrates_common::N_ROUNDS; i++) {
+    using namespace harpocrates_utils;
+
+    left_to_right_convoluted_substitution<n_rows>(state, lut);
+
+    for (size_t j = 0; j < lanes; j++) {
+      const size_t off = j * harpocrates_common::N_ROWS;
+
+      add_rc(state + off, i);
+      colsub(state + off, lut);
+    }
+
+    right_to_left_convoluted_substitution<n_rows>(state, lut);
+  }
+
+#if defined __clang__
+#pragma unroll 4
+#elif defined __GNUG__
+#pragma GCC ivdep
+#pragma GCC unroll 4
+#endif
+  for (size_t i = 0; i < itr_cnt; i++) {
+    const size_t b_off = i << 2;
+    const size_t r_off = i << 1;
+
+    out[b_off ^ 0] = static_cast<uint8_t>(state[r_off ^ 0] >> 8);
+    out[b_off ^ 1] = static_cast<uint8_t>(state[r_off ^ 0]);
+    out[b_off ^ 2] = static_cast<uint8_t>(state[r_off ^ 1] >> 8);
+    out[b_off ^ 3] = static_cast<uint8_t>(state[r_off ^ 1]);
+  }
+}
+
+// Given N -many consecutive 16 -bytes message blocks, encrypted under old look
+// up table, this routine re-encrypts all of them under new look up table,
+// processing N_LANES blocks at a time ( see transcrypt_lanes ), while trailing
+// blocks are re-encrypted one by one
+//
+// Computes same output as `decrypt_blocks` ( using `inv_lut` ) followed by
+// `encrypt_blocks` ( using `lut` ), without any intermediate buffer; `enc` and
+// `out` may point to same memory ( i.e. in-place re-encryption )
+//
+// Input:
+// - inv_lut: Inverse of old look up table
+// - lut: New look up table
+// - enc: N x 16 input bytes, encrypted under old look up table
+// - n_blocks: N, # -of message blocks
+//
+// Output:
+// - out: N x 16 output bytes, encrypted under new look up table
+template<const harpocrates_utils::column_substitution_t colsub =
+           harpocrates_utils::transposed_column_substitution>
+static inline void
+transcrypt_blocks(const uint8_t* const __restrict inv_lut, // old inverse table
+                  const uint8_t* const __restrict lut,     // new look up table
+                  const uint8_t* const enc,                // encrypted bytes
+                  uint8_t* const out,                      // re-encrypted bytes
+                  const size_t n_blocks                    // # -of blocks
+)
+{
+  constexpr size_t lanes = harpocrates_common::N_LANES;
+  constexpr size_t chunk_len = lanes * harpocrates_common::BLOCK_LEN;
+
+  const size_t n_chunks = n_blocks / lanes;
+
+  for (size_t i = 0; i < n_chunks; i++) {
+    const size_t off = i * chunk_len;
+    transcrypt_lanes<lanes, colsub>(inv_lut, lut, enc + off, out + off);
+  }
+
+  for (size_t i = n_chunks * lanes; i < n_blocks; i++) {
+    const size_t off = i * harpocrates_common::BLOCK_LEN;
+    transcrypt_lanes<1, colsub>(inv_lut, lut, enc + off, out + off);
+  }
+}
+
 }
@@ -0,0 +1,554 @@
+#pragma once
+#include "harpocrates_ctr.hpp"
+#include "harpocrates_xts.hpp"
+#include <algorithm>
+#include <vector>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, used for
+// authenticated encryption, in encrypt-then-MAC composition of counter mode (
+// see `harpocrates_ctr` ) & PMAC, under two distinct look up tables
+//
+// PMAC of message M = M_1 || ... || M_m ( each of 16 -bytes, except M_m, which
+// may be shorter ) is computed as
+//
+// L = E(K, 0^128) | Δ_i = γ_i · L | γ_i = i ^ (i >> 1) ( i.e. Gray code )
+// Σ = E(K, M_1 ^ Δ_1) ^ ... ^ E(K, M_(m-1) ^ Δ_(m-1))
+// T = E(K, Σ ^ M_m ^ L · x^-1), when M_m is of 16 -bytes, otherwise
+// T = E(K, Σ ^ (M_m || 10*))
+//
+// where multiplication happens in GF(2^128), same as `harpocrates_xts`. Each
+// block contributes to Σ independently of others & Δ_i can be computed
+// directly for any i, so blocks are masked & encrypted in batches, using bulk
+// encryption kernel selected at run time ( see `harpocrates_dispatch` ) & split
+// into chunks, whose partial sums are XORed together, across threads.
+//
+// Authenticated string is
+//
+// nonce ( 8 -bytes ) || len(AD) ( 8 -bytes, little-endian ) || AD || 0* || C
+//
+// where associated data ( read AD ) is zero padded to multiple of 16 -bytes, so
+// that tag covers nonce, associated data & cipher text unambiguously. While
+// encrypting, each batch of cipher text is authenticated right after it's
+// computed, while it's still in cache. While decrypting, tag is verified before
+// anything is decrypted.
+//
+// Note, same nonce must never be used for encrypting two different messages,
+// under same pair of look up tables.
+namespace harpocrates_aead {
+
+// Byte length of authentication tag
+constexpr size_t TAG_LEN = 16ul;
+
+// Byte length of nonce
+constexpr size_t NONCE_LEN = harpocrates_ctr::NONCE_LEN;
+
+// # -of message blocks ( i.e. 4 KB ), which are masked & encrypted together, by
+// single call to bulk encryption routine
+constexpr size_t BATCH_BLOCKS = 256ul;
+
+// Halves 16 -bytes little-endian element of GF(2^128) ( i.e. multiplies it by
+// x^-1 ), in place; inverse of `harpocrates_xts::gf_double`
+static inline void
+gf_halve(uint8_t* const t)
+{
+  uint64_t lo = 0ul;
+  uint64_t hi = 0ul;
+
+  for (size_t i = 0; i < 8; i++) {
+    lo |= static_cast<uint64_t>(t[i]) << (i << 3);
+    hi |= static_cast<uint64_t>(t[8 + i]) << (i << 3);
+  }
+
+  const uint64_t carry = lo & 1ul;
+
+  lo ^= carry * 0x87ul;
+  lo = (lo >> 1) | (hi << 63);
+  hi = (hi >> 1) | (carry << 63);
+
+  for (size_t i = 0; i < 8; i++) {
+    t[i] = static_cast<uint8_t>(lo >> (i << 3));
+    t[8 + i] = static_cast<uint8_t>(hi >> (i << 3));
+  }
+}
+
+// XORs 16 -bytes block `src` into `dst`
+static inline void
+xor_block(uint8_t* const __restrict dst, const uint8_t* const __restrict src)
+{
+#if defined __clang__
+#pragma unroll 16
+#elif defined __GNUG__
+#pragma GCC unroll 16
+#endif
+  for (size_t i = 0; i < harpocrates_common::BLOCK_LEN; i++) {
+    dst[i] ^= src[i];
+  }
+}
+
+// Parallelizable message authentication code, keyed by look up table, holding
+// L · x^j, for all j < 64 & L · x^-1, which are computed once
+//
+// Look up table must outlive it.
+class pmac
+{
+public:
+  explicit pmac(const uint8_t* const lut)
+    : lut(lut)
+  {
+    constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+    const uint8_t zero[blk_len] = {};
+    harpocrates_dispatch::encrypt(lut, zero, ls[0]);
+
+    for (size_t j = 1; j < 64; j++) {
+      std::memcpy(ls[j], ls[j - 1], blk_len);
+      harpocrates_xts::gf_double(ls[j]);
+    }
+
+    std::memcpy(l_inv, ls[0], blk_len);
+    gf_halve(l_inv);
+  }
+
+  ~pmac()
+  {
+    harpocrates_utils::secure_zero(ls, sizeof(ls));
+    harpocrates_utils::secure_zero(l_inv, sizeof(l_inv));
+  }
+
+  pmac(const pmac&) = delete;
+  pmac& operator=(const pmac&) = delete;
+
+  // Computes Δ_i = γ_i · L, for i > 0
+  void offset(const uint64_t i, uint8_t* const delta) const
+  {
+    const uint64_t gray = i ^ (i >> 1);
+
+    std::memset(delta, 0, harpocrates_common::BLOCK_LEN);
+    for (size_t j = 0; j < 64; j++) {
+      if ((gray >> j) & 1ul) {
+        xor_block(delta, ls[j]);
+      }
+    }
+  }
+
+  // XORs contributions E(K, M_i ^ Δ_i) of N consecutive 16 -bytes message
+  // blocks, where first one is i-th block of message ( i > 0 ), into Σ,
+  // masking & encrypting BATCH_BLOCKS blocks at a time
+  void absorb(const uint8_t* const __restrict blocks,
+              const uint64_t first,
+              const size_t n_blocks,
+              uint8_t* const __restrict sigma) const
+  {
+    constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+    uint8_t delta[blk_len];
+    uint8_t buf[BATCH_BLOCKS * blk_len];
+
+    offset(first, delta);
+
+    size_t done = 0;
+
+    while (done < n_blocks) {
+      const size_t cnt = std::min(BATCH_BLOCKS, n_blocks - done);
+
+      for (size_t i = 0; i < cnt; i++) {
+        const size_t off = i * blk_len;
+        const uint64_t idx = first + done + i;
+
+        for (size_t k = 0; k < blk_len; k++) {
+          buf[off + k] = blocks[(done + i) * blk_len + k] ^ delta[k];
+        }
+
+        // Δ_(i+1) = Δ_i ^ L · x^ntz(i+1)
+        xor_block(delta, ls[std::countr_zero(idx + 1)]);
+      }
+
+      if (cnt < harpocrates_common::N_LANES) {
+        for (size_t i = 0; i < cnt; i++) {
+          uint8_t blk[blk_len];
+
+          std::memcpy(blk, buf + i * blk_len, blk_len);
+          harpocrates_dispatch::encrypt(lut, blk, buf + i * blk_len);
+        }
+      } else {
+        harpocrates_dispatch::encrypt_blocks(lut, buf, buf, cnt);
+      }
+
+      for (size_t i = 0; i < cnt; i++) {
+        xor_block(sigma, buf + i * blk_len);
+      }
+
+      done += cnt;
+    }
+  }
+
+  // Computes tag from Σ & final block of message, which is of 1 to 16 -bytes (
+  // or empty, when whole message is empty )
+  void finalize(const uint8_t* const __restrict sigma,
+                const uint8_t* const __restrict last,
+                const size_t last_len,
+                uint8_t* const __restrict tag) const
+  {
+    constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+    uint8_t blk[blk_len];
+    std::memcpy(blk, sigma, blk_len);
+
+    if (last_len == blk_len) {
+      xor_block(blk, last);
+      xor_block(blk, l_inv);
+    } else {
+      for (size_t i = 0; i < last_len; i++) {
+        blk[i] ^= last[i];
+      }
+      blk[last_len] ^= 0x80;
+    }
+
+    harpocrates_dispatch::encrypt(lut, blk, tag);
+  }
+
+  // Computes 16 -bytes tag of N -bytes message ( of any length, including
+  // empty one, which is treated as single, padded, block )
+  void tag(const uint8_t* const __restrict msg,
+           const size_t len,
+           uint8_t* const __restrict out) const
+  {
+    constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+    const size_t n_blocks = len == 0 ? 0 : (len - 1) / blk_len;
+    uint8_t sigma[blk_len] = {};
+
+    absorb(msg, 1, n_blocks, sigma);
+    finalize(sigma, msg + n_blocks * blk_len, len - n_blocks * blk_len, out);
+  }
+
+  // Computes 16 -bytes tag of N -bytes message, same as above, but message
+  // blocks are split into chunks of `chunk_blocks` blocks, whose partial sums
+  // are computed by workers of thread pool
+  void tag(harpocrates_parallel::thread_pool& pool,
+           const uint8_t* const __restrict msg,
+           const size_t len,
+           uint8_t* const __restrict out,
+           const size_t chunk_blocks = harpocrates_parallel::CHUNK_BLOCKS) const
+  {
+    constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+    const size_t n_blocks = len == 0 ? 0 : (len - 1) / blk_len;
+    uint8_t sigma[blk_len] = {};
+
+    absorb(pool, msg, 1, n_blocks, sigma, chunk_blocks);
+    finalize(sigma, msg + n_blocks * blk_len, len - n_blocks * blk_len, out);
+  }
+
+  // XORs contributions of N consecutive message blocks into Σ, same as above,
+  // but blocks are split into chunks, absorbed by workers of thread pool, into
+  // partial sums, which are XORed together once all of them are done
+  void absorb(harpocrates_parallel::thread_pool& pool,
+              const uint8_t* const __restrict blocks,
+              const uint64_t first,
+              const size_t n_blocks,
+              uint8_t* const __restrict sigma,
+              const size_t chunk_blocks) const
+  {
+    constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+    auto fn = [&](const size_t beg, const size_t cnt, uint8_t* const part) {
+      absorb(blocks + beg * blk_len, first + beg, cnt, part);
+    };
+
+    combine(pool, n_blocks, chunk_blocks, sigma, fn);
+  }
+
+  // Splits N blocks into chunks of `chunk_blocks` blocks, invoking `fn(beg,
+  // cnt, part)` for each chunk, on workers of thread pool, where `part` is
+  // partial sum of that chunk, before XORing all partial sums into Σ
+  template<typename F>
+  static void combine(harpocrates_parallel::thread_pool& pool,
+                      const size_t n_blocks,
+                      const size_t chunk_blocks,
+                      uint8_t* const sigma,
+                      F&& fn)
+  {
+    constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+    const size_t n_chunks = (n_blocks + chunk_blocks - 1) / chunk_blocks;
+    std::vector<uint8_t> parts(n_chunks * blk_len, 0);
+
+    pool.parallel_for(n_chunks, [&](const size_t i) {
+      const size_t beg = i * chunk_blocks;
+      const size_t cnt = std::min(chunk_blocks, n_blocks - beg);
+
+      fn(beg, cnt, parts.data() + i * blk_len);
+    });
+
+    for (size_t i = 0; i < n_chunks; i++) {
+      xor_block(sigma, parts.data() + i * blk_len);
+    }
+  }
+
+private:
+  const uint8_t* lut;
+  uint8_t ls[64][harpocrates_common::BLOCK_LEN];
+  uint8_t l_inv[harpocrates_common::BLOCK_LEN];
+};
+
+// Authenticated encryption, keyed by look up table for counter mode
+// encryption & another, distinct, look up table for PMAC; both must outlive it
+class aead
+{
+public:
+  aead(const uint8_t* const enc_lut, const uint8_t* const mac_lut)
+    : enc_lut(enc_lut)
+    , mac(mac_lut)
+  {
+  }
+
+  aead(const aead&) = delete;
+  aead& operator=(const aead&) = delete;
+
+  // Encrypts N -bytes message in counter mode & then computes 16 -bytes tag
+  // over nonce, associated data & cipher text; `txt` and `enc` may point to
+  // same memory
+  void seal(const uint8_t* const __restrict nonce, // 8 -bytes nonce
+            const uint8_t* const __restrict ad,    // associated data
+            const size_t ad_len,                   // # -of bytes of AD
+            const uint8_t* const txt,              // plain text
+            uint8_t* const enc,                    // cipher text
+            const size_t len,                      // # -of bytes of message
+            uint8_t* const __restrict tag          // 16 -bytes tag
+  ) const
+  {
+    uint8_t sigma[harpocrates_common::BLOCK_LEN] = {};
+    const layout_t lay = prefix(nonce, ad, ad_len, len, sigma);
+
+    seal_blocks(nonce, txt, enc, 0, lay.ct_blocks, lay.ct_first, sigma);
+    finish<true>(nonce, ad, ad_len, lay, txt, enc, len, sigma, tag);
+  }
+
+  // Encrypts & authenticates N -bytes message, same as above, but cipher text
+  // blocks are split into chunks of `chunk_blocks` blocks, each of which is
+  // encrypted & authenticated by some worker of thread pool
+  void seal(harpocrates_parallel::thread_pool& pool,
+            const uint8_t* const __restrict nonce,
+            const uint8_t* const __restrict ad,
+            const size_t ad_len,
+            const uint8_t* const txt,
+            uint8_t* const enc,
+            const size_t len,
+            uint8_t* const __restrict tag,
+            const size_t chunk_blocks =
+              harpocrates_parallel::CHUNK_BLOCKS) const
+  {
+    uint8_t sigma[harpocrates_common::BLOCK_LEN] = {};
+    const layout_t lay = prefix(nonce, ad, ad_len, len, sigma);
+
+    auto fn = [&](const size_t beg, const size_t cnt, uint8_t* const part) {
+      seal_blocks(nonce, txt, enc, beg, cnt, lay.ct_first, part);
+    };
+
+    pmac::combine(pool, lay.ct_blocks, chunk_blocks, sigma, fn);
+
+    finish<true>(nonce, ad, ad_len, lay, txt, enc, len, sigma, tag);
+  }
+
+  // Verifies 16 -bytes tag over nonce, associated data & N -bytes cipher text
+  // & only when it's valid, decrypts cipher text; returns false, leaving `txt`
+  // untouched, when tag isn't valid. `enc` and `txt` may point to same memory.
+  bool open(const uint8_t* const __restrict nonce, // 8 -bytes nonce
+            const uint8_t* const __restrict ad,    // associated data
+            const size_t ad_len,                   // # -of bytes of AD
+            const uint8_t* const enc,              // cipher text
+            uint8_t* const txt,                    // plain text
+            const size_t len,                      // # -of bytes of message
+            const uint8_t* const __restrict tag    // 16 -bytes tag
+  ) const
+  {
+    constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+    uint8_t sigma[blk_len] = {};
+    const layout_t lay = prefix(nonce, ad, ad_len, len, sigma);
+
+    mac.absorb(enc, lay.ct_first, lay.ct_blocks, sigma);
+
+    uint8_t expected[TAG_LEN];
+    finish<false>(nonce, ad, ad_len, lay, enc, txt, len, sigma, expected);
+
+    if (!equal(expected, tag)) {
+      return false;
+    }
+
+    harpocrates_ctr::crypt(enc_lut, nonce, 0, enc, txt, len);
+    return true;
+  }
+
+  // Verifies tag & decrypts N -bytes cipher text, same as above, but cipher
+  // text blocks are split into chunks of `chunk_blocks` blocks, which are
+  // authenticated & then decrypted by workers of thread pool
+  bool open(harpocrates_parallel::thread_pool& pool,
+            const uint8_t* const __restrict nonce,
+            const uint8_t* const __restrict ad,
+            const size_t ad_len,
+            const uint8_t* const enc,
+            uint8_t* const txt,
+            const size_t len,
+            const uint8_t* const __restrict tag,
+            const size_t chunk_blocks =
+              harpocrates_parallel::CHUNK_BLOCKS) const
+  {
+    constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+    uint8_t sigma[blk_len] = {};
+    const layout_t lay = prefix(nonce, ad, ad_len, len, sigma);
+
+    mac.absorb(pool, enc, lay.ct_first, lay.ct_blocks, sigma, chunk_blocks);
+
+    uint8_t expected[TAG_LEN];
+    finish<false>(nonce, ad, ad_len, lay, enc, txt, len, sigma, expected);
+
+    if (!equal(expected, tag)) {
+      return false;
+    }
+
+    harpocrates_ctr::crypt(
+      pool, enc_lut, nonce, 0, enc, txt, len, chunk_blocks * blk_len);
+    return true;
+  }
+
+private:
+  // Position of cipher text in authenticated string, where all but final
+  // block of authenticated string are absorbed into Σ, while `ct_blocks` is #
+  // -of such blocks of cipher text, starting at `ct_first` -th block of
+  // authenticated string
+  struct layout_t
+  {
+    uint64_t ct_first;
+    size_t ct_blocks;
+  };
+
+  // Prepares header block ( nonce || len(AD) ) of authenticated string
+  static void header(const uint8_t* const __restrict nonce,
+                     const size_t ad_len,
+                     uint8_t* const __restrict hdr)
+  {
+    std::memcpy(hdr, nonce, NONCE_LEN);
+    for (size_t i = 0; i < 8; i++) {
+      hdr[NONCE_LEN + i] = static_cast<uint8_t>(ad_len >> (i << 3));
+    }
+  }
+
+  // Absorbs header & zero padded associated data into Σ, except final block
+  // of authenticated string, when cipher text is empty
+  layout_t prefix(const uint8_t* const __restrict nonce,
+                  const uint8_t* const __restrict ad,
+                  const size_t ad_len,
+                  const size_t len,
+                  uint8_t* const __restrict sigma) const
+  {
+    constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+    const size_t ad_full = ad_len / blk_len;
+    const size_t ad_blocks = (ad_len + blk_len - 1) / blk_len;
+    const bool empty = len == 0;
+
+    // header, unless it's final block
+    if (!empty || ad_blocks > 0) {
+      uint8_t hdr[blk_len];
+      header(nonce, ad_len, hdr);
+      mac.absorb(hdr, 1, 1, sigma);
+    }
+
+    // full blocks of associated data, except final block
+    const size_t n_full = empty && ad_full == ad_blocks && ad_full > 0
+                            ? ad_full - 1
+                            : ad_full;
+    mac.absorb(ad, 2, n_full, sigma);
+
+    // zero padded partial block of associated data, unless it's final block
+    if (!empty && ad_full < ad_blocks) {
+      uint8_t pad[blk_len] = {};
+      std::memcpy(pad, ad + ad_full * blk_len, ad_len - ad_full * blk_len);
+      mac.absorb(pad, 2 + ad_full, 1, sigma);
+    }
+
+    return { 2 + ad_blocks, empty ? 0 : (len - 1) / blk_len };
+  }
+
+  // Encrypts `cnt` cipher text blocks, starting at `beg` -th one, in batches,
+  // absorbing each batch of cipher text into Σ, right after it's computed
+  void seal_blocks(const uint8_t* const __restrict nonce,
+                   const uint8_t* const txt,
+                   uint8_t* const enc,
+                   const size_t beg,
+                   const size_t cnt,
+                   const uint64_t ct_first,
+                   uint8_t* const __restrict sigma) const
+  {
+    constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+    for (size_t done = 0; done < cnt; done += BATCH_BLOCKS) {
+      const size_t n = std::min(BATCH_BLOCKS, cnt - done);
+      const size_t off = (beg + done) * blk_len;
+
+      harpocrates_ctr::crypt(
+        enc_lut, nonce, off, txt + off, enc + off, n * blk_len);
+      mac.absorb(enc + off, ct_first + beg + done, n, sigma);
+    }
+  }
+
+  // Encrypts ( when `encrypt` is set ) final block of message & computes tag
+  // from Σ & final block of authenticated string, which is final block of
+  // cipher text, or of header & zero padded associated data, when cipher text
+  // is empty
+  template<const bool encrypt>
+  void finish(const uint8_t* const __restrict nonce,
+              const uint8_t* const __restrict ad,
+              const size_t ad_len,
+              const layout_t& lay,
+              const uint8_t* const in,
+              uint8_t* const out,
+              const size_t len,
+              const uint8_t* const __restrict sigma,
+              uint8_t* const __restrict tag) const
+  {
+    constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+    uint8_t last[blk_len] = {};
+    size_t last_len = blk_len;
+
+    if (len > 0) {
+      const size_t off = lay.ct_blocks * blk_len;
+      last_len = len - off;
+
+      if constexpr (encrypt) {
+        harpocrates_ctr::crypt(
+          enc_lut, nonce, off, in + off, out + off, last_len);
+        std::memcpy(last, out + off, last_len);
+      } else {
+        std::memcpy(last, in + off, last_len);
+      }
+    } else if (ad_len > 0) {
+      const size_t off = ((ad_len - 1) / blk_len) * blk_len;
+      std::memcpy(last, ad + off, ad_len - off);
+    } else {
+      header(nonce, ad_len, last);
+    }
+
+    mac.finalize(sigma, last, last_len, tag);
+  }
+
+  // Compares tags in constant time
+  static bool equal(const uint8_t* const a, const uint8_t* const b)
+  {
+    uint8_t acc = 0;
+    for (size_t i = 0; i < TAG_LEN; i++) {
+      acc |= a[i] ^ b[i];
+    }
+
+    return acc == 0;
+  }
+
+  const uint8_t* enc_lut;
+  pmac mac;
+};
+
+}
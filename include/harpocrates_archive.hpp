@@ -0,0 +1,575 @@
+#pragma once
+#include "harpocrates_ctr.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <random>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, used for
+// storing large message as random-access encrypted archive, from which any
+// byte range can be decrypted, without decrypting ( or even reading ) bytes
+// preceding it
+//
+// Message is split into fixed size chunks ( last one may be shorter ), which
+// are encrypted in counter mode ( see `harpocrates_ctr` ), under randomly
+// chosen 8 -bytes nonce of archive, with counter of each chunk continuing from
+// its byte offset in message, so that no two chunks of archive share any
+// keystream block. Nonces of archives written under same look up table are
+// likely to collide after ~2^32 archives, so look up table must be replaced
+// well before that. Archive is laid out as
+//
+// - 64 -bytes header ( see `header_t` ), holding nonce of archive
+// - encrypted chunks, one after another, starting at page boundary
+// - trailing index, holding one 32 -bytes entry per chunk ( see `index_t` ),
+//   which records offset & length of that chunk
+//
+// So reader finds chunks covering any byte range by division, decrypting only
+// those keystream blocks which overlap with range, while chunks of many ranges
+// are decrypted by workers of thread pool. As with keystore ( see
+// `harpocrates_keystore` ), all integers are in byte order of host, which is
+// recorded in header.
+//
+// Note, archive provides confidentiality only; chunks aren't authenticated.
+namespace harpocrates_archive {
+
+// Magic bytes, at start of archive
+constexpr char MAGIC[8] = { 'H', 'R', 'P', 'C', 'A', 'R', 'C', 'H' };
+
+// Version of archive format
+constexpr uint32_t VERSION = 2u;
+
+// Written as is, for detecting archive built on host of other byte order
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+
+// Offset of first chunk, in archive
+constexpr uint64_t DATA_OFF = 4096ul;
+
+// Default byte length of chunks ( i.e. 64 KB ), which must be a multiple of 16
+// -bytes; smaller chunks waste less work on reads of short ranges, while
+// costing larger index
+constexpr size_t CHUNK_LEN = 1ul << 16;
+
+// Header of archive
+struct header_t
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t chunk_len;
+  uint64_t n_chunks;
+  uint64_t data_len; // byte length of message
+  uint64_t index_off;
+  uint64_t file_len;
+  uint8_t nonce[harpocrates_ctr::NONCE_LEN];
+};
+
+// Index entry of a chunk
+struct index_t
+{
+  uint64_t off; // offset of chunk, in archive
+  uint64_t len; // byte length of chunk
+  uint64_t reserved[2];
+};
+
+static_assert(sizeof(header_t) == 64, "Header must be of 64 -bytes");
+static_assert(sizeof(index_t) == 32, "Index entry must be of 32 -bytes");
+
+// Byte range of message, which is to be decrypted into `out`
+struct range_t
+{
+  uint64_t offset;
+  uint8_t* out;
+  size_t len;
+};
+
+// Rounds up to next multiple of `align`, which must be a power of 2
+static inline uint64_t
+align_up(const uint64_t n, const uint64_t align)
+{
+  return (n + align - 1) & ~(align - 1);
+}
+
+// Writes all bytes at given offset of file
+static inline bool
+write_at(const int fd, const void* const buf, const size_t len, uint64_t off)
+{
+  const uint8_t* ptr = static_cast<const uint8_t*>(buf);
+  size_t left = len;
+
+  while (left > 0) {
+    const ssize_t n = ::pwrite(fd, ptr, left, static_cast<off_t>(off));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+
+    ptr += n;
+    off += static_cast<uint64_t>(n);
+    left -= static_cast<size_t>(n);
+  }
+
+  return true;
+}
+
+// Writes message of arbitrary length, which is passed in pieces, as archive,
+// encrypting each chunk as soon as it's full
+//
+// Archive is written to a uniquely named temporary file, readable only by its
+// owner, which is renamed to its path by `close`, once index & header are
+// written, so that readers never see a partially written archive, while
+// concurrent writers of same archive never write to same file. Look up table
+// must outlive writer. When writer goes out of scope without being closed,
+// temporary file is removed.
+class writer
+{
+public:
+  writer() = default;
+  writer(const writer&) = delete;
+  writer& operator=(const writer&) = delete;
+
+  ~writer() { abort(); }
+
+  // Starts writing archive to `path`, under given look up table, splitting
+  // message into chunks of `chunk_len` -bytes; returns false, leaving cause in
+  // `errno` ( EINVAL, when chunk length isn't a non-zero multiple of 16 -bytes
+  // )
+  bool open(const char* const path,
+            const uint8_t* const lut,
+            const size_t chunk_len = CHUNK_LEN)
+  {
+    abort();
+
+    if (chunk_len == 0 || chunk_len % harpocrates_common::BLOCK_LEN != 0) {
+      errno = EINVAL;
+      return false;
+    }
+
+    this->path = path;
+    tmp_path = this->path + ".XXXXXX";
+
+    // created exclusively, so that it neither truncates some other writer's
+    // file nor follows a planted symbolic link
+    fd = ::mkstemp(tmp_path.data());
+    if (fd < 0) {
+      return false;
+    }
+
+    std::random_device rd;
+
+    for (size_t i = 0; i < harpocrates_ctr::NONCE_LEN; i += 4) {
+      const uint32_t v = rd();
+      std::memcpy(nonce + i, &v, 4);
+    }
+
+    this->lut = lut;
+    this->chunk_len = chunk_len;
+    buf.resize(chunk_len);
+    filled = 0;
+    index.clear();
+
+    return true;
+  }
+
+  // Appends N bytes to message; chunks which get full are encrypted & written
+  bool write(const uint8_t* const data, const size_t len)
+  {
+    if (fd < 0) {
+      errno = EBADF;
+      return false;
+    }
+
+    size_t done = 0;
+
+    while (done < len) {
+      // whole chunk is encrypted straight out of `data`, without staging it
+      if (filled == 0 && len - done >= chunk_len) {
+        if (!flush(data + done, chunk_len)) {
+          return false;
+        }
+
+        done += chunk_len;
+        continue;
+      }
+
+      const size_t take = std::min(chunk_len - filled, len - done);
+      std::memcpy(buf.data() + filled, data + done, take);
+
+      filled += take;
+      done += take;
+
+      if (filled == chunk_len) {
+        filled = 0;
+
+        if (!flush(buf.data(), chunk_len)) {
+          return false;
+        }
+      }
+    }
+
+    return true;
+  }
+
+  // Encrypts & writes last partially filled chunk, followed by index & header,
+  // before renaming archive to its path; returns false, leaving cause in
+  // `errno`
+  bool close()
+  {
+    if (fd < 0) {
+      errno = EBADF;
+      return false;
+    }
+
+    bool ok = filled == 0 || flush(buf.data(), filled);
+    filled = 0;
+
+    header_t hdr;
+    std::memset(&hdr, 0, sizeof(hdr));
+    std::memcpy(hdr.magic, MAGIC, sizeof(MAGIC));
+
+    hdr.version = VERSION;
+    hdr.byte_order = BYTE_ORDER_MARK;
+    hdr.chunk_len = chunk_len;
+    hdr.n_chunks = index.size();
+    hdr.data_len = data_end() - DATA_OFF;
+    hdr.index_off = align_up(data_end(), alignof(index_t));
+    hdr.file_len = hdr.index_off + index.size() * sizeof(index_t);
+    std::memcpy(hdr.nonce, nonce, sizeof(nonce));
+
+    const size_t index_len = index.size() * sizeof(index_t);
+
+    ok = ok && write_at(fd, index.data(), index_len, hdr.index_off);
+    ok = ok && write_at(fd, &hdr, sizeof(hdr), 0);
+    ok = ok && ::ftruncate(fd, static_cast<off_t>(hdr.file_len)) == 0;
+    ok = ok && ::fsync(fd) == 0;
+    ok = (::close(fd) == 0) && ok;
+    fd = -1;
+
+    ok = ok && std::rename(tmp_path.c_str(), path.c_str()) == 0;
+
+    if (!ok) {
+      const int err = errno;
+      ::unlink(tmp_path.c_str());
+      errno = err;
+    }
+
+    wipe();
+    return ok;
+  }
+
+private:
+  // Offset of byte following last chunk written so far
+  uint64_t data_end() const
+  {
+    return index.empty() ? DATA_OFF : index.back().off + index.back().len;
+  }
+
+  // Encrypts N ( at most `chunk_len` ) bytes as next chunk, continuing
+  // keystream of archive from chunk's offset in message, writing it to archive
+  bool flush(const uint8_t* const data, const size_t len)
+  {
+    index_t e;
+    std::memset(&e, 0, sizeof(e));
+
+    e.off = data_end();
+    e.len = len;
+
+    const uint64_t pos = e.off - DATA_OFF;
+    harpocrates_ctr::crypt(lut, nonce, pos, data, buf.data(), len);
+
+    if (!write_at(fd, buf.data(), len, e.off)) {
+      return false;
+    }
+
+    index.push_back(e);
+    return true;
+  }
+
+  // Removes temporary file, when archive isn't closed
+  void abort()
+  {
+    if (fd >= 0) {
+      ::close(fd);
+      ::unlink(tmp_path.c_str());
+    }
+
+    fd = -1;
+    wipe();
+  }
+
+  // Erases plain text, which may be staged in chunk buffer
+  void wipe()
+  {
+    harpocrates_utils::secure_zero(buf.data(), buf.size());
+    filled = 0;
+  }
+
+  int fd = -1;
+  std::string path;
+  std::string tmp_path;
+  const uint8_t* lut = nullptr;
+  size_t chunk_len = 0;
+  std::vector<uint8_t> buf;
+  size_t filled = 0;
+  std::vector<index_t> index;
+  uint8_t nonce[harpocrates_ctr::NONCE_LEN] = {};
+};
+
+// Archive mapped read-only into memory, which is unmapped when it goes out of
+// scope; any byte range of message can be decrypted from it, given look up
+// table, under which it was written
+class reader
+{
+public:
+  reader() = default;
+  reader(const reader&) = delete;
+  reader& operator=(const reader&) = delete;
+
+  ~reader() { close(); }
+
+  // Maps archive & validates its header & index; returns false, leaving cause
+  // in `errno` ( EINVAL, when it's not a valid archive )
+  bool open(const char* const path)
+  {
+    close();
+
+    const int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      const int err = errno;
+      ::close(fd);
+      errno = err;
+
+      return false;
+    }
+
+    len = static_cast<size_t>(st.st_size);
+    if (len < sizeof(header_t)) {
+      ::close(fd);
+      len = 0;
+      errno = EINVAL;
+
+      return false;
+    }
+
+    void* const addr = ::mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+    const int err = errno;
+    ::close(fd);
+
+    if (addr == MAP_FAILED) {
+      len = 0;
+      errno = err;
+
+      return false;
+    }
+
+    base = static_cast<const uint8_t*>(addr);
+    if (!valid()) {
+      close();
+      errno = EINVAL;
+
+      return false;
+    }
+
+    // ranges are read in arbitrary order, so reading ahead is wasted
+    ::madvise(const_cast<uint8_t*>(base), len, MADV_RANDOM);
+
+    return true;
+  }
+
+  // Unmaps archive, if it's open
+  void close()
+  {
+    if (base != nullptr) {
+      ::munmap(const_cast<uint8_t*>(base), len);
+    }
+
+    base = nullptr;
+    len = 0;
+  }
+
+  // Byte length of message
+  uint64_t size() const { return base == nullptr ? 0 : header()->data_len; }
+
+  // Byte length of chunks
+  size_t chunk_len() const
+  {
+    return base == nullptr ? 0 : static_cast<size_t>(header()->chunk_len);
+  }
+
+  // # -of chunks
+  size_t n_chunks() const
+  {
+    return base == nullptr ? 0 : static_cast<size_t>(header()->n_chunks);
+  }
+
+  // Decrypts N bytes of message, starting at given byte offset, into `out`,
+  // touching only those chunks which overlap with range; returns false, when
+  // archive isn't open or range doesn't lie within message
+  bool read(const uint8_t* const __restrict lut, // look up table
+            const uint64_t offset,               // byte offset in message
+            uint8_t* const __restrict out,       // decrypted bytes
+            const size_t len                     // # -of bytes
+  ) const
+  {
+    if (base == nullptr || !within(offset, len)) {
+      return false;
+    }
+
+    const uint64_t c_len = header()->chunk_len;
+    size_t done = 0;
+
+    while (done < len) {
+      const uint64_t pos = offset + done;
+      const size_t take = std::min<uint64_t>(c_len - pos % c_len, len - done);
+
+      crypt_piece(lut, pos, out + done, take);
+      done += take;
+    }
+
+    return true;
+  }
+
+  // Decrypts N byte ranges of message, where each range is split at chunk
+  // boundaries & those pieces are decrypted by workers of thread pool; returns
+  // false, without decrypting anything, when archive isn't open or some range
+  // doesn't lie within message
+  bool read(harpocrates_parallel::thread_pool& pool, // reusable thread pool
+            const uint8_t* const __restrict lut,     // look up table
+            const range_t* const ranges,             // byte ranges
+            const size_t n_ranges                    // # -of ranges
+  ) const
+  {
+    struct piece_t
+    {
+      uint64_t pos;
+      uint8_t* out;
+      size_t len;
+    };
+
+    if (base == nullptr) {
+      return false;
+    }
+
+    const uint64_t c_len = chunk_len();
+    std::vector<piece_t> pieces;
+
+    for (size_t i = 0; i < n_ranges; i++) {
+      const range_t& r = ranges[i];
+
+      if (!within(r.offset, r.len)) {
+        return false;
+      }
+
+      size_t done = 0;
+
+      while (done < r.len) {
+        const uint64_t pos = r.offset + done;
+        const size_t take =
+          std::min<uint64_t>(c_len - pos % c_len, r.len - done);
+
+        pieces.push_back({ pos, r.out + done, take });
+        done += take;
+      }
+    }
+
+    pool.parallel_for(pieces.size(), [&](const size_t i) {
+      crypt_piece(lut, pieces[i].pos, pieces[i].out, pieces[i].len);
+    });
+
+    return true;
+  }
+
+private:
+  const header_t* header() const
+  {
+    return reinterpret_cast<const header_t*>(base);
+  }
+
+  const index_t* index() const
+  {
+    return reinterpret_cast<const index_t*>(base + header()->index_off);
+  }
+
+  // Checks whether N bytes starting at given byte offset lie within message
+  bool within(const uint64_t offset, const size_t n) const
+  {
+    const uint64_t total = size();
+    return offset <= total && n <= total - offset;
+  }
+
+  // Decrypts N bytes of message, starting at given byte offset, which lie in
+  // same chunk
+  void crypt_piece(const uint8_t* const __restrict lut,
+                   const uint64_t pos,
+                   uint8_t* const __restrict out,
+                   const size_t n) const
+  {
+    const header_t* const hdr = header();
+    const index_t& e = index()[pos / hdr->chunk_len];
+    const uint64_t c_off = pos % hdr->chunk_len;
+
+    harpocrates_ctr::crypt(lut, hdr->nonce, pos, base + e.off + c_off, out, n);
+  }
+
+  // Checks header & all index entries, so that i-th chunk covers bytes [i *
+  // chunk_len, (i + 1) * chunk_len) of message & lies within mapping
+  bool valid() const
+  {
+    const header_t* const hdr = header();
+    const uint64_t c_len = hdr->chunk_len;
+
+    if (std::memcmp(hdr->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        hdr->version != VERSION || hdr->byte_order != BYTE_ORDER_MARK ||
+        hdr->file_len != len || c_len == 0 ||
+        c_len % harpocrates_common::BLOCK_LEN != 0 ||
+        hdr->index_off % alignof(index_t) != 0) {
+      return false;
+    }
+
+    const uint64_t n_chunks =
+      hdr->data_len / c_len + (hdr->data_len % c_len != 0 ? 1 : 0);
+
+    if (hdr->data_len > len || hdr->n_chunks != n_chunks) {
+      return false;
+    }
+
+    if (hdr->index_off > len ||
+        hdr->n_chunks > (len - hdr->index_off) / sizeof(index_t)) {
+      return false;
+    }
+
+    const index_t* const idx = index();
+
+    for (size_t i = 0; i < hdr->n_chunks; i++) {
+      const index_t& e = idx[i];
+      const uint64_t beg = i * c_len;
+
+      if (e.len != std::min(c_len, hdr->data_len - beg)) {
+        return false;
+      }
+      if (e.off < DATA_OFF || e.off > hdr->index_off ||
+          hdr->index_off - e.off < e.len) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  const uint8_t* base = nullptr;
+  size_t len = 0;
+};
+
+}
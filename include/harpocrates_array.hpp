@@ -0,0 +1,321 @@
+#pragma once
+#include "harpocrates_ctr.hpp"
+#include "harpocrates_dispatch.hpp"
+#include <algorithm>
+#include <compare>
+#include <iterator>
+#include <random>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, keeping
+// array of trivially copyable elements encrypted in memory, while exposing it
+// as a C++20 random-access range, whose elements are decrypted lazily, as
+// they're accessed
+//
+// Elements are encrypted in counter mode ( see `harpocrates_ctr` ), under
+// randomly chosen nonce, so that any group of `group_blocks` consecutive 16
+// -bytes blocks can be decrypted on its own. Each iterator caches one
+// decrypted group, so that scanning elements lying in same group decrypts it
+// only once, while partial scans decrypt only groups they touch & never hold
+// more than one group of plain text, per iterator. Groups of fewer than
+// N_LANES blocks are decrypted one block at a time, as vectorized bulk kernels
+// always work on many blocks. Indexing array itself doesn't cache anything, it
+// decrypts only block(s) covering requested element.
+//
+// Elements straddling group boundaries ( when element size doesn't divide
+// group size ) are assembled from both groups.
+namespace harpocrates_array {
+
+// # -of blocks decrypted together, by default, which is kept small, so that
+// each iterator caches only 128 -bytes of plain text, which is cheap to copy &
+// erase, trading off scan throughput, as AVX2/ AVX-512 kernels ( 32/ 64 lanes
+// ) run mostly idle on so few blocks; ask for `MAX_LANES` blocks ( see
+// `harpocrates_dispatch` ), when long scans dominate, or a single block, when
+// elements are mostly accessed randomly
+constexpr size_t GROUP_BLOCKS = harpocrates_common::N_LANES;
+
+// Array of N elements of type T, encrypted under given look up table, which
+// must outlive array ( & all of its iterators ); contents are fixed once it's
+// constructed
+template<typename T, const size_t group_blocks = GROUP_BLOCKS>
+class encrypted_array
+{
+  static_assert(std::is_trivially_copyable_v<T>,
+                "Elements must be trivially copyable");
+  static_assert(group_blocks > 0, "Group must hold at least one block");
+
+public:
+  // Byte length of group of blocks, decrypted together
+  static constexpr size_t GROUP_LEN =
+    group_blocks * harpocrates_common::BLOCK_LEN;
+
+  class iterator;
+
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using const_iterator = iterator;
+
+  // Encrypts N elements, under given look up table & freshly chosen nonce
+  encrypted_array(const uint8_t* const lut, const T* const data, const size_t n)
+    : lut(lut)
+    , len(n)
+    , enc(n * sizeof(T))
+  {
+    std::random_device rd;
+
+    for (size_t i = 0; i < harpocrates_ctr::NONCE_LEN; i += 4) {
+      const uint32_t v = rd();
+      std::memcpy(nonce + i, &v, 4);
+    }
+
+    const uint8_t* const txt = reinterpret_cast<const uint8_t*>(data);
+    harpocrates_ctr::crypt(lut, nonce, 0, txt, enc.data(), enc.size());
+  }
+
+  encrypted_array(const uint8_t* const lut, const std::span<const T> data)
+    : encrypted_array(lut, data.data(), data.size())
+  {
+  }
+
+  // # -of elements
+  size_t size() const { return len; }
+  bool empty() const { return len == 0; }
+
+  // Encrypted bytes of all elements
+  const uint8_t* data() const { return enc.data(); }
+
+  // Decrypts i-th element, decrypting only block(s) holding it, at most a
+  // group at a time
+  T operator[](const size_t i) const
+  {
+    constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+    T v;
+    uint8_t* const dst = reinterpret_cast<uint8_t*>(&v);
+
+    const size_t off = i * sizeof(T);
+    const size_t last = (off + sizeof(T) - 1) / blk_len;
+
+    uint8_t buf[GROUP_LEN];
+    size_t done = 0;
+
+    while (done < sizeof(T)) {
+      const size_t pos = off + done;
+      const size_t blk = pos / blk_len;
+      const size_t n_blocks = std::min(group_blocks, last - blk + 1);
+
+      decrypt_blocks(blk, n_blocks, buf);
+
+      const size_t b_off = pos % blk_len;
+      const size_t avail = n_blocks * blk_len - b_off;
+      const size_t take = std::min(avail, sizeof(T) - done);
+
+      std::memcpy(dst + done, buf + b_off, take);
+      done += take;
+    }
+
+    harpocrates_utils::secure_zero(buf, sizeof(buf));
+    return v;
+  }
+
+  // Decrypts all elements into `out`, using bulk counter mode routine
+  void decrypt(T* const out) const
+  {
+    uint8_t* const dst = reinterpret_cast<uint8_t*>(out);
+    harpocrates_ctr::crypt(lut, nonce, 0, enc.data(), dst, enc.size());
+  }
+
+  iterator begin() const { return iterator(this, 0); }
+  iterator end() const { return iterator(this, static_cast<ptrdiff_t>(len)); }
+
+  // Random-access view over all elements, which can be sliced & composed
+  // with range adaptors, decrypting lazily
+  std::ranges::subrange<iterator> view() const { return { begin(), end() }; }
+
+  // Random-access iterator, whose dereferencing decrypts element ( returned by
+  // value ), caching decrypted group holding it, which is erased, when
+  // iterator goes out of scope
+  class iterator
+  {
+  public:
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::input_iterator_tag;
+    using value_type = T;
+    using difference_type = ptrdiff_t;
+
+    iterator() = default;
+
+    iterator(const iterator& other) = default;
+    iterator& operator=(const iterator& other) = default;
+
+    ~iterator() { harpocrates_utils::secure_zero(cache, sizeof(cache)); }
+
+    T operator*() const { return load(static_cast<size_t>(idx)); }
+
+    T operator[](const ptrdiff_t n) const
+    {
+      return load(static_cast<size_t>(idx + n));
+    }
+
+    iterator& operator++()
+    {
+      idx++;
+      return *this;
+    }
+
+    iterator operator++(int)
+    {
+      iterator tmp = *this;
+      idx++;
+      return tmp;
+    }
+
+    iterator& operator--()
+    {
+      idx--;
+      return *this;
+    }
+
+    iterator operator--(int)
+    {
+      iterator tmp = *this;
+      idx--;
+      return tmp;
+    }
+
+    iterator& operator+=(const ptrdiff_t n)
+    {
+      idx += n;
+      return *this;
+    }
+
+    iterator& operator-=(const ptrdiff_t n)
+    {
+      idx -= n;
+      return *this;
+    }
+
+    friend iterator operator+(iterator it, const ptrdiff_t n)
+    {
+      it += n;
+      return it;
+    }
+
+    friend iterator operator+(const ptrdiff_t n, iterator it)
+    {
+      it += n;
+      return it;
+    }
+
+    friend iterator operator-(iterator it, const ptrdiff_t n)
+    {
+      it -= n;
+      return it;
+    }
+
+    friend ptrdiff_t operator-(const iterator& a, const iterator& b)
+    {
+      return a.idx - b.idx;
+    }
+
+    friend bool operator==(const iterator& a, const iterator& b)
+    {
+      return a.idx == b.idx;
+    }
+
+    friend std::strong_ordering operator<=>(const iterator& a,
+                                            const iterator& b)
+    {
+      return a.idx <=> b.idx;
+    }
+
+  private:
+    friend class encrypted_array;
+
+    iterator(const encrypted_array* const arr, const ptrdiff_t idx)
+      : arr(arr)
+      , idx(idx)
+    {
+    }
+
+    // Copies bytes of i-th element out of decrypted group(s), decrypting
+    // group, unless it's already cached
+    T load(const size_t i) const
+    {
+      T v;
+      uint8_t* const dst = reinterpret_cast<uint8_t*>(&v);
+
+      const size_t off = i * sizeof(T);
+      size_t done = 0;
+
+      while (done < sizeof(T)) {
+        const size_t pos = off + done;
+        const size_t g = pos / GROUP_LEN;
+
+        if (g != group) {
+          arr->decrypt_blocks(g * group_blocks, group_blocks, cache);
+          group = g;
+        }
+
+        const size_t g_off = pos % GROUP_LEN;
+        const size_t take = std::min(GROUP_LEN - g_off, sizeof(T) - done);
+
+        std::memcpy(dst + done, cache + g_off, take);
+        done += take;
+      }
+
+      return v;
+    }
+
+    const encrypted_array* arr = nullptr;
+    ptrdiff_t idx = 0;
+    mutable size_t group = SIZE_MAX;
+    mutable uint8_t cache[GROUP_LEN] = {};
+  };
+
+private:
+  // Decrypts N ( <= group_blocks ) consecutive blocks, starting at given
+  // block index, into `out`, which is of GROUP_LEN -bytes; bytes beyond end of
+  // array are left as is
+  void decrypt_blocks(const size_t first,
+                      const size_t count,
+                      uint8_t* const out) const
+  {
+    constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+    const size_t beg = first * blk_len;
+    const size_t n = std::min(count * blk_len, enc.size() - beg);
+    const size_t n_blocks = (n + blk_len - 1) / blk_len;
+
+    uint8_t ks[GROUP_LEN];
+    harpocrates_ctr::counter_blocks(nonce, first, ks, n_blocks);
+
+    if (n_blocks < harpocrates_common::N_LANES) {
+      for (size_t i = 0; i < n_blocks; i++) {
+        uint8_t ctr[blk_len];
+
+        std::memcpy(ctr, ks + i * blk_len, blk_len);
+        harpocrates_dispatch::encrypt(lut, ctr, ks + i * blk_len);
+      }
+    } else {
+      harpocrates_dispatch::encrypt_blocks(lut, ks, ks, n_blocks);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+      out[i] = enc[beg + i] ^ ks[i];
+    }
+
+    harpocrates_utils::secure_zero(ks, sizeof(ks));
+  }
+
+  const uint8_t* lut;
+  uint8_t nonce[harpocrates_ctr::NONCE_LEN];
+  size_t len;
+  std::vector<uint8_t> enc;
+};
+
+}
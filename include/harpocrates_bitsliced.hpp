@@ -0,0 +1,472 @@
+#pragma once
+#include "harpocrates_utils.hpp"
+#include <bit>
+#include <cstring>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, bitsliced
+// so that N message blocks are processed in parallel, using only bitwise
+// boolean operations on N -bit words
+//
+// State matrices of N message blocks are kept as 128 bit-planes, where p-th
+// plane ( an N -bit word ) holds bit (p & 7) of byte (p >> 3) of all N
+// message blocks. Shifts & rotations of round function then become renaming of
+// planes, while look ups into 256 -bytes table are replaced by evaluating a
+// boolean circuit, compiled from table ( see `compile_lut` ), so that no
+// memory access or branch depends on message bytes or on look up table.
+//
+// Word type can be one of `word64`, `word128` or `word256`, processing 64, 128
+// or 256 message blocks at a time; latter two are GCC/ Clang vector extension
+// types, which are lowered to SSE2/ AVX2 instructions, when those are enabled
+// at compile time ( e.g. -mavx2 ), otherwise they're split into narrower ones.
+namespace harpocrates_bitsliced {
+
+// 64 message blocks per pass
+using word64 = uint64_t;
+
+// 128 message blocks per pass
+using word128 = uint64_t __attribute__((vector_size(16)));
+
+// 256 message blocks per pass
+using word256 = uint64_t __attribute__((vector_size(32)));
+
+// # -of bit-planes, holding state matrices of N message blocks
+constexpr size_t N_PLANES = harpocrates_common::BLOCK_LEN << 3;
+
+// # -of message blocks, processed in parallel, using word type W
+template<typename W>
+constexpr size_t N_LANES = sizeof(W) << 3;
+
+// Boolean circuit computing 8 -bit to 8 -bit substitution, given by some look
+// up table, in its Shannon decomposition over high & low nibble of input
+//
+// j-th output bit, when high nibble of input is h, is a boolean function of
+// low nibble, whose truth table is `truth[j][h]` i.e. its l-th bit is j-th bit
+// of `lut[(h << 4) | l]`
+struct sbox_t
+{
+  uint16_t truth[8][16];
+};
+
+// Given 256 -bytes look up table ( or inverse look up table ), this routine
+// compiles it into a boolean circuit, which is evaluated by bitsliced
+// substitution; this is one-time process ( in pre-compute phase )
+static inline void
+compile_lut(const uint8_t* const __restrict lut,
+            sbox_t* const __restrict sbox)
+{
+  for (size_t j = 0; j < 8; j++) {
+    for (size_t h = 0; h < 16; h++) {
+      uint16_t t = 0;
+
+      for (size_t l = 0; l < 16; l++) {
+        const uint8_t v = lut[(h << 4) | l];
+        t |= static_cast<uint16_t>((v >> j) & 0b1) << l;
+      }
+
+      sbox->truth[j][h] = t;
+    }
+  }
+}
+
+// Computes all 4 minterms of two bitsliced boolean variables, such that i-th
+// minterm is set for those lanes, where (x[1], x[0]) = i
+template<typename W>
+static inline void
+minterms(const W* const __restrict x, W* const __restrict m)
+{
+  const W n0 = ~x[0];
+  const W n1 = ~x[1];
+
+  m[0] = n1 & n0;
+  m[1] = n1 & x[0];
+  m[2] = x[1] & n0;
+  m[3] = x[1] & x[0];
+}
+
+// Bitsliced substitution of 8 -bit input x ( x[0] being least significant
+// bit ) to 8 -bit output y, by evaluating compiled boolean circuit
+//
+// All 16 minterms of low nibble & of high nibble are computed first, so that
+// each output bit is OR of minterms of high nibble, each ANDed with OR of
+// minterms of low nibble, masked by bits of compiled truth table. Those masks
+// are all-ones/ all-zero words, built in registers from truth table bits, so
+// amount of work is same for every look up table & no memory access or branch
+// depends on either message bytes or look up table.
+template<typename W>
+static inline void
+substitute(const sbox_t& sbox,
+           const W* const __restrict x,
+           W* const __restrict y)
+{
+  W m0[4];
+  W m1[4];
+  W m2[4];
+  W m3[4];
+
+  minterms(x + 0, m0);
+  minterms(x + 2, m1);
+  minterms(x + 4, m2);
+  minterms(x + 6, m3);
+
+  W lo[16];
+  W hi[16];
+
+#if defined __clang__
+#pragma unroll 4
+#elif defined __GNUG__
+#pragma GCC unroll 4
+#endif
+  for (size_t i = 0; i < 4; i++) {
+#if defined __clang__
+#pragma unroll 4
+#elif defined __GNUG__
+#pragma GCC unroll 4
+#endif
+    for (size_t k = 0; k < 4; k++) {
+      lo[(i << 2) | k] = m1[i] & m0[k];
+      hi[(i << 2) | k] = m3[i] & m2[k];
+    }
+  }
+
+  for (size_t j = 0; j < 8; j++) {
+    W acc{};
+
+    for (size_t h = 0; h < 16; h++) {
+      const uint64_t t = sbox.truth[j][h];
+      W g{};
+
+#if defined __clang__
+#pragma unroll 16
+#elif defined __GNUG__
+#pragma GCC unroll 16
+#endif
+      for (size_t l = 0; l < 16; l++) {
+        const uint64_t mask = 0ul - ((t >> l) & 0b1);
+        g |= lo[l] & mask;
+      }
+
+      acc |= hi[h] & g;
+    }
+
+    y[j] = acc;
+  }
+}
+
+// Bitsliced left to right convoluted substitution, applied on each row of
+// state matrix; see `harpocrates_utils::left_to_right_convoluted_substitution`
+//
+// Planes [16r, 16r + 8) hold most significant byte of r-th row, while planes
+// [16r + 8, 16r + 16) hold least significant byte.
+template<typename W>
+static inline void
+left_to_right_convoluted_substitution(W* const __restrict state,
+                                      const sbox_t& sbox)
+{
+  for (size_t r = 0; r < harpocrates_common::N_ROWS; r++) {
+    W* const hi = state + (r << 4);
+    W* const lo = hi + 8;
+
+    W t[8];
+    W u[8];
+
+    // step 1
+    substitute(sbox, hi, t);
+    hi[7] = t[7];
+    hi[6] = t[6];
+
+    // step 2, 3, 4
+    for (size_t s = 1; s < 4; s++) {
+      const size_t l_off = 8 - (s << 1);
+      const size_t h_off = 7 - (s << 1);
+
+      u[0] = lo[l_off ^ 0];
+      u[1] = lo[l_off ^ 1];
+      std::memcpy(u + 2, t, sizeof(W) * 6);
+
+      substitute(sbox, u, t);
+      hi[h_off ^ 0] = t[7];
+      hi[h_off ^ 1] = t[6];
+    }
+
+    // step 5
+    u[0] = lo[0];
+    u[1] = lo[1];
+    std::memcpy(u + 2, t, sizeof(W) * 6);
+
+    substitute(sbox, u, lo);
+  }
+}
+
+// Bitsliced round constant addition, which flips those planes, whose bit is
+// set in round constants; see `harpocrates_utils::add_rc`
+template<typename W>
+static inline void
+add_rc(W* const state, const size_t r_idx)
+{
+  for (size_t i = 0; i < harpocrates_common::N_ROWS; i++) {
+    const uint16_t rc = std::rotl(harpocrates_common::RC[i], r_idx << 1);
+
+    for (size_t b = 0; b < 16; b++) {
+      if ((rc >> b) & 0b1) {
+        const size_t p = (i << 4) | (b ^ 8);
+        state[p] = ~state[p];
+      }
+    }
+  }
+}
+
+// Bitsliced column substitution, where i-th column's bit from r-th row is
+// (7 - r)-th bit of substitution input/ output; see
+// `harpocrates_utils::column_substitution`
+template<typename W>
+static inline void
+column_substitution(W* const __restrict state, const sbox_t& sbox)
+{
+  for (size_t c = 0; c < harpocrates_common::N_COLS; c++) {
+    const size_t b = (15 - c) ^ 8;
+
+    W x[8];
+    W y[8];
+
+    for (size_t k = 0; k < 8; k++) {
+      x[k] = state[((7 - k) << 4) | b];
+    }
+
+    substitute(sbox, x, y);
+
+    for (size_t k = 0; k < 8; k++) {
+      state[((7 - k) << 4) | b] = y[k];
+    }
+  }
+}
+
+// Bitsliced right to left convoluted substitution, applied on each row of
+// state matrix; see `harpocrates_utils::right_to_left_convoluted_substitution`
+template<typename W>
+static inline void
+right_to_left_convoluted_substitution(W* const __restrict state,
+                                      const sbox_t& sbox)
+{
+  for (size_t r = 0; r < harpocrates_common::N_ROWS; r++) {
+    W* const hi = state + (r << 4);
+    W* const lo = hi + 8;
+
+    W t[8];
+    W u[8];
+
+    // step 1
+    substitute(sbox, lo, t);
+    lo[0] = t[0];
+    lo[1] = t[1];
+
+    // step 2, 3, 4
+    for (size_t s = 1; s < 4; s++) {
+      const size_t off = (s - 1) << 1;
+
+      std::memcpy(u, t + 2, sizeof(W) * 6);
+      u[6] = hi[off ^ 0];
+      u[7] = hi[off ^ 1];
+
+      substitute(sbox, u, t);
+      lo[(s << 1) ^ 0] = t[0];
+      lo[(s << 1) ^ 1] = t[1];
+    }
+
+    // step 5
+    std::memcpy(u, t + 2, sizeof(W) * 6);
+    u[6] = hi[6];
+    u[7] = hi[7];
+
+    substitute(sbox, u, hi);
+  }
+}
+
+// Transposes N -many consecutive 16 -bytes message blocks into 128 bit-planes,
+// such that i-th message block's bit is i-th bit of each plane ( counting
+// across 64 -bit elements of word, when it's a vector type )
+template<typename W>
+static inline void
+transpose_in(const uint8_t* const __restrict blocks, W* const __restrict state)
+{
+  constexpr size_t n_elms = sizeof(W) / sizeof(uint64_t);
+
+  uint64_t planes[N_PLANES * n_elms] = {};
+
+  for (size_t l = 0; l < n_elms; l++) {
+    for (size_t g = 0; g < 8; g++) {
+      const uint8_t* const grp = blocks + (((l << 3) | g) << 7);
+
+      for (size_t j = 0; j < harpocrates_common::BLOCK_LEN; j++) {
+        uint64_t x = 0ul;
+
+        // i-th most significant byte is taken from (7 - i)-th block
+        for (size_t i = 0; i < 8; i++) {
+          x = (x << 8) | grp[((7 - i) << 4) | j];
+        }
+
+        const uint64_t y = harpocrates_utils::transpose8x8(x);
+
+        for (size_t k = 0; k < 8; k++) {
+          const uint64_t v = (y >> (k << 3)) & 0xff;
+          planes[(((j << 3) | k) * n_elms) + l] |= v << (g << 3);
+        }
+      }
+    }
+  }
+
+  std::memcpy(state, planes, sizeof(planes));
+}
+
+// Transposes 128 bit-planes back into N -many consecutive 16 -bytes message
+// blocks; inverse of `transpose_in`
+template<typename W>
+static inline void
+transpose_out(const W* const __restrict state, uint8_t* const __restrict blocks)
+{
+  constexpr size_t n_elms = sizeof(W) / sizeof(uint64_t);
+
+  uint64_t planes[N_PLANES * n_elms];
+  std::memcpy(planes, state, sizeof(planes));
+
+  for (size_t l = 0; l < n_elms; l++) {
+    for (size_t g = 0; g < 8; g++) {
+      uint8_t* const grp = blocks + (((l << 3) | g) << 7);
+
+      for (size_t j = 0; j < harpocrates_common::BLOCK_LEN; j++) {
+        uint64_t y = 0ul;
+
+        for (size_t k = 0; k < 8; k++) {
+          const uint64_t v = planes[(((j << 3) | k) * n_elms) + l];
+          y |= ((v >> (g << 3)) & 0xff) << (k << 3);
+        }
+
+        const uint64_t x = harpocrates_utils::transpose8x8(y);
+
+        for (size_t i = 0; i < 8; i++) {
+          grp[((7 - i) << 4) | j] = static_cast<uint8_t>(x >> (56 - (i << 3)));
+        }
+      }
+    }
+  }
+}
+
+// Encrypts N message blocks, already transposed into 128 bit-planes ( see
+// `transpose_in` ), using compiled look up table ( see `compile_lut` )
+template<typename W>
+static inline void
+encrypt(const sbox_t& sbox, W* const state)
+{
+  for (size_t i = 0; i < harpocrates_common::N_ROUNDS; i++) {
+    left_to_right_convoluted_substitution(state, sbox);
+    add_rc(state, i);
+    column_substitution(state, sbox);
+    right_to_left_convoluted_substitution(state, sbox);
+  }
+}
+
+// Decrypts N message blocks, already transposed into 128 bit-planes ( see
+// `transpose_in` ), using compiled inverse look up table ( see `compile_lut` )
+template<typename W>
+static inline void
+decrypt(const sbox_t& inv_sbox, W* const state)
+{
+  for (size_t i = 0; i < harpocrates_common::N_ROUNDS; i++) {
+    left_to_right_convoluted_substitution(state, inv_sbox);
+    column_substitution(state, inv_sbox);
+    add_rc(state, harpocrates_common::N_ROUNDS - (i + 1));
+    right_to_left_convoluted_substitution(state, inv_sbox);
+  }
+}
+
+// Given N -many consecutive 16 -bytes message blocks & compiled look up table
+// ( read `sbox` ), this routine encrypts all of them, N_LANES<W> blocks at a
+// time, while trailing blocks are zero padded & encrypted together
+//
+// Computes same output as `harpocrates::encrypt_blocks`; `txt` and `enc` may
+// point to same memory ( i.e. in-place encryption )
+template<typename W>
+static inline void
+encrypt_blocks(const sbox_t& sbox,       // compiled look up table
+               const uint8_t* const txt, // input plain text
+               uint8_t* const enc,       // output encrypted bytes
+               const size_t n_blocks     // # -of message blocks
+)
+{
+  constexpr size_t chunk_len = N_LANES<W> * harpocrates_common::BLOCK_LEN;
+
+  W state[N_PLANES];
+
+  const size_t n_chunks = n_blocks / N_LANES<W>;
+
+  for (size_t i = 0; i < n_chunks; i++) {
+    const size_t off = i * chunk_len;
+
+    transpose_in(txt + off, state);
+    encrypt(sbox, state);
+    transpose_out(state, enc + off);
+  }
+
+  const size_t off = n_chunks * chunk_len;
+  const size_t rem = n_blocks * harpocrates_common::BLOCK_LEN - off;
+
+  if (rem > 0) {
+    uint8_t buf[chunk_len];
+
+    std::memset(buf, 0, chunk_len);
+    std::memcpy(buf, txt + off, rem);
+
+    transpose_in(buf, state);
+    encrypt(sbox, state);
+    transpose_out(state, buf);
+
+    std::memcpy(enc + off, buf, rem);
+  }
+}
+
+// Given N -many consecutive 16 -bytes encrypted message blocks & compiled
+// inverse look up table ( read `inv_sbox` ), this routine decrypts all of them,
+// N_LANES<W> blocks at a time, while trailing blocks are zero padded &
+// decrypted together
+//
+// Computes same output as `harpocrates::decrypt_blocks`; `enc` and `dec` may
+// point to same memory ( i.e. in-place decryption )
+template<typename W>
+static inline void
+decrypt_blocks(const sbox_t& inv_sbox,   // compiled inverse look up table
+               const uint8_t* const enc, // input encrypted bytes
+               uint8_t* const dec,       // output decrypted bytes
+               const size_t n_blocks     // # -of message blocks
+)
+{
+  constexpr size_t chunk_len = N_LANES<W> * harpocrates_common::BLOCK_LEN;
+
+  W state[N_PLANES];
+
+  const size_t n_chunks = n_blocks / N_LANES<W>;
+
+  for (size_t i = 0; i < n_chunks; i++) {
+    const size_t off = i * chunk_len;
+
+    transpose_in(enc + off, state);
+    decrypt(inv_sbox, state);
+    transpose_out(state, dec + off);
+  }
+
+  const size_t off = n_chunks * chunk_len;
+  const size_t rem = n_blocks * harpocrates_common::BLOCK_LEN - off;
+
+  if (rem > 0) {
+    uint8_t buf[chunk_len];
+
+    std::memset(buf, 0, chunk_len);
+    std::memcpy(buf, enc + off, rem);
+
+    transpose_in(buf, state);
+    decrypt(inv_sbox, state);
+    transpose_out(state, buf);
+
+    std::memcpy(dec + off, buf, rem);
+  }
+}
+
+}
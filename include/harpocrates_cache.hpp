@@ -0,0 +1,322 @@
+#pragma once
+#include "harpocrates_context.hpp"
+#include "harpocrates_dispatch.hpp"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, serving
+// many keys ( e.g. one per tenant ) from a bounded cache of cipher contexts
+//
+// Cache holds contexts of recently used keys, within a memory budget. Each
+// cached key has a plain context ( 512 -bytes, see
+// `harpocrates_context::context` ), which is loaded on first use, while keys
+// used often ( i.e. hot ones ) are also given a context with expanded tables
+// ( ~512 KB, see `harpocrates_expanded` ). When budget is exceeded, least
+// recently used keys first lose their expanded tables, falling back to plain
+// look up table path, & then they're evicted.
+//
+// Expanded tables only beat look up table path of kernels, which process one
+// block at a time ( i.e. scalar, BMI2 & GFNI, see `harpocrates_dispatch` ),
+// while AVX2/ AVX-512 kernels are as fast or faster, so by default, keys are
+// given expanded tables only when one of former kernels is selected.
+//
+// Keys are spread over shards, each one with its own lock & least recently
+// used ordering, so that concurrent lookups of different keys rarely contend.
+// Loading & expanding contexts happens outside of lock.
+namespace harpocrates_cache {
+
+// # -of shards, by default
+constexpr size_t N_SHARDS = 16ul;
+
+// # -of lookups of a key, after which it's given expanded tables, by default
+constexpr uint64_t EXPAND_AFTER = 64ul;
+
+// Returns EXPAND_AFTER, when selected kernel processes one block at a time,
+// otherwise zero, disabling expansion, as vectorized kernels don't gain from
+// expanded tables
+static inline uint64_t
+default_expand_after()
+{
+  using harpocrates_dispatch::kernel_t;
+
+  const kernel_t kernel = harpocrates_dispatch::selected_kernel();
+  return kernel == kernel_t::avx2 || kernel == kernel_t::avx512 ? 0
+                                                                 : EXPAND_AFTER;
+}
+
+// Loads 256 -bytes look up table of key ( e.g. deriving it using
+// `harpocrates_kdf`, or reading it from keystore ), returning false, when
+// there's no such key
+using loader_t = std::function<bool(uint64_t id, uint8_t* lut)>;
+
+// Counters of cache, summed over all shards
+struct stats_t
+{
+  uint64_t hits;       // lookups of cached keys
+  uint64_t misses;     // lookups, which had to load key
+  uint64_t evictions;  // keys evicted, for keeping within budget
+  uint64_t expansions; // keys given expanded tables
+  uint64_t demotions;  // keys whose expanded tables were dropped
+  size_t entries;      // # -of cached keys
+  size_t bytes;        // memory held by cached contexts
+};
+
+// Bounded, thread-safe cache of cipher contexts, keyed by 64 -bit identifier
+class context_cache
+{
+public:
+  using context_ptr = std::shared_ptr<const harpocrates_context::context>;
+
+  // Cache holding at most `budget` bytes of contexts, split evenly over
+  // `n_shards` shards, loading look up tables using `loader` & expanding
+  // tables of keys looked up at least `expand_after` times ( zero disables
+  // expansion, as does a budget too small for holding expanded tables in
+  // each shard )
+  context_cache(const size_t budget,
+                loader_t loader,
+                const uint64_t expand_after = default_expand_after(),
+                const size_t n_shards = N_SHARDS)
+    : loader(std::move(loader))
+    , expand_after(expand_after)
+    , shards(std::max<size_t>(n_shards, 1))
+  {
+    using harpocrates_context::tables_t;
+    constexpr size_t exp_len = harpocrates_expanded::TABLE_LEN << 2;
+
+    for (auto& s : shards) {
+      s.budget = budget / shards.size();
+    }
+    if (shards[0].budget < (sizeof(tables_t) << 1) + exp_len) {
+      this->expand_after = 0;
+    }
+  }
+
+  context_cache(const context_cache&) = delete;
+  context_cache& operator=(const context_cache&) = delete;
+
+  // Returns context of key, loading it, on miss; returned context stays valid
+  // as long as caller holds it, even if it's evicted meanwhile. Returns
+  // nullptr, when loader doesn't know about key.
+  context_ptr get(const uint64_t id)
+  {
+    shard_t& s = shard(id);
+
+    context_ptr plain;
+    {
+      std::lock_guard<std::mutex> lock(s.mtx);
+
+      auto it = s.map.find(id);
+      if (it != s.map.end()) {
+        entry_t& e = *it->second;
+        touch(s, it->second);
+        s.hits.fetch_add(1, std::memory_order_relaxed);
+
+        if (e.fast) {
+          return e.fast;
+        }
+        if (expand_after == 0 || ++e.uses < expand_after || e.expanding) {
+          return e.plain;
+        }
+
+        e.expanding = true;
+        plain = e.plain;
+      }
+    }
+
+    if (plain) {
+      return expand(s, id, plain);
+    }
+
+    s.misses.fetch_add(1, std::memory_order_relaxed);
+    return load(s, id);
+  }
+
+  // Drops key from cache ( e.g. on key rotation ), so that it's loaded again,
+  // on next lookup
+  void erase(const uint64_t id)
+  {
+    shard_t& s = shard(id);
+    std::lock_guard<std::mutex> lock(s.mtx);
+
+    auto it = s.map.find(id);
+    if (it != s.map.end()) {
+      remove(s, it->second);
+    }
+  }
+
+  // Returns counters, summed over all shards
+  stats_t stats() const
+  {
+    stats_t st{};
+
+    for (const auto& s : shards) {
+      st.hits += s.hits.load(std::memory_order_relaxed);
+      st.misses += s.misses.load(std::memory_order_relaxed);
+      st.evictions += s.evictions.load(std::memory_order_relaxed);
+      st.expansions += s.expansions.load(std::memory_order_relaxed);
+      st.demotions += s.demotions.load(std::memory_order_relaxed);
+
+      std::lock_guard<std::mutex> lock(s.mtx);
+      st.entries += s.map.size();
+      st.bytes += s.bytes;
+    }
+
+    return st;
+  }
+
+private:
+  struct entry_t;
+  using lru_t = std::list<entry_t>;
+
+  // Cached key, holding plain context & ( when it's hot ) context with
+  // expanded tables, where `fast_pos` is position in shard's least recently
+  // used ordering of expanded entries
+  struct entry_t
+  {
+    uint64_t id;
+    context_ptr plain;
+    context_ptr fast;
+    uint64_t uses = 0;
+    bool expanding = false;
+    std::list<lru_t::iterator>::iterator fast_pos;
+  };
+
+  struct alignas(harpocrates_parallel::CACHE_LINE) shard_t
+  {
+    mutable std::mutex mtx;
+    lru_t lru; // most recently used first
+    std::list<lru_t::iterator> fast_lru;
+    std::unordered_map<uint64_t, lru_t::iterator> map;
+    size_t bytes = 0;
+    size_t budget = 0;
+
+    std::atomic<uint64_t> hits{ 0 };
+    std::atomic<uint64_t> misses{ 0 };
+    std::atomic<uint64_t> evictions{ 0 };
+    std::atomic<uint64_t> expansions{ 0 };
+    std::atomic<uint64_t> demotions{ 0 };
+  };
+
+  shard_t& shard(const uint64_t id)
+  {
+    return shards[harpocrates_utils::mix64(id) % shards.size()];
+  }
+
+  // Moves entry to front of least recently used ordering(s)
+  static void touch(shard_t& s, const lru_t::iterator it)
+  {
+    s.lru.splice(s.lru.begin(), s.lru, it);
+    if (it->fast) {
+      s.fast_lru.splice(s.fast_lru.begin(), s.fast_lru, it->fast_pos);
+    }
+  }
+
+  // Drops expanded tables of entry
+  static void demote(shard_t& s, const lru_t::iterator it)
+  {
+    s.bytes -= it->fast->footprint();
+    s.fast_lru.erase(it->fast_pos);
+    it->fast.reset();
+    it->uses = 0;
+  }
+
+  static void remove(shard_t& s, const lru_t::iterator it)
+  {
+    if (it->fast) {
+      demote(s, it);
+    }
+
+    s.bytes -= it->plain->footprint();
+    s.map.erase(it->id);
+    s.lru.erase(it);
+  }
+
+  // Demotes least recently used expanded entries & then evicts least recently
+  // used entries, until shard is within its budget
+  static void shrink(shard_t& s)
+  {
+    while (s.bytes > s.budget && !s.fast_lru.empty()) {
+      demote(s, s.fast_lru.back());
+      s.demotions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    while (s.bytes > s.budget && !s.lru.empty()) {
+      remove(s, std::prev(s.lru.end()));
+      s.evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  // Loads context of key & inserts it into shard, unless some other thread
+  // did so meanwhile
+  context_ptr load(shard_t& s, const uint64_t id)
+  {
+    uint8_t lut[256];
+    if (!loader(id, lut)) {
+      harpocrates_utils::secure_zero(lut, sizeof(lut));
+      return nullptr;
+    }
+
+    auto ctx = std::make_shared<const harpocrates_context::context>(lut);
+    harpocrates_utils::secure_zero(lut, sizeof(lut));
+
+    std::lock_guard<std::mutex> lock(s.mtx);
+
+    auto it = s.map.find(id);
+    if (it != s.map.end()) {
+      touch(s, it->second);
+      return it->second->fast ? it->second->fast : it->second->plain;
+    }
+
+    s.lru.emplace_front();
+    s.lru.front().id = id;
+    s.lru.front().plain = ctx;
+    s.map.emplace(id, s.lru.begin());
+    s.bytes += ctx->footprint();
+
+    shrink(s);
+
+    return ctx;
+  }
+
+  // Computes expanded tables of key & attaches them to its entry, if it's
+  // still cached
+  context_ptr expand(shard_t& s, const uint64_t id, const context_ptr& plain)
+  {
+    harpocrates_context::context exp = plain->clone();
+    exp.expand();
+
+    auto fast =
+      std::make_shared<const harpocrates_context::context>(std::move(exp));
+
+    std::lock_guard<std::mutex> lock(s.mtx);
+
+    auto it = s.map.find(id);
+    if (it == s.map.end() || it->second->plain != plain) {
+      return fast;
+    }
+
+    entry_t& e = *it->second;
+    e.expanding = false;
+    e.fast = fast;
+    s.fast_lru.push_front(it->second);
+    e.fast_pos = s.fast_lru.begin();
+    s.bytes += fast->footprint();
+    s.expansions.fetch_add(1, std::memory_order_relaxed);
+
+    shrink(s);
+
+    return fast;
+  }
+
+  loader_t loader;
+  uint64_t expand_after;
+  std::vector<shard_t> shards;
+};
+
+}
@@ -23,6 +23,11 @@ constexpr size_t N_ROWS = BLOCK_LEN >> 1;
 // matrix )
 constexpr size_t N_COLS = 16ul;
 
+// # -of independent message blocks, whose state matrices are interleaved by
+// bulk encrypt_blocks()/ decrypt_blocks() routines, so that dependent chain of
+// look ups in one block's rows can overlap with those of other blocks
+constexpr size_t N_LANES = 8ul;
+
 // 16 -bit masks for selecting ( read enabling/ disabling ) column(s), when
 // performing column substitution
 constexpr uint16_t COL_MASKS[16] = { 0b0111111111111111, 0b1011111111111111,
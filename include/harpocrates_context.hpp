@@ -0,0 +1,408 @@
+#pragma once
+#include "harpocrates_bitsliced.hpp"
+#include "harpocrates_ctr.hpp"
+#include "harpocrates_dispatch.hpp"
+#include "harpocrates_expanded.hpp"
+#include "harpocrates_kdf.hpp"
+#include "harpocrates_parallel.hpp"
+#include "harpocrates_xts.hpp"
+#include <memory>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, keyed by a
+// reusable cipher context, which owns look up table & all tables derived from
+// it, so that they're computed once per key, instead of at every call site
+//
+// Look up table & its inverse live in a single cache line aligned allocation,
+// while boolean circuits ( used by bitsliced engine ) & expanded tables are
+// computed only when asked for ( see `compile`/ `expand` ), each in its own
+// cache line aligned allocation. Every encryption/ decryption routine ( single
+// block, bulk, multi-threaded, counter mode, XTS-like mode, bitsliced,
+// expanded ) is exposed as a member.
+// Context can be moved, but it can't be copied, except explicitly, using
+// `clone`; routines, which only need to read tables, accept a non-owning
+// `context_view`, which is cheap to pass by value.
+namespace harpocrates_context {
+
+// Per-key tables, each one starting at cache line boundary
+struct alignas(harpocrates_parallel::CACHE_LINE) tables_t
+{
+  uint8_t lut[256];
+  uint8_t inv_lut[256];
+};
+
+// Look up table & inverse look up table, compiled into boolean circuits, used
+// by bitsliced engine
+struct alignas(harpocrates_parallel::CACHE_LINE) circuits_t
+{
+  harpocrates_bitsliced::sbox_t sbox;
+  harpocrates_bitsliced::sbox_t inv_sbox;
+};
+
+// Expanded look up table, followed by expanded inverse look up table
+struct alignas(harpocrates_parallel::CACHE_LINE) expanded_t
+{
+  uint16_t tbl[harpocrates_expanded::TABLE_LEN << 1];
+};
+
+// Given 256 -bytes look up table, this routine computes inverse look up table
+static inline void
+derive_tables(const uint8_t* const __restrict lut, tables_t* const __restrict t)
+{
+  std::memcpy(t->lut, lut, sizeof(t->lut));
+  harpocrates_utils::generate_inv_lut(t->lut, t->inv_lut);
+}
+
+// Non-owning view of per-key tables, which must outlive it, exposing all
+// encryption/ decryption routines
+class context_view
+{
+public:
+  context_view() = default;
+
+  // Views tables, along with ( optional ) expanded tables, holding expanded
+  // look up table, followed by expanded inverse look up table, & ( optional )
+  // compiled boolean circuits
+  explicit context_view(const tables_t* const tbl,
+                        const uint16_t* const exp = nullptr,
+                        const circuits_t* const circ = nullptr)
+    : tbl(tbl)
+    , exp(exp)
+    , circ(circ)
+  {}
+
+  // Checks whether view points to some tables
+  explicit operator bool() const { return tbl != nullptr; }
+
+  const tables_t* tables() const { return tbl; }
+  const uint8_t* lut() const { return tbl->lut; }
+  const uint8_t* inv_lut() const { return tbl->inv_lut; }
+
+  // Checks whether expanded tables are available, which are required by
+  // `encrypt_blocks_expanded`/ `decrypt_blocks_expanded`
+  bool has_expanded() const { return exp != nullptr; }
+
+  // Checks whether compiled boolean circuits are available, which are
+  // required by `encrypt_blocks_bitsliced`/ `decrypt_blocks_bitsliced`
+  bool has_compiled() const { return circ != nullptr; }
+
+  // Encrypts 16 -bytes message block; see `harpocrates_dispatch::encrypt`
+  void encrypt(const uint8_t* const __restrict txt,
+               uint8_t* const __restrict enc) const
+  {
+    harpocrates_dispatch::encrypt(tbl->lut, txt, enc);
+  }
+
+  // Decrypts 16 -bytes message block; see `harpocrates_dispatch::decrypt`
+  void decrypt(const uint8_t* const __restrict enc,
+               uint8_t* const __restrict dec) const
+  {
+    harpocrates_dispatch::decrypt(tbl->inv_lut, enc, dec);
+  }
+
+  // Encrypts N -many consecutive 16 -bytes message blocks, using kernel
+  // selected at run time; `txt` and `enc` may point to same memory
+  void encrypt_blocks(const uint8_t* const txt,
+                      uint8_t* const enc,
+                      const size_t n_blocks) const
+  {
+    harpocrates_dispatch::encrypt_blocks(tbl->lut, txt, enc, n_blocks);
+  }
+
+  // Decrypts N -many consecutive 16 -bytes message blocks, using kernel
+  // selected at run time; `enc` and `dec` may point to same memory
+  void decrypt_blocks(const uint8_t* const enc,
+                      uint8_t* const dec,
+                      const size_t n_blocks) const
+  {
+    harpocrates_dispatch::decrypt_blocks(tbl->inv_lut, enc, dec, n_blocks);
+  }
+
+  // Encrypts N -many consecutive 16 -bytes message blocks, using workers of
+  // thread pool; see `harpocrates_parallel::encrypt_blocks`
+  void encrypt_blocks(harpocrates_parallel::thread_pool& pool,
+                      const uint8_t* const txt,
+                      uint8_t* const enc,
+                      const size_t n_blocks) const
+  {
+    harpocrates_parallel::encrypt_blocks(pool, tbl->lut, txt, enc, n_blocks);
+  }
+
+  // Decrypts N -many consecutive 16 -bytes message blocks, using workers of
+  // thread pool; see `harpocrates_parallel::decrypt_blocks`
+  void decrypt_blocks(harpocrates_parallel::thread_pool& pool,
+                      const uint8_t* const enc,
+                      uint8_t* const dec,
+                      const size_t n_blocks) const
+  {
+    harpocrates_parallel::decrypt_blocks(
+      pool, tbl->inv_lut, enc, dec, n_blocks);
+  }
+
+  // Encrypts N -many consecutive 16 -bytes message blocks, without memory
+  // accesses depending on message bytes, using compiled boolean circuits,
+  // which must be available; see `harpocrates_bitsliced`
+  template<typename W = harpocrates_bitsliced::word128>
+  void encrypt_blocks_bitsliced(const uint8_t* const txt,
+                                uint8_t* const enc,
+                                const size_t n_blocks) const
+  {
+    harpocrates_bitsliced::encrypt_blocks<W>(circ->sbox, txt, enc, n_blocks);
+  }
+
+  // Decrypts N -many consecutive 16 -bytes message blocks, without memory
+  // accesses depending on message bytes, using compiled boolean circuits,
+  // which must be available; see `harpocrates_bitsliced`
+  template<typename W = harpocrates_bitsliced::word128>
+  void decrypt_blocks_bitsliced(const uint8_t* const enc,
+                                uint8_t* const dec,
+                                const size_t n_blocks) const
+  {
+    harpocrates_bitsliced::decrypt_blocks<W>(
+      circ->inv_sbox, enc, dec, n_blocks);
+  }
+
+  // Encrypts N -many consecutive 16 -bytes message blocks, using expanded
+  // tables, which must be available; see `harpocrates_expanded`
+  void encrypt_blocks_expanded(const uint8_t* const txt,
+                               uint8_t* const enc,
+                               const size_t n_blocks) const
+  {
+    harpocrates_expanded::encrypt_blocks(tbl->lut, exp, txt, enc, n_blocks);
+  }
+
+  // Decrypts N -many consecutive 16 -bytes message blocks, using expanded
+  // tables, which must be available; see `harpocrates_expanded`
+  void decrypt_blocks_expanded(const uint8_t* const enc,
+                               uint8_t* const dec,
+                               const size_t n_blocks) const
+  {
+    const uint16_t* const inv_exp = exp + harpocrates_expanded::TABLE_LEN;
+    harpocrates_expanded::decrypt_blocks(
+      tbl->inv_lut, inv_exp, enc, dec, n_blocks);
+  }
+
+  // Encrypts ( or decrypts ) N bytes of message in counter mode, starting at
+  // given byte offset; see `harpocrates_ctr::crypt`
+  void crypt(const uint8_t* const __restrict nonce,
+             const uint64_t offset,
+             const uint8_t* const in,
+             uint8_t* const out,
+             const size_t len) const
+  {
+    harpocrates_ctr::crypt(tbl->lut, nonce, offset, in, out, len);
+  }
+
+  // Encrypts ( or decrypts ) N bytes of message in counter mode, using
+  // workers of thread pool; see `harpocrates_ctr::crypt`
+  void crypt(harpocrates_parallel::thread_pool& pool,
+             const uint8_t* const __restrict nonce,
+             const uint64_t offset,
+             const uint8_t* const in,
+             uint8_t* const out,
+             const size_t len) const
+  {
+    harpocrates_ctr::crypt(pool, tbl->lut, nonce, offset, in, out, len);
+  }
+
+  // Encrypts N consecutive sectors in XTS-like mode, where tweaks are
+  // encrypted under `tweak` context; see `harpocrates_xts::encrypt_sectors`
+  bool encrypt_sectors(const context_view tweak,
+                       const uint64_t sector,
+                       const uint8_t* const txt,
+                       uint8_t* const enc,
+                       const size_t sector_len,
+                       const size_t n_sectors) const
+  {
+    return harpocrates_xts::encrypt_sectors(
+      tbl->lut, tweak.lut(), sector, txt, enc, sector_len, n_sectors);
+  }
+
+  // Decrypts N consecutive sectors in XTS-like mode, where tweaks are
+  // encrypted under `tweak` context; see `harpocrates_xts::decrypt_sectors`
+  bool decrypt_sectors(const context_view tweak,
+                       const uint64_t sector,
+                       const uint8_t* const enc,
+                       uint8_t* const dec,
+                       const size_t sector_len,
+                       const size_t n_sectors) const
+  {
+    return harpocrates_xts::decrypt_sectors(
+      tbl->inv_lut, tweak.lut(), sector, enc, dec, sector_len, n_sectors);
+  }
+
+  // Encrypts N consecutive sectors in XTS-like mode, using workers of thread
+  // pool; see `harpocrates_xts::encrypt_sectors`
+  bool encrypt_sectors(harpocrates_parallel::thread_pool& pool,
+                       const context_view tweak,
+                       const uint64_t sector,
+                       const uint8_t* const txt,
+                       uint8_t* const enc,
+                       const size_t sector_len,
+                       const size_t n_sectors) const
+  {
+    return harpocrates_xts::encrypt_sectors(
+      pool, tbl->lut, tweak.lut(), sector, txt, enc, sector_len, n_sectors);
+  }
+
+  // Decrypts N consecutive sectors in XTS-like mode, using workers of thread
+  // pool; see `harpocrates_xts::decrypt_sectors`
+  bool decrypt_sectors(harpocrates_parallel::thread_pool& pool,
+                       const context_view tweak,
+                       const uint64_t sector,
+                       const uint8_t* const enc,
+                       uint8_t* const dec,
+                       const size_t sector_len,
+                       const size_t n_sectors) const
+  {
+    return harpocrates_xts::decrypt_sectors(
+      pool, tbl->inv_lut, tweak.lut(), sector, enc, dec, sector_len, n_sectors);
+  }
+
+protected:
+  const tables_t* tbl = nullptr;
+  const uint16_t* exp = nullptr;
+  const circuits_t* circ = nullptr;
+};
+
+// Cipher context, owning per-key tables, which are computed once, when it's
+// constructed; it's movable, but copying must be asked for, using `clone`
+class context : public context_view
+{
+public:
+  // Empty context, which holds no tables; assign some other context to it,
+  // before using it
+  context() = default;
+
+  // Computes look up table & inverse look up table, from given look up table
+  explicit context(const uint8_t* const lut)
+    : owned_tbl(std::make_unique<tables_t>())
+  {
+    derive_tables(lut, owned_tbl.get());
+    tbl = owned_tbl.get();
+  }
+
+  // Generates random look up table ( see `harpocrates_utils::generate_lut` ) &
+  // computes inverse look up table from it
+  static context generate()
+  {
+    uint8_t lut[256];
+    harpocrates_utils::generate_lut(lut);
+
+    return context(lut);
+  }
+
+  // Derives look up table from 16 -bytes or 32 -bytes secret key & 64 -bit
+  // identifier ( see `harpocrates_kdf::derive_lut` ) & computes inverse look
+  // up table from it
+  template<const size_t key_len>
+  static context derive(const uint8_t* const key, const uint64_t id)
+  {
+    uint8_t lut[256];
+    harpocrates_kdf::derive_lut<key_len>(key, id, lut);
+
+    return context(lut);
+  }
+
+  context(context&& other) noexcept
+    : context_view(other)
+    , owned_tbl(std::move(other.owned_tbl))
+    , owned_exp(std::move(other.owned_exp))
+    , owned_circ(std::move(other.owned_circ))
+  {
+    other.tbl = nullptr;
+    other.exp = nullptr;
+    other.circ = nullptr;
+  }
+
+  context& operator=(context&& other) noexcept
+  {
+    if (this != &other) {
+      owned_tbl = std::move(other.owned_tbl);
+      owned_exp = std::move(other.owned_exp);
+      owned_circ = std::move(other.owned_circ);
+      tbl = other.tbl;
+      exp = other.exp;
+      circ = other.circ;
+
+      other.tbl = nullptr;
+      other.exp = nullptr;
+      other.circ = nullptr;
+    }
+
+    return *this;
+  }
+
+  context(const context&) = delete;
+  context& operator=(const context&) = delete;
+
+  // Makes a deep copy of context, including expanded tables & compiled
+  // boolean circuits, if any
+  context clone() const
+  {
+    context c;
+
+    if (tbl != nullptr) {
+      c.owned_tbl = std::make_unique<tables_t>(*tbl);
+      c.tbl = c.owned_tbl.get();
+    }
+    if (exp != nullptr) {
+      c.expand();
+    }
+    if (circ != nullptr) {
+      c.compile();
+    }
+
+    return c;
+  }
+
+  // Computes expanded tables ( 512 KB ), once, enabling
+  // `encrypt_blocks_expanded`/ `decrypt_blocks_expanded`
+  void expand()
+  {
+    using namespace harpocrates_expanded;
+
+    if (exp != nullptr) {
+      return;
+    }
+
+    owned_exp = std::make_unique<expanded_t>();
+    expand_lut(tbl->lut, owned_exp->tbl);
+    expand_lut(tbl->inv_lut, owned_exp->tbl + TABLE_LEN);
+
+    exp = owned_exp->tbl;
+  }
+
+  // Compiles look up table & inverse look up table into boolean circuits
+  // ( 512 -bytes ), once, enabling `encrypt_blocks_bitsliced`/
+  // `decrypt_blocks_bitsliced`
+  void compile()
+  {
+    if (circ != nullptr) {
+      return;
+    }
+
+    owned_circ = std::make_unique<circuits_t>();
+    harpocrates_bitsliced::compile_lut(tbl->lut, &owned_circ->sbox);
+    harpocrates_bitsliced::compile_lut(tbl->inv_lut, &owned_circ->inv_sbox);
+
+    circ = owned_circ.get();
+  }
+
+  // Returns non-owning view of this context
+  context_view view() const { return context_view(tbl, exp, circ); }
+
+  // # -of bytes of memory owned by this context
+  size_t footprint() const
+  {
+    return (owned_tbl ? sizeof(tables_t) : 0) +
+           (owned_exp ? sizeof(expanded_t) : 0) +
+           (owned_circ ? sizeof(circuits_t) : 0);
+  }
+
+private:
+  std::unique_ptr<tables_t> owned_tbl;
+  std::unique_ptr<expanded_t> owned_exp;
+  std::unique_ptr<circuits_t> owned_circ;
+};
+
+}
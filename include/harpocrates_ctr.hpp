@@ -0,0 +1,228 @@
+#pragma once
+#include "harpocrates_dispatch.hpp"
+#include "harpocrates_parallel.hpp"
+#include <algorithm>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, used in
+// counter ( CTR ) mode, for encrypting/ decrypting messages of arbitrary length
+//
+// i-th 16 -bytes keystream block is encryption of counter block
+//
+// nonce ( 8 -bytes ) || i ( 8 -bytes, big-endian )
+//
+// which is XORed with i-th 16 -bytes of message. Any byte offset of keystream
+// can be computed directly, so encryption can start ( or resume ) at any byte
+// of message & keystream blocks are independent, so they're generated in
+// batches, using bulk encryption kernel selected at run time ( see
+// `harpocrates_dispatch` ) & across threads, for large messages. Decryption is
+// same as encryption, which never needs inverse look up table.
+//
+// Note, same nonce must never be used for encrypting two different messages,
+// under same look up table.
+namespace harpocrates_ctr {
+
+// Byte length of nonce
+constexpr size_t NONCE_LEN = 8ul;
+
+// # -of keystream blocks generated together ( i.e. 4 KB ), by single call to
+// bulk encryption routine
+constexpr size_t BATCH_BLOCKS = 256ul;
+
+// Prepares `n_blocks` consecutive counter blocks, starting from counter value
+// `ctr`, such that each of them is nonce || counter ( big-endian )
+static inline void
+counter_blocks(const uint8_t* const __restrict nonce,
+               const uint64_t ctr,
+               uint8_t* const __restrict blocks,
+               const size_t n_blocks)
+{
+  for (size_t i = 0; i < n_blocks; i++) {
+    uint8_t* const blk = blocks + i * harpocrates_common::BLOCK_LEN;
+    const uint64_t v = ctr + i;
+
+    std::memcpy(blk, nonce, NONCE_LEN);
+
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+    for (size_t j = 0; j < 8; j++) {
+      blk[NONCE_LEN + j] = static_cast<uint8_t>(v >> ((7 - j) << 3));
+    }
+  }
+}
+
+// Given look up table, nonce & byte offset into message, this routine encrypts
+// ( or decrypts ) N bytes of message, starting at that offset, by XORing them
+// with keystream, generated in batches of BATCH_BLOCKS
+//
+// `in` and `out` may point to same memory ( i.e. in-place encryption )
+//
+// Input:
+// - lut: Look up table holding 256 elements
+// - nonce: 8 -bytes nonce
+// - offset: Byte offset of `in[0]`, in message
+// - in: N input bytes, to be encrypted ( or decrypted )
+// - len: N, # -of bytes
+//
+// Output:
+// - out: N encrypted ( or decrypted ) output bytes
+static inline void
+crypt(const uint8_t* const __restrict lut,   // look up table
+      const uint8_t* const __restrict nonce, // 8 -bytes nonce
+      const uint64_t offset,                 // byte offset in message
+      const uint8_t* const in,               // input bytes
+      uint8_t* const out,                    // output bytes
+      const size_t len                       // # -of bytes
+)
+{
+  constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+  constexpr size_t batch_len = BATCH_BLOCKS * blk_len;
+
+  uint8_t ks[batch_len];
+
+  uint64_t ctr = offset / blk_len;
+  size_t skip = static_cast<size_t>(offset % blk_len);
+  size_t done = 0;
+
+  while (done < len) {
+    const size_t need = (skip + (len - done) + blk_len - 1) / blk_len;
+    const size_t n_blocks = std::min(need, BATCH_BLOCKS);
+
+    counter_blocks(nonce, ctr, ks, n_blocks);
+    harpocrates_dispatch::encrypt_blocks(lut, ks, ks, n_blocks);
+
+    const size_t take = std::min(n_blocks * blk_len - skip, len - done);
+
+    for (size_t i = 0; i < take; i++) {
+      out[done + i] = in[done + i] ^ ks[skip + i];
+    }
+
+    done += take;
+    ctr += n_blocks;
+    skip = 0;
+  }
+}
+
+// Computes N bytes of keystream, starting at given byte offset
+static inline void
+keystream(const uint8_t* const __restrict lut,   // look up table
+          const uint8_t* const __restrict nonce, // 8 -bytes nonce
+          const uint64_t offset,                 // byte offset in keystream
+          uint8_t* const __restrict out,         // keystream bytes
+          const size_t len                       // # -of bytes
+)
+{
+  std::memset(out, 0, len);
+  crypt(lut, nonce, offset, out, out, len);
+}
+
+// Encrypts ( or decrypts ) N bytes of message, starting at given byte offset,
+// same as above, but message is split into chunks of `chunk_len` bytes, whose
+// keystreams are generated by workers of thread pool
+static inline void
+crypt(harpocrates_parallel::thread_pool& pool, // reusable thread pool
+      const uint8_t* const __restrict lut,     // look up table
+      const uint8_t* const __restrict nonce,   // 8 -bytes nonce
+      const uint64_t offset,                   // byte offset in message
+      const uint8_t* const in,                 // input bytes
+      uint8_t* const out,                      // output bytes
+      const size_t len,                        // # -of bytes
+      const size_t chunk_len = harpocrates_parallel::CHUNK_BLOCKS *
+                               harpocrates_common::BLOCK_LEN)
+{
+  const size_t n_chunks = (len + chunk_len - 1) / chunk_len;
+
+  pool.parallel_for(n_chunks, [=](const size_t i) {
+    const size_t beg = i * chunk_len;
+    const size_t cnt = std::min(chunk_len, len - beg);
+
+    crypt(lut, nonce, offset + beg, in + beg, out + beg, cnt);
+  });
+}
+
+// Given old & new look up tables, along with their nonces, this routine
+// re-encrypts N bytes of message, starting at given byte offset, which were
+// encrypted under old table & nonce, so that they're encrypted under new ones
+//
+// Both keystreams are generated in batches of BATCH_BLOCKS & XORed into
+// message in a single pass, so that decrypted message is never written to
+// memory. `in` and `out` may point to same memory ( i.e. in-place ).
+static inline void
+transcrypt(const uint8_t* const __restrict old_lut,   // old look up table
+           const uint8_t* const __restrict old_nonce, // old 8 -bytes nonce
+           const uint8_t* const __restrict new_lut,   // new look up table
+           const uint8_t* const __restrict new_nonce, // new 8 -bytes nonce
+           const uint64_t offset,                     // byte offset in message
+           const uint8_t* const in,                   // input bytes
+           uint8_t* const out,                        // output bytes
+           const size_t len                           // # -of bytes
+)
+{
+  constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+  constexpr size_t batch_len = BATCH_BLOCKS * blk_len;
+
+  uint8_t old_ks[batch_len];
+  uint8_t new_ks[batch_len];
+
+  uint64_t ctr = offset / blk_len;
+  size_t skip = static_cast<size_t>(offset % blk_len);
+  size_t done = 0;
+
+  while (done < len) {
+    const size_t need = (skip + (len - done) + blk_len - 1) / blk_len;
+    const size_t n_blocks = std::min(need, BATCH_BLOCKS);
+
+    counter_blocks(old_nonce, ctr, old_ks, n_blocks);
+    counter_blocks(new_nonce, ctr, new_ks, n_blocks);
+
+    harpocrates_dispatch::encrypt_blocks(old_lut, old_ks, old_ks, n_blocks);
+    harpocrates_dispatch::encrypt_blocks(new_lut, new_ks, new_ks, n_blocks);
+
+    const size_t take = std::min(n_blocks * blk_len - skip, len - done);
+
+    for (size_t i = 0; i < take; i++) {
+      out[done + i] = in[done + i] ^ old_ks[skip + i] ^ new_ks[skip + i];
+    }
+
+    done += take;
+    ctr += n_blocks;
+    skip = 0;
+  }
+}
+
+// Re-encrypts N bytes of message, starting at given byte offset, same as
+// above, but message is split into chunks of `chunk_len` bytes, which are
+// re-encrypted by workers of thread pool
+static inline void
+transcrypt(harpocrates_parallel::thread_pool& pool,   // reusable thread pool
+           const uint8_t* const __restrict old_lut,   // old look up table
+           const uint8_t* const __restrict old_nonce, // old 8 -bytes nonce
+           const uint8_t* const __restrict new_lut,   // new look up table
+           const uint8_t* const __restrict new_nonce, // new 8 -bytes nonce
+           const uint64_t offset,                     // byte offset in message
+           const uint8_t* const in,                   // input bytes
+           uint8_t* const out,                        // output bytes
+           const size_t len,                          // # -of bytes
+           const size_t chunk_len = harpocrates_parallel::CHUNK_BLOCKS *
+                                    harpocrates_common::BLOCK_LEN)
+{
+  const size_t n_chunks = (len + chunk_len - 1) / chunk_len;
+
+  pool.parallel_for(n_chunks, [=](const size_t i) {
+    const size_t beg = i * chunk_len;
+    const size_t cnt = std::min(chunk_len, len - beg);
+
+    transcrypt(old_lut,
+               old_nonce,
+               new_lut,
+               new_nonce,
+               offset + beg,
+               in + beg,
+               out + beg,
+               cnt);
+  });
+}
+
+}
@@ -0,0 +1,493 @@
+#pragma once
+#include "harpocrates.hpp"
+#include "harpocrates_simd.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, with
+// implementation chosen at run time, based on extensions supported by
+// executing CPU, so that a single binary ( compiled without any -march flag )
+// can use fastest kernel available on every host
+//
+// CPU is probed once, when any routine of this namespace is first invoked &
+// fastest supported kernel is bound, unless environment variable
+// `HARPOCRATES_KERNEL` names some other supported kernel ( see
+// `KERNEL_NAMES` ). Selected kernel can also be overridden using
+// `force_kernel`, for testing.
+namespace harpocrates_dispatch {
+
+// Implementations, which can be selected at run time ( see `RANKING` for
+// order of preference )
+//
+// - scalar: portable implementation, using SWAR column substitution
+// - bmi2: portable implementation, using PEXT/ PDEP column substitution
+// - gfni: portable implementation, using GF2P8AFFINEQB column substitution
+// - avx2: 32 message blocks at a time, using AVX2 ( see `harpocrates_simd` )
+// - avx512: 64 message blocks at a time, using AVX-512 VBMI
+//
+// Single message block routines of last two kernels use most preferred one of
+// first three kernels, which is supported by executing CPU.
+enum class kernel_t : uint8_t
+{
+  scalar = 0,
+  bmi2,
+  gfni,
+  avx2,
+  avx512,
+};
+
+// # -of kernels, which can be selected at run time
+constexpr size_t N_KERNELS = 5ul;
+
+// Kernels, ordered by throughput of `encrypt_blocks` ( as measured by
+// `harpocrates_dispatch_encrypt_blocks` benchmark ), i.e. later ones are
+// faster; portable kernels come first
+//
+// Column substitution is a small part of a round, so that all portable kernels
+// are within a few percent of each other, where bmi2 measures slightly ahead
+// of gfni, while avx2 & avx512 are faster, once batches fill their lanes.
+constexpr kernel_t RANKING[N_KERNELS] = { kernel_t::scalar,
+                                          kernel_t::gfni,
+                                          kernel_t::bmi2,
+                                          kernel_t::avx2,
+                                          kernel_t::avx512 };
+
+// # -of portable kernels, at start of `RANKING`
+constexpr size_t N_PORTABLE = 3ul;
+
+// Names of kernels, which are also accepted as value of `HARPOCRATES_KERNEL`
+// environment variable
+constexpr const char* KERNEL_NAMES[N_KERNELS] = { "scalar",
+                                                  "bmi2",
+                                                  "gfni",
+                                                  "avx2",
+                                                  "avx512" };
+
+// Function pointers bound to some kernel
+struct table_t
+{
+  kernel_t kernel;
+  void (*encrypt)(const uint8_t* const, const uint8_t* const, uint8_t* const);
+  void (*decrypt)(const uint8_t* const, const uint8_t* const, uint8_t* const);
+  void (*encrypt_blocks)(const uint8_t* const,
+                         const uint8_t* const,
+                         uint8_t* const,
+                         const size_t);
+  void (*decrypt_blocks)(const uint8_t* const,
+                         const uint8_t* const,
+                         uint8_t* const,
+                         const size_t);
+  void (*transcrypt_blocks)(const uint8_t* const,
+                            const uint8_t* const,
+                            const uint8_t* const,
+                            uint8_t* const,
+                            const size_t);
+};
+
+// # -of message blocks processed together by widest bulk kernel, which callers
+// batching blocks for bulk routines use as unit of work
+#if defined __x86_64__
+constexpr size_t MAX_LANES = harpocrates_simd::avx512::N_LANES;
+#else
+constexpr size_t MAX_LANES = harpocrates_common::N_LANES;
+#endif
+
+// Returns name of kernel
+static inline const char*
+kernel_name(const kernel_t kernel)
+{
+  return KERNEL_NAMES[static_cast<size_t>(kernel)];
+}
+
+// Parses kernel name, returning false if it doesn't name any kernel
+static inline bool
+parse_kernel(const char* const name, kernel_t* const kernel)
+{
+  for (size_t i = 0; i < N_KERNELS; i++) {
+    if (std::strcmp(name, KERNEL_NAMES[i]) == 0) {
+      *kernel = static_cast<kernel_t>(i);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Checks whether executing CPU supports extensions required by kernel
+static inline bool
+is_supported(const kernel_t kernel)
+{
+#if defined __x86_64__
+  switch (kernel) {
+    case kernel_t::scalar:
+      return true;
+    case kernel_t::bmi2:
+      return __builtin_cpu_supports("bmi2");
+    case kernel_t::gfni:
+      return __builtin_cpu_supports("gfni") && __builtin_cpu_supports("ssse3");
+    case kernel_t::avx2:
+      return __builtin_cpu_supports("avx2");
+    case kernel_t::avx512:
+      return __builtin_cpu_supports("avx512f") &&
+             __builtin_cpu_supports("avx512bw") &&
+             __builtin_cpu_supports("avx512vbmi");
+  }
+
+  return false;
+#else
+  return kernel == kernel_t::scalar;
+#endif
+}
+
+// Returns fastest kernel supported by executing CPU, among first `n` kernels
+// of `RANKING`
+static inline kernel_t
+best_kernel(const size_t n = N_KERNELS)
+{
+  for (size_t i = n; i > 0; i--) {
+    const kernel_t kernel = RANKING[i - 1];
+    if (is_supported(kernel)) {
+      return kernel;
+    }
+  }
+
+  return kernel_t::scalar;
+}
+
+// Returns function pointers of portable implementation, using column
+// substitution routine `colsub`
+template<const harpocrates_utils::column_substitution_t colsub>
+static inline table_t
+portable_table(const kernel_t kernel)
+{
+  return { kernel,
+           harpocrates::encrypt<colsub>,
+           harpocrates::decrypt<colsub>,
+           harpocrates::encrypt_blocks<colsub>,
+           harpocrates::decrypt_blocks<colsub>,
+           harpocrates::transcrypt_blocks<colsub> };
+}
+
+#if defined __x86_64__
+
+// Portable routines, using PEXT/ PDEP column substitution, whose whole bodies
+// are compiled for BMI2 ( & flattened ), so that column substitution gets
+// inlined into them, as it can't be inlined into routines compiled for
+// baseline x86-64
+namespace bmi2 {
+
+using harpocrates_utils::column_substitution_bmi2;
+
+__attribute__((target("bmi2"), flatten)) static void
+encrypt(const uint8_t* const __restrict lut,
+        const uint8_t* const __restrict txt,
+        uint8_t* const __restrict enc)
+{
+  harpocrates::encrypt<column_substitution_bmi2>(lut, txt, enc);
+}
+
+__attribute__((target("bmi2"), flatten)) static void
+decrypt(const uint8_t* const __restrict inv_lut,
+        const uint8_t* const __restrict enc,
+        uint8_t* const __restrict dec)
+{
+  harpocrates::decrypt<column_substitution_bmi2>(inv_lut, enc, dec);
+}
+
+__attribute__((target("bmi2"), flatten)) static void
+encrypt_blocks(const uint8_t* const __restrict lut,
+               const uint8_t* const txt,
+               uint8_t* const enc,
+               const size_t n_blocks)
+{
+  harpocrates::encrypt_blocks<column_substitution_bmi2>(
+    lut, txt, enc, n_blocks);
+}
+
+__attribute__((target("bmi2"), flatten)) static void
+decrypt_blocks(const uint8_t* const __restrict inv_lut,
+               const uint8_t* const enc,
+               uint8_t* const dec,
+               const size_t n_blocks)
+{
+  harpocrates::decrypt_blocks<column_substitution_bmi2>(
+    inv_lut, enc, dec, n_blocks);
+}
+
+__attribute__((target("bmi2"), flatten)) static void
+transcrypt_blocks(const uint8_t* const __restrict inv_lut,
+                  const uint8_t* const __restrict lut,
+                  const uint8_t* const enc,
+                  uint8_t* const out,
+                  const size_t n_blocks)
+{
+  harpocrates::transcrypt_blocks<column_substitution_bmi2>(
+    inv_lut, lut, enc, out, n_blocks);
+}
+
+}
+
+// Portable routines, using GF2P8AFFINEQB column substitution, compiled for
+// GFNI ( see `bmi2` )
+namespace gfni {
+
+using harpocrates_utils::column_substitution_gfni;
+
+__attribute__((target("gfni,ssse3"), flatten)) static void
+encrypt(const uint8_t* const __restrict lut,
+        const uint8_t* const __restrict txt,
+        uint8_t* const __restrict enc)
+{
+  harpocrates::encrypt<column_substitution_gfni>(lut, txt, enc);
+}
+
+__attribute__((target("gfni,ssse3"), flatten)) static void
+decrypt(const uint8_t* const __restrict inv_lut,
+        const uint8_t* const __restrict enc,
+        uint8_t* const __restrict dec)
+{
+  harpocrates::decrypt<column_substitution_gfni>(inv_lut, enc, dec);
+}
+
+__attribute__((target("gfni,ssse3"), flatten)) static void
+encrypt_blocks(const uint8_t* const __restrict lut,
+               const uint8_t* const txt,
+               uint8_t* const enc,
+               const size_t n_blocks)
+{
+  harpocrates::encrypt_blocks<column_substitution_gfni>(
+    lut, txt, enc, n_blocks);
+}
+
+__attribute__((target("gfni,ssse3"), flatten)) static void
+decrypt_blocks(const uint8_t* const __restrict inv_lut,
+               const uint8_t* const enc,
+               uint8_t* const dec,
+               const size_t n_blocks)
+{
+  harpocrates::decrypt_blocks<column_substitution_gfni>(
+    inv_lut, enc, dec, n_blocks);
+}
+
+__attribute__((target("gfni,ssse3"), flatten)) static void
+transcrypt_blocks(const uint8_t* const __restrict inv_lut,
+                  const uint8_t* const __restrict lut,
+                  const uint8_t* const enc,
+                  uint8_t* const out,
+                  const size_t n_blocks)
+{
+  harpocrates::transcrypt_blocks<column_substitution_gfni>(
+    inv_lut, lut, enc, out, n_blocks);
+}
+
+}
+
+#endif
+
+// Returns function pointers bound to kernel, which must be supported by
+// executing CPU
+static inline table_t
+make_table(const kernel_t kernel)
+{
+  using namespace harpocrates_utils;
+
+  switch (kernel) {
+#if defined __x86_64__
+    case kernel_t::bmi2:
+      return { kernel,
+               bmi2::encrypt,
+               bmi2::decrypt,
+               bmi2::encrypt_blocks,
+               bmi2::decrypt_blocks,
+               bmi2::transcrypt_blocks };
+    case kernel_t::gfni:
+      return { kernel,
+               gfni::encrypt,
+               gfni::decrypt,
+               gfni::encrypt_blocks,
+               gfni::decrypt_blocks,
+               gfni::transcrypt_blocks };
+    case kernel_t::avx2: {
+      table_t table = make_table(best_kernel(N_PORTABLE));
+
+      table.kernel = kernel;
+      table.encrypt_blocks = harpocrates_simd::avx2::encrypt_blocks;
+      table.decrypt_blocks = harpocrates_simd::avx2::decrypt_blocks;
+      table.transcrypt_blocks = harpocrates_simd::avx2::transcrypt_blocks;
+
+      return table;
+    }
+    case kernel_t::avx512: {
+      table_t table = make_table(best_kernel(N_PORTABLE));
+
+      table.kernel = kernel;
+      table.encrypt_blocks = harpocrates_simd::avx512::encrypt_blocks;
+      table.decrypt_blocks = harpocrates_simd::avx512::decrypt_blocks;
+      table.transcrypt_blocks = harpocrates_simd::avx512::transcrypt_blocks;
+
+      return table;
+    }
+#endif
+    default:
+      return portable_table<column_substitution_swar>(kernel_t::scalar);
+  }
+}
+
+// Function pointers of every kernel supported by executing CPU, along with
+// currently selected one; shared by all translation units
+inline table_t tables[N_KERNELS];
+inline std::atomic<const table_t*> selected{ nullptr };
+inline std::once_flag probed;
+
+// Returns kernel, which is selected by default i.e. one named by
+// `HARPOCRATES_KERNEL` environment variable, if it's supported by executing
+// CPU, otherwise fastest supported one
+static inline kernel_t
+default_kernel()
+{
+  const char* const name = std::getenv("HARPOCRATES_KERNEL");
+
+  kernel_t kernel;
+  if (name != nullptr && parse_kernel(name, &kernel) && is_supported(kernel)) {
+    return kernel;
+  }
+
+  return best_kernel();
+}
+
+// Probes executing CPU ( only once ) & returns function pointers of currently
+// selected kernel
+static inline const table_t*
+table()
+{
+  const table_t* const ptr = selected.load(std::memory_order_acquire);
+  if (ptr != nullptr) {
+    return ptr;
+  }
+
+  std::call_once(probed, [] {
+    for (size_t i = 0; i < N_KERNELS; i++) {
+      const kernel_t kernel = static_cast<kernel_t>(i);
+      if (is_supported(kernel)) {
+        tables[i] = make_table(kernel);
+      }
+    }
+
+    const table_t* expected = nullptr;
+    const table_t* desired = tables + static_cast<size_t>(default_kernel());
+    selected.compare_exchange_strong(expected, desired);
+  });
+
+  return selected.load(std::memory_order_acquire);
+}
+
+// Selects kernel to be used by all subsequent calls, returning false ( while
+// keeping current selection ) if executing CPU doesn't support it
+static inline bool
+force_kernel(const kernel_t kernel)
+{
+  if (!is_supported(kernel)) {
+    return false;
+  }
+
+  table();
+  selected.store(tables + static_cast<size_t>(kernel),
+                 std::memory_order_release);
+
+  return true;
+}
+
+// Selects kernel by its name ( see `KERNEL_NAMES` ), returning false if it
+// doesn't name any kernel or executing CPU doesn't support it
+static inline bool
+force_kernel(const char* const name)
+{
+  kernel_t kernel;
+  return parse_kernel(name, &kernel) && force_kernel(kernel);
+}
+
+// Undoes effect of `force_kernel`, selecting default kernel again
+static inline void
+reset_kernel()
+{
+  force_kernel(default_kernel());
+}
+
+// Returns currently selected kernel
+static inline kernel_t
+selected_kernel()
+{
+  return table()->kernel;
+}
+
+// Returns name of currently selected kernel, which can be used for attributing
+// throughput to kernel, on each host
+static inline const char*
+selected_kernel_name()
+{
+  return kernel_name(selected_kernel());
+}
+
+// Encrypts 16 -bytes message block, using selected kernel; see
+// `harpocrates::encrypt`
+static inline void
+encrypt(const uint8_t* const __restrict lut, // look up table
+        const uint8_t* const __restrict txt, // input plain text
+        uint8_t* const __restrict enc        // output encrypted bytes
+)
+{
+  table()->encrypt(lut, txt, enc);
+}
+
+// Decrypts 16 -bytes message block, using selected kernel; see
+// `harpocrates::decrypt`
+static inline void
+decrypt(const uint8_t* const __restrict inv_lut, // inverse look up table
+        const uint8_t* const __restrict enc,     // input encrypted bytes
+        uint8_t* const __restrict dec            // output decrypted bytes
+)
+{
+  table()->decrypt(inv_lut, enc, dec);
+}
+
+// Encrypts N -many consecutive 16 -bytes message blocks, using selected kernel;
+// see `harpocrates::encrypt_blocks`
+static inline void
+encrypt_blocks(const uint8_t* const __restrict lut, // look up table
+               const uint8_t* const txt,            // input plain text
+               uint8_t* const enc,                  // output encrypted bytes
+               const size_t n_blocks                // # -of message blocks
+)
+{
+  table()->encrypt_blocks(lut, txt, enc, n_blocks);
+}
+
+// Decrypts N -many consecutive 16 -bytes encrypted message blocks, using
+// selected kernel; see `harpocrates::decrypt_blocks`
+static inline void
+decrypt_blocks(const uint8_t* const __restrict inv_lut, // inverse look up table
+               const uint8_t* const enc,                // input encrypted bytes
+               uint8_t* const dec,                      // decrypted bytes
+               const size_t n_blocks                    // # -of message blocks
+)
+{
+  table()->decrypt_blocks(inv_lut, enc, dec, n_blocks);
+}
+
+// Re-encrypts N -many consecutive 16 -bytes message blocks, encrypted under
+// old look up table, under new look up table, using selected kernel; see
+// `harpocrates::transcrypt_blocks`
+static inline void
+transcrypt_blocks(const uint8_t* const __restrict inv_lut, // old inverse table
+                  const uint8_t* const __restrict lut,     // new look up table
+                  const uint8_t* const enc,                // encrypted bytes
+                  uint8_t* const out,                      // re-encrypted bytes
+                  const size_t n_blocks                    // # -of blocks
+)
+{
+  table()->transcrypt_blocks(inv_lut, lut, enc, out, n_blocks);
+}
+
+}
@@ -0,0 +1,325 @@
+#pragma once
+#include "harpocrates_utils.hpp"
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, using
+// per-key expanded ( read precomputed ) row substitution tables
+//
+// For a fixed look up table, both left to right & right to left convoluted
+// substitutions are pure functions from 16 -bit row to 16 -bit row, which is
+// why they can be computed once for all 2^16 possible rows, so that five
+// dependent 8 -bit look ups per row get replaced by a single 16 -bit look up.
+//
+// Expanded tables take 256 KB per look up table, so this engine is meant to be
+// used only when that much memory can be spared, otherwise stick to
+// `harpocrates::` namespace, which requires only 256 -bytes look up table.
+namespace harpocrates_expanded {
+
+// # -of entries ( each of 16 -bit ) in each row substitution table, one for
+// every possible value of 16 -bit row
+constexpr size_t ROW_TABLE_LEN = 1ul << 16;
+
+// # -of entries ( each of 16 -bit ) in expanded table, holding left to right
+// convoluted substitution table, followed by right to left one
+constexpr size_t TABLE_LEN = ROW_TABLE_LEN << 1;
+
+// Given look up table ( read `lut` ) of size 256, this routine computes
+// expanded table ( read `tbl` ) of size 2^17, holding result of left to right
+// convoluted substitution for all possible 16 -bit rows, followed by result of
+// right to left convoluted substitution for all possible 16 -bit rows
+//
+// Input:
+// - lut: Look up table holding 256 elements
+//
+// Output:
+// - tbl: Expanded table holding 2^17 elements, each of 16 -bit
+//
+// Note, when expanded table is to be used for decryption, it must be computed
+// from inverse look up table, such that
+//
+// inv_tbl = harpocrates_expanded::expand_lut(inv_lut)
+static inline void
+expand_lut(const uint8_t* const __restrict lut, uint16_t* const __restrict tbl)
+{
+  uint16_t* const l2r_tbl = tbl;
+  uint16_t* const r2l_tbl = tbl + ROW_TABLE_LEN;
+
+  for (size_t i = 0; i < ROW_TABLE_LEN; i++) {
+    l2r_tbl[i] = static_cast<uint16_t>(i);
+    r2l_tbl[i] = static_cast<uint16_t>(i);
+  }
+
+  harpocrates_utils::left_to_right_convoluted_substitution<ROW_TABLE_LEN>(
+    l2r_tbl, lut);
+  harpocrates_utils::right_to_left_convoluted_substitution<ROW_TABLE_LEN>(
+    r2l_tbl, lut);
+}
+
+// Left to right convoluted substitution of `n_rows` -many rows, using
+// precomputed row substitution table ( see expand_lut )
+template<const size_t n_rows = harpocrates_common::N_ROWS>
+static inline void
+left_to_right_convoluted_substitution(uint16_t* const __restrict state,
+                                      const uint16_t* const __restrict tbl)
+{
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC ivdep
+#pragma GCC unroll 8
+#endif
+  for (size_t i = 0; i < n_rows; i++) {
+    state[i] = tbl[state[i]];
+  }
+}
+
+// Right to left convoluted substitution of `n_rows` -many rows, using
+// precomputed row substitution table ( see expand_lut )
+template<const size_t n_rows = harpocrates_common::N_ROWS>
+static inline void
+right_to_left_convoluted_substitution(uint16_t* const __restrict state,
+                                      const uint16_t* const __restrict tbl)
+{
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC ivdep
+#pragma GCC unroll 8
+#endif
+  for (size_t i = 0; i < n_rows; i++) {
+    state[i] = tbl[ROW_TABLE_LEN ^ state[i]];
+  }
+}
+
+// Given `lanes` -many consecutive 16 -bytes message blocks, look up table (
+// read `lut` ) & expanded table ( read `tbl` ) computed from `lut`, this
+// routine encrypts all of them together, by interleaving their state matrices
+//
+// Input:
+// - lut: Look up table holding 256 elements ( used for column substitution )
+// - tbl: Expanded table holding 2^17 elements ( see expand_lut )
+// - txt: lanes x 16 input bytes, to be encrypted
+//
+// Output:
+// - enc: lanes x 16 encrypted output bytes
+//
+// Note, `txt` and `enc` may point to same memory ( i.e. in-place encryption )
+template<const size_t lanes>
+static inline void
+encrypt_lanes(const uint8_t* const __restrict lut,  // look up table
+              const uint16_t* const __restrict tbl, // expanded table
+              const uint8_t* const txt,             // input plain text
+              uint8_t* const enc                    // output encrypted bytes
+)
+{
+  constexpr size_t n_rows = harpocrates_common::N_ROWS * lanes;
+  constexpr size_t itr_cnt = n_rows >> 1;
+
+  uint16_t state[n_rows] = { 0u };
+
+#if defined __clang__
+#pragma unroll 4
+#elif defined __GNUG__
+#pragma GCC ivdep
+#pragma GCC unroll 4
+#endif
+  for (size_t i = 0; i < itr_cnt; i++) {
+    const size_t b_off = i << 2;
+    const size_t r_off = i << 1;
+
+    state[r_off ^ 0] = (static_cast<uint16_t>(txt[b_off ^ 0]) << 8) |
+                       static_cast<uint16_t>(txt[b_off ^ 1]);
+    state[r_off ^ 1] = (static_cast<uint16_t>(txt[b_off ^ 2]) << 8) |
+                       static_cast<uint16_t>(txt[b_off ^ 3]);
+  }
+
+  for (size_t i = 0; i < harpocrates_common::N_ROUNDS; i++) {
+    left_to_right_convoluted_substitution<n_rows>(state, tbl);
+
+    for (size_t j = 0; j < lanes; j++) {
+      const size_t off = j * harpocrates_common::N_ROWS;
+
+      harpocrates_utils::add_rc(state + off, i);
+      harpocrates_utils::transposed_column_substitution(state + off, lut);
+    }
+
+    right_to_left_convoluted_substitution<n_rows>(state, tbl);
+  }
+
+#if defined __clang__
+#pragma unroll 4
+#elif defined __GNUG__
+#pragma GCC ivdep
+#pragma GCC unroll 4
+#endif
+  for (size_t i = 0; i < itr_cnt; i++) {
+    const size_t b_off = i << 2;
+    const size_t r_off = i << 1;
+
+    enc[b_off ^ 0] = static_cast<uint8_t>(state[r_off ^ 0] >> 8);
+    enc[b_off ^ 1] = static_cast<uint8_t>(state[r_off ^ 0]);
+    enc[b_off ^ 2] = static_cast<uint8_t>(state[r_off ^ 1] >> 8);
+    enc[b_off ^ 3] = static_cast<uint8_t>(state[r_off ^ 1]);
+  }
+}
+
+// Given `lanes` -many consecutive 16 -bytes encrypted message blocks, inverse
+// look up table ( read `inv_lut` ) & expanded table ( read `inv_tbl` ) computed
+// from `inv_lut`, this routine decrypts all of them together, by interleaving
+// their state matrices
+//
+// Input:
+// - inv_lut: Inverse look up table holding 256 elements
+// - inv_tbl: Expanded table holding 2^17 elements, computed from `inv_lut`
+// - enc: lanes x 16 encrypted input bytes
+//
+// Output:
+// - dec: lanes x 16 decrypted output bytes
+//
+// Note, `enc` and `dec` may point to same memory ( i.e. in-place decryption )
+template<const size_t lanes>
+static inline void
+decrypt_lanes(const uint8_t* const __restrict inv_lut,  // inverse look up table
+              const uint16_t* const __restrict inv_tbl, // expanded table
+              const uint8_t* const enc,                 // input encrypted bytes
+              uint8_t* const dec                        // decrypted bytes
+)
+{
+  constexpr size_t n_rows = harpocrates_common::N_ROWS * lanes;
+  constexpr size_t itr_cnt = n_rows >> 1;
+
+  uint16_t state[n_rows] = { 0u };
+
+#if defined __clang__
+#pragma unroll 4
+#elif defined __GNUG__
+#pragma GCC ivdep
+#pragma GCC unroll 4
+#endif
+  for (size_t i = 0; i < itr_cnt; i++) {
+    const size_t b_off = i << 2;
+    const size_t r_off = i << 1;
+
+    state[r_off ^ 0] = (static_cast<uint16_t>(enc[b_off ^ 0]) << 8) |
+                       static_cast<uint16_t>(enc[b_off ^ 1]);
+    state[r_off ^ 1] = (static_cast<uint16_t>(enc[b_off ^ 2]) << 8) |
+                       static_cast<uint16_t>(enc[b_off ^ 3]);
+  }
+
+  for (size_t i = 0; i < harpocrates_common::N_ROUNDS; i++) {
+    left_to_right_convoluted_substitution<n_rows>(state, inv_tbl);
+
+    for (size_t j = 0; j < lanes; j++) {
+      const size_t off = j * harpocrates_common::N_ROWS;
+
+      harpocrates_utils::transposed_column_substitution(state + off, inv_lut);
+      harpocrates_utils::add_rc(state + off,
+                                harpocrates_common::N_ROUNDS - (i + 1));
+    }
+
+    right_to_left_convoluted_substitution<n_rows>(state, inv_tbl);
+  }
+
+#if defined __clang__
+#pragma unroll 4
+#elif defined __GNUG__
+#pragma GCC ivdep
+#pragma GCC unroll 4
+#endif
+  for (size_t i = 0; i < itr_cnt; i++) {
+    const size_t b_off = i << 2;
+    const size_t r_off = i << 1;
+
+    dec[b_off ^ 0] = static_cast<uint8_t>(state[r_off ^ 0] >> 8);
+    dec[b_off ^ 1] = static_cast<uint8_t>(state[r_off ^ 0]);
+    dec[b_off ^ 2] = static_cast<uint8_t>(state[r_off ^ 1] >> 8);
+    dec[b_off ^ 3] = static_cast<uint8_t>(state[r_off ^ 1]);
+  }
+}
+
+// Given 16 -bytes of unencrypted input message block, look up table ( read
+// `lut` ) & expanded table ( read `tbl` ) computed from `lut`, this routine
+// computes 16 -bytes of encrypted data, which is same as what
+// `harpocrates::encrypt` computes
+static inline void
+encrypt(const uint8_t* const __restrict lut,  // look up table
+        const uint16_t* const __restrict tbl, // expanded table
+        const uint8_t* const txt,             // input plain text
+        uint8_t* const enc                    // output encrypted bytes
+)
+{
+  encrypt_lanes<1>(lut, tbl, txt, enc);
+}
+
+// Given 16 -bytes of encrypted input message block, inverse look up table (
+// read `inv_lut` ) & expanded table ( read `inv_tbl` ) computed from
+// `inv_lut`, this routine computes 16 -bytes of decrypted data, which is same
+// as what `harpocrates::decrypt` computes
+static inline void
+decrypt(const uint8_t* const __restrict inv_lut,  // inverse look up table
+        const uint16_t* const __restrict inv_tbl, // expanded table
+        const uint8_t* const enc,                 // input encrypted bytes
+        uint8_t* const dec                        // output decrypted bytes
+)
+{
+  decrypt_lanes<1>(inv_lut, inv_tbl, enc, dec);
+}
+
+// Given N -many consecutive 16 -bytes message blocks, this routine encrypts
+// all of them, processing N_LANES blocks at a time, while trailing blocks are
+// encrypted one by one
+//
+// `txt` and `enc` may point to same memory ( i.e. in-place encryption )
+static inline void
+encrypt_blocks(const uint8_t* const __restrict lut,  // look up table
+               const uint16_t* const __restrict tbl, // expanded table
+               const uint8_t* const txt,             // input plain text
+               uint8_t* const enc,                   // output encrypted bytes
+               const size_t n_blocks                 // # -of message blocks
+)
+{
+  constexpr size_t lanes = harpocrates_common::N_LANES;
+  constexpr size_t chunk_len = lanes * harpocrates_common::BLOCK_LEN;
+
+  const size_t n_chunks = n_blocks / lanes;
+
+  for (size_t i = 0; i < n_chunks; i++) {
+    const size_t off = i * chunk_len;
+    encrypt_lanes<lanes>(lut, tbl, txt + off, enc + off);
+  }
+
+  for (size_t i = n_chunks * lanes; i < n_blocks; i++) {
+    const size_t off = i * harpocrates_common::BLOCK_LEN;
+    encrypt_lanes<1>(lut, tbl, txt + off, enc + off);
+  }
+}
+
+// Given N -many consecutive 16 -bytes encrypted message blocks, this routine
+// decrypts all of them, processing N_LANES blocks at a time, while trailing
+// blocks are decrypted one by one
+//
+// `enc` and `dec` may point to same memory ( i.e. in-place decryption )
+static inline void
+decrypt_blocks(const uint8_t* const __restrict inv_lut,  // inverse LUT
+               const uint16_t* const __restrict inv_tbl, // expanded table
+               const uint8_t* const enc,                 // encrypted bytes
+               uint8_t* const dec,                       // decrypted bytes
+               const size_t n_blocks                     // # -of blocks
+)
+{
+  constexpr size_t lanes = harpocrates_common::N_LANES;
+  constexpr size_t chunk_len = lanes * harpocrates_common::BLOCK_LEN;
+
+  const size_t n_chunks = n_blocks / lanes;
+
+  for (size_t i = 0; i < n_chunks; i++) {
+    const size_t off = i * chunk_len;
+    decrypt_lanes<lanes>(inv_lut, inv_tbl, enc + off, dec + off);
+  }
+
+  for (size_t i = n_chunks * lanes; i < n_blocks; i++) {
+    const size_t off = i * harpocrates_common::BLOCK_LEN;
+    decrypt_lanes<1>(inv_lut, inv_tbl, enc + off, dec + off);
+  }
+}
+
+}
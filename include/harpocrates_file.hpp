@@ -0,0 +1,234 @@
+#pragma once
+#include "harpocrates_ctr.hpp"
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, used for
+// encrypting/ decrypting whole files, in counter mode
+//
+// Files are memory mapped, so that encryption kernel reads from & writes to
+// page cache directly, without read()/ write() copies through user space
+// buffers, while mapping is split into chunks, encrypted by workers of thread
+// pool. Kernel is advised that mapping is accessed sequentially ( so that it
+// reads ahead aggressively & drops pages behind ) and, where supported, that
+// it may be backed by transparent huge pages.
+namespace harpocrates_file {
+
+// Memory mapped file, which is unmapped & closed, when it goes out of scope;
+// on failure, routines return false, leaving cause in `errno`
+class mapped_file
+{
+public:
+  mapped_file() = default;
+  mapped_file(const mapped_file&) = delete;
+  mapped_file& operator=(const mapped_file&) = delete;
+
+  ~mapped_file() { close(); }
+
+  // Maps whole file, for reading
+  bool open_read(const char* const path)
+  {
+    close();
+
+    fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+
+    return map(PROT_READ);
+  }
+
+  // Maps whole file, for reading & writing; when `len` is given, file is
+  // created ( if it doesn't exist ) & resized to `len` -bytes. Blocks of whole
+  // file are allocated up front, so that running out of space is reported
+  // here, instead of raising SIGBUS, while writing through mapping.
+  bool open_write(const char* const path, const int64_t len = -1)
+  {
+    close();
+
+    fd = ::open(path, len < 0 ? O_RDWR : O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+      return false;
+    }
+
+    if (len >= 0 && ::ftruncate(fd, static_cast<off_t>(len)) != 0) {
+      return false;
+    }
+
+    return map(PROT_READ | PROT_WRITE);
+  }
+
+  // Writes modified pages of mapping back to file & flushes file to storage,
+  // so that write back errors are reported
+  bool sync()
+  {
+    if (ptr != nullptr && ::msync(ptr, len, MS_SYNC) != 0) {
+      return false;
+    }
+
+    return fd < 0 || ::fsync(fd) == 0;
+  }
+
+  // Unmaps & closes file, if it's open
+  bool close()
+  {
+    bool ok = true;
+
+    if (ptr != nullptr) {
+      ok = ::munmap(ptr, len) == 0;
+    }
+    if (fd >= 0) {
+      ok = (::close(fd) == 0) && ok;
+    }
+
+    fd = -1;
+    ptr = nullptr;
+    len = 0;
+
+    return ok;
+  }
+
+  uint8_t* data() const { return ptr; }
+  size_t size() const { return len; }
+
+private:
+  bool map(const int prot)
+  {
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      return false;
+    }
+
+    len = static_cast<size_t>(st.st_size);
+    if (len == 0) {
+      return true;
+    }
+
+    if ((prot & PROT_WRITE) != 0) {
+      const int err = ::posix_fallocate(fd, 0, static_cast<off_t>(len));
+      if (err != 0) {
+        len = 0;
+        errno = err;
+        return false;
+      }
+    }
+
+    void* const addr = ::mmap(nullptr, len, prot, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+      len = 0;
+      return false;
+    }
+
+    ptr = static_cast<uint8_t*>(addr);
+
+    ::madvise(ptr, len, MADV_SEQUENTIAL);
+#if defined MADV_HUGEPAGE
+    ::madvise(ptr, len, MADV_HUGEPAGE);
+#endif
+
+    return true;
+  }
+
+  int fd = -1;
+  uint8_t* ptr = nullptr;
+  size_t len = 0;
+};
+
+// Encrypts ( or decrypts ) whole file, in counter mode, given look up table &
+// 8 -bytes nonce, writing result to `out_path`, which is created if it doesn't
+// exist, or back to `in_path` itself ( i.e. in-place ), when `out_path` is
+// nullptr
+//
+// Returns false on failure, leaving cause in `errno`, which includes failing to
+// write result back to storage.
+static inline bool
+crypt_file(harpocrates_parallel::thread_pool& pool, // reusable thread pool
+           const uint8_t* const __restrict lut,     // look up table
+           const uint8_t* const __restrict nonce,   // 8 -bytes nonce
+           const char* const in_path,               // input file
+           const char* const out_path               // output file ( optional )
+)
+{
+  mapped_file in;
+  mapped_file out;
+
+  if (out_path == nullptr) {
+    if (!in.open_write(in_path)) {
+      return false;
+    }
+
+    uint8_t* const buf = in.data();
+    harpocrates_ctr::crypt(pool, lut, nonce, 0, buf, buf, in.size());
+
+    return in.sync() && in.close();
+  }
+
+  if (!in.open_read(in_path)) {
+    return false;
+  }
+  if (!out.open_write(out_path, static_cast<int64_t>(in.size()))) {
+    return false;
+  }
+
+  harpocrates_ctr::crypt(pool, lut, nonce, 0, in.data(), out.data(), in.size());
+
+  return out.sync() && out.close();
+}
+
+// Re-encrypts whole file, which was encrypted in counter mode, under old look
+// up table & nonce, so that it's encrypted under new ones, writing result to
+// `out_path`, which is created if it doesn't exist, or back to `in_path` itself
+// ( i.e. in-place ), when `out_path` is nullptr; see
+// `harpocrates_ctr::transcrypt`
+//
+// Returns false on failure, leaving cause in `errno`, which includes failing to
+// write result back to storage.
+static inline bool
+transcrypt_file(harpocrates_parallel::thread_pool& pool,   // reusable pool
+                const uint8_t* const __restrict old_lut,   // old look up table
+                const uint8_t* const __restrict old_nonce, // old nonce
+                const uint8_t* const __restrict new_lut,   // new look up table
+                const uint8_t* const __restrict new_nonce, // new nonce
+                const char* const in_path,                 // input file
+                const char* const out_path // output file ( optional )
+)
+{
+  mapped_file in;
+  mapped_file out;
+
+  if (out_path == nullptr) {
+    if (!in.open_write(in_path)) {
+      return false;
+    }
+
+    uint8_t* const buf = in.data();
+    harpocrates_ctr::transcrypt(
+      pool, old_lut, old_nonce, new_lut, new_nonce, 0, buf, buf, in.size());
+
+    return in.sync() && in.close();
+  }
+
+  if (!in.open_read(in_path)) {
+    return false;
+  }
+  if (!out.open_write(out_path, static_cast<int64_t>(in.size()))) {
+    return false;
+  }
+
+  harpocrates_ctr::transcrypt(pool,
+                              old_lut,
+                              old_nonce,
+                              new_lut,
+                              new_nonce,
+                              0,
+                              in.data(),
+                              out.data(),
+                              in.size());
+
+  return out.sync() && out.close();
+}
+
+}
@@ -0,0 +1,327 @@
+#pragma once
+#include "harpocrates_utils.hpp"
+#include <array>
+#include <bit>
+#include <utility>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, specialized
+// during compilation for a fixed look up table ( e.g. one provisioned into
+// firmware ), which is passed as non-type template parameter
+//
+// Inverse look up table is computed by compiler ( see `inverse` ) & both tables
+// are emitted as constants, so that look ups index into them at fixed
+// addresses, without keeping table pointer in some register. All N_ROUNDS
+// rounds are unrolled into straight-line code, with their round constants (
+// see `RCS` ) folded into immediate operands of XOR instructions.
+//
+// Message blocks are interleaved N_LANES at a time, same as
+// `harpocrates::encrypt_blocks` does, while column substitution routine can be
+// chosen, same as there.
+namespace harpocrates_fixed {
+
+// Look up table, which can be passed as non-type template parameter
+using lut_t = std::array<uint8_t, 256>;
+
+// Checks, during compilation, that look up table is a permutation of [0, 256)
+constexpr bool
+is_permutation(const lut_t& lut)
+{
+  bool seen[256] = {};
+
+  for (const uint8_t v : lut) {
+    if (seen[v]) {
+      return false;
+    }
+    seen[v] = true;
+  }
+
+  return true;
+}
+
+// Computes inverse of look up table, during compilation
+constexpr lut_t
+inverse(const lut_t& lut)
+{
+  lut_t inv_lut{};
+  harpocrates_utils::generate_inv_lut(lut.data(), inv_lut.data());
+
+  return inv_lut;
+}
+
+// Inverse of look up table, known at compile time
+template<const lut_t lut>
+constexpr lut_t inv_lut_v = inverse(lut);
+
+// Round constants of every round i.e. RCS[r][i] is i-th row of round-0
+// constants ( see `harpocrates_common::RC` ), rotated left by `r << 1` -bits
+constexpr auto RCS = [] {
+  using namespace harpocrates_common;
+
+  std::array<std::array<uint16_t, N_ROWS>, N_ROUNDS> rcs{};
+
+  for (size_t r = 0; r < N_ROUNDS; r++) {
+    for (size_t i = 0; i < N_ROWS; i++) {
+      rcs[r][i] = std::rotl(RC[i], static_cast<int>(r << 1));
+    }
+  }
+
+  return rcs;
+}();
+
+// Loads `lanes` -many consecutive 16 -bytes message blocks into state matrices
+template<const size_t lanes>
+static inline void
+load_state(const uint8_t* const __restrict blocks,
+           uint16_t* const __restrict state)
+{
+  constexpr size_t itr_cnt = (harpocrates_common::N_ROWS * lanes) >> 1;
+
+#if defined __clang__
+#pragma unroll 4
+#elif defined __GNUG__
+#pragma GCC ivdep
+#pragma GCC unroll 4
+#endif
+  for (size_t i = 0; i < itr_cnt; i++) {
+    const size_t b_off = i << 2;
+    const size_t r_off = i << 1;
+
+    state[r_off ^ 0] = (static_cast<uint16_t>(blocks[b_off ^ 0]) << 8) |
+                       static_cast<uint16_t>(blocks[b_off ^ 1]);
+    state[r_off ^ 1] = (static_cast<uint16_t>(blocks[b_off ^ 2]) << 8) |
+                       static_cast<uint16_t>(blocks[b_off ^ 3]);
+  }
+}
+
+// Stores `lanes` -many state matrices back as 16 -bytes message blocks
+template<const size_t lanes>
+static inline void
+store_state(const uint16_t* const __restrict state,
+            uint8_t* const __restrict blocks)
+{
+  constexpr size_t itr_cnt = (harpocrates_common::N_ROWS * lanes) >> 1;
+
+#if defined __clang__
+#pragma unroll 4
+#elif defined __GNUG__
+#pragma GCC ivdep
+#pragma GCC unroll 4
+#endif
+  for (size_t i = 0; i < itr_cnt; i++) {
+    const size_t b_off = i << 2;
+    const size_t r_off = i << 1;
+
+    blocks[b_off ^ 0] = static_cast<uint8_t>(state[r_off ^ 0] >> 8);
+    blocks[b_off ^ 1] = static_cast<uint8_t>(state[r_off ^ 0]);
+    blocks[b_off ^ 2] = static_cast<uint8_t>(state[r_off ^ 1] >> 8);
+    blocks[b_off ^ 3] = static_cast<uint8_t>(state[r_off ^ 1]);
+  }
+}
+
+// Adds round constants of r-th round into state matrix, where each of them is
+// an immediate operand
+template<const size_t r>
+static inline void
+add_rc(uint16_t* const state)
+{
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+  for (size_t i = 0; i < harpocrates_common::N_ROWS; i++) {
+    state[i] ^= RCS[r][i];
+  }
+}
+
+// r-th encryption round, applied on `lanes` interleaved state matrices, where
+// `lut` is address of table known at compile time, which is folded into look
+// ups, once this routine is inlined
+template<const size_t lanes,
+         const harpocrates_utils::column_substitution_t colsub,
+         const size_t r>
+static inline void
+encrypt_round(uint16_t* const __restrict state,
+              const uint8_t* const __restrict lut)
+{
+  using namespace harpocrates_utils;
+
+  constexpr size_t n_rows = harpocrates_common::N_ROWS * lanes;
+
+  left_to_right_convoluted_substitution<n_rows>(state, lut);
+
+  for (size_t j = 0; j < lanes; j++) {
+    const size_t off = j * harpocrates_common::N_ROWS;
+
+    add_rc<r>(state + off);
+    colsub(state + off, lut);
+  }
+
+  right_to_left_convoluted_substitution<n_rows>(state, lut);
+}
+
+// Decryption round, undoing r-th encryption round, applied on `lanes`
+// interleaved state matrices, using inverse look up table ( see
+// `encrypt_round` )
+template<const size_t lanes,
+         const harpocrates_utils::column_substitution_t colsub,
+         const size_t r>
+static inline void
+decrypt_round(uint16_t* const __restrict state,
+              const uint8_t* const __restrict inv_lut)
+{
+  using namespace harpocrates_utils;
+
+  constexpr size_t n_rows = harpocrates_common::N_ROWS * lanes;
+
+  left_to_right_convoluted_substitution<n_rows>(state, inv_lut);
+
+  for (size_t j = 0; j < lanes; j++) {
+    const size_t off = j * harpocrates_common::N_ROWS;
+
+    colsub(state + off, inv_lut);
+    add_rc<r>(state + off);
+  }
+
+  right_to_left_convoluted_substitution<n_rows>(state, inv_lut);
+}
+
+// Encrypts `lanes` -many consecutive 16 -bytes message blocks, under look up
+// table known at compile time, by interleaving their state matrices ( see
+// `harpocrates::encrypt_lanes` ); `txt` and `enc` may point to same memory
+template<const lut_t lut,
+         const size_t lanes,
+         const harpocrates_utils::column_substitution_t colsub =
+           harpocrates_utils::transposed_column_substitution>
+static inline void
+encrypt_lanes(const uint8_t* const txt, // input plain text
+              uint8_t* const enc        // output encrypted bytes
+)
+{
+  static_assert(is_permutation(lut), "Look up table must be a permutation");
+
+  uint16_t state[harpocrates_common::N_ROWS * lanes];
+
+  load_state<lanes>(txt, state);
+
+  [&]<size_t... r>(std::index_sequence<r...>) {
+    (encrypt_round<lanes, colsub, r>(state, lut.data()), ...);
+  }(std::make_index_sequence<harpocrates_common::N_ROUNDS>{});
+
+  store_state<lanes>(state, enc);
+}
+
+// Decrypts `lanes` -many consecutive 16 -bytes encrypted message blocks, under
+// look up table known at compile time ( not its inverse, which is computed by
+// compiler ); `enc` and `dec` may point to same memory
+template<const lut_t lut,
+         const size_t lanes,
+         const harpocrates_utils::column_substitution_t colsub =
+           harpocrates_utils::transposed_column_substitution>
+static inline void
+decrypt_lanes(const uint8_t* const enc, // input encrypted bytes
+              uint8_t* const dec        // output decrypted bytes
+)
+{
+  static_assert(is_permutation(lut), "Look up table must be a permutation");
+
+  constexpr size_t n_rounds = harpocrates_common::N_ROUNDS;
+
+  uint16_t state[harpocrates_common::N_ROWS * lanes];
+
+  load_state<lanes>(enc, state);
+
+  constexpr const uint8_t* inv_lut = inv_lut_v<lut>.data();
+
+  [&]<size_t... r>(std::index_sequence<r...>) {
+    (decrypt_round<lanes, colsub, n_rounds - (r + 1)>(state, inv_lut), ...);
+  }(std::make_index_sequence<n_rounds>{});
+
+  store_state<lanes>(state, dec);
+}
+
+// Encrypts 16 -bytes message block, under look up table known at compile time;
+// computes same output as `harpocrates::encrypt`, using that table
+template<const lut_t lut,
+         const harpocrates_utils::column_substitution_t colsub =
+           harpocrates_utils::transposed_column_substitution>
+static inline void
+encrypt(const uint8_t* const __restrict txt, // input plain text
+        uint8_t* const __restrict enc        // output encrypted bytes
+)
+{
+  encrypt_lanes<lut, 1, colsub>(txt, enc);
+}
+
+// Decrypts 16 -bytes encrypted message block, under look up table known at
+// compile time; computes same output as `harpocrates::decrypt`, using inverse
+// of that table
+template<const lut_t lut,
+         const harpocrates_utils::column_substitution_t colsub =
+           harpocrates_utils::transposed_column_substitution>
+static inline void
+decrypt(const uint8_t* const __restrict enc, // input encrypted bytes
+        uint8_t* const __restrict dec        // output decrypted bytes
+)
+{
+  decrypt_lanes<lut, 1, colsub>(enc, dec);
+}
+
+// Encrypts N -many consecutive 16 -bytes message blocks, under look up table
+// known at compile time, N_LANES blocks at a time, while trailing blocks are
+// encrypted one by one; computes same output as `harpocrates::encrypt_blocks`
+template<const lut_t lut,
+         const harpocrates_utils::column_substitution_t colsub =
+           harpocrates_utils::transposed_column_substitution>
+static inline void
+encrypt_blocks(const uint8_t* const txt, // input plain text
+               uint8_t* const enc,       // output encrypted bytes
+               const size_t n_blocks     // # -of message blocks
+)
+{
+  constexpr size_t lanes = harpocrates_common::N_LANES;
+  constexpr size_t chunk_len = lanes * harpocrates_common::BLOCK_LEN;
+
+  const size_t n_chunks = n_blocks / lanes;
+
+  for (size_t i = 0; i < n_chunks; i++) {
+    const size_t off = i * chunk_len;
+    encrypt_lanes<lut, lanes, colsub>(txt + off, enc + off);
+  }
+
+  for (size_t i = n_chunks * lanes; i < n_blocks; i++) {
+    const size_t off = i * harpocrates_common::BLOCK_LEN;
+    encrypt_lanes<lut, 1, colsub>(txt + off, enc + off);
+  }
+}
+
+// Decrypts N -many consecutive 16 -bytes encrypted message blocks, under look
+// up table known at compile time, N_LANES blocks at a time, while trailing
+// blocks are decrypted one by one; computes same output as
+// `harpocrates::decrypt_blocks`, using inverse of that table
+template<const lut_t lut,
+         const harpocrates_utils::column_substitution_t colsub =
+           harpocrates_utils::transposed_column_substitution>
+static inline void
+decrypt_blocks(const uint8_t* const enc, // input encrypted bytes
+               uint8_t* const dec,       // output decrypted bytes
+               const size_t n_blocks     // # -of message blocks
+)
+{
+  constexpr size_t lanes = harpocrates_common::N_LANES;
+  constexpr size_t chunk_len = lanes * harpocrates_common::BLOCK_LEN;
+
+  const size_t n_chunks = n_blocks / lanes;
+
+  for (size_t i = 0; i < n_chunks; i++) {
+    const size_t off = i * chunk_len;
+    decrypt_lanes<lut, lanes, colsub>(enc + off, dec + off);
+  }
+
+  for (size_t i = n_chunks * lanes; i < n_blocks; i++) {
+    const size_t off = i * harpocrates_common::BLOCK_LEN;
+    decrypt_lanes<lut, 1, colsub>(enc + off, dec + off);
+  }
+}
+
+}
@@ -0,0 +1,331 @@
+#pragma once
+#include "harpocrates_ctr.hpp"
+#include "harpocrates_dispatch.hpp"
+#include <algorithm>
+#include <span>
+#include <sys/uio.h>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, encrypting
+// ( or decrypting ) message, which is scattered over a chain of non-contiguous
+// segments ( described by `iovec`s, same as `readv`/ `writev` do ), whose
+// lengths need not be multiples of 16 -bytes, into ( possibly differently )
+// segmented output, without copying whole message into a flat buffer
+//
+// Long runs of message blocks lying within an input & an output segment are
+// processed in place, using bulk encryption kernel selected at run time ( see
+// `harpocrates_dispatch` ). Only blocks straddling some segment boundary &
+// short runs, which would leave vector lanes of that kernel idle, are gathered
+// into a small staging batch, which is processed once it's full & scattered
+// back over output segments. In counter mode, keystream is generated
+// in batches & XORed into segments, as they come.
+namespace harpocrates_iov {
+
+// # -of message blocks ( i.e. 4 KB ), which are staged together, before being
+// processed by single call to bulk encryption routine
+constexpr size_t STAGE_BLOCKS = 256ul;
+
+// Consecutive message blocks lying within an input & an output segment are
+// processed in place, when there are at least this many of them, otherwise
+// they're staged
+constexpr size_t RUN_BLOCKS = harpocrates_dispatch::MAX_LANES;
+
+// Position in a chain of segments, which only moves forward
+struct cursor_t
+{
+  const iovec* seg = nullptr;
+  const iovec* end = nullptr;
+  size_t off = 0;
+
+  cursor_t() = default;
+
+  explicit cursor_t(const std::span<const iovec> segs)
+    : seg(segs.data())
+    , end(segs.data() + segs.size())
+    , off(0)
+  {
+    skip_empty();
+  }
+
+  // Moves past exhausted ( or empty ) segments
+  void skip_empty()
+  {
+    while (seg != end && off == seg->iov_len) {
+      seg++;
+      off = 0;
+    }
+  }
+
+  // # -of bytes left in current segment
+  size_t avail() const { return seg == end ? 0 : seg->iov_len - off; }
+
+  // Pointer to current byte
+  uint8_t* ptr() const { return static_cast<uint8_t*>(seg->iov_base) + off; }
+
+  // Moves forward by N bytes, which must not cross end of current segment
+  void advance(const size_t n)
+  {
+    off += n;
+    skip_empty();
+  }
+
+  // Moves forward by N bytes, which may be spread over many segments
+  void skip(const size_t n)
+  {
+    size_t done = 0;
+    while (done < n) {
+      const size_t take = std::min(avail(), n - done);
+
+      advance(take);
+      done += take;
+    }
+  }
+
+  // Copies next N bytes ( possibly spread over many segments ) out of chain &
+  // moves past them
+  void read(uint8_t* const dst, const size_t n)
+  {
+    size_t done = 0;
+    while (done < n) {
+      const size_t take = std::min(avail(), n - done);
+
+      std::memcpy(dst + done, ptr(), take);
+      advance(take);
+      done += take;
+    }
+  }
+
+  // Copies N bytes into next N bytes ( possibly spread over many segments ) of
+  // chain & moves past them
+  void write(const uint8_t* const src, const size_t n)
+  {
+    size_t done = 0;
+    while (done < n) {
+      const size_t take = std::min(avail(), n - done);
+
+      std::memcpy(ptr(), src + done, take);
+      advance(take);
+      done += take;
+    }
+  }
+};
+
+// Total # -of bytes in a chain of segments
+static inline size_t
+total_len(const std::span<const iovec> segs)
+{
+  size_t len = 0;
+  for (const iovec& s : segs) {
+    len += s.iov_len;
+  }
+
+  return len;
+}
+
+// Given look up table, this routine encrypts ( when `decrypt` is false ) or
+// decrypts message held in input segments, writing output into output
+// segments, computing same bytes as `harpocrates::encrypt_blocks` ( or
+// `decrypt_blocks` ) would, on flat copy of message
+//
+// Only first N x 16 bytes are processed, where N x 16 is largest multiple of
+// 16, not exceeding total length of either chain. Input & output segments may
+// name same memory ( i.e. in-place encryption ), but they must not partially
+// overlap. When decrypting, `lut` must be inverse look up table.
+template<const bool decrypt>
+static inline void
+crypt_iov(const uint8_t* const __restrict lut, // look up table
+          const std::span<const iovec> in,     // input segments
+          const std::span<const iovec> out     // output segments
+)
+{
+  constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+  auto bulk = [lut](const uint8_t* const src,
+                    uint8_t* const dst,
+                    const size_t n_blocks) {
+    if constexpr (decrypt) {
+      harpocrates_dispatch::decrypt_blocks(lut, src, dst, n_blocks);
+    } else {
+      harpocrates_dispatch::encrypt_blocks(lut, src, dst, n_blocks);
+    }
+  };
+
+  cursor_t src(in);
+  cursor_t dst(out);
+
+  // staged blocks, along with positions & lengths of their outputs
+  uint8_t buf[STAGE_BLOCKS * blk_len];
+  cursor_t outs[STAGE_BLOCKS];
+  size_t out_lens[STAGE_BLOCKS];
+
+  size_t n_outs = 0;
+  size_t n_staged = 0;
+  bool merge = false;
+
+  auto flush = [&]() {
+    bulk(buf, buf, n_staged);
+
+    const uint8_t* ptr = buf;
+    for (size_t i = 0; i < n_outs; i++) {
+      outs[i].write(ptr, out_lens[i]);
+      ptr += out_lens[i];
+    }
+
+    n_outs = 0;
+    n_staged = 0;
+    merge = false;
+  };
+
+  size_t left = std::min(total_len(in), total_len(out)) / blk_len;
+
+  while (left > 0) {
+    const size_t fit = std::min(src.avail(), dst.avail()) / blk_len;
+    const size_t n = std::min(fit, left);
+
+    if (n >= RUN_BLOCKS) {
+      bulk(src.ptr(), dst.ptr(), n);
+
+      src.advance(n * blk_len);
+      dst.advance(n * blk_len);
+      left -= n;
+      merge = false;
+
+      continue;
+    }
+
+    // short run of blocks, or blocks straddling boundaries of short segments,
+    // which are staged until input reaches a segment long enough to hold a run
+    // of blocks, which could be processed in place
+    const size_t room = std::min(STAGE_BLOCKS - n_staged, left) * blk_len;
+    uint8_t* const stage = buf + n_staged * blk_len;
+
+    size_t len = 0;
+
+    if (n > 0) {
+      len = std::min(n * blk_len, room);
+      src.read(stage, len);
+    } else {
+      while (len < room) {
+        const size_t pad = blk_len - len % blk_len;
+        size_t take = std::min(src.avail(), room - len);
+
+        if (src.avail() >= RUN_BLOCKS * blk_len) {
+          if (len >= blk_len && pad == blk_len) {
+            break;
+          }
+          take = std::min(take, pad);
+        }
+
+        std::memcpy(stage + len, src.ptr(), take);
+        src.advance(take);
+        len += take;
+      }
+    }
+
+    // output follows that of previously staged blocks, unless some run of
+    // blocks was processed in place, in between
+    if (merge) {
+      out_lens[n_outs - 1] += len;
+    } else {
+      outs[n_outs] = dst;
+      out_lens[n_outs] = len;
+      n_outs++;
+    }
+
+    dst.skip(len);
+    merge = true;
+
+    n_staged += len / blk_len;
+    left -= len / blk_len;
+
+    if (n_staged == STAGE_BLOCKS) {
+      flush();
+    }
+  }
+
+  if (n_staged > 0) {
+    flush();
+  }
+}
+
+// Encrypts message held in input segments, writing encrypted bytes into output
+// segments; see `crypt_iov`
+static inline void
+encrypt_iov(const uint8_t* const __restrict lut, // look up table
+            const std::span<const iovec> txt,    // plain text segments
+            const std::span<const iovec> enc     // encrypted segments
+)
+{
+  crypt_iov<false>(lut, txt, enc);
+}
+
+// Decrypts message held in input segments, writing decrypted bytes into output
+// segments; see `crypt_iov`
+static inline void
+decrypt_iov(const uint8_t* const __restrict inv_lut, // inverse look up table
+            const std::span<const iovec> enc,        // encrypted segments
+            const std::span<const iovec> dec         // decrypted segments
+)
+{
+  crypt_iov<true>(inv_lut, enc, dec);
+}
+
+// Given look up table, nonce & byte offset into message, this routine encrypts
+// ( or decrypts ) message of arbitrary length held in input segments, in
+// counter mode, writing output into output segments, computing same bytes as
+// `harpocrates_ctr::crypt` would, on flat copy of message
+//
+// Processes as many bytes as total length of shorter chain.
+static inline void
+crypt_iov(const uint8_t* const __restrict lut,   // look up table
+          const uint8_t* const __restrict nonce, // 8 -bytes nonce
+          const uint64_t offset,                 // byte offset in message
+          const std::span<const iovec> in,       // input segments
+          const std::span<const iovec> out       // output segments
+)
+{
+  using namespace harpocrates_ctr;
+
+  constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+  uint8_t ks[BATCH_BLOCKS * blk_len];
+
+  cursor_t src(in);
+  cursor_t dst(out);
+
+  const size_t len = std::min(total_len(in), total_len(out));
+
+  uint64_t ctr = offset / blk_len;
+  size_t skip = static_cast<size_t>(offset % blk_len);
+  size_t done = 0;
+
+  while (done < len) {
+    const size_t need = (skip + (len - done) + blk_len - 1) / blk_len;
+    const size_t n_blocks = std::min(need, BATCH_BLOCKS);
+
+    counter_blocks(nonce, ctr, ks, n_blocks);
+    harpocrates_dispatch::encrypt_blocks(lut, ks, ks, n_blocks);
+
+    const size_t take = std::min(n_blocks * blk_len - skip, len - done);
+
+    for (size_t i = 0; i < take;) {
+      const size_t n = std::min(std::min(src.avail(), dst.avail()), take - i);
+
+      const uint8_t* const s = src.ptr();
+      uint8_t* const d = dst.ptr();
+
+      for (size_t j = 0; j < n; j++) {
+        d[j] = s[j] ^ ks[skip + i + j];
+      }
+
+      src.advance(n);
+      dst.advance(n);
+      i += n;
+    }
+
+    done += take;
+    ctr += n_blocks;
+    skip = 0;
+  }
+}
+
+}
@@ -0,0 +1,254 @@
+#pragma once
+#include "harpocrates_common.hpp"
+#include "harpocrates_utils.hpp"
+#include <cstring>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, with look
+// up table derived deterministically from compact secret key
+//
+// `harpocrates_utils::generate_lut` shuffles identity permutation using a
+// freshly seeded ( non-cryptographic ) random number generator, so resulting
+// look up table can't be reproduced & it must be persisted as is. Instead,
+// here 128 -bit or 256 -bit key ( along with 64 -bit identifier, such as
+// tenant id or key version, so that many look up tables can be derived from
+// same key ) is expanded into ChaCha20 keystream ( see RFC 8439 ), which drives
+// Fisher-Yates shuffle. Indices are chosen from 16 -bit keystream words, using
+// multiply & shift, where rarely ( < 0.4% ) a word is rejected, so that each
+// of 256! permutations is equally likely ( see https://arxiv.org/abs/1805.10941
+// ).
+namespace harpocrates_kdf {
+
+// Byte length of ChaCha20 block
+constexpr size_t CHACHA_BLOCK_LEN = 64ul;
+
+// # -of ChaCha20 blocks computed together, for deriving look up table; shuffle
+// consumes 510 keystream bytes, unless some words are rejected, in which case
+// more blocks are computed
+constexpr size_t DERIVE_BLOCKS = 8ul;
+
+// 8 lanes of 32 -bit words, one for each of DERIVE_BLOCKS ChaCha20 blocks,
+// computed together
+using u32x8 = uint32_t __attribute__((vector_size(32)));
+
+// ChaCha20 quarter round, applied on four words of state, where word is either
+// 32 -bit or 8 lanes of 32 -bit, one for each of 8 blocks
+template<typename T>
+static inline void
+quarter_round(T* const s,
+              const size_t a,
+              const size_t b,
+              const size_t c,
+              const size_t d)
+{
+  s[a] += s[b];
+  s[d] ^= s[a];
+  s[d] = (s[d] << 16) | (s[d] >> 16);
+  s[c] += s[d];
+  s[b] ^= s[c];
+  s[b] = (s[b] << 12) | (s[b] >> 20);
+  s[a] += s[b];
+  s[d] ^= s[a];
+  s[d] = (s[d] << 8) | (s[d] >> 24);
+  s[c] += s[d];
+  s[b] ^= s[c];
+  s[b] = (s[b] << 7) | (s[b] >> 25);
+}
+
+// Reads 32 -bit little-endian word
+static inline uint32_t
+load_le32(const uint8_t* const b)
+{
+  return static_cast<uint32_t>(b[0]) | (static_cast<uint32_t>(b[1]) << 8) |
+         (static_cast<uint32_t>(b[2]) << 16) |
+         (static_cast<uint32_t>(b[3]) << 24);
+}
+
+// Writes 32 -bit little-endian word
+static inline void
+store_le32(const uint32_t w, uint8_t* const b)
+{
+  b[0] = static_cast<uint8_t>(w);
+  b[1] = static_cast<uint8_t>(w >> 8);
+  b[2] = static_cast<uint8_t>(w >> 16);
+  b[3] = static_cast<uint8_t>(w >> 24);
+}
+
+// Prepares initial ChaCha20 state, for given 16 -bytes or 32 -bytes key, 32
+// -bit block counter & 12 -bytes nonce, following RFC 8439; 16 -bytes key
+// uses constant "expand 16-byte k" & is repeated, as in original ChaCha
+template<const size_t key_len>
+static inline void
+init_state(const uint8_t* const __restrict key,
+           const uint32_t counter,
+           const uint8_t* const __restrict nonce,
+           uint32_t* const __restrict init)
+{
+  static_assert(key_len == 16 || key_len == 32, "Key must be 128/ 256 -bit");
+
+  if constexpr (key_len == 32) {
+    init[0] = 0x61707865u; // "expand 32-byte k"
+    init[1] = 0x3320646eu;
+    init[2] = 0x79622d32u;
+    init[3] = 0x6b206574u;
+  } else {
+    init[0] = 0x61707865u; // "expand 16-byte k"
+    init[1] = 0x3120646eu;
+    init[2] = 0x79622d36u;
+    init[3] = 0x6b206574u;
+  }
+
+  for (size_t i = 0; i < 8; i++) {
+    init[4 + i] = load_le32(key + ((i << 2) % key_len));
+  }
+
+  init[12] = counter;
+  init[13] = load_le32(nonce);
+  init[14] = load_le32(nonce + 4);
+  init[15] = load_le32(nonce + 8);
+}
+
+// 20 rounds ( i.e. 10 column rounds, each followed by diagonal round ) of
+// ChaCha20, applied on state
+template<typename T>
+static inline void
+double_rounds(T* const s)
+{
+  for (size_t i = 0; i < 10; i++) {
+    quarter_round(s, 0, 4, 8, 12);
+    quarter_round(s, 1, 5, 9, 13);
+    quarter_round(s, 2, 6, 10, 14);
+    quarter_round(s, 3, 7, 11, 15);
+    quarter_round(s, 0, 5, 10, 15);
+    quarter_round(s, 1, 6, 11, 12);
+    quarter_round(s, 2, 7, 8, 13);
+    quarter_round(s, 3, 4, 9, 14);
+  }
+}
+
+// Computes 64 -bytes ChaCha20 block, for given 16 -bytes or 32 -bytes key,
+// 32 -bit block counter & 12 -bytes nonce ( see `init_state` )
+template<const size_t key_len>
+static inline void
+chacha20_block(const uint8_t* const __restrict key,
+               const uint32_t counter,
+               const uint8_t* const __restrict nonce,
+               uint8_t* const __restrict out)
+{
+  uint32_t init[16];
+  init_state<key_len>(key, counter, nonce, init);
+
+  uint32_t s[16];
+  std::memcpy(s, init, sizeof(s));
+
+  double_rounds(s);
+
+  for (size_t i = 0; i < 16; i++) {
+    store_le32(s[i] + init[i], out + (i << 2));
+  }
+}
+
+// Computes DERIVE_BLOCKS consecutive ChaCha20 blocks, starting from given 32
+// -bit block counter, same as calling `chacha20_block` for each of them, but
+// all blocks are computed together, keeping i-th word of each block in a lane
+// of i-th vector
+template<const size_t key_len>
+static inline void
+chacha20_blocks(const uint8_t* const __restrict key,
+                const uint32_t counter,
+                const uint8_t* const __restrict nonce,
+                uint8_t* const __restrict out)
+{
+  uint32_t init[16];
+  init_state<key_len>(key, counter, nonce, init);
+
+  u32x8 v_init[16];
+  for (size_t i = 0; i < 16; i++) {
+    v_init[i] = u32x8{} + init[i];
+  }
+  v_init[12] += u32x8{ 0, 1, 2, 3, 4, 5, 6, 7 };
+
+  u32x8 s[16];
+  std::memcpy(s, v_init, sizeof(s));
+
+  double_rounds(s);
+
+  for (size_t i = 0; i < 16; i++) {
+    const u32x8 w = s[i] + v_init[i];
+
+    for (size_t b = 0; b < DERIVE_BLOCKS; b++) {
+      store_le32(w[b], out + b * CHACHA_BLOCK_LEN + (i << 2));
+    }
+  }
+}
+
+// Given 16 -bytes or 32 -bytes secret key & 64 -bit identifier, this routine
+// derives look up table ( read `lut` ), which is always same for same key &
+// identifier, while look up tables derived for different identifiers ( or
+// keys ) are independent of each other
+//
+// ChaCha20 nonce is identifier ( 8 -bytes, little-endian ) followed by 4 zero
+// bytes, while block counter starts at 0. Fisher-Yates shuffle runs from last
+// element of identity permutation to first, swapping i-th element with j-th
+// one, where j = (r * (i + 1)) >> 16, for next 16 -bit little-endian keystream
+// word r, which is rejected if (r * (i + 1)) mod 2^16 < 2^16 mod (i + 1).
+//
+// Inverse look up table can be computed using
+// `harpocrates_utils::generate_inv_lut`, as usual.
+template<const size_t key_len>
+static inline void
+derive_lut(const uint8_t* const __restrict key,
+           const uint64_t id,
+           uint8_t* const __restrict lut)
+{
+  constexpr size_t ks_len = DERIVE_BLOCKS * CHACHA_BLOCK_LEN;
+
+  uint8_t nonce[12] = {};
+  for (size_t i = 0; i < 8; i++) {
+    nonce[i] = static_cast<uint8_t>(id >> (i << 3));
+  }
+
+  uint8_t ks[ks_len];
+  chacha20_blocks<key_len>(key, 0, nonce, ks);
+
+  for (size_t i = 0; i < 256; i++) {
+    lut[i] = static_cast<uint8_t>(i);
+  }
+
+  uint32_t ctr = DERIVE_BLOCKS;
+  size_t pos = 0;
+
+  for (uint32_t i = 255; i > 0; i--) {
+    const uint32_t n = i + 1;
+
+    uint32_t m = 0;
+    while (true) {
+      // rarely, keystream runs out; compute next DERIVE_BLOCKS blocks
+      if (pos == ks_len) {
+        chacha20_blocks<key_len>(key, ctr, nonce, ks);
+
+        ctr += DERIVE_BLOCKS;
+        pos = 0;
+      }
+
+      const uint32_t r = static_cast<uint32_t>(ks[pos]) |
+                         (static_cast<uint32_t>(ks[pos + 1]) << 8);
+      pos += 2;
+
+      m = r * n;
+      if ((m & 0xffffu) >= n || (m & 0xffffu) >= (0x10000u % n)) {
+        break;
+      }
+    }
+
+    const uint32_t j = m >> 16;
+
+    const uint8_t t = lut[i];
+    lut[i] = lut[j];
+    lut[j] = t;
+  }
+
+  // keystream fully determines look up table
+  harpocrates_utils::secure_zero(ks, sizeof(ks));
+}
+
+}
@@ -0,0 +1,414 @@
+#pragma once
+#include "harpocrates_context.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, with
+// per-key tables of many keys precomputed into a keystore file, which is
+// memory mapped ( read-only ), so that contexts are available right away, at
+// startup, without computing or parsing anything
+//
+// Keystore is laid out as
+//
+// - 64 -bytes header ( see `header_t` )
+// - index, holding one 32 -bytes entry per key, sorted by key identifier ( see
+//   `index_t` )
+// - per-key tables ( see `harpocrates_context::tables_t` ), one after another,
+//   each one cache line aligned
+// - ( optional ) expanded tables of each key, 512 KB each, page aligned,
+//   holding expanded look up table, followed by expanded inverse look up table
+//
+// All integers are in byte order of host, which is recorded in header, so that
+// keystore built on a host of other byte order is rejected. As mapping is
+// shared & read-only, pages of keystore are shared by all processes which open
+// it, through page cache.
+namespace harpocrates_keystore {
+
+// Magic bytes, at start of keystore
+constexpr char MAGIC[8] = { 'H', 'R', 'P', 'C', 'K', 'E', 'Y', 'S' };
+
+// Version of keystore format
+constexpr uint32_t VERSION = 1u;
+
+// Written as is, for detecting keystore built on host of other byte order
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+
+// Alignment of expanded tables, in keystore
+constexpr size_t PAGE_LEN = 4096ul;
+
+// Byte length of expanded tables of each key
+constexpr size_t EXP_LEN = harpocrates_expanded::TABLE_LEN << 2;
+
+// Header of keystore
+struct header_t
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order;
+  uint64_t n_keys;
+  uint64_t index_off;
+  uint64_t tables_len; // sizeof(tables_t)
+  uint64_t exp_len;    // EXP_LEN
+  uint64_t file_len;
+  uint64_t reserved;
+};
+
+// Index entry of a key, where `exp_off` is zero, when expanded tables of key
+// aren't stored
+struct index_t
+{
+  uint64_t id;
+  uint64_t tables_off;
+  uint64_t exp_off;
+  uint64_t reserved;
+};
+
+static_assert(sizeof(header_t) == 64, "Header must be of 64 -bytes");
+static_assert(sizeof(index_t) == 32, "Index entry must be of 32 -bytes");
+
+// Key to be stored in keystore, identified by `id`, along with its 256 -bytes
+// look up table
+struct key_entry_t
+{
+  uint64_t id;
+  const uint8_t* lut;
+};
+
+// Rounds up to next multiple of `align`, which must be a power of 2
+static inline uint64_t
+align_up(const uint64_t n, const uint64_t align)
+{
+  return (n + align - 1) & ~(align - 1);
+}
+
+// Writes all bytes at given offset of file
+static inline bool
+write_at(const int fd, const void* const buf, const size_t len, uint64_t off)
+{
+  const uint8_t* ptr = static_cast<const uint8_t*>(buf);
+  size_t left = len;
+
+  while (left > 0) {
+    const ssize_t n = ::pwrite(fd, ptr, left, static_cast<off_t>(off));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+
+    ptr += n;
+    off += static_cast<uint64_t>(n);
+    left -= static_cast<size_t>(n);
+  }
+
+  return true;
+}
+
+// Builds keystore holding tables ( and expanded tables, when `expanded` is set
+// ) of given N keys, whose identifiers must be unique
+//
+// Keystore is written to a uniquely named temporary file, readable & writable
+// only by its owner, which is renamed to `path` once it's complete, so that
+// processes opening `path` never see a partially written keystore, while those
+// which already mapped an older one keep using it. Returns false on failure,
+// leaving cause in `errno`.
+static inline bool
+build(const char* const path,          // keystore file
+      const key_entry_t* const keys, // keys to be stored
+      const size_t n_keys,           // # -of keys
+      const bool expanded            // whether to store expanded tables
+)
+{
+  using harpocrates_context::tables_t;
+
+  std::vector<key_entry_t> sorted(keys, keys + n_keys);
+  std::sort(sorted.begin(),
+            sorted.end(),
+            [](const key_entry_t& a, const key_entry_t& b) {
+              return a.id < b.id;
+            });
+
+  for (size_t i = 1; i < n_keys; i++) {
+    if (sorted[i - 1].id == sorted[i].id) {
+      errno = EINVAL;
+      return false;
+    }
+  }
+
+  header_t hdr;
+  std::memset(&hdr, 0, sizeof(hdr));
+  std::memcpy(hdr.magic, MAGIC, sizeof(MAGIC));
+
+  hdr.version = VERSION;
+  hdr.byte_order = BYTE_ORDER_MARK;
+  hdr.n_keys = n_keys;
+  hdr.index_off = sizeof(header_t);
+  hdr.tables_len = sizeof(tables_t);
+  hdr.exp_len = EXP_LEN;
+
+  const uint64_t tables_off = align_up(
+    hdr.index_off + n_keys * sizeof(index_t), harpocrates_parallel::CACHE_LINE);
+  const uint64_t exp_off =
+    align_up(tables_off + n_keys * sizeof(tables_t), PAGE_LEN);
+
+  hdr.file_len = expanded ? exp_off + n_keys * EXP_LEN
+                          : tables_off + n_keys * sizeof(tables_t);
+
+  // uniquely named temporary file, readable only by its owner, as keystore
+  // holds secret look up tables; it's created exclusively, so that concurrent
+  // builders never write to same file
+  std::string tmp_path = std::string(path) + ".XXXXXX";
+
+  const int fd = ::mkstemp(tmp_path.data());
+  if (fd < 0) {
+    return false;
+  }
+
+  std::vector<index_t> index(n_keys);
+  std::vector<tables_t> tables(n_keys);
+  std::vector<uint16_t> exp(expanded ? (EXP_LEN >> 1) : 0);
+
+  bool ok = ::ftruncate(fd, static_cast<off_t>(hdr.file_len)) == 0;
+
+  for (size_t i = 0; ok && i < n_keys; i++) {
+    index[i].id = sorted[i].id;
+    index[i].tables_off = tables_off + i * sizeof(tables_t);
+    index[i].exp_off = expanded ? exp_off + i * EXP_LEN : 0;
+    index[i].reserved = 0;
+
+    harpocrates_context::derive_tables(sorted[i].lut, &tables[i]);
+
+    if (expanded) {
+      using harpocrates_expanded::TABLE_LEN;
+
+      harpocrates_expanded::expand_lut(tables[i].lut, exp.data());
+      harpocrates_expanded::expand_lut(tables[i].inv_lut,
+                                       exp.data() + TABLE_LEN);
+
+      ok = write_at(fd, exp.data(), EXP_LEN, index[i].exp_off);
+    }
+  }
+
+  ok = ok && write_at(fd, &hdr, sizeof(hdr), 0);
+  const size_t index_len = n_keys * sizeof(index_t);
+  const size_t all_tables_len = n_keys * sizeof(tables_t);
+
+  ok = ok && write_at(fd, index.data(), index_len, hdr.index_off);
+  ok = ok && write_at(fd, tables.data(), all_tables_len, tables_off);
+  ok = ok && ::fsync(fd) == 0;
+  ok = (::close(fd) == 0) && ok;
+  ok = ok && std::rename(tmp_path.c_str(), path) == 0;
+
+  // erase secret tables, which were staged in memory
+  harpocrates_utils::secure_zero(tables.data(), all_tables_len);
+  harpocrates_utils::secure_zero(exp.data(), exp.size() * sizeof(uint16_t));
+
+  if (!ok) {
+    const int err = errno;
+    ::unlink(tmp_path.c_str());
+    errno = err;
+  }
+
+  return ok;
+}
+
+// Keystore mapped read-only into memory, which is unmapped when it goes out of
+// scope; contexts found in it are views into mapping, so they must not outlive
+// it
+class keystore
+{
+public:
+  keystore() = default;
+  keystore(const keystore&) = delete;
+  keystore& operator=(const keystore&) = delete;
+
+  ~keystore() { close(); }
+
+  // Maps keystore & validates its header; returns false, leaving cause in
+  // `errno` ( EINVAL, when it's not a valid keystore )
+  bool open(const char* const path)
+  {
+    close();
+
+    const int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      const int err = errno;
+      ::close(fd);
+      errno = err;
+
+      return false;
+    }
+
+    len = static_cast<size_t>(st.st_size);
+    if (len < sizeof(header_t)) {
+      ::close(fd);
+      len = 0;
+      errno = EINVAL;
+
+      return false;
+    }
+
+    void* const addr = ::mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+    const int err = errno;
+    ::close(fd);
+
+    if (addr == MAP_FAILED) {
+      len = 0;
+      errno = err;
+
+      return false;
+    }
+
+    base = static_cast<const uint8_t*>(addr);
+    if (!valid()) {
+      close();
+      errno = EINVAL;
+
+      return false;
+    }
+
+    // contexts are looked up in arbitrary order
+    ::madvise(const_cast<uint8_t*>(base), len, MADV_RANDOM);
+
+    return true;
+  }
+
+  // Unmaps keystore, if it's open
+  void close()
+  {
+    if (base != nullptr) {
+      ::munmap(const_cast<uint8_t*>(base), len);
+    }
+
+    base = nullptr;
+    len = 0;
+  }
+
+  // # -of keys in keystore
+  size_t size() const
+  {
+    return base == nullptr ? 0 : static_cast<size_t>(header()->n_keys);
+  }
+
+  // Identifier of i-th key, in ascending order; zero, when keystore isn't open
+  uint64_t id(const size_t i) const
+  {
+    return base == nullptr ? 0 : index()[i].id;
+  }
+
+  // Context of i-th key, in ascending order of identifiers; returned view is
+  // empty, when keystore isn't open
+  harpocrates_context::context_view at(const size_t i) const
+  {
+    using harpocrates_context::context_view;
+    using harpocrates_context::tables_t;
+
+    if (base == nullptr) {
+      return context_view();
+    }
+
+    const index_t& e = index()[i];
+
+    const tables_t* const tbl =
+      reinterpret_cast<const tables_t*>(base + e.tables_off);
+    const uint16_t* const exp =
+      e.exp_off == 0 ? nullptr
+                     : reinterpret_cast<const uint16_t*>(base + e.exp_off);
+
+    return context_view(tbl, exp);
+  }
+
+  // Looks up context of key, using binary search over index; returned view is
+  // empty, when there's no such key ( or keystore isn't open )
+  harpocrates_context::context_view find(const uint64_t id) const
+  {
+    if (base == nullptr) {
+      return harpocrates_context::context_view();
+    }
+
+    const index_t* const beg = index();
+    const index_t* const end = beg + size();
+
+    const index_t* const it =
+      std::lower_bound(beg, end, id, [](const index_t& e, const uint64_t v) {
+        return e.id < v;
+      });
+
+    if (it == end || it->id != id) {
+      return harpocrates_context::context_view();
+    }
+
+    return at(static_cast<size_t>(it - beg));
+  }
+
+private:
+  const header_t* header() const
+  {
+    return reinterpret_cast<const header_t*>(base);
+  }
+
+  const index_t* index() const
+  {
+    return reinterpret_cast<const index_t*>(base + header()->index_off);
+  }
+
+  // Checks header & offsets of all index entries, so that lookups never
+  // access memory outside mapping
+  bool valid() const
+  {
+    using harpocrates_context::tables_t;
+
+    const header_t* const hdr = header();
+
+    if (std::memcmp(hdr->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        hdr->version != VERSION || hdr->byte_order != BYTE_ORDER_MARK ||
+        hdr->tables_len != sizeof(tables_t) || hdr->exp_len != EXP_LEN ||
+        hdr->file_len != len || hdr->index_off % alignof(index_t) != 0) {
+      return false;
+    }
+
+    if (hdr->index_off > len ||
+        hdr->n_keys > (len - hdr->index_off) / sizeof(index_t)) {
+      return false;
+    }
+
+    const index_t* const idx = index();
+
+    for (size_t i = 0; i < hdr->n_keys; i++) {
+      const index_t& e = idx[i];
+
+      if (i > 0 && idx[i - 1].id >= e.id) {
+        return false;
+      }
+      if (e.tables_off % alignof(tables_t) != 0 || e.tables_off > len ||
+          len - e.tables_off < sizeof(tables_t)) {
+        return false;
+      }
+      if (e.exp_off != 0 && (e.exp_off % PAGE_LEN != 0 || e.exp_off > len ||
+                             len - e.exp_off < EXP_LEN)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  const uint8_t* base = nullptr;
+  size_t len = 0;
+};
+
+}
@@ -0,0 +1,233 @@
+#pragma once
+#include "harpocrates_ctr.hpp"
+#include "harpocrates_dispatch.hpp"
+#include <algorithm>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, encrypting
+// ( or decrypting ) many independent messages of different lengths, under same
+// look up table, in a single call, in the style of multi-buffer hashing
+//
+// Caller submits a list of jobs, each naming input, output & length of one
+// message. Message blocks ( or counter blocks, in counter mode ) are pulled
+// from whichever job still has some left, into a shared batch, which is
+// processed using bulk encryption kernel selected at run time ( see
+// `harpocrates_dispatch` ), once it's full. So short messages share vector
+// lanes ( or interleave slots ) of that kernel, instead of each one of them
+// leaving most lanes idle.
+namespace harpocrates_multibuffer {
+
+// # -of message blocks ( i.e. 4 KB ), which are pulled from jobs into a batch,
+// before it's processed by single call to bulk encryption routine
+constexpr size_t BATCH_BLOCKS = 256ul;
+
+// Consecutive message blocks of a job are processed in place, without staging
+// them in a batch, in multiples of this many blocks
+constexpr size_t RUN_BLOCKS = harpocrates_dispatch::MAX_LANES;
+
+// Message to be encrypted ( or decrypted ), whose length must be a multiple of
+// 16 -bytes; `in` and `out` may point to same memory
+struct job_t
+{
+  const uint8_t* in;
+  uint8_t* out;
+  size_t len;
+};
+
+// Message of arbitrary length to be encrypted ( or decrypted ) in counter mode,
+// starting at given byte offset ( see `harpocrates_ctr::crypt` ); `in` and
+// `out` may point to same memory
+struct ctr_job_t
+{
+  const uint8_t* nonce;
+  uint64_t offset;
+  const uint8_t* in;
+  uint8_t* out;
+  size_t len;
+};
+
+// Given look up table & N jobs, this routine encrypts ( when `decrypt` is false
+// ) or decrypts message of each job, computing same output as calling
+// `harpocrates::encrypt_blocks` ( or `decrypt_blocks` ) for each of them
+//
+// Leading multiple of RUN_BLOCKS blocks of each message are processed in place,
+// while remaining ones are copied into shared batch, processed once it's full &
+// copied back to outputs of their jobs. When decrypting, `lut` must be inverse
+// look up table.
+template<const bool decrypt>
+static inline void
+crypt_jobs(const uint8_t* const __restrict lut, // look up table
+           const job_t* const jobs,             // jobs
+           const size_t n_jobs                  // # -of jobs
+)
+{
+  constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+  auto bulk = [lut](const uint8_t* const src,
+                    uint8_t* const dst,
+                    const size_t n_blocks) {
+    if constexpr (decrypt) {
+      harpocrates_dispatch::decrypt_blocks(lut, src, dst, n_blocks);
+    } else {
+      harpocrates_dispatch::encrypt_blocks(lut, src, dst, n_blocks);
+    }
+  };
+
+  uint8_t buf[BATCH_BLOCKS * blk_len];
+
+  // output & length of each staged segment, which are staged one after another
+  uint8_t* seg_out[BATCH_BLOCKS];
+  size_t seg_len[BATCH_BLOCKS];
+
+  size_t n_segs = 0;
+  size_t n_staged = 0;
+
+  auto flush = [&]() {
+    bulk(buf, buf, n_staged);
+
+    const uint8_t* ptr = buf;
+    for (size_t i = 0; i < n_segs; i++) {
+      std::memcpy(seg_out[i], ptr, seg_len[i]);
+      ptr += seg_len[i];
+    }
+
+    n_segs = 0;
+    n_staged = 0;
+  };
+
+  for (size_t i = 0; i < n_jobs; i++) {
+    const size_t n_blocks = jobs[i].len / blk_len;
+    const size_t direct = (n_blocks / RUN_BLOCKS) * RUN_BLOCKS;
+
+    if (direct > 0) {
+      bulk(jobs[i].in, jobs[i].out, direct);
+    }
+
+    size_t done = direct;
+    while (done < n_blocks) {
+      const size_t take = std::min(n_blocks - done, BATCH_BLOCKS - n_staged);
+      const size_t off = done * blk_len;
+
+      std::memcpy(buf + n_staged * blk_len, jobs[i].in + off, take * blk_len);
+
+      seg_out[n_segs] = jobs[i].out + off;
+      seg_len[n_segs] = take * blk_len;
+      n_segs++;
+
+      n_staged += take;
+      done += take;
+
+      if (n_staged == BATCH_BLOCKS) {
+        flush();
+      }
+    }
+  }
+
+  if (n_staged > 0) {
+    flush();
+  }
+}
+
+// Encrypts message of each of N jobs, where message length must be a multiple
+// of 16 -bytes; see `crypt_jobs`
+static inline void
+encrypt_jobs(const uint8_t* const __restrict lut, // look up table
+             const job_t* const jobs,             // jobs
+             const size_t n_jobs                  // # -of jobs
+)
+{
+  crypt_jobs<false>(lut, jobs, n_jobs);
+}
+
+// Decrypts message of each of N jobs, where message length must be a multiple
+// of 16 -bytes; see `crypt_jobs`
+static inline void
+decrypt_jobs(const uint8_t* const __restrict inv_lut, // inverse look up table
+             const job_t* const jobs,                 // jobs
+             const size_t n_jobs                      // # -of jobs
+)
+{
+  crypt_jobs<true>(inv_lut, jobs, n_jobs);
+}
+
+// Given look up table & N jobs, this routine encrypts ( or decrypts ) message
+// of each job in counter mode, computing same output as calling
+// `harpocrates_ctr::crypt` for each of them
+//
+// Counter blocks of all jobs are prepared in shared batch, whose keystream is
+// computed once it's full & XORed into segments of messages, it covers.
+static inline void
+crypt_jobs(const uint8_t* const __restrict lut, // look up table
+           const ctr_job_t* const jobs,         // jobs
+           const size_t n_jobs                  // # -of jobs
+)
+{
+  constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+  uint8_t ks[BATCH_BLOCKS * blk_len];
+
+  // segment of some message, covered by keystream bytes starting at `ks_off`
+  struct segment_t
+  {
+    const uint8_t* in;
+    uint8_t* out;
+    size_t len;
+    size_t ks_off;
+  };
+
+  segment_t segs[BATCH_BLOCKS];
+
+  size_t n_segs = 0;
+  size_t n_staged = 0;
+
+  auto flush = [&]() {
+    harpocrates_dispatch::encrypt_blocks(lut, ks, ks, n_staged);
+
+    for (size_t i = 0; i < n_segs; i++) {
+      const segment_t& s = segs[i];
+
+      for (size_t j = 0; j < s.len; j++) {
+        s.out[j] = s.in[j] ^ ks[s.ks_off + j];
+      }
+    }
+
+    n_segs = 0;
+    n_staged = 0;
+  };
+
+  for (size_t i = 0; i < n_jobs; i++) {
+    const ctr_job_t& job = jobs[i];
+
+    uint64_t ctr = job.offset / blk_len;
+    size_t skip = static_cast<size_t>(job.offset % blk_len);
+    size_t done = 0;
+
+    while (done < job.len) {
+      const size_t need = (skip + (job.len - done) + blk_len - 1) / blk_len;
+      const size_t take = std::min(need, BATCH_BLOCKS - n_staged);
+      const size_t len = std::min(take * blk_len - skip, job.len - done);
+
+      harpocrates_ctr::counter_blocks(
+        job.nonce, ctr, ks + n_staged * blk_len, take);
+
+      segs[n_segs++] = { job.in + done,
+                         job.out + done,
+                         len,
+                         n_staged * blk_len + skip };
+
+      n_staged += take;
+      done += len;
+      ctr += take;
+      skip = 0;
+
+      if (n_staged == BATCH_BLOCKS) {
+        flush();
+      }
+    }
+  }
+
+  if (n_staged > 0) {
+    flush();
+  }
+}
+
+}
@@ -0,0 +1,322 @@
+#pragma once
+#include "harpocrates_dispatch.hpp"
+#include <algorithm>
+#include <functional>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, encrypting
+// ( or decrypting ) batch of message blocks, where each block may belong to a
+// different key, i.e. look up table ( e.g. small records of many tenants,
+// coalesced into a single write )
+//
+// Blocks of a batch are grouped by their look up table. Groups, which are
+// large enough, are encrypted using bulk encryption kernel selected at run time
+// ( see `harpocrates_dispatch` ), in place when group is a contiguous run of
+// blocks, otherwise after gathering them into a staging buffer, so that they
+// fill vector lanes of that kernel. Blocks of small groups are encrypted
+// N_LANES at a time, by interleaving their state matrices, same as
+// `harpocrates::encrypt_blocks` does, except that each state matrix is
+// substituted using its own look up table.
+namespace harpocrates_multikey {
+
+// # -of message blocks ( i.e. 16 KB ), which are grouped by their look up table
+// together
+constexpr size_t BATCH_BLOCKS = 1024ul;
+
+// Minimum # -of message blocks sharing a look up table, for them to be handed
+// over to bulk encryption kernel, instead of being interleaved with blocks of
+// other look up tables
+constexpr size_t MIN_GROUP = harpocrates_common::N_LANES;
+
+// Minimum # -of consecutive message blocks sharing a look up table, for them to
+// be encrypted in place, without being grouped with other blocks of that table
+constexpr size_t RUN_BLOCKS = harpocrates_dispatch::MAX_LANES;
+
+// Given `lanes` -many 16 -bytes message blocks, each with its own look up
+// table, this routine encrypts ( when `decrypt` is false ) or decrypts all of
+// them together, by interleaving their state matrices ( see
+// `harpocrates::encrypt_lanes` )
+//
+// When decrypting, i-th table must be inverse of look up table used for
+// encrypting i-th block. `in` and `out` may point to same memory.
+template<const size_t lanes,
+         const bool decrypt,
+         const harpocrates_utils::column_substitution_t colsub =
+           harpocrates_utils::transposed_column_substitution>
+static inline void
+crypt_lanes(const uint8_t* const* const __restrict luts, // look up tables
+            const uint8_t* const in,                     // input bytes
+            uint8_t* const out                           // output bytes
+)
+{
+  constexpr size_t n_rows = harpocrates_common::N_ROWS * lanes;
+  constexpr size_t itr_cnt = n_rows >> 1;
+
+  uint16_t state[n_rows] = { 0u };
+
+#if defined __clang__
+#pragma unroll 4
+#elif defined __GNUG__
+#pragma GCC ivdep
+#pragma GCC unroll 4
+#endif
+  for (size_t i = 0; i < itr_cnt; i++) {
+    const size_t b_off = i << 2;
+    const size_t r_off = i << 1;
+
+    state[r_off ^ 0] = (static_cast<uint16_t>(in[b_off ^ 0]) << 8) |
+                       static_cast<uint16_t>(in[b_off ^ 1]);
+    state[r_off ^ 1] = (static_cast<uint16_t>(in[b_off ^ 2]) << 8) |
+                       static_cast<uint16_t>(in[b_off ^ 3]);
+  }
+
+  for (size_t i = 0; i < harpocrates_common::N_ROUNDS; i++) {
+    using namespace harpocrates_utils;
+
+#if defined __clang__
+#pragma unroll
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+    for (size_t j = 0; j < lanes; j++) {
+      const size_t off = j * harpocrates_common::N_ROWS;
+      left_to_right_convoluted_substitution(state + off, luts[j]);
+    }
+
+    for (size_t j = 0; j < lanes; j++) {
+      const size_t off = j * harpocrates_common::N_ROWS;
+
+      if constexpr (decrypt) {
+        colsub(state + off, luts[j]);
+        add_rc(state + off, harpocrates_common::N_ROUNDS - (i + 1));
+      } else {
+        add_rc(state + off, i);
+        colsub(state + off, luts[j]);
+      }
+    }
+
+#if defined __clang__
+#pragma unroll
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+    for (size_t j = 0; j < lanes; j++) {
+      const size_t off = j * harpocrates_common::N_ROWS;
+      right_to_left_convoluted_substitution(state + off, luts[j]);
+    }
+  }
+
+#if defined __clang__
+#pragma unroll 4
+#elif defined __GNUG__
+#pragma GCC ivdep
+#pragma GCC unroll 4
+#endif
+  for (size_t i = 0; i < itr_cnt; i++) {
+    const size_t b_off = i << 2;
+    const size_t r_off = i << 1;
+
+    out[b_off ^ 0] = static_cast<uint8_t>(state[r_off ^ 0] >> 8);
+    out[b_off ^ 1] = static_cast<uint8_t>(state[r_off ^ 0]);
+    out[b_off ^ 2] = static_cast<uint8_t>(state[r_off ^ 1] >> 8);
+    out[b_off ^ 3] = static_cast<uint8_t>(state[r_off ^ 1]);
+  }
+}
+
+// Run of consecutive message blocks ( of a batch ), sharing a look up table
+struct run_t
+{
+  const uint8_t* lut;
+  uint16_t beg;
+  uint16_t len;
+};
+
+// Given N -many consecutive 16 -bytes message blocks & N look up tables ( read
+// `luts` ), where i-th block is to be encrypted ( when `decrypt` is false ) or
+// decrypted using i-th table, this routine processes them in batches of
+// BATCH_BLOCKS
+//
+// Each batch is split into runs of consecutive blocks sharing a look up table.
+// Runs of at least RUN_BLOCKS are encrypted in place, while shorter ones are
+// sorted by their look up table, so that runs of same table form a group.
+//
+// Look up tables are compared by address, so blocks of same key must point to
+// same table. When decrypting, tables must be inverse look up tables. `in` and
+// `out` may point to same memory ( i.e. in-place encryption )
+template<const bool decrypt,
+         const harpocrates_utils::column_substitution_t colsub =
+           harpocrates_utils::transposed_column_substitution>
+static inline void
+crypt_blocks(const uint8_t* const* const __restrict luts, // look up tables
+             const uint8_t* const in,                     // input bytes
+             uint8_t* const out,                          // output bytes
+             const size_t n_blocks                        // # -of blocks
+)
+{
+  constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+  constexpr size_t lanes = harpocrates_common::N_LANES;
+
+  auto bulk = [](const uint8_t* const lut,
+                 const uint8_t* const src,
+                 uint8_t* const dst,
+                 const size_t cnt) {
+    if constexpr (decrypt) {
+      harpocrates_dispatch::decrypt_blocks(lut, src, dst, cnt);
+    } else {
+      harpocrates_dispatch::encrypt_blocks(lut, src, dst, cnt);
+    }
+  };
+
+  run_t runs[BATCH_BLOCKS];
+  uint8_t buf[BATCH_BLOCKS * blk_len];
+
+  const uint8_t* mixed_luts[lanes];
+  uint16_t mixed[lanes];
+
+  for (size_t b = 0; b < n_blocks; b += BATCH_BLOCKS) {
+    const size_t cnt = std::min(BATCH_BLOCKS, n_blocks - b);
+
+    const uint8_t* const* const tbls = luts + b;
+    const uint8_t* const src = in + b * blk_len;
+    uint8_t* const dst = out + b * blk_len;
+
+    // long runs are encrypted right away, short ones are kept for grouping
+    size_t n_runs = 0;
+
+    for (size_t i = 0; i < cnt;) {
+      size_t j = i + 1;
+      while (j < cnt && tbls[j] == tbls[i]) {
+        j++;
+      }
+
+      if (j - i >= RUN_BLOCKS) {
+        bulk(tbls[i], src + i * blk_len, dst + i * blk_len, j - i);
+      } else {
+        runs[n_runs++] = { tbls[i],
+                           static_cast<uint16_t>(i),
+                           static_cast<uint16_t>(j - i) };
+      }
+
+      i = j;
+    }
+
+    // ties are broken by block index, so that blocks of a group stay in order
+    std::sort(runs, runs + n_runs, [](const run_t& x, const run_t& y) {
+      if (x.lut != y.lut) {
+        return std::less<const uint8_t*>()(x.lut, y.lut);
+      }
+      return x.beg < y.beg;
+    });
+
+    size_t n_mixed = 0;
+
+    size_t g_beg = 0;
+    while (g_beg < n_runs) {
+      const uint8_t* const lut = runs[g_beg].lut;
+
+      size_t g_len = runs[g_beg].len;
+      size_t g_end = g_beg + 1;
+
+      while (g_end < n_runs && runs[g_end].lut == lut) {
+        g_len += runs[g_end].len;
+        g_end++;
+      }
+
+      if (g_len >= MIN_GROUP && g_end - g_beg == 1) {
+        const size_t off = runs[g_beg].beg * blk_len;
+        bulk(lut, src + off, dst + off, g_len);
+      } else if (g_len >= MIN_GROUP) {
+        uint8_t* ptr = buf;
+
+        for (size_t i = g_beg; i < g_end; i++) {
+          const size_t len = runs[i].len * blk_len;
+
+          std::memcpy(ptr, src + runs[i].beg * blk_len, len);
+          ptr += len;
+        }
+
+        bulk(lut, buf, buf, g_len);
+
+        ptr = buf;
+        for (size_t i = g_beg; i < g_end; i++) {
+          const size_t len = runs[i].len * blk_len;
+
+          std::memcpy(dst + runs[i].beg * blk_len, ptr, len);
+          ptr += len;
+        }
+      } else {
+        // blocks of small groups are interleaved, N_LANES at a time
+        for (size_t i = g_beg; i < g_end; i++) {
+          for (size_t j = 0; j < runs[i].len; j++) {
+            mixed[n_mixed++] = static_cast<uint16_t>(runs[i].beg + j);
+
+            if (n_mixed < lanes) {
+              continue;
+            }
+
+            for (size_t k = 0; k < lanes; k++) {
+              const size_t off = mixed[k] * blk_len;
+
+              std::memcpy(buf + k * blk_len, src + off, blk_len);
+              mixed_luts[k] = tbls[mixed[k]];
+            }
+
+            crypt_lanes<lanes, decrypt, colsub>(mixed_luts, buf, buf);
+
+            for (size_t k = 0; k < lanes; k++) {
+              const size_t off = mixed[k] * blk_len;
+              std::memcpy(dst + off, buf + k * blk_len, blk_len);
+            }
+
+            n_mixed = 0;
+          }
+        }
+      }
+
+      g_beg = g_end;
+    }
+
+    // trailing blocks of small groups are processed one by one
+    for (size_t i = 0; i < n_mixed; i++) {
+      const size_t off = mixed[i] * blk_len;
+
+      uint8_t blk[blk_len];
+      std::memcpy(blk, src + off, blk_len);
+
+      if constexpr (decrypt) {
+        harpocrates_dispatch::decrypt(tbls[mixed[i]], blk, dst + off);
+      } else {
+        harpocrates_dispatch::encrypt(tbls[mixed[i]], blk, dst + off);
+      }
+    }
+  }
+}
+
+// Encrypts N -many consecutive 16 -bytes message blocks, where i-th block is
+// encrypted using i-th look up table; see `crypt_blocks`
+//
+// Computes same output as calling `harpocrates::encrypt` for each block
+static inline void
+encrypt_blocks(const uint8_t* const* const __restrict luts, // look up tables
+               const uint8_t* const txt,                    // input plain text
+               uint8_t* const enc,   // output encrypted bytes
+               const size_t n_blocks // # -of message blocks
+)
+{
+  crypt_blocks<false>(luts, txt, enc, n_blocks);
+}
+
+// Decrypts N -many consecutive 16 -bytes encrypted message blocks, where i-th
+// block is decrypted using i-th inverse look up table; see `crypt_blocks`
+//
+// Computes same output as calling `harpocrates::decrypt` for each block
+static inline void
+decrypt_blocks(const uint8_t* const* const __restrict inv_luts, // inverse LUTs
+               const uint8_t* const enc, // input encrypted bytes
+               uint8_t* const dec,       // decrypted bytes
+               const size_t n_blocks     // # -of message blocks
+)
+{
+  crypt_blocks<true>(inv_luts, enc, dec, n_blocks);
+}
+
+}
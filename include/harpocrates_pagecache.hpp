@@ -0,0 +1,425 @@
+#pragma once
+#include "harpocrates_xts.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <fcntl.h>
+#include <memory>
+#include <mutex>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, serving
+// reads & writes of a file, which is stored encrypted page by page ( e.g.
+// pages of a database ), through a bounded cache of decrypted pages
+//
+// Each page of backing file is encrypted in XTS-like mode ( see
+// `harpocrates_xts` ), using page number as sector number, so that a page can
+// be decrypted on its own & encrypted again, in place, when it's modified. A
+// page is read & decrypted only on first access, after which it's served from
+// cache, until it's evicted. Modified pages are marked dirty & they're
+// encrypted & written back only when they're evicted, or on `flush`.
+//
+// Pages are spread over shards, each one with its own lock, fixed pool of
+// page frames & CLOCK replacement, where a hit only sets reference bit of
+// frame, instead of reordering a least recently used list. Misses & write
+// backs are served while holding shard's lock, so that a page is never loaded
+// twice, nor loaded while its dirty copy is being written back.
+//
+// Pages which were never written ( i.e. lying beyond end of backing file, or
+// in holes ) read as zeros.
+namespace harpocrates_pagecache {
+
+// Default byte length of pages ( must be a multiple of 16 -bytes )
+constexpr size_t PAGE_LEN = 4096ul;
+
+// # -of shards, by default
+constexpr size_t N_SHARDS = 16ul;
+
+// Counters of page cache, summed over all shards
+struct stats_t
+{
+  uint64_t hits;       // accesses of cached pages
+  uint64_t misses;     // accesses, which had to read & decrypt page
+  uint64_t evictions;  // pages evicted, for making room
+  uint64_t writebacks; // dirty pages encrypted & written back
+};
+
+// Bounded, thread-safe cache of decrypted pages of a backing file, which is
+// encrypted page by page; on failure, routines return false, leaving cause in
+// `errno`
+class page_cache
+{
+public:
+  // Cache holding at most `capacity` pages ( at least one per shard ) of
+  // `page_len` -bytes, split evenly over `n_shards` shards, where pages are
+  // encrypted under given look up table & tweak look up table ( see
+  // `harpocrates_xts` )
+  page_cache(const uint8_t* const __restrict lut,
+             const uint8_t* const __restrict tweak_lut,
+             const size_t capacity,
+             const size_t page_len = PAGE_LEN,
+             const size_t n_shards = N_SHARDS)
+    : page_len(page_len)
+    , shards(std::max<size_t>(n_shards, 1))
+  {
+    std::memcpy(this->lut, lut, sizeof(this->lut));
+    std::memcpy(this->tweak_lut, tweak_lut, sizeof(this->tweak_lut));
+    harpocrates_utils::generate_inv_lut(this->lut, inv_lut);
+
+    const size_t n_frames = std::max<size_t>(capacity / shards.size(), 1);
+
+    for (auto& s : shards) {
+      s.frames.resize(n_frames);
+      s.data = std::make_unique<uint8_t[]>(n_frames * page_len);
+      s.scratch = std::make_unique<uint8_t[]>(page_len);
+    }
+  }
+
+  page_cache(const page_cache&) = delete;
+  page_cache& operator=(const page_cache&) = delete;
+
+  // Writes back dirty pages & closes backing file, erasing all decrypted pages
+  // & tables
+  ~page_cache()
+  {
+    close();
+
+    for (auto& s : shards) {
+      const size_t data_len = s.frames.size() * page_len;
+      harpocrates_utils::secure_zero(s.data.get(), data_len);
+    }
+
+    harpocrates_utils::secure_zero(lut, sizeof(lut));
+    harpocrates_utils::secure_zero(inv_lut, sizeof(inv_lut));
+    harpocrates_utils::secure_zero(tweak_lut, sizeof(tweak_lut));
+  }
+
+  // Opens backing file ( creating it, if it doesn't exist ), for reading &
+  // writing; returns false, leaving cause in `errno` ( EINVAL, when page
+  // length isn't a non-zero multiple of 16 -bytes )
+  bool open(const char* const path)
+  {
+    if (!close()) {
+      return false;
+    }
+
+    if (page_len == 0 || page_len % harpocrates_common::BLOCK_LEN != 0) {
+      errno = EINVAL;
+      return false;
+    }
+
+    fd = ::open(path, O_RDWR | O_CREAT, 0644);
+    return fd >= 0;
+  }
+
+  // Writes back dirty pages & closes backing file, dropping ( & erasing ) all
+  // cached pages; returns false, leaving cause in `errno`, when some page
+  // can't be written back, in which case file stays open
+  bool close()
+  {
+    if (fd < 0) {
+      return true;
+    }
+
+    if (!flush()) {
+      return false;
+    }
+
+    for (auto& s : shards) {
+      std::lock_guard<std::mutex> lock(s.mtx);
+
+      for (auto& f : s.frames) {
+        f = frame_t{};
+      }
+      s.map.clear();
+
+      // erase decrypted pages, which stay allocated until cache is destroyed
+      harpocrates_utils::secure_zero(s.data.get(), s.frames.size() * page_len);
+    }
+
+    ::close(fd);
+    fd = -1;
+
+    return true;
+  }
+
+  // Copies N bytes, starting at given byte offset of file, out of cached
+  // pages, reading & decrypting those pages which aren't cached
+  bool read(const uint64_t offset, uint8_t* const out, const size_t len)
+  {
+    return access(offset, len, false, [&](uint8_t* const page,
+                                          const size_t off,
+                                          const size_t done,
+                                          const size_t n) {
+      std::memcpy(out + done, page + off, n);
+    });
+  }
+
+  // Copies N bytes into cached pages, starting at given byte offset of file,
+  // marking those pages dirty; pages which aren't cached are read & decrypted
+  // first, unless they're overwritten as a whole
+  bool write(const uint64_t offset, const uint8_t* const in, const size_t len)
+  {
+    return access(offset, len, true, [&](uint8_t* const page,
+                                         const size_t off,
+                                         const size_t done,
+                                         const size_t n) {
+      std::memcpy(page + off, in + done, n);
+    });
+  }
+
+  // Encrypts & writes back all dirty pages, keeping them cached, before
+  // syncing backing file
+  bool flush()
+  {
+    if (fd < 0) {
+      errno = EBADF;
+      return false;
+    }
+
+    for (auto& s : shards) {
+      std::lock_guard<std::mutex> lock(s.mtx);
+
+      for (size_t i = 0; i < s.frames.size(); i++) {
+        if (s.frames[i].dirty && !write_back(s, i)) {
+          return false;
+        }
+      }
+    }
+
+    return ::fsync(fd) == 0;
+  }
+
+  // Byte length of pages
+  size_t page_size() const { return page_len; }
+
+  // Returns counters, summed over all shards
+  stats_t stats() const
+  {
+    stats_t st{};
+
+    for (const auto& s : shards) {
+      st.hits += s.hits.load(std::memory_order_relaxed);
+      st.misses += s.misses.load(std::memory_order_relaxed);
+      st.evictions += s.evictions.load(std::memory_order_relaxed);
+      st.writebacks += s.writebacks.load(std::memory_order_relaxed);
+    }
+
+    return st;
+  }
+
+private:
+  // Page frame, where `ref` is reference bit of CLOCK replacement
+  struct frame_t
+  {
+    uint64_t page = 0;
+    bool used = false;
+    bool ref = false;
+    bool dirty = false;
+  };
+
+  struct alignas(harpocrates_parallel::CACHE_LINE) shard_t
+  {
+    mutable std::mutex mtx;
+    std::vector<frame_t> frames;
+    std::unique_ptr<uint8_t[]> data;    // decrypted pages, one per frame
+    std::unique_ptr<uint8_t[]> scratch; // encrypted page, being written back
+    std::unordered_map<uint64_t, size_t> map;
+    size_t hand = 0;
+
+    std::atomic<uint64_t> hits{ 0 };
+    std::atomic<uint64_t> misses{ 0 };
+    std::atomic<uint64_t> evictions{ 0 };
+    std::atomic<uint64_t> writebacks{ 0 };
+  };
+
+  shard_t& shard(const uint64_t page)
+  {
+    return shards[harpocrates_utils::mix64(page) % shards.size()];
+  }
+
+  // Splits byte range at page boundaries & invokes `fn(page, off, done, n)`
+  // for each piece, with shard's lock held, where `page` is decrypted page,
+  // holding n bytes of range at offset `off`, which are `done` bytes into
+  // range; pages are marked dirty, when `writing` is set
+  template<typename F>
+  bool access(const uint64_t offset,
+              const size_t len,
+              const bool writing,
+              F&& fn)
+  {
+    if (fd < 0) {
+      errno = EBADF;
+      return false;
+    }
+
+    size_t done = 0;
+
+    while (done < len) {
+      const uint64_t pos = offset + done;
+      const uint64_t page = pos / page_len;
+      const size_t off = static_cast<size_t>(pos % page_len);
+      const size_t n = std::min(page_len - off, len - done);
+
+      shard_t& s = shard(page);
+      std::lock_guard<std::mutex> lock(s.mtx);
+
+      size_t idx;
+
+      auto it = s.map.find(page);
+      if (it != s.map.end()) {
+        idx = it->second;
+        s.hits.fetch_add(1, std::memory_order_relaxed);
+      } else {
+        if (!evict(s, &idx)) {
+          return false;
+        }
+
+        // page being overwritten as a whole needn't be read
+        const bool whole = writing && n == page_len;
+        uint8_t* const dst = s.data.get() + idx * page_len;
+
+        if (!whole && !load(page, dst)) {
+          // frame stays free, without partially read bytes or evicted page
+          harpocrates_utils::secure_zero(dst, page_len);
+          return false;
+        }
+
+        s.frames[idx] = frame_t{ page, true, false, false };
+        s.map.emplace(page, idx);
+        s.misses.fetch_add(1, std::memory_order_relaxed);
+      }
+
+      frame_t& f = s.frames[idx];
+      f.ref = true;
+      f.dirty |= writing;
+
+      fn(s.data.get() + idx * page_len, off, done, n);
+
+      done += n;
+    }
+
+    return true;
+  }
+
+  // Reads & decrypts page; page which was never written ( i.e. lying beyond
+  // end of file, or in a hole, reading as all zeros ) is zeroed
+  bool load(const uint64_t page, uint8_t* const dst)
+  {
+    const uint64_t beg = page * page_len;
+    size_t got = 0;
+
+    while (got < page_len) {
+      const ssize_t n = ::pread(
+        fd, dst + got, page_len - got, static_cast<off_t>(beg + got));
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n < 0) {
+        return false;
+      }
+      if (n == 0) {
+        break;
+      }
+
+      got += static_cast<size_t>(n);
+    }
+
+    if (got > 0 && got < page_len) {
+      errno = EIO;
+      return false;
+    }
+
+    // ciphertext of a written page being all zeros is negligibly unlikely
+    uint8_t acc = 0;
+    for (size_t i = 0; i < got; i++) {
+      acc |= dst[i];
+    }
+
+    if (acc == 0) {
+      std::memset(dst, 0, page_len);
+      return true;
+    }
+
+    harpocrates_xts::decrypt_sectors(
+      inv_lut, tweak_lut, page, dst, dst, page_len, 1);
+
+    return true;
+  }
+
+  // Encrypts & writes back i-th frame of shard, marking it clean
+  bool write_back(shard_t& s, const size_t idx)
+  {
+    frame_t& f = s.frames[idx];
+    uint8_t* const enc = s.scratch.get();
+
+    harpocrates_xts::encrypt_sectors(
+      lut, tweak_lut, f.page, s.data.get() + idx * page_len, enc, page_len, 1);
+
+    const uint64_t beg = f.page * page_len;
+    size_t put = 0;
+
+    while (put < page_len) {
+      const ssize_t n = ::pwrite(
+        fd, enc + put, page_len - put, static_cast<off_t>(beg + put));
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        return false;
+      }
+
+      put += static_cast<size_t>(n);
+    }
+
+    f.dirty = false;
+    s.writebacks.fetch_add(1, std::memory_order_relaxed);
+
+    return true;
+  }
+
+  // Finds a free frame or, when there's none, picks a victim by sweeping CLOCK
+  // hand, clearing reference bits on its way & evicts it, writing it back,
+  // when it's dirty
+  bool evict(shard_t& s, size_t* const idx)
+  {
+    const size_t n_frames = s.frames.size();
+
+    while (true) {
+      const size_t i = s.hand;
+      frame_t& f = s.frames[i];
+
+      s.hand = (s.hand + 1) % n_frames;
+
+      if (!f.used) {
+        *idx = i;
+        return true;
+      }
+      if (f.ref) {
+        f.ref = false;
+        continue;
+      }
+      if (f.dirty && !write_back(s, i)) {
+        return false;
+      }
+
+      s.map.erase(f.page);
+      f = frame_t{};
+      s.evictions.fetch_add(1, std::memory_order_relaxed);
+
+      *idx = i;
+      return true;
+    }
+  }
+
+  size_t page_len;
+  int fd = -1;
+  uint8_t lut[256];
+  uint8_t inv_lut[256];
+  uint8_t tweak_lut[256];
+  std::vector<shard_t> shards;
+};
+
+}
@@ -0,0 +1,324 @@
+#pragma once
+#include "harpocrates_dispatch.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, encrypting
+// ( or decrypting ) large buffers using many CPU cores
+//
+// Message blocks are independent of each other, so buffer is split into cache
+// sized chunks, which are spread over workers of a reusable thread pool, each
+// worker encrypting its chunks using kernel selected at run time ( see
+// `harpocrates_dispatch` ) & stealing chunks from other workers, once it runs
+// out of its own.
+namespace harpocrates_parallel {
+
+// # -of 16 -bytes message blocks in a chunk ( i.e. 32 KB ), which is the unit
+// of work, scheduled on some worker of thread pool
+constexpr size_t CHUNK_BLOCKS = 2048ul;
+
+// Size of cache line, used for keeping per-worker state apart
+constexpr size_t CACHE_LINE = 64ul;
+
+// Pool of worker threads, which are created once & reused across calls to
+// `parallel_for`, where calling thread also participates as worker 0
+//
+// Each call splits tasks [0, N) into contiguous ranges, one per worker. Worker
+// takes tasks from front of its own range & once that's empty, it steals back
+// half of some other worker's remaining range, so that workers finishing early
+// keep others from becoming stragglers.
+//
+// Only one `parallel_for` runs at a time; concurrent callers are serialized,
+// while `parallel_for` called from inside a task of same pool runs all of its
+// tasks inline, on calling worker, as every other worker may be busy.
+class thread_pool
+{
+public:
+  // Spawns `n_threads - 1` worker threads; zero means one per hardware thread
+  explicit thread_pool(const size_t n_threads = 0)
+  {
+    const size_t hw = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    n_workers = n_threads == 0 ? hw : n_threads;
+    ranges = std::make_unique<range_t[]>(n_workers);
+
+    threads.reserve(n_workers - 1);
+    for (size_t i = 1; i < n_workers; i++) {
+      threads.emplace_back([this, i] { worker_loop(i); });
+    }
+  }
+
+  thread_pool(const thread_pool&) = delete;
+  thread_pool& operator=(const thread_pool&) = delete;
+
+  ~thread_pool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+      stop = true;
+    }
+
+    wake_cv.notify_all();
+    for (auto& t : threads) {
+      t.join();
+    }
+  }
+
+  // # -of workers, including calling thread
+  size_t size() const { return n_workers; }
+
+  // Invokes `fn(i)` for each task index i in [0, n_tasks), spread over all
+  // workers, returning only after all of them are done; `fn` must not throw
+  template<typename F>
+  void parallel_for(const size_t n_tasks, F&& fn)
+  {
+    if (n_tasks == 0) {
+      return;
+    }
+
+    if (n_workers == 1 || n_tasks == 1 || active == this) {
+      for (size_t i = 0; i < n_tasks; i++) {
+        fn(i);
+      }
+      return;
+    }
+
+    std::lock_guard<std::mutex> submit_lock(submit_mtx);
+
+    for (size_t i = 0; i < n_workers; i++) {
+      const size_t beg = (n_tasks * i) / n_workers;
+      const size_t end = (n_tasks * (i + 1)) / n_workers;
+      ranges[i].val.store(pack(beg, end), std::memory_order_relaxed);
+    }
+
+    using fn_t = std::remove_reference_t<F>;
+
+    {
+      std::lock_guard<std::mutex> lock(mtx);
+
+      job_ctx = static_cast<void*>(&fn);
+      job_fn = [](void* ctx, const size_t i) { (*static_cast<fn_t*>(ctx))(i); };
+      busy = n_workers - 1;
+      generation++;
+    }
+
+    wake_cv.notify_all();
+    run(0);
+
+    std::unique_lock<std::mutex> lock(mtx);
+    done_cv.wait(lock, [this] { return busy == 0; });
+
+    job_ctx = nullptr;
+    job_fn = nullptr;
+  }
+
+private:
+  // Range of task indices [beg, end) packed into a 64 -bit word, so that owner
+  // & thieves can update it using a single compare-and-swap
+  struct alignas(CACHE_LINE) range_t
+  {
+    std::atomic<uint64_t> val{ 0 };
+  };
+
+  static constexpr uint64_t pack(const size_t beg, const size_t end)
+  {
+    return (static_cast<uint64_t>(beg) << 32) | static_cast<uint64_t>(end);
+  }
+
+  // Takes task from front of worker's own range
+  bool pop(const size_t id, size_t* const task)
+  {
+    uint64_t cur = ranges[id].val.load(std::memory_order_acquire);
+
+    while (true) {
+      const size_t beg = static_cast<size_t>(cur >> 32);
+      const size_t end = static_cast<size_t>(cur & 0xffffffffu);
+
+      if (beg >= end) {
+        return false;
+      }
+
+      if (ranges[id].val.compare_exchange_weak(cur, pack(beg + 1, end))) {
+        *task = beg;
+        return true;
+      }
+    }
+  }
+
+  // Steals back half of victim's remaining range, placing it in thief's own
+  // ( empty ) range
+  bool steal(const size_t id, const size_t victim)
+  {
+    uint64_t cur = ranges[victim].val.load(std::memory_order_acquire);
+
+    while (true) {
+      const size_t beg = static_cast<size_t>(cur >> 32);
+      const size_t end = static_cast<size_t>(cur & 0xffffffffu);
+
+      if (beg >= end) {
+        return false;
+      }
+
+      const size_t mid = end - ((end - beg + 1) >> 1);
+      if (ranges[victim].val.compare_exchange_weak(cur, pack(beg, mid))) {
+        ranges[id].val.store(pack(mid, end), std::memory_order_release);
+        return true;
+      }
+    }
+  }
+
+  // Executes tasks of current job, until none are left in any range, marking
+  // calling thread as running tasks of this pool, meanwhile
+  void run(const size_t id)
+  {
+    const thread_pool* const prev = active;
+    active = this;
+
+    size_t task = 0;
+
+    while (true) {
+      while (pop(id, &task)) {
+        job_fn(job_ctx, task);
+      }
+
+      bool stolen = false;
+      for (size_t i = 1; i < n_workers && !stolen; i++) {
+        stolen = steal(id, (id + i) % n_workers);
+      }
+
+      if (!stolen) {
+        break;
+      }
+    }
+
+    active = prev;
+  }
+
+  void worker_loop(const size_t id)
+  {
+    size_t seen = 0;
+
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        wake_cv.wait(lock, [&] { return stop || generation != seen; });
+
+        if (stop) {
+          return;
+        }
+        seen = generation;
+      }
+
+      run(id);
+
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        busy--;
+      }
+      done_cv.notify_one();
+    }
+  }
+
+  // Pool, whose tasks calling thread is running, if any
+  static inline thread_local const thread_pool* active = nullptr;
+
+  size_t n_workers = 1;
+  std::unique_ptr<range_t[]> ranges;
+  std::vector<std::thread> threads;
+
+  std::mutex submit_mtx;
+  std::mutex mtx;
+  std::condition_variable wake_cv;
+  std::condition_variable done_cv;
+
+  void* job_ctx = nullptr;
+  void (*job_fn)(void*, const size_t) = nullptr;
+  size_t busy = 0;
+  size_t generation = 0;
+  bool stop = false;
+};
+
+// Given N -many consecutive 16 -bytes message blocks & look up table ( read
+// `lut` ), this routine encrypts all of them, split into chunks of
+// `chunk_blocks` message blocks, which are encrypted by workers of thread pool
+//
+// Computes same output as `harpocrates::encrypt_blocks`; `txt` and `enc` may
+// point to same memory ( i.e. in-place encryption )
+static inline void
+encrypt_blocks(thread_pool& pool,                   // reusable thread pool
+               const uint8_t* const __restrict lut, // look up table
+               const uint8_t* const txt,            // input plain text
+               uint8_t* const enc,                  // output encrypted bytes
+               const size_t n_blocks,               // # -of message blocks
+               const size_t chunk_blocks = CHUNK_BLOCKS)
+{
+  const size_t n_chunks = (n_blocks + chunk_blocks - 1) / chunk_blocks;
+
+  pool.parallel_for(n_chunks, [=](const size_t i) {
+    const size_t beg = i * chunk_blocks;
+    const size_t cnt = std::min(chunk_blocks, n_blocks - beg);
+    const size_t off = beg * harpocrates_common::BLOCK_LEN;
+
+    harpocrates_dispatch::encrypt_blocks(lut, txt + off, enc + off, cnt);
+  });
+}
+
+// Given N -many consecutive 16 -bytes encrypted message blocks & inverse look
+// up table ( read `inv_lut` ), this routine decrypts all of them, split into
+// chunks of `chunk_blocks` message blocks, which are decrypted by workers of
+// thread pool
+//
+// Computes same output as `harpocrates::decrypt_blocks`; `enc` and `dec` may
+// point to same memory ( i.e. in-place decryption )
+static inline void
+decrypt_blocks(thread_pool& pool,                       // reusable thread pool
+               const uint8_t* const __restrict inv_lut, // inverse look up table
+               const uint8_t* const enc,                // input encrypted bytes
+               uint8_t* const dec,                      // decrypted bytes
+               const size_t n_blocks,                   // # -of message blocks
+               const size_t chunk_blocks = CHUNK_BLOCKS)
+{
+  const size_t n_chunks = (n_blocks + chunk_blocks - 1) / chunk_blocks;
+
+  pool.parallel_for(n_chunks, [=](const size_t i) {
+    const size_t beg = i * chunk_blocks;
+    const size_t cnt = std::min(chunk_blocks, n_blocks - beg);
+    const size_t off = beg * harpocrates_common::BLOCK_LEN;
+
+    harpocrates_dispatch::decrypt_blocks(inv_lut, enc + off, dec + off, cnt);
+  });
+}
+
+// Given N -many consecutive 16 -bytes message blocks, encrypted under old look
+// up table, this routine re-encrypts all of them under new look up table,
+// split into chunks of `chunk_blocks` message blocks, which are re-encrypted
+// by workers of thread pool
+//
+// Computes same output as `harpocrates::transcrypt_blocks`; `enc` and `out`
+// may point to same memory ( i.e. in-place )
+static inline void
+transcrypt_blocks(thread_pool& pool,                       // reusable pool
+                  const uint8_t* const __restrict inv_lut, // old inverse table
+                  const uint8_t* const __restrict lut,     // new look up table
+                  const uint8_t* const enc,                // encrypted bytes
+                  uint8_t* const out,                      // re-encrypted bytes
+                  const size_t n_blocks,                   // # -of blocks
+                  const size_t chunk_blocks = CHUNK_BLOCKS)
+{
+  const size_t n_chunks = (n_blocks + chunk_blocks - 1) / chunk_blocks;
+
+  pool.parallel_for(n_chunks, [=](const size_t i) {
+    const size_t beg = i * chunk_blocks;
+    const size_t cnt = std::min(chunk_blocks, n_blocks - beg);
+    const size_t off = beg * harpocrates_common::BLOCK_LEN;
+
+    harpocrates_dispatch::transcrypt_blocks(
+      inv_lut, lut, enc + off, out + off, cnt);
+  });
+}
+
+}
@@ -0,0 +1,1129 @@
+#pragma once
+#include "harpocrates_common.hpp"
+#include <bit>
+#include <cstring>
+
+#if defined __x86_64__
+#include <immintrin.h>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, vectorized
+// using x86_64 SIMD extensions, processing many message blocks in parallel
+//
+// State matrices of N message blocks are kept byte-sliced i.e. i-th vector
+// register holds i-th byte of all N message blocks, so that every step of
+// Harpocrates round function ( including look ups into 256 -bytes table, which
+// are performed using in-register byte shuffles ) is applied to N blocks using
+// a few vector instructions.
+//
+// Routines living in `avx2::` & `avx512::` namespaces must only be invoked
+// when executing CPU supports respective extensions, which can be checked by
+//
+// - avx2: __builtin_cpu_supports("avx2")
+// - avx512: __builtin_cpu_supports("avx512bw") &&
+//           __builtin_cpu_supports("avx512vbmi")
+namespace harpocrates_simd {
+
+// 4 -bit bit-reversal permutation, used for undoing index permutation which
+// happens during 16 x 16 byte matrix transposition
+constexpr size_t REV4[16] = { 0, 8, 4, 12, 2, 10, 6, 14,
+                              1, 9, 5, 13, 3, 11, 7, 15 };
+
+// Transposes 16 x 16 byte matrix, where i-th row is held in i-th 128 -bit
+// register, using four stages of byte/ word/ double word/ quad word
+// interleaving
+//
+// Used for converting 16 message blocks ( each of 16 -bytes ) into byte-sliced
+// form i.e. i-th register holds i-th byte of all 16 message blocks & back
+static inline void
+transpose16x16(__m128i* const mat)
+{
+  __m128i t[16];
+
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+  for (size_t i = 0; i < 8; i++) {
+    t[i] = _mm_unpacklo_epi8(mat[2 * i], mat[2 * i + 1]);
+    t[8 + i] = _mm_unpackhi_epi8(mat[2 * i], mat[2 * i + 1]);
+  }
+
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+  for (size_t i = 0; i < 8; i++) {
+    mat[i] = _mm_unpacklo_epi16(t[2 * i], t[2 * i + 1]);
+    mat[8 + i] = _mm_unpackhi_epi16(t[2 * i], t[2 * i + 1]);
+  }
+
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+  for (size_t i = 0; i < 8; i++) {
+    t[i] = _mm_unpacklo_epi32(mat[2 * i], mat[2 * i + 1]);
+    t[8 + i] = _mm_unpackhi_epi32(mat[2 * i], mat[2 * i + 1]);
+  }
+
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+  for (size_t i = 0; i < 8; i++) {
+    mat[REV4[i]] = _mm_unpacklo_epi64(t[2 * i], t[2 * i + 1]);
+    mat[REV4[8 + i]] = _mm_unpackhi_epi64(t[2 * i], t[2 * i + 1]);
+  }
+}
+
+}
+
+#if defined __clang__
+#pragma clang attribute push(__attribute__((target("avx2"))),                \
+                             apply_to = function)
+#elif defined __GNUG__
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+// Harpocrates cipher, vectorized using AVX2, processing 32 message blocks at a
+// time, where 256 -bytes look up table is kept in sixteen 256 -bit registers (
+// each holding 16 -bytes of table, in both 128 -bit lanes ), so that a look up
+// is sixteen VPSHUFB instructions, whose results are reduced using VPBLENDVB
+namespace harpocrates_simd::avx2 {
+
+// # -of message blocks processed in parallel
+constexpr size_t N_LANES = 32ul;
+
+// Loads 256 -bytes look up table into sixteen 256 -bit registers, i-th of
+// which holds lut[16*i .. 16*(i+1)], in both 128 -bit lanes
+static inline void
+load_lut(const uint8_t* const __restrict lut, __m256i* const __restrict tbl)
+{
+  for (size_t i = 0; i < 16; i++) {
+    const __m128i* const ptr = reinterpret_cast<const __m128i*>(lut) + i;
+    tbl[i] = _mm256_broadcastsi128_si256(_mm_loadu_si128(ptr));
+  }
+}
+
+// Substitutes each of 32 bytes in `idx`, using 256 -bytes look up table,
+// loaded using `load_lut`
+static inline __m256i
+lookup(const __m256i* const tbl, const __m256i idx)
+{
+  const __m256i lo = _mm256_and_si256(idx, _mm256_set1_epi8(0x0f));
+
+  __m256i r[16];
+
+#if defined __clang__
+#pragma unroll 16
+#elif defined __GNUG__
+#pragma GCC unroll 16
+#endif
+  for (size_t i = 0; i < 16; i++) {
+    r[i] = _mm256_shuffle_epi8(tbl[i], lo);
+  }
+
+  // select among looked up bytes, using bit 4, 5, 6 & 7 of index, which are
+  // moved to bit 7 of each byte, as VPBLENDVB only considers that bit
+  const __m256i m4 = _mm256_slli_epi16(idx, 3);
+  const __m256i m5 = _mm256_slli_epi16(idx, 2);
+  const __m256i m6 = _mm256_slli_epi16(idx, 1);
+
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+  for (size_t i = 0; i < 8; i++) {
+    r[i] = _mm256_blendv_epi8(r[2 * i], r[2 * i + 1], m4);
+  }
+
+#if defined __clang__
+#pragma unroll 4
+#elif defined __GNUG__
+#pragma GCC unroll 4
+#endif
+  for (size_t i = 0; i < 4; i++) {
+    r[i] = _mm256_blendv_epi8(r[2 * i], r[2 * i + 1], m5);
+  }
+
+  r[0] = _mm256_blendv_epi8(r[0], r[1], m6);
+  r[1] = _mm256_blendv_epi8(r[2], r[3], m6);
+
+  return _mm256_blendv_epi8(r[0], r[1], idx);
+}
+
+// Shifts each byte left by `n` bit places
+template<const int n>
+static inline __m256i
+shl(const __m256i x)
+{
+  constexpr uint8_t m = static_cast<uint8_t>(0xff << n);
+  return _mm256_and_si256(_mm256_slli_epi16(x, n), _mm256_set1_epi8(m));
+}
+
+// Shifts each byte right by `n` bit places
+template<const int n>
+static inline __m256i
+shr(const __m256i x)
+{
+  constexpr uint8_t m = static_cast<uint8_t>(0xff >> n);
+  return _mm256_and_si256(_mm256_srli_epi16(x, n), _mm256_set1_epi8(m));
+}
+
+// Bitwise AND of each byte with 8 -bit constant
+static inline __m256i
+mask(const __m256i x, const uint8_t m)
+{
+  return _mm256_and_si256(x, _mm256_set1_epi8(m));
+}
+
+// Left to right convoluted substitution of byte-sliced state matrices, which
+// is same as `harpocrates_utils::left_to_right_convoluted_substitution`
+static inline void
+left_to_right_convoluted_substitution(__m256i* const __restrict state,
+                                      const __m256i* const __restrict tbl)
+{
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+  for (size_t i = 0; i < harpocrates_common::N_ROWS; i++) {
+    const __m256i hi = state[2 * i];
+    const __m256i lo = state[2 * i + 1];
+
+    const __m256i lo_msb0 = shr<6>(lo);
+    const __m256i lo_msb2 = mask(shr<4>(lo), 0b11);
+    const __m256i lo_msb4 = mask(shr<2>(lo), 0b11);
+    const __m256i lo_msb6 = mask(lo, 0b11);
+
+    // step 1
+    const __m256i t1 = lookup(tbl, hi);
+    const __m256i msb0 = mask(t1, 0b11000000);
+
+    // step 2
+    const __m256i t2 = _mm256_or_si256(shl<2>(t1), lo_msb0);
+    const __m256i t3 = lookup(tbl, t2);
+    const __m256i msb2 = mask(shr<2>(t3), 0b00110000);
+
+    // step 3
+    const __m256i t4 = _mm256_or_si256(shl<2>(t3), lo_msb2);
+    const __m256i t5 = lookup(tbl, t4);
+    const __m256i msb4 = mask(shr<4>(t5), 0b00001100);
+
+    // step 4
+    const __m256i t6 = _mm256_or_si256(shl<2>(t5), lo_msb4);
+    const __m256i t7 = lookup(tbl, t6);
+    const __m256i msb6 = shr<6>(t7);
+
+    // step 5
+    const __m256i t8 = _mm256_or_si256(shl<2>(t7), lo_msb6);
+    const __m256i t9 = lookup(tbl, t8);
+
+    state[2 * i] = _mm256_or_si256(_mm256_or_si256(msb0, msb2),
+                                   _mm256_or_si256(msb4, msb6));
+    state[2 * i + 1] = t9;
+  }
+}
+
+// Right to left convoluted substitution of byte-sliced state matrices, which
+// is same as `harpocrates_utils::right_to_left_convoluted_substitution`
+static inline void
+right_to_left_convoluted_substitution(__m256i* const __restrict state,
+                                      const __m256i* const __restrict tbl)
+{
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+  for (size_t i = 0; i < harpocrates_common::N_ROWS; i++) {
+    const __m256i hi = state[2 * i];
+    const __m256i lo = state[2 * i + 1];
+
+    const __m256i hi_msb6 = shl<6>(hi);
+    const __m256i hi_msb4 = mask(shl<4>(hi), 0b11000000);
+    const __m256i hi_msb2 = mask(shl<2>(hi), 0b11000000);
+    const __m256i hi_msb0 = mask(hi, 0b11000000);
+
+    // step 1
+    const __m256i t1 = lookup(tbl, lo);
+    const __m256i msb6 = mask(t1, 0b11);
+
+    // step 2
+    const __m256i t2 = _mm256_or_si256(hi_msb6, shr<2>(t1));
+    const __m256i t3 = lookup(tbl, t2);
+    const __m256i msb4 = mask(shl<2>(t3), 0b00001100);
+
+    // step 3
+    const __m256i t4 = _mm256_or_si256(hi_msb4, shr<2>(t3));
+    const __m256i t5 = lookup(tbl, t4);
+    const __m256i msb2 = mask(shl<4>(t5), 0b00110000);
+
+    // step 4
+    const __m256i t6 = _mm256_or_si256(hi_msb2, shr<2>(t5));
+    const __m256i t7 = lookup(tbl, t6);
+    const __m256i msb0 = shl<6>(t7);
+
+    // step 5
+    const __m256i t8 = _mm256_or_si256(hi_msb0, shr<2>(t7));
+    const __m256i t9 = lookup(tbl, t8);
+
+    state[2 * i] = t9;
+    state[2 * i + 1] = _mm256_or_si256(_mm256_or_si256(msb0, msb2),
+                                       _mm256_or_si256(msb4, msb6));
+  }
+}
+
+// Transposes 8 x 8 bit matrices, held in each byte lane of eight registers
+// ( i-th register holding i-th row ), using three stages of bit swapping
+static inline void
+transpose_bits(__m256i* const rows)
+{
+  constexpr size_t sft[3] = { 4, 2, 1 };
+  constexpr uint8_t msk[3] = { 0x0f, 0x33, 0x55 };
+
+#if defined __clang__
+#pragma unroll 3
+#elif defined __GNUG__
+#pragma GCC unroll 3
+#endif
+  for (size_t s = 0; s < 3; s++) {
+    const __m256i m = _mm256_set1_epi8(msk[s]);
+
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+    for (size_t i = 0; i < 8; i++) {
+      if ((i & sft[s]) != 0) {
+        continue;
+      }
+
+      const size_t j = i + sft[s];
+      const int n = static_cast<int>(sft[s]);
+
+      const __m256i t0 = _mm256_srli_epi16(rows[j], n);
+      const __m256i t1 = _mm256_and_si256(_mm256_xor_si256(rows[i], t0), m);
+
+      rows[i] = _mm256_xor_si256(rows[i], t1);
+      rows[j] = _mm256_xor_si256(rows[j], _mm256_slli_epi16(t1, n));
+    }
+  }
+}
+
+// Column substitution of byte-sliced state matrices, which is same as
+// `harpocrates_utils::column_substitution`
+static inline void
+column_substitution(__m256i* const __restrict state,
+                    const __m256i* const __restrict tbl)
+{
+  __m256i hi[8];
+  __m256i lo[8];
+
+  for (size_t i = 0; i < harpocrates_common::N_ROWS; i++) {
+    hi[i] = state[2 * i];
+    lo[i] = state[2 * i + 1];
+  }
+
+  transpose_bits(hi);
+  transpose_bits(lo);
+
+  for (size_t i = 0; i < 8; i++) {
+    hi[i] = lookup(tbl, hi[i]);
+    lo[i] = lookup(tbl, lo[i]);
+  }
+
+  transpose_bits(hi);
+  transpose_bits(lo);
+
+  for (size_t i = 0; i < harpocrates_common::N_ROWS; i++) {
+    state[2 * i] = hi[i];
+    state[2 * i + 1] = lo[i];
+  }
+}
+
+// Adds round constants into byte-sliced state matrices
+static inline void
+add_rc(__m256i* const state, const size_t r_idx)
+{
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+  for (size_t i = 0; i < harpocrates_common::N_ROWS; i++) {
+    const uint16_t rc = std::rotl(harpocrates_common::RC[i], r_idx << 1);
+
+    const __m256i rc_hi = _mm256_set1_epi8(static_cast<char>(rc >> 8));
+    const __m256i rc_lo = _mm256_set1_epi8(static_cast<char>(rc));
+
+    state[2 * i] = _mm256_xor_si256(state[2 * i], rc_hi);
+    state[2 * i + 1] = _mm256_xor_si256(state[2 * i + 1], rc_lo);
+  }
+}
+
+// Loads 32 message blocks into byte-sliced form
+static inline void
+load_blocks(const uint8_t* const __restrict blocks,
+            __m256i* const __restrict state)
+{
+  __m128i mat[2][16];
+
+  for (size_t h = 0; h < 2; h++) {
+    for (size_t i = 0; i < 16; i++) {
+      const size_t off = (h * 16 + i) * harpocrates_common::BLOCK_LEN;
+      const __m128i* const ptr = reinterpret_cast<const __m128i*>(blocks + off);
+      mat[h][i] = _mm_loadu_si128(ptr);
+    }
+
+    harpocrates_simd::transpose16x16(mat[h]);
+  }
+
+  for (size_t i = 0; i < harpocrates_common::BLOCK_LEN; i++) {
+    state[i] = _mm256_set_m128i(mat[1][i], mat[0][i]);
+  }
+}
+
+// Stores byte-sliced state matrices back as 32 message blocks
+static inline void
+store_blocks(const __m256i* const __restrict state,
+             uint8_t* const __restrict blocks)
+{
+  __m128i mat[2][16];
+
+  for (size_t i = 0; i < harpocrates_common::BLOCK_LEN; i++) {
+    mat[0][i] = _mm256_castsi256_si128(state[i]);
+    mat[1][i] = _mm256_extracti128_si256(state[i], 1);
+  }
+
+  for (size_t h = 0; h < 2; h++) {
+    harpocrates_simd::transpose16x16(mat[h]);
+
+    for (size_t i = 0; i < 16; i++) {
+      const size_t off = (h * 16 + i) * harpocrates_common::BLOCK_LEN;
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(blocks + off), mat[h][i]);
+    }
+  }
+}
+
+// Encrypts 32 consecutive message blocks, using look up table, loaded into
+// registers using `load_lut`
+static inline void
+encrypt_lanes(const __m256i* const __restrict tbl, // look up table
+              const uint8_t* const txt,            // input plain text
+              uint8_t* const enc                   // output encrypted bytes
+)
+{
+  __m256i state[harpocrates_common::BLOCK_LEN];
+
+  load_blocks(txt, state);
+
+  for (size_t i = 0; i < harpocrates_common::N_ROUNDS; i++) {
+    left_to_right_convoluted_substitution(state, tbl);
+    add_rc(state, i);
+    column_substitution(state, tbl);
+    right_to_left_convoluted_substitution(state, tbl);
+  }
+
+  store_blocks(state, enc);
+}
+
+// Decrypts 32 consecutive encrypted message blocks, using inverse look up
+// table, loaded into registers using `load_lut`
+static inline void
+decrypt_lanes(const __m256i* const __restrict inv_tbl, // inverse look up table
+              const uint8_t* const enc,                // input encrypted bytes
+              uint8_t* const dec                       // output decrypted bytes
+)
+{
+  __m256i state[harpocrates_common::BLOCK_LEN];
+
+  load_blocks(enc, state);
+
+  for (size_t i = 0; i < harpocrates_common::N_ROUNDS; i++) {
+    left_to_right_convoluted_substitution(state, inv_tbl);
+    column_substitution(state, inv_tbl);
+    add_rc(state, harpocrates_common::N_ROUNDS - (i + 1));
+    right_to_left_convoluted_substitution(state, inv_tbl);
+  }
+
+  store_blocks(state, dec);
+}
+
+// Re-encrypts 32 consecutive message blocks, encrypted under old look up table,
+// under new look up table, by running decryption rounds & then encryption
+// rounds on same byte-sliced state, using both tables, loaded into registers
+// using `load_lut`
+static inline void
+transcrypt_lanes(const __m256i* const __restrict inv_tbl, // old inverse table
+                 const __m256i* const __restrict tbl,     // new look up table
+                 const uint8_t* const enc,                // encrypted bytes
+                 uint8_t* const out                       // re-encrypted bytes
+)
+{
+  __m256i state[harpocrates_common::BLOCK_LEN];
+
+  load_blocks(enc, state);
+
+  for (size_t i = 0; i < harpocrates_common::N_ROUNDS; i++) {
+    left_to_right_convoluted_substitution(state, inv_tbl);
+    column_substitution(state, inv_tbl);
+    add_rc(state, harpocrates_common::N_ROUNDS - (i + 1));
+    right_to_left_convoluted_substitution(state, inv_tbl);
+  }
+
+  for (size_t i = 0; i < harpocrates_common::N_ROUNDS; i++) {
+    left_to_right_convoluted_substitution(state, tbl);
+    add_rc(state, i);
+    column_substitution(state, tbl);
+    right_to_left_convoluted_substitution(state, tbl);
+  }
+
+  store_blocks(state, out);
+}
+
+// Given N -many consecutive 16 -bytes message blocks & look up table ( read
+// `lut` ), this routine encrypts all of them, 32 blocks at a time, while
+// trailing blocks are zero padded & encrypted together
+//
+// Computes same output as `harpocrates::encrypt_blocks`; `txt` and `enc` may
+// point to same memory ( i.e. in-place encryption )
+static inline void
+encrypt_blocks(const uint8_t* const __restrict lut, // look up table
+               const uint8_t* const txt,            // input plain text
+               uint8_t* const enc,                  // output encrypted bytes
+               const size_t n_blocks                // # -of message blocks
+)
+{
+  constexpr size_t chunk_len = N_LANES * harpocrates_common::BLOCK_LEN;
+
+  __m256i tbl[16];
+  load_lut(lut, tbl);
+
+  const size_t n_chunks = n_blocks / N_LANES;
+
+  for (size_t i = 0; i < n_chunks; i++) {
+    const size_t off = i * chunk_len;
+    encrypt_lanes(tbl, txt + off, enc + off);
+  }
+
+  const size_t off = n_chunks * chunk_len;
+  const size_t rem = n_blocks * harpocrates_common::BLOCK_LEN - off;
+
+  if (rem > 0) {
+    uint8_t buf[chunk_len];
+
+    std::memset(buf, 0, chunk_len);
+    std::memcpy(buf, txt + off, rem);
+    encrypt_lanes(tbl, buf, buf);
+    std::memcpy(enc + off, buf, rem);
+  }
+}
+
+// Given N -many consecutive 16 -bytes encrypted message blocks & inverse look
+// up table ( read `inv_lut` ), this routine decrypts all of them, 32 blocks at
+// a time, while trailing blocks are zero padded & decrypted together
+//
+// Computes same output as `harpocrates::decrypt_blocks`; `enc` and `dec` may
+// point to same memory ( i.e. in-place decryption )
+static inline void
+decrypt_blocks(const uint8_t* const __restrict inv_lut, // inverse look up table
+               const uint8_t* const enc,                // input encrypted bytes
+               uint8_t* const dec,                      // decrypted bytes
+               const size_t n_blocks                    // # -of message blocks
+)
+{
+  constexpr size_t chunk_len = N_LANES * harpocrates_common::BLOCK_LEN;
+
+  __m256i inv_tbl[16];
+  load_lut(inv_lut, inv_tbl);
+
+  const size_t n_chunks = n_blocks / N_LANES;
+
+  for (size_t i = 0; i < n_chunks; i++) {
+    const size_t off = i * chunk_len;
+    decrypt_lanes(inv_tbl, enc + off, dec + off);
+  }
+
+  const size_t off = n_chunks * chunk_len;
+  const size_t rem = n_blocks * harpocrates_common::BLOCK_LEN - off;
+
+  if (rem > 0) {
+    uint8_t buf[chunk_len];
+
+    std::memset(buf, 0, chunk_len);
+    std::memcpy(buf, enc + off, rem);
+    decrypt_lanes(inv_tbl, buf, buf);
+    std::memcpy(dec + off, buf, rem);
+  }
+}
+
+// Given N -many consecutive 16 -bytes message blocks, encrypted under old look
+// up table, this routine re-encrypts all of them under new look up table, 32
+// blocks at a time, while trailing blocks are zero padded & re-encrypted
+// together
+//
+// Computes same output as `harpocrates::transcrypt_blocks`; `enc` and `out`
+// may point to same memory ( i.e. in-place )
+static inline void
+transcrypt_blocks(const uint8_t* const __restrict inv_lut, // old inverse table
+                  const uint8_t* const __restrict lut,     // new look up table
+                  const uint8_t* const enc,                // encrypted bytes
+                  uint8_t* const out,                      // re-encrypted bytes
+                  const size_t n_blocks                    // # -of blocks
+)
+{
+  constexpr size_t chunk_len = N_LANES * harpocrates_common::BLOCK_LEN;
+
+  __m256i inv_tbl[16];
+  __m256i tbl[16];
+
+  load_lut(inv_lut, inv_tbl);
+  load_lut(lut, tbl);
+
+  const size_t n_chunks = n_blocks / N_LANES;
+
+  for (size_t i = 0; i < n_chunks; i++) {
+    const size_t off = i * chunk_len;
+    transcrypt_lanes(inv_tbl, tbl, enc + off, out + off);
+  }
+
+  const size_t off = n_chunks * chunk_len;
+  const size_t rem = n_blocks * harpocrates_common::BLOCK_LEN - off;
+
+  if (rem > 0) {
+    uint8_t buf[chunk_len];
+
+    std::memset(buf, 0, chunk_len);
+    std::memcpy(buf, enc + off, rem);
+    transcrypt_lanes(inv_tbl, tbl, buf, buf);
+    std::memcpy(out + off, buf, rem);
+  }
+}
+
+}
+
+#if defined __clang__
+#pragma clang attribute pop
+#elif defined __GNUG__
+#pragma GCC pop_options
+#endif
+
+#if defined __clang__
+#pragma clang attribute push(                                                \
+  __attribute__((target("avx512f,avx512bw,avx512vbmi"))),                    \
+  apply_to = function)
+#elif defined __GNUG__
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512bw,avx512vbmi")
+#endif
+
+// Harpocrates cipher, vectorized using AVX-512, processing 64 message blocks at
+// a time, where 256 -bytes look up table is kept in four 512 -bit registers,
+// so that a look up is two VPERMI2B instructions ( each indexing into 128
+// -bytes of table ), whose results are selected using bit 7 of index
+namespace harpocrates_simd::avx512 {
+
+// # -of message blocks processed in parallel
+constexpr size_t N_LANES = 64ul;
+
+// Loads 256 -bytes look up table into four 512 -bit registers
+static inline void
+load_lut(const uint8_t* const __restrict lut, __m512i* const __restrict tbl)
+{
+  for (size_t i = 0; i < 4; i++) {
+    tbl[i] = _mm512_loadu_si512(reinterpret_cast<const __m512i*>(lut) + i);
+  }
+}
+
+// Substitutes each of 64 bytes in `idx`, using 256 -bytes look up table,
+// loaded using `load_lut`
+static inline __m512i
+lookup(const __m512i* const tbl, const __m512i idx)
+{
+  const __m512i lo = _mm512_permutex2var_epi8(tbl[0], idx, tbl[1]);
+  const __m512i hi = _mm512_permutex2var_epi8(tbl[2], idx, tbl[3]);
+  const __mmask64 sel = _mm512_movepi8_mask(idx);
+
+  return _mm512_mask_blend_epi8(sel, lo, hi);
+}
+
+// Shifts each byte left by `n` bit places
+template<const int n>
+static inline __m512i
+shl(const __m512i x)
+{
+  constexpr uint8_t m = static_cast<uint8_t>(0xff << n);
+  return _mm512_and_si512(_mm512_slli_epi16(x, n), _mm512_set1_epi8(m));
+}
+
+// Shifts each byte right by `n` bit places
+template<const int n>
+static inline __m512i
+shr(const __m512i x)
+{
+  constexpr uint8_t m = static_cast<uint8_t>(0xff >> n);
+  return _mm512_and_si512(_mm512_srli_epi16(x, n), _mm512_set1_epi8(m));
+}
+
+// Bitwise AND of each byte with 8 -bit constant
+static inline __m512i
+mask(const __m512i x, const uint8_t m)
+{
+  return _mm512_and_si512(x, _mm512_set1_epi8(m));
+}
+
+// Left to right convoluted substitution of byte-sliced state matrices, which
+// is same as `harpocrates_utils::left_to_right_convoluted_substitution`
+static inline void
+left_to_right_convoluted_substitution(__m512i* const __restrict state,
+                                      const __m512i* const __restrict tbl)
+{
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+  for (size_t i = 0; i < harpocrates_common::N_ROWS; i++) {
+    const __m512i hi = state[2 * i];
+    const __m512i lo = state[2 * i + 1];
+
+    const __m512i lo_msb0 = shr<6>(lo);
+    const __m512i lo_msb2 = mask(shr<4>(lo), 0b11);
+    const __m512i lo_msb4 = mask(shr<2>(lo), 0b11);
+    const __m512i lo_msb6 = mask(lo, 0b11);
+
+    // step 1
+    const __m512i t1 = lookup(tbl, hi);
+    const __m512i msb0 = mask(t1, 0b11000000);
+
+    // step 2
+    const __m512i t2 = _mm512_or_si512(shl<2>(t1), lo_msb0);
+    const __m512i t3 = lookup(tbl, t2);
+    const __m512i msb2 = mask(shr<2>(t3), 0b00110000);
+
+    // step 3
+    const __m512i t4 = _mm512_or_si512(shl<2>(t3), lo_msb2);
+    const __m512i t5 = lookup(tbl, t4);
+    const __m512i msb4 = mask(shr<4>(t5), 0b00001100);
+
+    // step 4
+    const __m512i t6 = _mm512_or_si512(shl<2>(t5), lo_msb4);
+    const __m512i t7 = lookup(tbl, t6);
+    const __m512i msb6 = shr<6>(t7);
+
+    // step 5
+    const __m512i t8 = _mm512_or_si512(shl<2>(t7), lo_msb6);
+    const __m512i t9 = lookup(tbl, t8);
+
+    state[2 * i] = _mm512_or_si512(_mm512_or_si512(msb0, msb2),
+                                   _mm512_or_si512(msb4, msb6));
+    state[2 * i + 1] = t9;
+  }
+}
+
+// Right to left convoluted substitution of byte-sliced state matrices, which
+// is same as `harpocrates_utils::right_to_left_convoluted_substitution`
+static inline void
+right_to_left_convoluted_substitution(__m512i* const __restrict state,
+                                      const __m512i* const __restrict tbl)
+{
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+  for (size_t i = 0; i < harpocrates_common::N_ROWS; i++) {
+    const __m512i hi = state[2 * i];
+    const __m512i lo = state[2 * i + 1];
+
+    const __m512i hi_msb6 = shl<6>(hi);
+    const __m512i hi_msb4 = mask(shl<4>(hi), 0b11000000);
+    const __m512i hi_msb2 = mask(shl<2>(hi), 0b11000000);
+    const __m512i hi_msb0 = mask(hi, 0b11000000);
+
+    // step 1
+    const __m512i t1 = lookup(tbl, lo);
+    const __m512i msb6 = mask(t1, 0b11);
+
+    // step 2
+    const __m512i t2 = _mm512_or_si512(hi_msb6, shr<2>(t1));
+    const __m512i t3 = lookup(tbl, t2);
+    const __m512i msb4 = mask(shl<2>(t3), 0b00001100);
+
+    // step 3
+    const __m512i t4 = _mm512_or_si512(hi_msb4, shr<2>(t3));
+    const __m512i t5 = lookup(tbl, t4);
+    const __m512i msb2 = mask(shl<4>(t5), 0b00110000);
+
+    // step 4
+    const __m512i t6 = _mm512_or_si512(hi_msb2, shr<2>(t5));
+    const __m512i t7 = lookup(tbl, t6);
+    const __m512i msb0 = shl<6>(t7);
+
+    // step 5
+    const __m512i t8 = _mm512_or_si512(hi_msb0, shr<2>(t7));
+    const __m512i t9 = lookup(tbl, t8);
+
+    state[2 * i] = t9;
+    state[2 * i + 1] = _mm512_or_si512(_mm512_or_si512(msb0, msb2),
+                                       _mm512_or_si512(msb4, msb6));
+  }
+}
+
+// Transposes 8 x 8 bit matrices, held in each byte lane of eight registers
+// ( i-th register holding i-th row ), using three stages of bit swapping
+static inline void
+transpose_bits(__m512i* const rows)
+{
+  constexpr size_t sft[3] = { 4, 2, 1 };
+  constexpr uint8_t msk[3] = { 0x0f, 0x33, 0x55 };
+
+#if defined __clang__
+#pragma unroll 3
+#elif defined __GNUG__
+#pragma GCC unroll 3
+#endif
+  for (size_t s = 0; s < 3; s++) {
+    const __m512i m = _mm512_set1_epi8(msk[s]);
+
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+    for (size_t i = 0; i < 8; i++) {
+      if ((i & sft[s]) != 0) {
+        continue;
+      }
+
+      const size_t j = i + sft[s];
+      const unsigned int n = static_cast<unsigned int>(sft[s]);
+
+      const __m512i t0 = _mm512_srli_epi16(rows[j], n);
+      const __m512i t1 = _mm512_and_si512(_mm512_xor_si512(rows[i], t0), m);
+
+      rows[i] = _mm512_xor_si512(rows[i], t1);
+      rows[j] = _mm512_xor_si512(rows[j], _mm512_slli_epi16(t1, n));
+    }
+  }
+}
+
+// Column substitution of byte-sliced state matrices, which is same as
+// `harpocrates_utils::column_substitution`
+static inline void
+column_substitution(__m512i* const __restrict state,
+                    const __m512i* const __restrict tbl)
+{
+  __m512i hi[8];
+  __m512i lo[8];
+
+  for (size_t i = 0; i < harpocrates_common::N_ROWS; i++) {
+    hi[i] = state[2 * i];
+    lo[i] = state[2 * i + 1];
+  }
+
+  transpose_bits(hi);
+  transpose_bits(lo);
+
+  for (size_t i = 0; i < 8; i++) {
+    hi[i] = lookup(tbl, hi[i]);
+    lo[i] = lookup(tbl, lo[i]);
+  }
+
+  transpose_bits(hi);
+  transpose_bits(lo);
+
+  for (size_t i = 0; i < harpocrates_common::N_ROWS; i++) {
+    state[2 * i] = hi[i];
+    state[2 * i + 1] = lo[i];
+  }
+}
+
+// Adds round constants into byte-sliced state matrices
+static inline void
+add_rc(__m512i* const state, const size_t r_idx)
+{
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+  for (size_t i = 0; i < harpocrates_common::N_ROWS; i++) {
+    const uint16_t rc = std::rotl(harpocrates_common::RC[i], r_idx << 1);
+
+    const __m512i rc_hi = _mm512_set1_epi8(static_cast<char>(rc >> 8));
+    const __m512i rc_lo = _mm512_set1_epi8(static_cast<char>(rc));
+
+    state[2 * i] = _mm512_xor_si512(state[2 * i], rc_hi);
+    state[2 * i + 1] = _mm512_xor_si512(state[2 * i + 1], rc_lo);
+  }
+}
+
+// Loads 64 message blocks into byte-sliced form
+static inline void
+load_blocks(const uint8_t* const __restrict blocks,
+            __m512i* const __restrict state)
+{
+  __m128i mat[4][16];
+
+  for (size_t h = 0; h < 4; h++) {
+    for (size_t i = 0; i < 16; i++) {
+      const size_t off = (h * 16 + i) * harpocrates_common::BLOCK_LEN;
+      const __m128i* const ptr = reinterpret_cast<const __m128i*>(blocks + off);
+      mat[h][i] = _mm_loadu_si128(ptr);
+    }
+
+    harpocrates_simd::transpose16x16(mat[h]);
+  }
+
+  for (size_t i = 0; i < harpocrates_common::BLOCK_LEN; i++) {
+    __m512i t = _mm512_castsi128_si512(mat[0][i]);
+
+    t = _mm512_inserti32x4(t, mat[1][i], 1);
+    t = _mm512_inserti32x4(t, mat[2][i], 2);
+    t = _mm512_inserti32x4(t, mat[3][i], 3);
+
+    state[i] = t;
+  }
+}
+
+// Stores byte-sliced state matrices back as 64 message blocks
+static inline void
+store_blocks(const __m512i* const __restrict state,
+             uint8_t* const __restrict blocks)
+{
+  __m128i mat[4][16];
+
+  for (size_t i = 0; i < harpocrates_common::BLOCK_LEN; i++) {
+    __m128i t[4];
+    _mm512_storeu_si512(reinterpret_cast<__m512i*>(t), state[i]);
+
+    mat[0][i] = t[0];
+    mat[1][i] = t[1];
+    mat[2][i] = t[2];
+    mat[3][i] = t[3];
+  }
+
+  for (size_t h = 0; h < 4; h++) {
+    harpocrates_simd::transpose16x16(mat[h]);
+
+    for (size_t i = 0; i < 16; i++) {
+      const size_t off = (h * 16 + i) * harpocrates_common::BLOCK_LEN;
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(blocks + off), mat[h][i]);
+    }
+  }
+}
+
+// Encrypts 64 consecutive message blocks, using look up table, loaded into
+// registers using `load_lut`
+static inline void
+encrypt_lanes(const __m512i* const __restrict tbl, // look up table
+              const uint8_t* const txt,            // input plain text
+              uint8_t* const enc                   // output encrypted bytes
+)
+{
+  __m512i state[harpocrates_common::BLOCK_LEN];
+
+  load_blocks(txt, state);
+
+  for (size_t i = 0; i < harpocrates_common::N_ROUNDS; i++) {
+    left_to_right_convoluted_substitution(state, tbl);
+    add_rc(state, i);
+    column_substitution(state, tbl);
+    right_to_left_convoluted_substitution(state, tbl);
+  }
+
+  store_blocks(state, enc);
+}
+
+// Decrypts 64 consecutive encrypted message blocks, using inverse look up
+// table, loaded into registers using `load_lut`
+static inline void
+decrypt_lanes(const __m512i* const __restrict inv_tbl, // inverse look up table
+              const uint8_t* const enc,                // input encrypted bytes
+              uint8_t* const dec                       // output decrypted bytes
+)
+{
+  __m512i state[harpocrates_common::BLOCK_LEN];
+
+  load_blocks(enc, state);
+
+  for (size_t i = 0; i < harpocrates_common::N_ROUNDS; i++) {
+    left_to_right_convoluted_substitution(state, inv_tbl);
+    column_substitution(state, inv_tbl);
+    add_rc(state, harpocrates_common::N_ROUNDS - (i + 1));
+    right_to_left_convoluted_substitution(state, inv_tbl);
+  }
+
+  store_blocks(state, dec);
+}
+
+// Re-encrypts 64 consecutive message blocks, encrypted under old look up table,
+// under new look up table, by running decryption rounds & then encryption
+// rounds on same byte-sliced state, using both tables, loaded into registers
+// using `load_lut`
+static inline void
+transcrypt_lanes(const __m512i* const __restrict inv_tbl, // old inverse table
+                 const __m512i* const __restrict tbl,     // new look up table
+                 const uint8_t* const enc,                // encrypted bytes
+                 uint8_t* const out                       // re-encrypted bytes
+)
+{
+  __m512i state[harpocrates_common::BLOCK_LEN];
+
+  load_blocks(enc, state);
+
+  for (size_t i = 0; i < harpocrates_common::N_ROUNDS; i++) {
+    left_to_right_convoluted_substitution(state, inv_tbl);
+    column_substitution(state, inv_tbl);
+    add_rc(state, harpocrates_common::N_ROUNDS - (i + 1));
+    right_to_left_convoluted_substitution(state, inv_tbl);
+  }
+
+  for (size_t i = 0; i < harpocrates_common::N_ROUNDS; i++) {
+    left_to_right_convoluted_substitution(state, tbl);
+    add_rc(state, i);
+    column_substitution(state, tbl);
+    right_to_left_convoluted_substitution(state, tbl);
+  }
+
+  store_blocks(state, out);
+}
+
+// Given N -many consecutive 16 -bytes message blocks & look up table ( read
+// `lut` ), this routine encrypts all of them, 64 blocks at a time, while
+// trailing blocks are zero padded & encrypted together
+//
+// Computes same output as `harpocrates::encrypt_blocks`; `txt` and `enc` may
+// point to same memory ( i.e. in-place encryption )
+static inline void
+encrypt_blocks(const uint8_t* const __restrict lut, // look up table
+               const uint8_t* const txt,            // input plain text
+               uint8_t* const enc,                  // output encrypted bytes
+               const size_t n_blocks                // # -of message blocks
+)
+{
+  constexpr size_t chunk_len = N_LANES * harpocrates_common::BLOCK_LEN;
+
+  __m512i tbl[4];
+  load_lut(lut, tbl);
+
+  const size_t n_chunks = n_blocks / N_LANES;
+
+  for (size_t i = 0; i < n_chunks; i++) {
+    const size_t off = i * chunk_len;
+    encrypt_lanes(tbl, txt + off, enc + off);
+  }
+
+  const size_t off = n_chunks * chunk_len;
+  const size_t rem = n_blocks * harpocrates_common::BLOCK_LEN - off;
+
+  if (rem > 0) {
+    uint8_t buf[chunk_len];
+
+    std::memset(buf, 0, chunk_len);
+    std::memcpy(buf, txt + off, rem);
+    encrypt_lanes(tbl, buf, buf);
+    std::memcpy(enc + off, buf, rem);
+  }
+}
+
+// Given N -many consecutive 16 -bytes encrypted message blocks & inverse look
+// up table ( read `inv_lut` ), this routine decrypts all of them, 64 blocks at
+// a time, while trailing blocks are zero padded & decrypted together
+//
+// Computes same output as `harpocrates::decrypt_blocks`; `enc` and `dec` may
+// point to same memory ( i.e. in-place decryption )
+static inline void
+decrypt_blocks(const uint8_t* const __restrict inv_lut, // inverse look up table
+               const uint8_t* const enc,                // input encrypted bytes
+               uint8_t* const dec,                      // decrypted bytes
+               const size_t n_blocks                    // # -of message blocks
+)
+{
+  constexpr size_t chunk_len = N_LANES * harpocrates_common::BLOCK_LEN;
+
+  __m512i inv_tbl[4];
+  load_lut(inv_lut, inv_tbl);
+
+  const size_t n_chunks = n_blocks / N_LANES;
+
+  for (size_t i = 0; i < n_chunks; i++) {
+    const size_t off = i * chunk_len;
+    decrypt_lanes(inv_tbl, enc + off, dec + off);
+  }
+
+  const size_t off = n_chunks * chunk_len;
+  const size_t rem = n_blocks * harpocrates_common::BLOCK_LEN - off;
+
+  if (rem > 0) {
+    uint8_t buf[chunk_len];
+
+    std::memset(buf, 0, chunk_len);
+    std::memcpy(buf, enc + off, rem);
+    decrypt_lanes(inv_tbl, buf, buf);
+    std::memcpy(dec + off, buf, rem);
+  }
+}
+
+// Given N -many consecutive 16 -bytes message blocks, encrypted under old look
+// up table, this routine re-encrypts all of them under new look up table, 64
+// blocks at a time, while trailing blocks are zero padded & re-encrypted
+// together
+//
+// Computes same output as `harpocrates::transcrypt_blocks`; `enc` and `out`
+// may point to same memory ( i.e. in-place )
+static inline void
+transcrypt_blocks(const uint8_t* const __restrict inv_lut, // old inverse table
+                  const uint8_t* const __restrict lut,     // new look up table
+                  const uint8_t* const enc,                // encrypted bytes
+                  uint8_t* const out,                      // re-encrypted bytes
+                  const size_t n_blocks                    // # -of blocks
+)
+{
+  constexpr size_t chunk_len = N_LANES * harpocrates_common::BLOCK_LEN;
+
+  __m512i inv_tbl[4];
+  __m512i tbl[4];
+
+  load_lut(inv_lut, inv_tbl);
+  load_lut(lut, tbl);
+
+  const size_t n_chunks = n_blocks / N_LANES;
+
+  for (size_t i = 0; i < n_chunks; i++) {
+    const size_t off = i * chunk_len;
+    transcrypt_lanes(inv_tbl, tbl, enc + off, out + off);
+  }
+
+  const size_t off = n_chunks * chunk_len;
+  const size_t rem = n_blocks * harpocrates_common::BLOCK_LEN - off;
+
+  if (rem > 0) {
+    uint8_t buf[chunk_len];
+
+    std::memset(buf, 0, chunk_len);
+    std::memcpy(buf, enc + off, rem);
+    transcrypt_lanes(inv_tbl, tbl, buf, buf);
+    std::memcpy(out + off, buf, rem);
+  }
+}
+
+}
+
+#if defined __clang__
+#pragma clang attribute pop
+#elif defined __GNUG__
+#pragma GCC pop_options
+#endif
+
+#endif
@@ -0,0 +1,127 @@
+#pragma once
+#include "harpocrates_ctr.hpp"
+#include "harpocrates_dispatch.hpp"
+#include <algorithm>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, encrypting
+// ( or decrypting ) a stream incrementally, in counter mode ( see
+// `harpocrates_ctr` ), as pieces of arbitrary length arrive ( e.g. socket
+// reads ), so that encrypted bytes can be written out right away, without
+// accumulating whole message in memory
+//
+// As counter mode is length-preserving, each piece is encrypted as soon as
+// it's passed to `update`. Only a small window of keystream ( see `KS_BLOCKS`
+// ) is kept, which is computed ahead of stream, using bulk encryption kernel
+// selected at run time ( see `harpocrates_dispatch` ), so that short pieces
+// neither compute partially consumed block again, nor run bulk kernel on a
+// few blocks. Long pieces are encrypted in batches, same as
+// `harpocrates_ctr::crypt` does.
+namespace harpocrates_stream {
+
+// # -of keystream blocks, which are computed ahead, by single call to bulk
+// encryption routine, so that short pieces don't leave vector lanes of
+// selected kernel idle; it's lane count of widest kernel ( see `MAX_LANES` ),
+// so window isn't of fixed byte length
+constexpr size_t KS_BLOCKS = harpocrates_dispatch::MAX_LANES;
+
+// Stream encryptor ( which is also decryptor ), holding look up table, nonce,
+// current byte offset into stream & keystream computed ahead of it
+//
+// Look up table must outlive stream encryptor. Same nonce must never be used
+// for encrypting two different streams, under same look up table.
+class ctr_stream
+{
+public:
+  // Starts encrypting stream at given byte offset, under given look up table &
+  // 8 -bytes nonce
+  ctr_stream(const uint8_t* const __restrict lut,
+             const uint8_t* const __restrict nonce,
+             const uint64_t offset = 0)
+    : lut(lut)
+    , pos(offset)
+    , start(offset)
+  {
+    std::memcpy(this->nonce, nonce, harpocrates_ctr::NONCE_LEN);
+  }
+
+  ~ctr_stream() { wipe(); }
+
+  ctr_stream(const ctr_stream&) = delete;
+  ctr_stream& operator=(const ctr_stream&) = delete;
+
+  // Encrypts ( or decrypts ) next N bytes of stream, writing them to `out`;
+  // `in` and `out` may point to same memory ( i.e. in-place encryption )
+  void update(const uint8_t* const in, uint8_t* const out, const size_t len)
+  {
+    constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+    constexpr size_t ks_len = KS_BLOCKS * blk_len;
+
+    size_t done = 0;
+
+    while (done < len) {
+      // consume keystream computed ahead
+      if (ks_valid && pos >= ks_beg && pos - ks_beg < ks_len) {
+        const size_t ks_off = static_cast<size_t>(pos - ks_beg);
+        const size_t take = std::min(ks_len - ks_off, len - done);
+
+        for (size_t i = 0; i < take; i++) {
+          out[done + i] = in[done + i] ^ ks[ks_off + i];
+        }
+
+        done += take;
+        pos += take;
+        continue;
+      }
+
+      // long piece, starting at block boundary, is encrypted in batches
+      const size_t full = ((len - done) / ks_len) * ks_len;
+      if (pos % blk_len == 0 && full > 0) {
+        harpocrates_ctr::crypt(lut, nonce, pos, in + done, out + done, full);
+
+        done += full;
+        pos += full;
+        continue;
+      }
+
+      refill(pos / blk_len);
+    }
+  }
+
+  // Ends stream, erasing keystream computed ahead, returning # -of bytes
+  // encrypted since stream was started; stream must not be updated afterwards
+  uint64_t finalize()
+  {
+    wipe();
+    return pos - start;
+  }
+
+  // Byte offset of next byte of stream
+  uint64_t position() const { return pos; }
+
+private:
+  // Computes KS_BLOCKS keystream blocks, starting from i-th one
+  void refill(const uint64_t ctr)
+  {
+    harpocrates_ctr::counter_blocks(nonce, ctr, ks, KS_BLOCKS);
+    harpocrates_dispatch::encrypt_blocks(lut, ks, ks, KS_BLOCKS);
+
+    ks_beg = ctr * harpocrates_common::BLOCK_LEN;
+    ks_valid = true;
+  }
+
+  void wipe()
+  {
+    harpocrates_utils::secure_zero(ks, sizeof(ks));
+    ks_valid = false;
+  }
+
+  const uint8_t* lut;
+  uint8_t nonce[harpocrates_ctr::NONCE_LEN];
+  uint8_t ks[KS_BLOCKS * harpocrates_common::BLOCK_LEN] = {};
+  uint64_t ks_beg = 0;
+  bool ks_valid = false;
+  uint64_t pos;
+  uint64_t start;
+};
+
+}
@@ -0,0 +1,855 @@
+#pragma once
+#include "harpocrates_ctr.hpp"
+#include <atomic>
+#include <cerrno>
+#include <coroutine>
+#include <cstdlib>
+#include <exception>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <linux/io_uring.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, used for
+// encrypting/ decrypting files ( or block devices ) in counter mode, through
+// an asynchronous pipeline, which overlaps reads, encryption & writes
+//
+// It's meant for files, which can't be memory mapped ( see `harpocrates_file`
+// ) e.g. those opened with O_DIRECT. Reads & writes are submitted to kernel
+// using io_uring ( talking to it using raw system calls, so no liburing is
+// needed ), while a bounded number of aligned buffers are kept in flight, each
+// one owned by a coroutine, which repeatedly claims next chunk of file, reads
+// it, encrypts it & writes it back. As keystream of counter mode can be
+// computed at any byte offset, chunks are independent, so while one buffer is
+// being encrypted, I/O of all others is progressing in kernel.
+//
+// Usage: `co_await crypt_file(ring, ...)` from some coroutine, or drive it
+// from ordinary code using `sync_wait`. `crypt_file_sync` is a synchronous
+// pread/ encrypt/ pwrite loop, for hosts where io_uring isn't available.
+namespace harpocrates_uring {
+
+// Alignment of I/O buffers, offsets & lengths, as required by O_DIRECT
+constexpr size_t IO_ALIGN = 4096ul;
+
+// Default byte length of each I/O buffer ( i.e. 1 MB )
+constexpr size_t BUF_LEN = 1ul << 20;
+
+// Default # -of buffers kept in flight
+constexpr size_t QUEUE_DEPTH = 8ul;
+
+// Lazily started coroutine, producing a value of type T, which resumes its
+// awaiter ( if any ) once it's done
+//
+// Awaiting task starts it, unless it was already started using `start`, in
+// which case awaiter is only resumed, once task is done.
+template<typename T>
+class task
+{
+public:
+  struct promise_type
+  {
+    T value{};
+    std::coroutine_handle<> cont = std::noop_coroutine();
+    bool started = false;
+
+    task get_return_object()
+    {
+      return task(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    auto final_suspend() noexcept
+    {
+      struct final_awaiter
+      {
+        bool await_ready() noexcept { return false; }
+        std::coroutine_handle<> await_suspend(
+          std::coroutine_handle<promise_type> h) noexcept
+        {
+          return h.promise().cont;
+        }
+        void await_resume() noexcept {}
+      };
+
+      return final_awaiter{};
+    }
+
+    void return_value(T v) { value = v; }
+    void unhandled_exception() { std::terminate(); }
+  };
+
+  task(task&& other) noexcept
+    : h(other.h)
+  {
+    other.h = nullptr;
+  }
+
+  task(const task&) = delete;
+  task& operator=(const task&) = delete;
+
+  ~task()
+  {
+    if (h) {
+      h.destroy();
+    }
+  }
+
+  // Runs coroutine, until it first suspends ( or finishes )
+  void start()
+  {
+    h.promise().started = true;
+    h.resume();
+  }
+
+  bool done() const { return h.done(); }
+  T result() const { return h.promise().value; }
+
+  bool await_ready() const { return h.done(); }
+
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> cont)
+  {
+    h.promise().cont = cont;
+    if (h.promise().started) {
+      return std::noop_coroutine();
+    }
+
+    h.promise().started = true;
+    return h;
+  }
+
+  T await_resume() const { return h.promise().value; }
+
+private:
+  explicit task(std::coroutine_handle<promise_type> h)
+    : h(h)
+  {}
+
+  std::coroutine_handle<promise_type> h;
+};
+
+class ring;
+
+// Awaitable read or write request, which suspends awaiting coroutine, until
+// kernel completes it, resuming with result of request ( i.e. # -of bytes
+// read/ written or negated errno ); request made on failed ring completes
+// immediately, with negated errno, which made ring fail
+struct io_op
+{
+  io_op(ring* const r,
+        const uint8_t opcode,
+        const int fd,
+        uint8_t* const buf,
+        const size_t len,
+        const uint64_t off)
+    : r(r)
+    , opcode(opcode)
+    , fd(fd)
+    , buf(buf)
+    , len(static_cast<uint32_t>(len))
+    , off(off)
+  {}
+
+  ring* r;
+  uint8_t opcode;
+  int fd;
+  uint8_t* buf;
+  uint32_t len;
+  uint64_t off;
+
+  int32_t res = 0;
+  std::coroutine_handle<> h;
+
+  // links of ring's list of requests, not yet completed
+  io_op* prev = nullptr;
+  io_op* next = nullptr;
+
+  bool await_ready() const { return false; }
+  bool await_suspend(std::coroutine_handle<> h);
+  int32_t await_resume() const { return res; }
+};
+
+// Submission & completion queues of an io_uring instance, shared with kernel
+// through memory mappings; not thread-safe, it's meant to be driven by single
+// thread, which also runs all coroutines awaiting its requests
+class ring
+{
+public:
+  ring() = default;
+  ring(const ring&) = delete;
+  ring& operator=(const ring&) = delete;
+
+  ~ring() { close(); }
+
+  // Sets up io_uring instance, with ( at least ) `entries` submission queue
+  // entries; returns false, leaving cause in `errno`, when kernel doesn't
+  // support io_uring ( or it's disallowed )
+  bool open(const uint32_t entries = 2 * QUEUE_DEPTH)
+  {
+    close();
+
+    io_uring_params p;
+    std::memset(&p, 0, sizeof(p));
+
+    fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+    if (fd < 0) {
+      fd = -1;
+      return false;
+    }
+
+    sq_len = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+    cq_len = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+    sqes_len = p.sq_entries * sizeof(io_uring_sqe);
+
+    const bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) {
+      sq_len = std::max(sq_len, cq_len);
+      cq_len = sq_len;
+    }
+
+    sq_ptr = map(sq_len, IORING_OFF_SQ_RING);
+    cq_ptr = single ? sq_ptr : map(cq_len, IORING_OFF_CQ_RING);
+    sqes = static_cast<io_uring_sqe*>(map(sqes_len, IORING_OFF_SQES));
+
+    if (sq_ptr == nullptr || cq_ptr == nullptr || sqes == nullptr) {
+      const int err = errno;
+      close();
+      errno = err;
+
+      return false;
+    }
+
+    uint8_t* const sq = static_cast<uint8_t*>(sq_ptr);
+    uint8_t* const cq = static_cast<uint8_t*>(cq_ptr);
+
+    sq_head = reinterpret_cast<uint32_t*>(sq + p.sq_off.head);
+    sq_tail = reinterpret_cast<uint32_t*>(sq + p.sq_off.tail);
+    sq_array = reinterpret_cast<uint32_t*>(sq + p.sq_off.array);
+    sq_mask = *reinterpret_cast<uint32_t*>(sq + p.sq_off.ring_mask);
+    sq_entries = p.sq_entries;
+
+    cq_head = reinterpret_cast<uint32_t*>(cq + p.cq_off.head);
+    cq_tail = reinterpret_cast<uint32_t*>(cq + p.cq_off.tail);
+    cq_mask = *reinterpret_cast<uint32_t*>(cq + p.cq_off.ring_mask);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+
+    return true;
+  }
+
+  // Unmaps queues & closes io_uring instance, if it's open
+  void close()
+  {
+    if (sqes != nullptr) {
+      ::munmap(sqes, sqes_len);
+    }
+    if (cq_ptr != nullptr && cq_ptr != sq_ptr) {
+      ::munmap(cq_ptr, cq_len);
+    }
+    if (sq_ptr != nullptr) {
+      ::munmap(sq_ptr, sq_len);
+    }
+    if (fd >= 0) {
+      ::close(fd);
+    }
+
+    fd = -1;
+    sq_ptr = cq_ptr = nullptr;
+    sqes = nullptr;
+    pending = 0;
+    ops = nullptr;
+    err = 0;
+  }
+
+  bool is_open() const { return fd >= 0; }
+
+  // Errno, which made io_uring_enter fail ( or 0, while ring is usable )
+  int error() const { return err; }
+
+  // Queues request, whose completion resumes awaiting coroutine; requests are
+  // handed over to kernel, in next call to `run_once`
+  //
+  // Returns false, without queueing request, when ring has failed ( or fails
+  // now, while making room in full queue ), leaving negated errno in `op->res`
+  bool push(io_op* const op)
+  {
+    const uint32_t tail = *sq_tail;
+
+    // queue is full; make kernel consume queued entries
+    while (err == 0 &&
+           tail - std::atomic_ref(*sq_head).load(std::memory_order_acquire) ==
+             sq_entries) {
+      enter(0);
+    }
+
+    if (err != 0) {
+      op->res = -err;
+      return false;
+    }
+
+    const uint32_t idx = tail & sq_mask;
+    io_uring_sqe* const sqe = sqes + idx;
+
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = op->opcode;
+    sqe->fd = op->fd;
+    sqe->addr = reinterpret_cast<uint64_t>(op->buf);
+    sqe->len = op->len;
+    sqe->off = op->off;
+    sqe->user_data = reinterpret_cast<uint64_t>(op);
+
+    sq_array[idx] = idx;
+    std::atomic_ref(*sq_tail).store(tail + 1, std::memory_order_release);
+    pending++;
+
+    link(op);
+    return true;
+  }
+
+  // Submits queued requests, waits until at least one request completes &
+  // resumes coroutines awaiting all completed requests
+  //
+  // When io_uring_enter fails ( other than being interrupted ), ring is marked
+  // failed & all requests, not yet completed, are resumed with negated errno,
+  // so that their coroutines can unwind, reporting failure
+  void run_once()
+  {
+    if (err == 0) {
+      enter(1);
+    }
+
+    uint32_t head = *cq_head;
+    while (head != std::atomic_ref(*cq_tail).load(std::memory_order_acquire)) {
+      const io_uring_cqe* const cqe = cqes + (head & cq_mask);
+      io_op* const op = reinterpret_cast<io_op*>(cqe->user_data);
+
+      op->res = cqe->res;
+      head++;
+      std::atomic_ref(*cq_head).store(head, std::memory_order_release);
+
+      unlink(op);
+      op->h.resume();
+    }
+
+    // resumed coroutines may only queue new requests on failed ring, which
+    // completes them immediately, so this drains list
+    while (err != 0 && ops != nullptr) {
+      io_op* const op = ops;
+
+      op->res = -err;
+      unlink(op);
+      op->h.resume();
+    }
+  }
+
+private:
+  void* map(const size_t len, const uint64_t off)
+  {
+    void* const addr = ::mmap(nullptr,
+                              len,
+                              PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE,
+                              fd,
+                              static_cast<off_t>(off));
+    return addr == MAP_FAILED ? nullptr : addr;
+  }
+
+  // Hands over queued requests to kernel, waiting for `min_complete` requests
+  // to complete; failure, other than interruption, marks ring failed, after
+  // which no more requests are handed over
+  void enter(const uint32_t min_complete)
+  {
+    const uint32_t flags = min_complete > 0 ? IORING_ENTER_GETEVENTS : 0u;
+    const long ret =
+      ::syscall(__NR_io_uring_enter, fd, pending, min_complete, flags, 0, 0);
+
+    if (ret >= 0) {
+      pending -= static_cast<uint32_t>(ret);
+    } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      err = errno;
+    }
+  }
+
+  // Adds request to ( or removes it from ) list of requests, not yet completed
+  void link(io_op* const op)
+  {
+    op->prev = nullptr;
+    op->next = ops;
+    if (ops != nullptr) {
+      ops->prev = op;
+    }
+    ops = op;
+  }
+
+  void unlink(io_op* const op)
+  {
+    if (op->prev != nullptr) {
+      op->prev->next = op->next;
+    } else {
+      ops = op->next;
+    }
+    if (op->next != nullptr) {
+      op->next->prev = op->prev;
+    }
+  }
+
+  int fd = -1;
+
+  void* sq_ptr = nullptr;
+  void* cq_ptr = nullptr;
+  size_t sq_len = 0;
+  size_t cq_len = 0;
+  size_t sqes_len = 0;
+
+  uint32_t* sq_head = nullptr;
+  uint32_t* sq_tail = nullptr;
+  uint32_t* sq_array = nullptr;
+  uint32_t sq_mask = 0;
+  uint32_t sq_entries = 0;
+  io_uring_sqe* sqes = nullptr;
+
+  uint32_t* cq_head = nullptr;
+  uint32_t* cq_tail = nullptr;
+  uint32_t cq_mask = 0;
+  io_uring_cqe* cqes = nullptr;
+
+  uint32_t pending = 0;
+  io_op* ops = nullptr;
+  int err = 0;
+};
+
+inline bool
+io_op::await_suspend(std::coroutine_handle<> h)
+{
+  this->h = h;
+  return r->push(this);
+}
+
+// Runs task to completion, driving io_uring instance, on which it submits
+// requests, returning value produced by task
+template<typename T>
+static inline T
+sync_wait(ring& r, task<T>&& t)
+{
+  t.start();
+  while (!t.done()) {
+    r.run_once();
+  }
+
+  return t.result();
+}
+
+// Checks whether file can be read/ written at any offset ( i.e. it's a regular
+// file or block device ), computing its byte length, when it can; pipes,
+// sockets & character devices can only be read/ written sequentially
+static inline bool
+fd_length(const int fd, uint64_t* const len, bool* const seekable = nullptr)
+{
+  struct stat st;
+  if (::fstat(fd, &st) != 0) {
+    return false;
+  }
+
+  const bool blk = S_ISBLK(st.st_mode);
+  const bool reg = S_ISREG(st.st_mode);
+
+  if (seekable != nullptr) {
+    *seekable = blk || reg;
+  }
+
+  if (blk) {
+    return ::ioctl(fd, BLKGETSIZE64, len) == 0;
+  }
+
+  *len = reg ? static_cast<uint64_t>(st.st_size) : 0ul;
+  return true;
+}
+
+// Offset, which makes io_uring read/ write request use ( & advance ) current
+// file position, as required by pipes & other sequential files
+constexpr uint64_t STREAM_OFF = ~0ul;
+
+// State shared by all coroutines, encrypting chunks of same file
+struct job_t
+{
+  ring* r;
+  const uint8_t* lut;
+  const uint8_t* nonce;
+  int in_fd;
+  int out_fd;
+  bool in_seekable;
+  bool out_seekable;
+  uint64_t len;
+  uint64_t next;
+  size_t buf_len;
+  int err;
+};
+
+// Rounds up to next multiple of IO_ALIGN
+static inline size_t
+align_up(const size_t n)
+{
+  return (n + IO_ALIGN - 1) & ~(IO_ALIGN - 1);
+}
+
+// Reads chunk of input file, starting at byte offset `off`, into `buf`,
+// producing # -of bytes read or -1, on failure
+//
+// Chunk of seekable input is of `buf_len` -bytes, unless it's last one & it's
+// read using IO_ALIGN -bytes aligned requests, so that they work on files
+// opened with O_DIRECT. Sequential input ( e.g. pipe ) is read until buffer is
+// full or input is exhausted, so that only last chunk is short & offsets of
+// chunks stay multiples of `buf_len`.
+static inline task<int64_t>
+read_chunk(job_t* const job, uint8_t* const buf, const uint64_t off)
+{
+  const size_t n =
+    job->in_seekable
+      ? static_cast<size_t>(std::min<uint64_t>(job->buf_len, job->len - off))
+      : job->buf_len;
+
+  size_t got = 0;
+  while (got < n) {
+    const size_t want = job->in_seekable ? align_up(n) - got : n - got;
+    const uint64_t at = job->in_seekable ? off + got : STREAM_OFF;
+
+    const int32_t res =
+      co_await io_op(job->r, IORING_OP_READ, job->in_fd, buf + got, want, at);
+
+    if (res == -EINTR || res == -EAGAIN) {
+      continue;
+    }
+    if (res == 0 && !job->in_seekable) {
+      break; // end of input
+    }
+    if (res <= 0) {
+      job->err = res == 0 ? EIO : -res; // file shrank underneath
+      co_return -1;
+    }
+
+    got += static_cast<size_t>(res);
+  }
+
+  co_return static_cast<int64_t>(std::min(got, n));
+}
+
+// Writes N -bytes chunk from `buf` to output file, at byte offset `off`,
+// producing false, on failure
+//
+// Chunk is padded with zeros, to IO_ALIGN -bytes, when output is seekable, so
+// that it works on files opened with O_DIRECT; last chunk may so be written
+// past end of output file, which is truncated by caller. Sequential output (
+// e.g. pipe ) gets exactly N -bytes, at its current position.
+static inline task<bool>
+write_chunk(job_t* const job,
+            uint8_t* const buf,
+            const size_t n,
+            const uint64_t off)
+{
+  if (job->out_seekable) {
+    std::memset(buf + n, 0, align_up(n) - n);
+  }
+
+  size_t put = 0;
+  while (put < n) {
+    const size_t want = job->out_seekable ? align_up(n) - put : n - put;
+    const uint64_t at = job->out_seekable ? off + put : STREAM_OFF;
+
+    const int32_t res =
+      co_await io_op(job->r, IORING_OP_WRITE, job->out_fd, buf + put, want, at);
+
+    if (res == -EINTR || res == -EAGAIN) {
+      continue;
+    }
+    if (res <= 0) {
+      job->err = res == 0 ? EIO : -res;
+      co_return false;
+    }
+
+    put += static_cast<size_t>(res);
+  }
+
+  co_return true;
+}
+
+// Claims next chunk of file ( until none are left ), reads it into `buf`,
+// encrypts it & writes it back at same offset, of output file; used when both
+// files are seekable, so that many chunks can be in flight, in any order
+static inline task<bool>
+crypt_chunks(job_t* const job, uint8_t* const buf)
+{
+  while (job->err == 0 && job->next < job->len) {
+    const uint64_t off = job->next;
+    job->next += std::min<uint64_t>(job->buf_len, job->len - off);
+
+    const int64_t n = co_await read_chunk(job, buf, off);
+    if (n < 0) {
+      co_return false;
+    }
+
+    const size_t len = static_cast<size_t>(n);
+    harpocrates_ctr::crypt(job->lut, job->nonce, off, buf, buf, len);
+
+    if (!co_await write_chunk(job, buf, len, off)) {
+      co_return false;
+    }
+  }
+
+  co_return job->err == 0;
+}
+
+// Encrypts chunks of file one after another, in order, reading next chunk into
+// one of two buffers, while previous one is written from other; used when
+// either file is sequential ( e.g. pipe ), leaving # -of bytes processed in
+// `job->len`
+static inline task<bool>
+crypt_stream(job_t* const job, uint8_t* const bufs)
+{
+  uint8_t* cur = bufs;
+  uint8_t* nxt = bufs + job->buf_len;
+
+  uint64_t off = 0;
+  int64_t n = co_await read_chunk(job, cur, off);
+
+  while (n > 0) {
+    const size_t len = static_cast<size_t>(n);
+    harpocrates_ctr::crypt(job->lut, job->nonce, off, cur, cur, len);
+
+    task<bool> w = write_chunk(job, cur, len, off);
+    w.start();
+
+    const bool more = job->in_seekable ? off + len < job->len
+                                       : len == job->buf_len;
+    const int64_t m = more ? co_await read_chunk(job, nxt, off + len) : 0;
+
+    if (!co_await w || m < 0) {
+      co_return false;
+    }
+
+    off += len;
+    n = m;
+    std::swap(cur, nxt);
+  }
+
+  job->len = off;
+  co_return n == 0;
+}
+
+// Encrypts ( or decrypts ) whole file ( or block device ), in counter mode,
+// given look up table & 8 -bytes nonce, reading from `in_fd` & writing to same
+// offsets of `out_fd`, which may be same as `in_fd` ( i.e. in-place )
+//
+// Up to `depth` buffers, each of `buf_len` -bytes ( a multiple of IO_ALIGN ),
+// are kept in flight. Both files may be opened with O_DIRECT; regular output
+// file is truncated to length of input file, once done. When either file is
+// sequential ( e.g. pipe ), input is read until it's exhausted, through two
+// buffers, so that chunks are read & written in order.
+//
+// Coroutine produces false on failure, leaving cause in `errno`; `lut` and
+// `nonce` must stay alive until it's done.
+static inline task<bool>
+crypt_file(ring& r,                               // open io_uring instance
+           const uint8_t* const __restrict lut,   // look up table
+           const uint8_t* const __restrict nonce, // 8 -bytes nonce
+           const int in_fd,                       // input file
+           const int out_fd,                      // output file
+           const size_t depth = QUEUE_DEPTH,      // # -of buffers in flight
+           const size_t buf_len = BUF_LEN         // bytes per buffer
+)
+{
+  job_t job{ &r, lut, nonce, in_fd, out_fd, false, false, 0, 0, buf_len, 0 };
+
+  uint64_t out_len = 0;
+  if (!fd_length(in_fd, &job.len, &job.in_seekable) ||
+      !fd_length(out_fd, &out_len, &job.out_seekable)) {
+    co_return false;
+  }
+
+  const bool stream = !job.in_seekable || !job.out_seekable;
+  const size_t n_bufs = stream ? 2 : depth;
+
+  uint8_t* const bufs =
+    static_cast<uint8_t*>(std::aligned_alloc(IO_ALIGN, n_bufs * buf_len));
+  if (bufs == nullptr) {
+    errno = ENOMEM;
+    co_return false;
+  }
+
+  if (stream) {
+    co_await crypt_stream(&job, bufs);
+  } else {
+    const uint64_t n_chunks = (job.len + buf_len - 1) / buf_len;
+    const size_t n_lanes =
+      static_cast<size_t>(std::min<uint64_t>(depth, n_chunks));
+
+    // all coroutines are started first, so that each of them has its first
+    // read in flight, before any of them is awaited
+    std::vector<task<bool>> lanes;
+    lanes.reserve(n_lanes);
+
+    for (size_t i = 0; i < n_lanes; i++) {
+      lanes.push_back(crypt_chunks(&job, bufs + i * buf_len));
+      lanes.back().start();
+    }
+    for (auto& lane : lanes) {
+      co_await lane;
+    }
+  }
+
+  std::free(bufs);
+
+  if (job.err != 0) {
+    errno = job.err;
+    co_return false;
+  }
+
+  struct stat st;
+  if (::fstat(out_fd, &st) != 0) {
+    co_return false;
+  }
+  if (S_ISREG(st.st_mode) &&
+      ::ftruncate(out_fd, static_cast<off_t>(job.len)) != 0) {
+    co_return false;
+  }
+
+  co_return true;
+}
+
+// Reads ( when `write` is false ) or writes N -bytes using synchronous system
+// calls, at byte offset `off` of seekable file, or at current position of
+// sequential one, retrying interrupted & partial requests; produces # -of
+// bytes transferred, which is fewer than N only when sequential input is
+// exhausted, or -1, on failure
+template<const bool write>
+static inline int64_t
+transfer(const int fd,
+         uint8_t* const buf,
+         const size_t n,
+         const size_t want_len,
+         const uint64_t off,
+         const bool seekable)
+{
+  size_t done = 0;
+
+  while (done < n) {
+    const size_t want = want_len - done;
+    const off_t at = static_cast<off_t>(off + done);
+
+    ssize_t res = 0;
+    if constexpr (write) {
+      res = seekable ? ::pwrite(fd, buf + done, want, at)
+                     : ::write(fd, buf + done, want);
+    } else {
+      res = seekable ? ::pread(fd, buf + done, want, at)
+                     : ::read(fd, buf + done, want);
+    }
+
+    if (res < 0 && (errno == EINTR || errno == EAGAIN)) {
+      continue;
+    }
+    if (res == 0 && !write && !seekable) {
+      break; // end of input
+    }
+    if (res <= 0) {
+      errno = res == 0 ? EIO : errno;
+      return -1;
+    }
+
+    done += static_cast<size_t>(res);
+  }
+
+  return static_cast<int64_t>(std::min(done, n));
+}
+
+// Encrypts ( or decrypts ) whole file, same as above, but using a synchronous
+// loop, which reads chunk, encrypts it & writes it back, one after another
+//
+// Returns false on failure, leaving cause in `errno`.
+static inline bool
+crypt_file_sync(const uint8_t* const __restrict lut,   // look up table
+                const uint8_t* const __restrict nonce, // 8 -bytes nonce
+                const int in_fd,                       // input file
+                const int out_fd,                      // output file
+                const size_t buf_len = BUF_LEN         // bytes per buffer
+)
+{
+  uint64_t len = 0;
+  uint64_t out_len = 0;
+  bool in_seekable = false;
+  bool out_seekable = false;
+
+  if (!fd_length(in_fd, &len, &in_seekable) ||
+      !fd_length(out_fd, &out_len, &out_seekable)) {
+    return false;
+  }
+
+  uint8_t* const buf =
+    static_cast<uint8_t*>(std::aligned_alloc(IO_ALIGN, buf_len));
+  if (buf == nullptr) {
+    errno = ENOMEM;
+    return false;
+  }
+
+  bool ok = true;
+  uint64_t off = 0;
+
+  while (true) {
+    const size_t want =
+      in_seekable
+        ? static_cast<size_t>(std::min<uint64_t>(buf_len, len - off))
+        : buf_len;
+    if (want == 0) {
+      break;
+    }
+
+    const size_t want_len = in_seekable ? align_up(want) : want;
+    const int64_t got =
+      transfer<false>(in_fd, buf, want, want_len, off, in_seekable);
+    if (got <= 0) {
+      ok = got == 0;
+      break;
+    }
+
+    const size_t n = static_cast<size_t>(got);
+    harpocrates_ctr::crypt(lut, nonce, off, buf, buf, n);
+
+    size_t put_len = n;
+    if (out_seekable) {
+      put_len = align_up(n);
+      std::memset(buf + n, 0, put_len - n);
+    }
+
+    if (transfer<true>(out_fd, buf, n, put_len, off, out_seekable) < 0) {
+      ok = false;
+      break;
+    }
+
+    off += n;
+    if (!in_seekable && n < buf_len) {
+      break;
+    }
+  }
+
+  std::free(buf);
+
+  if (!ok) {
+    return false;
+  }
+
+  struct stat st;
+  if (::fstat(out_fd, &st) != 0) {
+    return false;
+  }
+  if (S_ISREG(st.st_mode) &&
+      ::ftruncate(out_fd, static_cast<off_t>(off)) != 0) {
+    return false;
+  }
+
+  return true;
+}
+
+}
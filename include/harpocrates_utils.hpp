@@ -4,6 +4,10 @@
 #include <random>
 #include <type_traits>
 
+#if defined __x86_64__
+#include <immintrin.h>
+#endif
+
 // Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, related
 // utility functions
 namespace harpocrates_utils {
@@ -69,7 +73,10 @@ generate_lut(uint8_t* const lut)
 // Generation of inverse Look Up Table ( read `inv_lut` ), using involution
 // function of `lut`, as defined in section 2.1 of Harpocrates specification
 // https://eprint.iacr.org/2022/519.pdf
-static inline void
+//
+// It can also be evaluated during compilation, for look up tables known at
+// compile time ( see `harpocrates_fixed` )
+static inline constexpr void
 generate_inv_lut(const uint8_t* const __restrict lut,
                  uint8_t* const __restrict inv_lut)
 {
@@ -96,6 +103,11 @@ generate_inv_lut(const uint8_t* const __restrict lut,
 //
 // Also see figure 4 of above linked document to better understand workings of
 // this procedure
+//
+// Each row is substituted independently of others, so `n_rows` can be set to
+// some multiple of N_ROWS, for processing state matrices of multiple message
+// blocks, laid out one after another, in a single call
+template<const size_t n_rows = harpocrates_common::N_ROWS>
 static inline void
 left_to_right_convoluted_substitution(uint16_t* const __restrict state,
                                       const uint8_t* const __restrict lut)
@@ -106,7 +118,7 @@ left_to_right_convoluted_substitution(uint16_t* const __restrict state,
 #pragma GCC ivdep
 #pragma GCC unroll 8
 #endif
-  for (size_t i = 0; i < harpocrates_common::N_ROWS; i++) {
+  for (size_t i = 0; i < n_rows; i++) {
     const uint16_t row = state[i];
 
     const uint8_t lo = static_cast<uint8_t>(row);
@@ -446,11 +458,217 @@ column_substitution(uint16_t* const __restrict state,
   state[7] = row7;
 }
 
+// Transposes 8 x 8 bit matrix, where i-th row is held in i-th most significant
+// byte of 64 -bit word & j-th column of some row is j-th most significant bit
+// of that byte, using SWAR ( SIMD within a register ) technique
+//
+// See section 7-3 of Hacker's Delight ( 2nd edition )
+static inline constexpr uint64_t
+transpose8x8(uint64_t x)
+{
+  uint64_t t = 0ul;
+
+  t = (x ^ (x >> 7)) & 0x00aa00aa00aa00aaul;
+  x = x ^ t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000cccc0000ccccul;
+  x = x ^ t ^ (t << 14);
+  t = (x ^ (x >> 28)) & 0x00000000f0f0f0f0ul;
+  x = x ^ t ^ (t << 28);
+
+  return x;
+}
+
+// Splits 8 x 16 state matrix into two 8 x 8 bit matrices, holding most & least
+// significant bytes of each row, such that i-th row is i-th most significant
+// byte of 64 -bit word ( see transpose8x8 )
+static inline void
+split_state(const uint16_t* const __restrict state,
+            uint64_t* const __restrict hi,
+            uint64_t* const __restrict lo)
+{
+  uint64_t t0 = 0ul;
+  uint64_t t1 = 0ul;
+
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+  for (size_t i = 0; i < harpocrates_common::N_ROWS; i++) {
+    t0 = (t0 << 8) | static_cast<uint64_t>(state[i] >> 8);
+    t1 = (t1 << 8) | static_cast<uint64_t>(state[i] & 0xff);
+  }
+
+  *hi = t0;
+  *lo = t1;
+}
+
+// Merges two 8 x 8 bit matrices, holding most & least significant bytes of
+// each row, back into 8 x 16 state matrix; inverse of split_state
+static inline void
+merge_state(uint16_t* const state, const uint64_t hi, const uint64_t lo)
+{
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+  for (size_t i = 0; i < harpocrates_common::N_ROWS; i++) {
+    const size_t sft = (harpocrates_common::N_ROWS - (i + 1)) << 3;
+
+    state[i] = static_cast<uint16_t>(((hi >> sft) & 0xff) << 8) |
+               static_cast<uint16_t>((lo >> sft) & 0xff);
+  }
+}
+
+// Substitutes each byte of 64 -bit word, using look up table
+static inline uint64_t
+substitute_bytes(const uint64_t x, const uint8_t* const lut)
+{
+  uint64_t y = 0ul;
+
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+  for (size_t i = 0; i < 8; i++) {
+    const size_t sft = i << 3;
+    y |= static_cast<uint64_t>(lut[(x >> sft) & 0xff]) << sft;
+  }
+
+  return y;
+}
+
+// Column substitution, computing same output as `column_substitution`, but
+// state matrix is viewed as two 8 x 8 bit matrices, which are transposed (
+// using SWAR technique ) so that columns become bytes, substituted using look
+// up table & transposed back to rows
+static inline void
+column_substitution_swar(uint16_t* const __restrict state,
+                         const uint8_t* const __restrict lut)
+{
+  uint64_t hi = 0ul;
+  uint64_t lo = 0ul;
+
+  split_state(state, &hi, &lo);
+
+  const uint64_t hi_cols = substitute_bytes(transpose8x8(hi), lut);
+  const uint64_t lo_cols = substitute_bytes(transpose8x8(lo), lut);
+
+  merge_state(state, transpose8x8(hi_cols), transpose8x8(lo_cols));
+}
+
+#if defined __x86_64__
+
+// Column substitution, computing same output as `column_substitution`, where
+// i-th column of 8 x 8 bit matrix is gathered into a byte using PEXT &
+// scattered back into rows using PDEP instruction, which are available on CPUs
+// with BMI2 extension
+__attribute__((target("bmi2"))) static inline void
+column_substitution_bmi2(uint16_t* const __restrict state,
+                         const uint8_t* const __restrict lut)
+{
+  constexpr uint64_t col_mask = 0x0101010101010101ul;
+
+  uint64_t hi = 0ul;
+  uint64_t lo = 0ul;
+
+  split_state(state, &hi, &lo);
+
+  uint64_t shi = 0ul;
+  uint64_t slo = 0ul;
+
+#if defined __clang__
+#pragma unroll 8
+#elif defined __GNUG__
+#pragma GCC unroll 8
+#endif
+  for (size_t i = 0; i < 8; i++) {
+    const uint64_t mask = col_mask << (7 - i);
+
+    const uint8_t hi_col = static_cast<uint8_t>(_pext_u64(hi, mask));
+    const uint8_t lo_col = static_cast<uint8_t>(_pext_u64(lo, mask));
+
+    shi |= _pdep_u64(lut[hi_col], mask);
+    slo |= _pdep_u64(lut[lo_col], mask);
+  }
+
+  merge_state(state, shi, slo);
+}
+
+// Column substitution, computing same output as `column_substitution`, where
+// both 8 x 8 bit matrices are transposed in a single GF2P8AFFINEQB instruction
+// ( multiplying by identity matrix ), available on CPUs with GFNI extension
+__attribute__((target("gfni,ssse3"))) static inline void
+column_substitution_gfni(uint16_t* const __restrict state,
+                         const uint8_t* const __restrict lut)
+{
+  // i-th row's most significant byte goes to byte i & least significant byte
+  // goes to byte 8 + i
+  const __m128i split = _mm_setr_epi8(1, 3, 5, 7, 9, 11, 13, 15, //
+                                      0, 2, 4, 6, 8, 10, 12, 14);
+  // inverse of above byte shuffle
+  const __m128i merge = _mm_setr_epi8(8, 0, 9, 1, 10, 2, 11, 3, //
+                                      12, 4, 13, 5, 14, 6, 15, 7);
+  const __m128i ident = _mm_set1_epi64x(0x0102040810204080l);
+
+  const __m128i rows = _mm_loadu_si128(reinterpret_cast<__m128i*>(state));
+  const __m128i mats = _mm_shuffle_epi8(rows, split);
+  const __m128i cols = _mm_gf2p8affine_epi64_epi8(ident, mats, 0);
+
+  alignas(16) uint8_t bytes[harpocrates_common::N_COLS];
+  _mm_store_si128(reinterpret_cast<__m128i*>(bytes), cols);
+
+#if defined __clang__
+#pragma unroll 16
+#elif defined __GNUG__
+#pragma GCC unroll 16
+#endif
+  for (size_t i = 0; i < harpocrates_common::N_COLS; i++) {
+    bytes[i] = lut[bytes[i]];
+  }
+
+  const __m128i scols = _mm_load_si128(reinterpret_cast<__m128i*>(bytes));
+  const __m128i smats = _mm_gf2p8affine_epi64_epi8(ident, scols, 0);
+  const __m128i srows = _mm_shuffle_epi8(smats, merge);
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state), srows);
+}
+
+#endif
+
+// Column substitution, using fastest of above transpose based variants, which
+// is available on target CPU, as decided during compilation
+static inline void
+transposed_column_substitution(uint16_t* const __restrict state,
+                               const uint8_t* const __restrict lut)
+{
+#if defined __x86_64__ && defined __GFNI__ && defined __SSSE3__
+  column_substitution_gfni(state, lut);
+#elif defined __x86_64__ && defined __BMI2__
+  column_substitution_bmi2(state, lut);
+#else
+  column_substitution_swar(state, lut);
+#endif
+}
+
+// Type of column substitution routines, one of which can be chosen ( at compile
+// time ) by encryption/ decryption routines, living in `harpocrates::`
+// namespace, so that variants requiring CPU extensions can be selected at run
+// time, without compiling whole library for those extensions
+using column_substitution_t = void (*)(uint16_t* const, const uint8_t* const);
+
 // Right to left convoluted substitution, as described in point (4) of
 // section 2.3 of Harpocrates specification https://eprint.iacr.org/2022/519.pdf
 //
 // Also see figure 7 of above linked document to better understand workings of
 // this procedure
+//
+// Each row is substituted independently of others, so `n_rows` can be set to
+// some multiple of N_ROWS, for processing state matrices of multiple message
+// blocks, laid out one after another, in a single call
+template<const size_t n_rows = harpocrates_common::N_ROWS>
 static inline void
 right_to_left_convoluted_substitution(uint16_t* const __restrict state,
                                       const uint8_t* const __restrict lut)
@@ -461,7 +679,7 @@ right_to_left_convoluted_substitution(uint16_t* const __restrict state,
 #pragma GCC ivdep
 #pragma GCC unroll 8
 #endif
-  for (size_t i = 0; i < harpocrates_common::N_ROWS; i++) {
+  for (size_t i = 0; i < n_rows; i++) {
     const uint16_t row = state[i];
 
     const uint8_t hi = static_cast<uint8_t>(row >> 8);
@@ -500,4 +718,28 @@ right_to_left_convoluted_substitution(uint16_t* const __restrict state,
   }
 }
 
+// Finalizer of SplitMix64, mixing all bits of 64 -bit input into output, so
+// that consecutive values ( say key identifiers or page numbers ) spread
+// evenly, when reduced modulo number of shards
+static inline constexpr uint64_t
+mix64(const uint64_t v)
+{
+  uint64_t h = v;
+  h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ul;
+  h = (h ^ (h >> 27)) * 0x94d049bb133111ebul;
+  return h ^ (h >> 31);
+}
+
+// Zeroes N -bytes of memory through volatile stores, so that compiler can't
+// elide erasure of secret material ( say plain text or key stream ), which is
+// never read again
+static inline void
+secure_zero(void* const buf, const size_t len)
+{
+  volatile uint8_t* const ptr = static_cast<uint8_t*>(buf);
+  for (size_t i = 0; i < len; i++) {
+    ptr[i] = 0;
+  }
+}
+
 }
@@ -0,0 +1,295 @@
+#pragma once
+#include "harpocrates_dispatch.hpp"
+#include "harpocrates_parallel.hpp"
+#include <algorithm>
+#include <cerrno>
+
+// Harpocrates - An Efficient Encryption Mechanism for Data-at-rest, used in
+// XTS-like tweakable mode, for encrypting/ decrypting fixed size sectors (
+// e.g. 512 -bytes/ 4 KB ) of block devices, each of which can be decrypted
+// independently of others
+//
+// For sector number s, tweak T = E(K2, s), where s is encoded as 16 -bytes
+// little-endian integer & K2 is a look up table, which is not same as K1, used
+// for encrypting message blocks. j-th 16 -bytes block of sector is then
+//
+// C_j = E(K1, P_j ^ T_j) ^ T_j | T_j = T * α^j
+//
+// where multiplication happens in GF(2^128), using reduction polynomial
+// x^128 + x^7 + x^2 + x + 1, following IEEE 1619 ( XTS-AES ). As sectors are
+// always multiple of 16 -bytes, no ciphertext stealing is needed.
+//
+// Tweaks of many sectors are computed together & message blocks of many
+// sectors are encrypted together, using bulk encryption kernel selected at run
+// time ( see `harpocrates_dispatch` ).
+namespace harpocrates_xts {
+
+// # -of sectors, whose tweaks are computed together
+constexpr size_t TWEAK_BATCH = 64ul;
+
+// # -of message blocks ( i.e. 16 KB ), which are masked using tweaks &
+// encrypted together, by single call to bulk encryption routine
+constexpr size_t GROUP_BLOCKS = 1024ul;
+
+// Multiplies 16 -bytes little-endian element of GF(2^128) by α ( i.e. x ), in
+// place
+static inline void
+gf_double(uint8_t* const t)
+{
+  uint64_t lo = 0ul;
+  uint64_t hi = 0ul;
+
+  for (size_t i = 0; i < 8; i++) {
+    lo |= static_cast<uint64_t>(t[i]) << (i << 3);
+    hi |= static_cast<uint64_t>(t[8 + i]) << (i << 3);
+  }
+
+  const uint64_t carry = hi >> 63;
+
+  hi = (hi << 1) | (lo >> 63);
+  lo = (lo << 1) ^ (carry * 0x87ul);
+
+  for (size_t i = 0; i < 8; i++) {
+    t[i] = static_cast<uint8_t>(lo >> (i << 3));
+    t[8 + i] = static_cast<uint8_t>(hi >> (i << 3));
+  }
+}
+
+// Computes tweaks of `n_sectors` consecutive sectors, starting from sector
+// number `sector`
+static inline void
+sector_tweaks(const uint8_t* const __restrict tweak_lut,
+              const uint64_t sector,
+              uint8_t* const __restrict tweaks,
+              const size_t n_sectors)
+{
+  std::memset(tweaks, 0, n_sectors * harpocrates_common::BLOCK_LEN);
+
+  for (size_t i = 0; i < n_sectors; i++) {
+    uint8_t* const t = tweaks + i * harpocrates_common::BLOCK_LEN;
+    const uint64_t v = sector + i;
+
+    for (size_t j = 0; j < 8; j++) {
+      t[j] = static_cast<uint8_t>(v >> (j << 3));
+    }
+  }
+
+  // few tweaks ( e.g. random access to a sector ) are computed one by one, as
+  // vectorized bulk kernels always work on many blocks
+  if (n_sectors < harpocrates_common::N_LANES) {
+    for (size_t i = 0; i < n_sectors; i++) {
+      uint8_t* const t = tweaks + i * harpocrates_common::BLOCK_LEN;
+      uint8_t sno[harpocrates_common::BLOCK_LEN];
+
+      std::memcpy(sno, t, sizeof(sno));
+      harpocrates_dispatch::encrypt(tweak_lut, sno, t);
+    }
+  } else {
+    harpocrates_dispatch::encrypt_blocks(tweak_lut, tweaks, tweaks, n_sectors);
+  }
+}
+
+// Checks whether sector length is a non-zero multiple of 16 -bytes, leaving
+// EINVAL in `errno`, when it isn't
+static inline bool
+valid_sector_len(const size_t sector_len)
+{
+  if (sector_len == 0 || sector_len % harpocrates_common::BLOCK_LEN != 0) {
+    errno = EINVAL;
+    return false;
+  }
+
+  return true;
+}
+
+// Given look up table ( read `lut` ) for message blocks, look up table ( read
+// `tweak_lut` ) for tweaks & number of first sector, this routine encrypts (
+// when `decrypt` is false ) or decrypts N consecutive sectors, each of length
+// `sector_len` -bytes, which must be a non-zero multiple of 16; returns false,
+// leaving EINVAL in `errno` & output untouched, when it isn't
+//
+// When decrypting, `lut` must be inverse of look up table used for encryption,
+// while `tweak_lut` stays same, as tweaks are always encrypted.
+//
+// `in` and `out` may point to same memory ( i.e. in-place encryption )
+template<const bool decrypt>
+static inline bool
+crypt_sectors(const uint8_t* const __restrict lut,       // look up table
+              const uint8_t* const __restrict tweak_lut, // tweak look up table
+              const uint64_t sector,                     // first sector number
+              const uint8_t* const in,                   // input bytes
+              uint8_t* const out,                        // output bytes
+              const size_t sector_len,                   // bytes per sector
+              const size_t n_sectors                     // # -of sectors
+)
+{
+  constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+  if (!valid_sector_len(sector_len)) {
+    return false;
+  }
+
+  const size_t blks_per_sector = sector_len / blk_len;
+
+  uint8_t tweaks[TWEAK_BATCH * blk_len];
+  uint8_t masks[GROUP_BLOCKS * blk_len];
+
+  size_t run_beg = 0;
+  size_t run_len = 0;
+
+  // encrypts ( or decrypts ) masked blocks of current run & unmasks them
+  auto flush = [&]() {
+    uint8_t* const blks = out + run_beg * blk_len;
+
+    if constexpr (decrypt) {
+      harpocrates_dispatch::decrypt_blocks(lut, blks, blks, run_len);
+    } else {
+      harpocrates_dispatch::encrypt_blocks(lut, blks, blks, run_len);
+    }
+
+    for (size_t i = 0; i < run_len * blk_len; i++) {
+      blks[i] ^= masks[i];
+    }
+
+    run_beg += run_len;
+    run_len = 0;
+  };
+
+  for (size_t s = 0; s < n_sectors; s += TWEAK_BATCH) {
+    const size_t cnt = std::min(TWEAK_BATCH, n_sectors - s);
+    sector_tweaks(tweak_lut, sector + s, tweaks, cnt);
+
+    for (size_t i = 0; i < cnt; i++) {
+      uint8_t t[blk_len];
+      std::memcpy(t, tweaks + i * blk_len, blk_len);
+
+      const size_t blk_off = (s + i) * blks_per_sector;
+
+      for (size_t j = 0; j < blks_per_sector; j++) {
+        const size_t off = (blk_off + j) * blk_len;
+        uint8_t* const mask = masks + run_len * blk_len;
+
+        std::memcpy(mask, t, blk_len);
+        for (size_t k = 0; k < blk_len; k++) {
+          out[off + k] = in[off + k] ^ t[k];
+        }
+
+        gf_double(t);
+
+        if (++run_len == GROUP_BLOCKS) {
+          flush();
+        }
+      }
+    }
+  }
+
+  if (run_len > 0) {
+    flush();
+  }
+
+  return true;
+}
+
+// Encrypts N consecutive sectors, starting from sector number `sector`; see
+// `crypt_sectors`, which also tells what's returned
+static inline bool
+encrypt_sectors(const uint8_t* const __restrict lut,       // look up table
+                const uint8_t* const __restrict tweak_lut, // tweak LUT
+                const uint64_t sector,                     // first sector
+                const uint8_t* const txt,                  // input plain text
+                uint8_t* const enc,                        // encrypted bytes
+                const size_t sector_len,                   // bytes per sector
+                const size_t n_sectors                     // # -of sectors
+)
+{
+  return crypt_sectors<false>(
+    lut, tweak_lut, sector, txt, enc, sector_len, n_sectors);
+}
+
+// Decrypts N consecutive sectors, starting from sector number `sector`; see
+// `crypt_sectors`, which also tells what's returned
+static inline bool
+decrypt_sectors(const uint8_t* const __restrict inv_lut,   // inverse LUT
+                const uint8_t* const __restrict tweak_lut, // tweak LUT
+                const uint64_t sector,                     // first sector
+                const uint8_t* const enc,                  // encrypted bytes
+                uint8_t* const dec,                        // decrypted bytes
+                const size_t sector_len,                   // bytes per sector
+                const size_t n_sectors                     // # -of sectors
+)
+{
+  return crypt_sectors<true>(
+    inv_lut, tweak_lut, sector, enc, dec, sector_len, n_sectors);
+}
+
+// Encrypts N consecutive sectors, same as above, but sectors are split into
+// groups of ( at least ) 32 KB, which are encrypted by workers of thread pool
+static inline bool
+encrypt_sectors(harpocrates_parallel::thread_pool& pool,   // thread pool
+                const uint8_t* const __restrict lut,       // look up table
+                const uint8_t* const __restrict tweak_lut, // tweak LUT
+                const uint64_t sector,                     // first sector
+                const uint8_t* const txt,                  // input plain text
+                uint8_t* const enc,                        // encrypted bytes
+                const size_t sector_len,                   // bytes per sector
+                const size_t n_sectors                     // # -of sectors
+)
+{
+  constexpr size_t chunk_len =
+    harpocrates_parallel::CHUNK_BLOCKS * harpocrates_common::BLOCK_LEN;
+
+  if (!valid_sector_len(sector_len)) {
+    return false;
+  }
+
+  const size_t per_task = std::max<size_t>(chunk_len / sector_len, 1);
+  const size_t n_tasks = (n_sectors + per_task - 1) / per_task;
+
+  pool.parallel_for(n_tasks, [=](const size_t i) {
+    const size_t beg = i * per_task;
+    const size_t cnt = std::min(per_task, n_sectors - beg);
+    const size_t off = beg * sector_len;
+
+    encrypt_sectors(
+      lut, tweak_lut, sector + beg, txt + off, enc + off, sector_len, cnt);
+  });
+
+  return true;
+}
+
+// Decrypts N consecutive sectors, same as above, but sectors are split into
+// groups of ( at least ) 32 KB, which are decrypted by workers of thread pool
+static inline bool
+decrypt_sectors(harpocrates_parallel::thread_pool& pool,   // thread pool
+                const uint8_t* const __restrict inv_lut,   // inverse LUT
+                const uint8_t* const __restrict tweak_lut, // tweak LUT
+                const uint64_t sector,                     // first sector
+                const uint8_t* const enc,                  // encrypted bytes
+                uint8_t* const dec,                        // decrypted bytes
+                const size_t sector_len,                   // bytes per sector
+                const size_t n_sectors                     // # -of sectors
+)
+{
+  constexpr size_t chunk_len =
+    harpocrates_parallel::CHUNK_BLOCKS * harpocrates_common::BLOCK_LEN;
+
+  if (!valid_sector_len(sector_len)) {
+    return false;
+  }
+
+  const size_t per_task = std::max<size_t>(chunk_len / sector_len, 1);
+  const size_t n_tasks = (n_sectors + per_task - 1) / per_task;
+
+  pool.parallel_for(n_tasks, [=](const size_t i) {
+    const size_t beg = i * per_task;
+    const size_t cnt = std::min(per_task, n_sectors - beg);
+    const size_t off = beg * sector_len;
+
+    decrypt_sectors(
+      inv_lut, tweak_lut, sector + beg, enc + off, dec + off, sector_len, cnt);
+  });
+
+  return true;
+}
+
+}
@@ -0,0 +1,231 @@
+#pragma once
+#include "harpocrates.hpp"
+#include "harpocrates_aead.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <vector>
+
+// Tests GF(2^128) halving, by asserting that it undoes doubling, on some hand
+// computed & random values
+static inline void
+test_gf_halve()
+{
+  using namespace harpocrates_aead;
+
+  uint8_t t[16] = {};
+
+  t[0] = 0x87;
+  gf_halve(t);
+  assert(t[0] == 0x00 && t[15] == 0x80);
+
+  std::memset(t, 0, sizeof(t));
+  t[8] = 0x01;
+  gf_halve(t);
+  assert(t[7] == 0x80 && t[8] == 0x00);
+
+  for (size_t i = 0; i < 64; i++) {
+    uint8_t u[16];
+    random_data(t, sizeof(t));
+    std::memcpy(u, t, sizeof(t));
+
+    harpocrates_xts::gf_double(u);
+    gf_halve(u);
+    assert(std::memcmp(t, u, sizeof(t)) == 0);
+  }
+}
+
+// Computes PMAC of N -bytes message, following its definition, one block at a
+// time, where Δ_i = γ_i · L is computed by double-and-add, over bits of γ_i
+static inline void
+pmac_reference(const uint8_t* const lut,
+               const uint8_t* const msg,
+               const size_t len,
+               uint8_t* const tag)
+{
+  constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+  const uint8_t zero[blk_len] = {};
+  uint8_t l[blk_len];
+  harpocrates::encrypt(lut, zero, l);
+
+  const size_t m = len == 0 ? 1 : (len + blk_len - 1) / blk_len;
+  uint8_t sigma[blk_len] = {};
+
+  for (size_t i = 1; i < m; i++) {
+    const uint64_t gray = i ^ (i >> 1);
+    uint8_t delta[blk_len] = {};
+
+    for (size_t j = 64; j > 0; j--) {
+      harpocrates_xts::gf_double(delta);
+      if ((gray >> (j - 1)) & 1ul) {
+        harpocrates_aead::xor_block(delta, l);
+      }
+    }
+
+    uint8_t blk[blk_len];
+    uint8_t enc[blk_len];
+
+    for (size_t k = 0; k < blk_len; k++) {
+      blk[k] = msg[(i - 1) * blk_len + k] ^ delta[k];
+    }
+
+    harpocrates::encrypt(lut, blk, enc);
+    harpocrates_aead::xor_block(sigma, enc);
+  }
+
+  const size_t last_len = len - (m - 1) * blk_len;
+  const uint8_t* const last = msg + (m - 1) * blk_len;
+
+  if (last_len == blk_len) {
+    harpocrates_aead::xor_block(sigma, last);
+    harpocrates_aead::gf_halve(l);
+    harpocrates_aead::xor_block(sigma, l);
+  } else {
+    for (size_t k = 0; k < last_len; k++) {
+      sigma[k] ^= last[k];
+    }
+    sigma[last_len] ^= 0x80;
+  }
+
+  harpocrates::encrypt(lut, sigma, tag);
+}
+
+// Tests functional correctness of authenticated encryption, for N -bytes
+// message & M -bytes associated data, by asserting that
+//
+// - PMAC computes same tag as its reference implementation, single & multi
+//   threaded
+// - cipher text is counter mode encryption of message & tag is PMAC of nonce,
+//   length of associated data, zero padded associated data & cipher text
+// - single & multi threaded, out-of-place & in-place, encryption/ decryption
+//   compute same bytes, while tampering with nonce, associated data, cipher
+//   text or tag is detected, without decrypting anything
+static inline void
+test_harpocrates_aead(harpocrates_parallel::thread_pool& pool,
+                      const size_t len,
+                      const size_t ad_len)
+{
+  using namespace harpocrates_aead;
+
+  constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+  uint8_t enc_lut[256];
+  uint8_t mac_lut[256];
+  uint8_t nonce[NONCE_LEN];
+
+  harpocrates_utils::generate_lut(enc_lut);
+  harpocrates_utils::generate_lut(mac_lut);
+  random_data(nonce, sizeof(nonce));
+
+  // acquire memory resources
+  std::vector<uint8_t> txt(len);
+  std::vector<uint8_t> ad(ad_len);
+  std::vector<uint8_t> enc0(len);
+  std::vector<uint8_t> enc1(len);
+  std::vector<uint8_t> dec(len);
+
+  random_data(txt.data(), len);
+  random_data(ad.data(), ad_len);
+
+  uint8_t tag0[TAG_LEN];
+  uint8_t tag1[TAG_LEN];
+
+  // PMAC of message
+  const pmac mac(mac_lut);
+
+  pmac_reference(mac_lut, txt.data(), len, tag0);
+
+  mac.tag(txt.data(), len, tag1);
+  assert(std::memcmp(tag0, tag1, TAG_LEN) == 0);
+
+  mac.tag(pool, txt.data(), len, tag1, 5);
+  assert(std::memcmp(tag0, tag1, TAG_LEN) == 0);
+
+  // cipher text & tag, following definition
+  harpocrates_ctr::crypt(enc_lut, nonce, 0, txt.data(), enc0.data(), len);
+
+  const size_t ad_pad = ((ad_len + blk_len - 1) / blk_len) * blk_len;
+  std::vector<uint8_t> str(blk_len + ad_pad + len, 0);
+
+  std::memcpy(str.data(), nonce, NONCE_LEN);
+  for (size_t i = 0; i < 8; i++) {
+    str[NONCE_LEN + i] = static_cast<uint8_t>(ad_len >> (i << 3));
+  }
+  std::memcpy(str.data() + blk_len, ad.data(), ad_len);
+  std::memcpy(str.data() + blk_len + ad_pad, enc0.data(), len);
+
+  pmac_reference(mac_lut, str.data(), str.size(), tag0);
+
+  const aead cipher(enc_lut, mac_lut);
+
+  cipher.seal(nonce, ad.data(), ad_len, txt.data(), enc1.data(), len, tag1);
+  assert(std::memcmp(tag0, tag1, TAG_LEN) == 0);
+  assert(std::memcmp(enc0.data(), enc1.data(), len) == 0);
+
+  const bool ok_open =
+    cipher.open(nonce, ad.data(), ad_len, enc1.data(), dec.data(), len, tag1);
+  assert(ok_open);
+  assert(std::memcmp(txt.data(), dec.data(), len) == 0);
+
+  // multi threaded, in-place
+  dec = txt;
+  cipher.seal(
+    pool, nonce, ad.data(), ad_len, dec.data(), dec.data(), len, tag1, 3);
+  assert(std::memcmp(tag0, tag1, TAG_LEN) == 0);
+  assert(std::memcmp(enc0.data(), dec.data(), len) == 0);
+
+  const bool ok_open_mt = cipher.open(
+    pool, nonce, ad.data(), ad_len, dec.data(), dec.data(), len, tag1, 3);
+  assert(ok_open_mt);
+  assert(std::memcmp(txt.data(), dec.data(), len) == 0);
+
+  // tampering is detected, leaving output untouched
+  auto assert_rejected = [&]() {
+    std::fill(dec.begin(), dec.end(), 0xa5);
+
+    const bool ok0 =
+      cipher.open(nonce, ad.data(), ad_len, enc1.data(), dec.data(), len, tag1);
+    const bool ok1 = cipher.open(
+      pool, nonce, ad.data(), ad_len, enc1.data(), dec.data(), len, tag1, 3);
+
+    for (size_t i = 0; i < len; i++) {
+      assert(dec[i] == 0xa5);
+    }
+
+    assert(!ok0 && !ok1);
+  };
+
+  nonce[3] ^= 0x10;
+  assert_rejected();
+  nonce[3] ^= 0x10;
+
+  tag1[TAG_LEN - 1] ^= 0x01;
+  assert_rejected();
+  tag1[TAG_LEN - 1] ^= 0x01;
+
+  if (len > 0) {
+    enc1[len - 1] ^= 0x80;
+    assert_rejected();
+    enc1[len - 1] ^= 0x80;
+
+    enc1[0] ^= 0x01;
+    assert_rejected();
+    enc1[0] ^= 0x01;
+  }
+
+  if (ad_len > 0) {
+    ad[ad_len / 2] ^= 0x04;
+    assert_rejected();
+    ad[ad_len / 2] ^= 0x04;
+
+    // dropping last byte of associated data
+    const bool ok = cipher.open(
+      nonce, ad.data(), ad_len - 1, enc1.data(), dec.data(), len, tag1);
+    assert(!ok);
+  }
+
+  const bool ok_restored =
+    cipher.open(nonce, ad.data(), ad_len, enc1.data(), dec.data(), len, tag1);
+  assert(ok_restored);
+  assert(std::memcmp(txt.data(), dec.data(), len) == 0);
+}
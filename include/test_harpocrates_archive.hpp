@@ -0,0 +1,151 @@
+#pragma once
+#include "harpocrates_archive.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+// Tests random-access encrypted archive, by asserting that, when N -bytes
+// message is written to archive in randomly sized pieces, split into chunks
+// of given length
+//
+// - whole message & randomly chosen byte ranges decrypt back to same bytes,
+//   both one by one & in parallel, across workers of thread pool
+// - ranges not lying within message ( or archive, which isn't open ), invalid
+//   chunk lengths & corrupted archives are rejected
+// - concurrent writers of same archive don't clobber each other's files
+static inline void
+test_harpocrates_archive(harpocrates_parallel::thread_pool& pool,
+                         const size_t msg_len,
+                         const size_t chunk_len)
+{
+  using namespace harpocrates_archive;
+
+  constexpr size_t n_ranges = 32;
+
+  uint8_t lut[256];
+  harpocrates_utils::generate_lut(lut);
+
+  // acquire memory resources
+  std::vector<uint8_t> txt(msg_len);
+  std::vector<uint8_t> dec(msg_len);
+
+  random_data(txt.data(), msg_len);
+
+  char path[] = "/tmp/harpocrates_archive_XXXXXX";
+  const int fd = ::mkstemp(path);
+  assert(fd >= 0);
+  ::close(fd);
+
+  {
+    writer w;
+
+    errno = 0;
+    const bool ok_zero = w.open(path, lut, 0);
+    assert(!ok_zero && errno == EINVAL);
+
+    errno = 0;
+    const bool ok_odd = w.open(path, lut, chunk_len + 1);
+    assert(!ok_odd && errno == EINVAL);
+
+    const bool ok_open = w.open(path, lut, chunk_len);
+    assert(ok_open);
+
+    // another writer of same archive neither truncates nor removes this
+    // writer's temporary file
+    {
+      writer other;
+
+      const bool ok_open = other.open(path, lut, chunk_len);
+      const bool ok_write = other.write(txt.data(), msg_len >> 1);
+      assert(ok_open && ok_write);
+    }
+
+    size_t off = 0;
+
+    while (off < msg_len) {
+      uint8_t r[2];
+      random_data(r, sizeof(r));
+
+      const size_t rnd = static_cast<size_t>((r[0] << 8) | r[1]);
+      const size_t len = std::min(rnd % (chunk_len * 3), msg_len - off);
+
+      const bool ok_write = w.write(txt.data() + off, len);
+      assert(ok_write);
+      off += len;
+    }
+
+    const bool ok_close = w.close();
+    assert(ok_close);
+  }
+
+  reader rd;
+  const bool ok_open = rd.open(path);
+  assert(ok_open);
+  assert(rd.size() == msg_len);
+  assert(rd.chunk_len() == chunk_len);
+  assert(rd.n_chunks() == (msg_len + chunk_len - 1) / chunk_len);
+
+  const bool ok_all = rd.read(lut, 0, dec.data(), msg_len);
+  assert(ok_all);
+  assert(std::memcmp(txt.data(), dec.data(), msg_len) == 0);
+
+  // random ranges, decrypted one by one & then all together
+  std::vector<range_t> ranges(n_ranges);
+  std::vector<std::vector<uint8_t>> outs(n_ranges);
+
+  for (size_t i = 0; i < n_ranges; i++) {
+    uint64_t r[2];
+    random_data(reinterpret_cast<uint8_t*>(r), sizeof(r));
+
+    const uint64_t beg = r[0] % (msg_len + 1);
+    const size_t len = static_cast<size_t>(r[1] % (msg_len - beg + 1));
+
+    outs[i].resize(len);
+    ranges[i] = { beg, outs[i].data(), len };
+
+    const bool ok_range = rd.read(lut, beg, outs[i].data(), len);
+    assert(ok_range);
+    assert(std::memcmp(txt.data() + beg, outs[i].data(), len) == 0);
+
+    std::memset(outs[i].data(), 0, len);
+  }
+
+  const bool ok_ranges = rd.read(pool, lut, ranges.data(), n_ranges);
+  assert(ok_ranges);
+
+  for (size_t i = 0; i < n_ranges; i++) {
+    const range_t& r = ranges[i];
+    assert(std::memcmp(txt.data() + r.offset, r.out, r.len) == 0);
+  }
+
+  // ranges not lying within message
+  const range_t bad = { msg_len + 1, dec.data(), 0 };
+
+  const bool ok_past = rd.read(lut, msg_len, dec.data(), 1);
+  const bool ok_long = rd.read(lut, 1, dec.data(), msg_len);
+  const bool ok_bad = rd.read(pool, lut, &bad, 1);
+  assert(!ok_past && !ok_long && !ok_bad);
+
+  rd.close();
+
+  // archive, which isn't open
+  const bool ok_closed0 = rd.read(lut, 0, dec.data(), 0);
+  const bool ok_closed1 = rd.read(pool, lut, ranges.data(), n_ranges);
+  assert(!ok_closed0 && !ok_closed1);
+
+  // corrupted archive
+  {
+    const int wfd = ::open(path, O_WRONLY);
+    const ssize_t n = ::pwrite(wfd, "X", 1, 0);
+    assert(wfd >= 0 && n == 1);
+    ::close(wfd);
+
+    errno = 0;
+    const bool ok_corrupt = rd.open(path);
+    assert(!ok_corrupt && errno == EINVAL);
+  }
+
+  std::remove(path);
+}
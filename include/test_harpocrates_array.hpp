@@ -0,0 +1,109 @@
+#pragma once
+#include "harpocrates_array.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cassert>
+#include <ranges>
+#include <vector>
+
+// Element of 12 -bytes, which straddles 16 -bytes block boundaries
+struct record12_t
+{
+  uint32_t key;
+  uint32_t val;
+  uint32_t tag;
+
+  bool operator==(const record12_t&) const = default;
+};
+
+// Element of 40 -bytes, which is longer than a block
+struct record40_t
+{
+  uint64_t w[5];
+
+  bool operator==(const record40_t&) const = default;
+};
+
+using array12_t = harpocrates_array::encrypted_array<record12_t, 3>;
+using view12_t = decltype(std::declval<const array12_t&>().view());
+
+static_assert(std::ranges::random_access_range<const array12_t&>,
+              "Encrypted array must be a random-access range");
+static_assert(std::ranges::view<view12_t> &&
+                std::ranges::random_access_range<view12_t>,
+              "View over encrypted array must be a random-access view");
+
+// Tests encrypted array of N elements of type T, by asserting that elements
+// decrypted lazily, when scanning forward/ backward, indexing randomly &
+// composing its view with range adaptors, are same as original ones, as are
+// those decrypted in bulk, while stored bytes aren't plain text
+template<typename T, const size_t group_blocks>
+static inline void
+test_harpocrates_array(const size_t n)
+{
+  using harpocrates_array::encrypted_array;
+
+  uint8_t lut[256];
+  harpocrates_utils::generate_lut(lut);
+
+  // acquire memory resources
+  std::vector<T> txt(n);
+  std::vector<T> dec(n);
+
+  random_data(reinterpret_cast<uint8_t*>(txt.data()), n * sizeof(T));
+
+  const encrypted_array<T, group_blocks> arr(lut, std::span<const T>(txt));
+
+  assert(arr.size() == n);
+  assert(arr.empty() == (n == 0));
+
+  if (n * sizeof(T) >= 64) {
+    const uint8_t* const raw = reinterpret_cast<const uint8_t*>(txt.data());
+    assert(std::memcmp(raw, arr.data(), n * sizeof(T)) != 0);
+  }
+
+  arr.decrypt(dec.data());
+  assert(std::equal(txt.begin(), txt.end(), dec.begin()));
+
+  // forward & backward scans
+  size_t i = 0;
+  for (const T v : arr) {
+    assert(v == txt[i++]);
+  }
+  assert(i == n);
+
+  auto it = arr.end();
+  while (it != arr.begin()) {
+    --it;
+    assert(*it == txt[static_cast<size_t>(it - arr.begin())]);
+  }
+
+  // random indexing, through array & through single iterator
+  const auto beg = arr.begin();
+
+  for (size_t k = 0; k < n; k++) {
+    uint64_t r;
+    random_data(reinterpret_cast<uint8_t*>(&r), sizeof(r));
+
+    const size_t j = static_cast<size_t>(r % n);
+
+    assert(arr[j] == txt[j]);
+    assert(beg[static_cast<ptrdiff_t>(j)] == txt[j]);
+  }
+
+  // range adaptors, over view
+  const size_t skip = n / 3;
+  auto tail = arr.view() | std::views::drop(skip) | std::views::reverse;
+
+  assert(static_cast<size_t>(std::ranges::distance(tail)) == n - skip);
+  assert(std::ranges::equal(tail, txt | std::views::drop(skip) |
+                                    std::views::reverse));
+
+  if (n > 0) {
+    const T last = txt[n - 1];
+    const auto found = std::ranges::find(arr, last);
+
+    assert(found != arr.end());
+    assert(*found == last);
+  }
+}
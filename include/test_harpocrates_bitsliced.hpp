@@ -0,0 +1,68 @@
+#pragma once
+#include "harpocrates.hpp"
+#include "harpocrates_bitsliced.hpp"
+#include "utils.hpp"
+#include <cassert>
+
+// Tests functional correctness of bitsliced Harpocrates cipher implementation,
+// using word type W, by asserting that it computes same encrypted/ decrypted
+// bytes as Harpocrates implementation, using 256 -bytes look up table, while
+// also checking that bit-plane transposition is its own inverse
+template<typename W>
+static inline void
+test_harpocrates_bitsliced(const size_t n_blocks)
+{
+  using namespace harpocrates_bitsliced;
+
+  constexpr size_t chunk_len = N_LANES<W> * harpocrates_common::BLOCK_LEN;
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  // acquire memory resources
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc0 = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc1 = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* blk0 = static_cast<uint8_t*>(std::malloc(chunk_len));
+  uint8_t* blk1 = static_cast<uint8_t*>(std::malloc(chunk_len));
+
+  sbox_t sbox;
+  sbox_t inv_sbox;
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+  compile_lut(lut, &sbox);
+  compile_lut(inv_lut, &inv_sbox);
+
+  random_data(txt, ct_len);
+  random_data(blk0, chunk_len);
+
+  W state[N_PLANES];
+
+  transpose_in(blk0, state);
+  transpose_out(state, blk1);
+
+  for (size_t i = 0; i < chunk_len; i++) {
+    assert((blk0[i] ^ blk1[i]) == 0u);
+  }
+
+  harpocrates::encrypt_blocks(lut, txt, enc0, n_blocks);
+  encrypt_blocks<W>(sbox, txt, enc1, n_blocks);
+  decrypt_blocks<W>(inv_sbox, enc1, dec, n_blocks);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+    assert((txt[i] ^ dec[i]) == 0u);
+  }
+
+  // deallocate all resources
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(txt);
+  std::free(enc0);
+  std::free(enc1);
+  std::free(dec);
+  std::free(blk0);
+  std::free(blk1);
+}
@@ -0,0 +1,152 @@
+#pragma once
+#include "harpocrates.hpp"
+#include "harpocrates_cache.hpp"
+#include "harpocrates_kdf.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// Tests bounded cache of cipher contexts, by asserting that
+//
+// - contexts returned by cache encrypt/ decrypt same way as look up tables of
+//   their keys, whether they're given expanded tables or not
+// - hits, misses, expansions, demotions & evictions are counted, while cache
+//   stays within its budget
+// - unknown keys aren't cached, erased keys are loaded again & concurrent
+//   lookups ( from many threads ) are safe
+static inline void
+test_harpocrates_cache()
+{
+  using namespace harpocrates_cache;
+  using harpocrates_context::tables_t;
+
+  constexpr size_t n_blocks = 17;
+  constexpr size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+  constexpr size_t exp_len = harpocrates_expanded::TABLE_LEN << 2;
+  constexpr uint64_t unknown = 1ul << 40;
+
+  // acquire memory resources
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc0 = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc1 = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  uint8_t key[16];
+  random_data(key, sizeof(key));
+  random_data(txt, ct_len);
+
+  const loader_t loader = [&key](const uint64_t id, uint8_t* const out) {
+    if (id >= unknown) {
+      return false;
+    }
+
+    harpocrates_kdf::derive_lut<16>(key, id, out);
+    return true;
+  };
+
+  // single shard, with room for 2 expanded keys & a few plain ones
+  {
+    constexpr size_t budget = ((sizeof(tables_t) << 1) + exp_len) * 2 + 4096;
+    context_cache cache(budget, loader, 3, 1);
+
+    for (uint64_t id = 0; id < 4; id++) {
+      for (size_t i = 0; i < 4; i++) {
+        const auto ctx = cache.get(id);
+        assert(ctx);
+        assert(ctx->has_expanded() == (i >= 3));
+
+        harpocrates_kdf::derive_lut<16>(key, id, lut);
+        harpocrates::encrypt_blocks(lut, txt, enc0, n_blocks);
+
+        ctx->encrypt_blocks(txt, enc1, n_blocks);
+        assert(std::memcmp(enc0, enc1, ct_len) == 0);
+
+        if (ctx->has_expanded()) {
+          ctx->decrypt_blocks_expanded(enc1, dec, n_blocks);
+        } else {
+          ctx->decrypt_blocks(enc1, dec, n_blocks);
+        }
+        assert(std::memcmp(dec, txt, ct_len) == 0);
+      }
+    }
+
+    stats_t st = cache.stats();
+    assert(st.misses == 4 && st.hits == 12);
+    assert(st.expansions == 4 && st.demotions == 2);
+    assert(st.evictions == 0 && st.entries == 4);
+    assert(st.bytes <= budget);
+
+    // least recently used keys lost their expanded tables
+    assert(!cache.get(0)->has_expanded());
+    assert(cache.get(3)->has_expanded());
+
+    assert(!cache.get(unknown));
+
+    st = cache.stats();
+    assert(st.misses == 5 && st.entries == 4);
+
+    // many plain keys, evicting least recently used ones
+    for (uint64_t id = 4; id < 4096; id++) {
+      assert(cache.get(id));
+    }
+
+    st = cache.stats();
+    assert(st.evictions > 0);
+    assert(st.bytes <= budget);
+    assert(st.entries * sizeof(tables_t) <= budget);
+
+    cache.erase(4095);
+    const uint64_t misses = cache.stats().misses;
+    assert(cache.get(4095));
+    assert(cache.stats().misses == misses + 1);
+  }
+
+  // budget too small for expanded tables
+  {
+    context_cache cache(sizeof(tables_t) * 2, loader, 1, 1);
+
+    for (size_t i = 0; i < 8; i++) {
+      const auto ctx = cache.get(i & 1);
+      assert(ctx && !ctx->has_expanded());
+    }
+
+    const stats_t st = cache.stats();
+    assert(st.misses == 2 && st.hits == 6 && st.expansions == 0);
+  }
+
+  // concurrent lookups, from many threads
+  {
+    constexpr size_t n_threads = 4;
+    constexpr size_t n_lookups = 1024;
+    constexpr size_t budget = sizeof(tables_t) * 16 * N_SHARDS;
+
+    context_cache cache(budget, loader, 0);
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < n_threads; t++) {
+      threads.emplace_back([&cache, t]() {
+        for (size_t i = 0; i < n_lookups; i++) {
+          const uint64_t id = (i * 7 + t) % 512;
+          assert(cache.get(id));
+        }
+      });
+    }
+    for (auto& th : threads) {
+      th.join();
+    }
+
+    const stats_t st = cache.stats();
+    assert(st.hits + st.misses == n_threads * n_lookups);
+    assert(st.bytes <= budget);
+  }
+
+  // deallocate all resources
+  std::free(lut);
+  std::free(txt);
+  std::free(enc0);
+  std::free(enc1);
+  std::free(dec);
+}
@@ -0,0 +1,149 @@
+#pragma once
+#include "harpocrates.hpp"
+#include "harpocrates_context.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+// Tests functional correctness of cipher context, by asserting that
+//
+// - its tables are cache line aligned & derived from its look up table
+// - each of its member routines computes same bytes as free routine it wraps
+// - moving & cloning keep tables usable, while copying doesn't compile
+static inline void
+test_harpocrates_context(harpocrates_parallel::thread_pool& pool,
+                         const size_t n_blocks)
+{
+  using namespace harpocrates_context;
+
+  static_assert(!std::is_copy_constructible_v<context>);
+  static_assert(!std::is_copy_assignable_v<context>);
+  static_assert(std::is_nothrow_move_constructible_v<context>);
+
+  constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+  constexpr size_t sector_len = 512;
+
+  const size_t ct_len = n_blocks * blk_len;
+
+  // acquire memory resources
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* nonce = static_cast<uint8_t*>(std::malloc(8));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc0 = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc1 = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+
+  random_data(nonce, 8);
+  random_data(txt, ct_len);
+
+  context ctx(lut);
+
+  const uintptr_t addr = reinterpret_cast<uintptr_t>(ctx.tables());
+  assert(addr % harpocrates_parallel::CACHE_LINE == 0);
+  assert(std::memcmp(ctx.lut(), lut, 256) == 0);
+  assert(std::memcmp(ctx.inv_lut(), inv_lut, 256) == 0);
+  assert(ctx.footprint() == sizeof(tables_t));
+
+  // single block
+  ctx.encrypt(txt, enc0);
+  harpocrates::encrypt(lut, txt, enc1);
+  assert(std::memcmp(enc0, enc1, blk_len) == 0);
+
+  ctx.decrypt(enc0, dec);
+  assert(std::memcmp(dec, txt, blk_len) == 0);
+
+  // bulk, multi-threaded, bitsliced & expanded
+  harpocrates::encrypt_blocks(lut, txt, enc1, n_blocks);
+
+  ctx.encrypt_blocks(txt, enc0, n_blocks);
+  assert(std::memcmp(enc0, enc1, ct_len) == 0);
+
+  ctx.encrypt_blocks(pool, txt, enc0, n_blocks);
+  assert(std::memcmp(enc0, enc1, ct_len) == 0);
+
+  ctx.compile();
+  assert(ctx.has_compiled());
+  assert(ctx.footprint() == sizeof(tables_t) + sizeof(circuits_t));
+
+  ctx.encrypt_blocks_bitsliced(txt, enc0, n_blocks);
+  assert(std::memcmp(enc0, enc1, ct_len) == 0);
+
+  ctx.expand();
+  assert(ctx.has_expanded());
+
+  ctx.encrypt_blocks_expanded(txt, enc0, n_blocks);
+  assert(std::memcmp(enc0, enc1, ct_len) == 0);
+
+  ctx.decrypt_blocks(enc1, dec, n_blocks);
+  assert(std::memcmp(dec, txt, ct_len) == 0);
+
+  ctx.decrypt_blocks(pool, enc1, dec, n_blocks);
+  assert(std::memcmp(dec, txt, ct_len) == 0);
+
+  ctx.decrypt_blocks_bitsliced(enc1, dec, n_blocks);
+  assert(std::memcmp(dec, txt, ct_len) == 0);
+
+  ctx.decrypt_blocks_expanded(enc1, dec, n_blocks);
+  assert(std::memcmp(dec, txt, ct_len) == 0);
+
+  // counter mode
+  harpocrates_ctr::crypt(lut, nonce, 7, txt, enc1, ct_len);
+
+  ctx.crypt(nonce, 7, txt, enc0, ct_len);
+  assert(std::memcmp(enc0, enc1, ct_len) == 0);
+
+  ctx.crypt(pool, nonce, 7, txt, enc0, ct_len);
+  assert(std::memcmp(enc0, enc1, ct_len) == 0);
+
+  // moving, cloning & viewing
+  context moved = std::move(ctx);
+  assert(!ctx && moved);
+  assert(ctx.footprint() == 0);
+
+  context cloned = moved.clone();
+  assert(cloned.tables() != moved.tables());
+  assert(cloned.has_expanded());
+  assert(cloned.has_compiled());
+  assert(cloned.footprint() == moved.footprint());
+
+  ctx = std::move(cloned);
+  assert(ctx && !cloned);
+
+  const context_view view = ctx.view();
+  view.crypt(nonce, 7, txt, enc0, ct_len);
+  assert(std::memcmp(enc0, enc1, ct_len) == 0);
+
+  // XTS-like mode, with tweaks encrypted under another context
+  const size_t n_sectors = ct_len / sector_len;
+  const context tweak = context::generate();
+
+  harpocrates_xts::encrypt_sectors(
+    lut, tweak.lut(), 3, txt, enc1, sector_len, n_sectors);
+
+  view.encrypt_sectors(tweak, 3, txt, enc0, sector_len, n_sectors);
+  assert(std::memcmp(enc0, enc1, n_sectors * sector_len) == 0);
+
+  view.encrypt_sectors(pool, tweak, 3, txt, enc0, sector_len, n_sectors);
+  assert(std::memcmp(enc0, enc1, n_sectors * sector_len) == 0);
+
+  view.decrypt_sectors(tweak, 3, enc0, dec, sector_len, n_sectors);
+  assert(std::memcmp(dec, txt, n_sectors * sector_len) == 0);
+
+  view.decrypt_sectors(pool, tweak, 3, enc0, dec, sector_len, n_sectors);
+  assert(std::memcmp(dec, txt, n_sectors * sector_len) == 0);
+
+  // deallocate all resources
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(nonce);
+  std::free(txt);
+  std::free(enc0);
+  std::free(enc1);
+  std::free(dec);
+}
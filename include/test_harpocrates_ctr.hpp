@@ -0,0 +1,87 @@
+#pragma once
+#include "harpocrates.hpp"
+#include "harpocrates_ctr.hpp"
+#include "utils.hpp"
+#include <cassert>
+
+// Tests functional correctness of Harpocrates in counter mode, by asserting
+// that
+//
+// - keystream is encryption of nonce || counter blocks
+// - encryption starting at some byte offset computes same bytes as encrypting
+//   whole message & taking slice of it
+// - multi-threaded encryption computes same bytes as single threaded one
+// - decryption ( i.e. encryption of encrypted bytes ) recovers message
+static inline void
+test_harpocrates_ctr(harpocrates_parallel::thread_pool& pool,
+                     const size_t msg_len,
+                     const size_t offset)
+{
+  using namespace harpocrates_ctr;
+
+  constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+  const size_t n_blocks = (msg_len + blk_len - 1) / blk_len;
+
+  // acquire memory resources
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* nonce = static_cast<uint8_t*>(std::malloc(NONCE_LEN));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(msg_len));
+  uint8_t* enc0 = static_cast<uint8_t*>(std::malloc(msg_len));
+  uint8_t* enc1 = static_cast<uint8_t*>(std::malloc(msg_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(msg_len));
+  uint8_t* ctrs = static_cast<uint8_t*>(std::malloc(n_blocks * blk_len));
+  uint8_t* ks = static_cast<uint8_t*>(std::malloc(n_blocks * blk_len));
+
+  harpocrates_utils::generate_lut(lut);
+
+  random_data(nonce, NONCE_LEN);
+  random_data(txt, msg_len);
+
+  // keystream
+  counter_blocks(nonce, 0, ctrs, n_blocks);
+  harpocrates::encrypt_blocks(lut, ctrs, ks, n_blocks);
+
+  crypt(lut, nonce, 0, txt, enc0, msg_len);
+
+  for (size_t i = 0; i < msg_len; i++) {
+    assert((enc0[i] ^ txt[i] ^ ks[i]) == 0u);
+  }
+
+  keystream(lut, nonce, offset, enc1, msg_len - offset);
+
+  for (size_t i = offset; i < msg_len; i++) {
+    assert((enc1[i - offset] ^ ks[i]) == 0u);
+  }
+
+  // seeking
+  crypt(lut, nonce, offset, txt + offset, enc1 + offset, msg_len - offset);
+  crypt(lut, nonce, 0, txt, enc1, offset);
+
+  for (size_t i = 0; i < msg_len; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+  }
+
+  // multi-threaded, in-place
+  std::memcpy(enc1, txt, msg_len);
+  crypt(pool, lut, nonce, 0, enc1, enc1, msg_len, 100);
+
+  for (size_t i = 0; i < msg_len; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+  }
+
+  crypt(pool, lut, nonce, 0, enc1, dec, msg_len);
+
+  for (size_t i = 0; i < msg_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0u);
+  }
+
+  // deallocate all resources
+  std::free(lut);
+  std::free(nonce);
+  std::free(txt);
+  std::free(enc0);
+  std::free(enc1);
+  std::free(dec);
+  std::free(ctrs);
+  std::free(ks);
+}
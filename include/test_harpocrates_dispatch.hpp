@@ -0,0 +1,85 @@
+#pragma once
+#include "harpocrates.hpp"
+#include "harpocrates_dispatch.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <cstring>
+
+// Tests functional correctness of run time dispatched Harpocrates cipher, by
+// forcing each kernel supported by executing CPU & asserting that it computes
+// same encrypted/ decrypted bytes as Harpocrates implementation, selected at
+// compile time
+static inline void
+test_harpocrates_dispatch(const size_t n_blocks)
+{
+  using namespace harpocrates_dispatch;
+
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  // acquire memory resources
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc0 = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc1 = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+
+  random_data(txt, ct_len);
+
+  harpocrates::encrypt_blocks(lut, txt, enc0, n_blocks);
+
+  const kernel_t dflt = selected_kernel();
+  assert(is_supported(dflt));
+
+  for (size_t k = 0; k < N_KERNELS; k++) {
+    const kernel_t kernel = static_cast<kernel_t>(k);
+
+    if (!is_supported(kernel)) {
+      assert(!force_kernel(kernel));
+      assert(selected_kernel() == dflt);
+      continue;
+    }
+
+    assert(force_kernel(kernel_name(kernel)));
+    assert(selected_kernel() == kernel);
+    assert(std::strcmp(selected_kernel_name(), KERNEL_NAMES[k]) == 0);
+
+    // bulk API
+    encrypt_blocks(lut, txt, enc1, n_blocks);
+    decrypt_blocks(inv_lut, enc1, dec, n_blocks);
+
+    for (size_t i = 0; i < ct_len; i++) {
+      assert((enc0[i] ^ enc1[i]) == 0u);
+      assert((txt[i] ^ dec[i]) == 0u);
+    }
+
+    // single message block API
+    for (size_t i = 0; i < n_blocks; i++) {
+      const size_t off = i * harpocrates_common::BLOCK_LEN;
+
+      encrypt(lut, txt + off, enc1 + off);
+      decrypt(inv_lut, enc1 + off, dec + off);
+    }
+
+    for (size_t i = 0; i < ct_len; i++) {
+      assert((enc0[i] ^ enc1[i]) == 0u);
+      assert((txt[i] ^ dec[i]) == 0u);
+    }
+  }
+
+  assert(!force_kernel("sse9"));
+
+  reset_kernel();
+  assert(selected_kernel() == dflt);
+
+  // deallocate all resources
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(txt);
+  std::free(enc0);
+  std::free(enc1);
+  std::free(dec);
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "harpocrates.hpp"
+#include "harpocrates_expanded.hpp"
+#include "utils.hpp"
+#include <cassert>
+
+// Tests functional correctness of Harpocrates cipher implementation, using
+// expanded row substitution tables, by asserting that it computes same
+// encrypted/ decrypted bytes as Harpocrates implementation, using only 256
+// -bytes look up table
+static inline void
+test_harpocrates_expanded(const size_t n_blocks)
+{
+  constexpr size_t tbl_len = harpocrates_expanded::TABLE_LEN * sizeof(uint16_t);
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  // acquire memory resources
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(256));
+  uint16_t* tbl = static_cast<uint16_t*>(std::malloc(tbl_len));
+  uint16_t* inv_tbl = static_cast<uint16_t*>(std::malloc(tbl_len));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc0 = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc1 = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+  harpocrates_expanded::expand_lut(lut, tbl);
+  harpocrates_expanded::expand_lut(inv_lut, inv_tbl);
+
+  random_data(txt, ct_len);
+
+  harpocrates::encrypt_blocks(lut, txt, enc0, n_blocks);
+  harpocrates_expanded::encrypt_blocks(lut, tbl, txt, enc1, n_blocks);
+  harpocrates_expanded::decrypt_blocks(inv_lut, inv_tbl, enc1, dec, n_blocks);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+    assert((txt[i] ^ dec[i]) == 0u);
+  }
+
+  // single message block API
+  for (size_t i = 0; i < n_blocks; i++) {
+    const size_t off = i * harpocrates_common::BLOCK_LEN;
+
+    harpocrates_expanded::encrypt(lut, tbl, txt + off, enc1 + off);
+    harpocrates_expanded::decrypt(inv_lut, inv_tbl, enc1 + off, dec + off);
+  }
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+    assert((txt[i] ^ dec[i]) == 0u);
+  }
+
+  // deallocate all resources
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(tbl);
+  std::free(inv_tbl);
+  std::free(txt);
+  std::free(enc0);
+  std::free(enc1);
+  std::free(dec);
+}
@@ -0,0 +1,135 @@
+#pragma once
+#include "harpocrates_ctr.hpp"
+#include "harpocrates_file.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+// Tests functional correctness of whole file encryption, over memory mapped
+// files, by asserting that it computes same bytes as counter mode encryption
+// of in-memory buffer, both when writing to another file & in-place, and that
+// re-encryption under new look up table & nonce does same
+static inline void
+test_harpocrates_file(harpocrates_parallel::thread_pool& pool,
+                      const size_t file_len)
+{
+  using namespace harpocrates_file;
+
+  // acquire memory resources
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* nonce = static_cast<uint8_t*>(std::malloc(8));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(file_len));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(file_len));
+
+  harpocrates_utils::generate_lut(lut);
+
+  random_data(nonce, 8);
+  random_data(txt, file_len);
+
+  harpocrates_ctr::crypt(lut, nonce, 0, txt, enc, file_len);
+
+  char in_path[] = "/tmp/harpocrates_in_XXXXXX";
+  char out_path[] = "/tmp/harpocrates_out_XXXXXX";
+
+  const int in_fd = ::mkstemp(in_path);
+  const int out_fd = ::mkstemp(out_path);
+  assert(in_fd >= 0 && out_fd >= 0);
+
+  const ssize_t n = ::write(in_fd, txt, file_len);
+  assert(n == static_cast<ssize_t>(file_len));
+  ::close(in_fd);
+  ::close(out_fd);
+
+  // to another file
+  const bool ok0 = crypt_file(pool, lut, nonce, in_path, out_path);
+  assert(ok0);
+
+  {
+    mapped_file out;
+    const bool ok = out.open_read(out_path);
+    assert(ok);
+    assert(out.size() == file_len);
+
+    for (size_t i = 0; i < file_len; i++) {
+      assert((out.data()[i] ^ enc[i]) == 0u);
+    }
+  }
+
+  // in-place, twice
+  const bool ok1 = crypt_file(pool, lut, nonce, in_path, nullptr);
+  assert(ok1);
+
+  {
+    mapped_file in;
+    const bool ok = in.open_read(in_path);
+    assert(ok);
+
+    for (size_t i = 0; i < file_len; i++) {
+      assert((in.data()[i] ^ enc[i]) == 0u);
+    }
+  }
+
+  const bool ok2 = crypt_file(pool, lut, nonce, in_path, nullptr);
+  assert(ok2);
+
+  {
+    mapped_file in;
+    const bool ok = in.open_read(in_path);
+    assert(ok);
+
+    for (size_t i = 0; i < file_len; i++) {
+      assert((in.data()[i] ^ txt[i]) == 0u);
+    }
+  }
+
+  // re-encrypted under new look up table & nonce, to another file & back
+  // in-place
+  uint8_t new_lut[256];
+  uint8_t new_nonce[8];
+
+  harpocrates_utils::generate_lut(new_lut);
+  random_data(new_nonce, 8);
+
+  const bool ok3 = crypt_file(pool, lut, nonce, in_path, nullptr);
+  const bool ok4 = transcrypt_file(
+    pool, lut, nonce, new_lut, new_nonce, in_path, out_path);
+  assert(ok3 && ok4);
+
+  harpocrates_ctr::crypt(new_lut, new_nonce, 0, txt, enc, file_len);
+
+  {
+    mapped_file out;
+    const bool ok = out.open_read(out_path);
+    assert(ok);
+    assert(out.size() == file_len);
+
+    for (size_t i = 0; i < file_len; i++) {
+      assert((out.data()[i] ^ enc[i]) == 0u);
+    }
+  }
+
+  const bool ok5 = transcrypt_file(
+    pool, new_lut, new_nonce, lut, nonce, out_path, nullptr);
+  const bool ok6 = crypt_file(pool, lut, nonce, out_path, nullptr);
+  assert(ok5 && ok6);
+
+  {
+    mapped_file out;
+    const bool ok = out.open_read(out_path);
+    assert(ok);
+
+    for (size_t i = 0; i < file_len; i++) {
+      assert((out.data()[i] ^ txt[i]) == 0u);
+    }
+  }
+
+  std::remove(in_path);
+  std::remove(out_path);
+
+  // deallocate all resources
+  std::free(lut);
+  std::free(nonce);
+  std::free(txt);
+  std::free(enc);
+}
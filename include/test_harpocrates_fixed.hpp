@@ -0,0 +1,89 @@
+#pragma once
+#include "harpocrates.hpp"
+#include "harpocrates_fixed.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <vector>
+
+// Inverse look up table is computed during compilation & it's same as one
+// computed at run time
+static_assert(harpocrates_fixed::inverse(harpocrates_fixed::inverse(KAT_LUT)) ==
+                KAT_LUT,
+              "Inverse of inverse look up table must be look up table");
+static_assert(harpocrates_fixed::inv_lut_v<KAT_LUT>[0xda] == 0x00,
+              "Inverse look up table must map lut[i] back to i");
+
+// Tests functional correctness of Harpocrates cipher, specialized for look up
+// table known at compile time, by asserting that it computes same encrypted/
+// decrypted bytes as Harpocrates implementation using that table at run time,
+// for N message blocks ( & one of known answer tests, see Appendix B of
+// Harpocrates specification https://eprint.iacr.org/2022/519.pdf )
+static inline void
+test_harpocrates_fixed(const size_t n_blocks)
+{
+  using namespace harpocrates_fixed;
+
+  constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+  const size_t ct_len = n_blocks * blk_len;
+
+  uint8_t inv_lut[256];
+  harpocrates_utils::generate_inv_lut(KAT_LUT.data(), inv_lut);
+
+  for (size_t i = 0; i < 256; i++) {
+    assert(inv_lut_v<KAT_LUT>[i] == inv_lut[i]);
+  }
+
+  {
+    const uint8_t txt[blk_len] = {};
+    uint8_t enc[blk_len];
+    uint8_t dec[blk_len];
+
+    encrypt<KAT_LUT>(txt, enc);
+    decrypt<KAT_LUT>(enc, dec);
+
+    assert(to_hex(enc, blk_len) == "5f5bc52acc8665cd08700f35b8ab66dc");
+    assert(to_hex(dec, blk_len) == to_hex(txt, blk_len));
+  }
+
+  // acquire memory resources
+  std::vector<uint8_t> txt(ct_len);
+  std::vector<uint8_t> enc0(ct_len);
+  std::vector<uint8_t> enc1(ct_len);
+  std::vector<uint8_t> dec(ct_len);
+
+  random_data(txt.data(), ct_len);
+
+  harpocrates::encrypt_blocks(
+    KAT_LUT.data(), txt.data(), enc0.data(), n_blocks);
+  encrypt_blocks<KAT_LUT>(txt.data(), enc1.data(), n_blocks);
+  decrypt_blocks<KAT_LUT>(enc1.data(), dec.data(), n_blocks);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+    assert((txt[i] ^ dec[i]) == 0u);
+  }
+
+  // portable column substitution, in-place
+  using harpocrates_utils::column_substitution_swar;
+
+  encrypt_blocks<KAT_LUT, column_substitution_swar>(
+    txt.data(), dec.data(), n_blocks);
+  decrypt_blocks<KAT_LUT, column_substitution_swar>(
+    dec.data(), dec.data(), n_blocks);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0u);
+  }
+
+  for (size_t i = 0; i < n_blocks; i++) {
+    const size_t off = i * blk_len;
+
+    encrypt<KAT_LUT>(txt.data() + off, enc1.data() + off);
+    decrypt<KAT_LUT>(enc1.data() + off, dec.data() + off);
+  }
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+    assert((txt[i] ^ dec[i]) == 0u);
+  }
+}
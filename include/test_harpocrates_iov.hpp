@@ -0,0 +1,85 @@
+#pragma once
+#include "harpocrates.hpp"
+#include "harpocrates_ctr.hpp"
+#include "harpocrates_iov.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <vector>
+
+// Splits N -bytes buffer into segments of random lengths ( including empty
+// ones ), none of them longer than `max_seg` bytes
+static inline std::vector<iovec>
+random_segments(uint8_t* const buf, const size_t len, const size_t max_seg)
+{
+  std::vector<iovec> segs;
+
+  size_t off = 0;
+  while (off < len) {
+    uint8_t r[2];
+    random_data(r, sizeof(r));
+
+    const size_t seg = std::min<size_t>(((r[0] << 8) | r[1]) % (max_seg + 1),
+                                        len - off);
+
+    segs.push_back({ buf + off, seg });
+    off += seg;
+  }
+
+  return segs;
+}
+
+// Tests functional correctness of scatter-gather encryption, by asserting
+// that, when N -bytes message & its output are split into ( differently )
+// randomly sized segments, it computes same bytes as
+//
+// - `harpocrates::encrypt_blocks`, on flat message, while decryption ( in-place
+//   ) recovers message
+// - `harpocrates_ctr::crypt`, on flat message, starting at given byte offset
+static inline void
+test_harpocrates_iov(const size_t msg_len,
+                     const size_t max_seg,
+                     const uint64_t offset)
+{
+  using namespace harpocrates_iov;
+
+  constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+  const size_t n_blocks = msg_len / blk_len;
+
+  uint8_t lut[256];
+  uint8_t inv_lut[256];
+  uint8_t nonce[harpocrates_ctr::NONCE_LEN];
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+  random_data(nonce, sizeof(nonce));
+
+  // acquire memory resources
+  std::vector<uint8_t> txt(msg_len);
+  std::vector<uint8_t> enc0(msg_len);
+  std::vector<uint8_t> enc1(msg_len);
+
+  random_data(txt.data(), msg_len);
+
+  const auto in = random_segments(txt.data(), msg_len, max_seg);
+  const auto out = random_segments(enc1.data(), msg_len, max_seg);
+
+  harpocrates::encrypt_blocks(lut, txt.data(), enc0.data(), n_blocks);
+  encrypt_iov(lut, in, out);
+
+  for (size_t i = 0; i < n_blocks * blk_len; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+  }
+
+  decrypt_iov(inv_lut, out, out);
+
+  for (size_t i = 0; i < n_blocks * blk_len; i++) {
+    assert((txt[i] ^ enc1[i]) == 0u);
+  }
+
+  harpocrates_ctr::crypt(lut, nonce, offset, txt.data(), enc0.data(), msg_len);
+  crypt_iov(lut, nonce, offset, in, out);
+
+  for (size_t i = 0; i < msg_len; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+  }
+}
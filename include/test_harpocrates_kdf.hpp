@@ -0,0 +1,154 @@
+#pragma once
+#include "harpocrates.hpp"
+#include "harpocrates_context.hpp"
+#include "harpocrates_kdf.hpp"
+#include "utils.hpp"
+#include <cassert>
+
+// Tests ChaCha20 block function against test vector given in section 2.3.2 of
+// RFC 8439 https://www.rfc-editor.org/rfc/rfc8439
+static inline void
+test_chacha20_block()
+{
+  constexpr uint8_t nonce[12] = { 0x00, 0x00, 0x00, 0x09, 0x00, 0x00,
+                                  0x00, 0x4a, 0x00, 0x00, 0x00, 0x00 };
+  constexpr uint8_t expected[64] = {
+    0x10, 0xf1, 0xe7, 0xe4, 0xd1, 0x3b, 0x59, 0x15, 0x50, 0x0f, 0xdd, 0x1f,
+    0xa3, 0x20, 0x71, 0xc4, 0xc7, 0xd1, 0xf4, 0xc7, 0x33, 0xc0, 0x68, 0x03,
+    0x04, 0x22, 0xaa, 0x9a, 0xc3, 0xd4, 0x6c, 0x4e, 0xd2, 0x82, 0x64, 0x46,
+    0x07, 0x9f, 0xaa, 0x09, 0x14, 0xc2, 0xd7, 0x05, 0xd9, 0x8b, 0x02, 0xa2,
+    0xb5, 0x12, 0x9c, 0xd1, 0xde, 0x16, 0x4e, 0xb9, 0xcb, 0xd0, 0x83, 0xe8,
+    0xa2, 0x50, 0x3c, 0x4e
+  };
+
+  uint8_t key[32];
+  uint8_t out[64];
+
+  for (size_t i = 0; i < 32; i++) {
+    key[i] = static_cast<uint8_t>(i);
+  }
+
+  harpocrates_kdf::chacha20_block<32>(key, 1, nonce, out);
+
+  for (size_t i = 0; i < 64; i++) {
+    assert(out[i] == expected[i]);
+  }
+}
+
+// Tests that computing many ChaCha20 blocks together produces same keystream
+// as computing them one by one, for both 128 -bit & 256 -bit keys
+template<const size_t key_len>
+static inline void
+test_chacha20_blocks()
+{
+  using namespace harpocrates_kdf;
+
+  constexpr size_t ks_len = DERIVE_BLOCKS * CHACHA_BLOCK_LEN;
+
+  uint8_t key[key_len];
+  uint8_t nonce[12];
+  uint8_t ks0[ks_len];
+  uint8_t ks1[ks_len];
+
+  random_data(key, key_len);
+  random_data(nonce, sizeof(nonce));
+
+  const uint32_t ctr = 0xfffffffcu; // wraps around
+
+  chacha20_blocks<key_len>(key, ctr, nonce, ks0);
+  for (size_t i = 0; i < DERIVE_BLOCKS; i++) {
+    const uint32_t c = ctr + static_cast<uint32_t>(i);
+    chacha20_block<key_len>(key, c, nonce, ks1 + i * CHACHA_BLOCK_LEN);
+  }
+
+  assert(std::memcmp(ks0, ks1, ks_len) == 0);
+}
+
+// Tests keyed look up table derivation, by asserting that
+//
+// - look up table derived from key 00..1f & identifier 0x0102030405060708 is
+//   same as computed by an independent implementation ( using OpenSSL's
+//   ChaCha20 keystream )
+// - derived look up tables are permutations, same for same key & identifier,
+//   different otherwise, & usable for encrypt -> decrypt cycle
+static inline void
+test_harpocrates_kdf()
+{
+  using namespace harpocrates_kdf;
+
+  constexpr uint8_t expected[256] = {
+    0xfe, 0x07, 0x0e, 0xb3, 0x62, 0x24, 0x2d, 0x60, 0xf8, 0x1a, 0xeb, 0x20,
+    0x3f, 0x9b, 0x71, 0x2a, 0x01, 0xbd, 0xb9, 0x81, 0xaa, 0xa5, 0xc8, 0xac,
+    0x66, 0x0c, 0x16, 0xc4, 0x49, 0x08, 0x5d, 0x5c, 0xf1, 0x25, 0x8c, 0x1b,
+    0xba, 0xb5, 0x4b, 0x59, 0x1d, 0xbc, 0x70, 0x46, 0x29, 0xab, 0x28, 0x7b,
+    0xd8, 0xfc, 0x88, 0x8e, 0xbf, 0x9e, 0xc7, 0x6d, 0x3e, 0x14, 0xdd, 0x83,
+    0xb1, 0xca, 0x2b, 0xc6, 0x1f, 0xf4, 0xff, 0x06, 0x41, 0xf6, 0x86, 0xfa,
+    0x94, 0xf3, 0x3b, 0xbb, 0x35, 0x3a, 0x22, 0xd3, 0x5b, 0x50, 0xd6, 0xe3,
+    0xee, 0x68, 0x15, 0x53, 0xa9, 0x40, 0x55, 0x2c, 0x9a, 0x7f, 0x4a, 0x5f,
+    0xc9, 0xf7, 0x21, 0x7e, 0x27, 0xa0, 0xd0, 0xe1, 0x32, 0x8f, 0xe5, 0xc1,
+    0xb8, 0x52, 0xed, 0xea, 0x56, 0x51, 0x93, 0xa7, 0x05, 0x10, 0x65, 0x6e,
+    0x1c, 0x69, 0x5a, 0x0a, 0x4e, 0xd2, 0x09, 0x02, 0x42, 0x61, 0xd1, 0x3c,
+    0x11, 0x36, 0x4f, 0x0b, 0x76, 0x45, 0x8b, 0x98, 0x43, 0x4d, 0x03, 0xdf,
+    0x00, 0x58, 0xde, 0xa8, 0xdc, 0x30, 0xe9, 0x8a, 0x0d, 0xf0, 0x48, 0xcc,
+    0x57, 0x38, 0x77, 0x26, 0x99, 0x84, 0xf2, 0x04, 0x54, 0xd7, 0x34, 0xe6,
+    0xd4, 0xb2, 0xdb, 0x6b, 0x47, 0x44, 0xb0, 0x33, 0x1e, 0xad, 0x13, 0xe8,
+    0xbe, 0xc2, 0x7c, 0xa2, 0x2f, 0x85, 0x7a, 0xcd, 0xe0, 0x91, 0x17, 0x39,
+    0xaf, 0xc3, 0xe2, 0xc5, 0x74, 0xc0, 0x78, 0xd9, 0xb4, 0x4c, 0xa3, 0x64,
+    0x5e, 0x79, 0xf5, 0x80, 0xae, 0x82, 0x3d, 0xce, 0x19, 0x90, 0x6c, 0xe4,
+    0x0f, 0x96, 0x8d, 0xef, 0x87, 0x67, 0x23, 0x7d, 0x89, 0xfd, 0xe7, 0xcb,
+    0x75, 0x73, 0xb6, 0xfb, 0x9f, 0x37, 0x92, 0x6a, 0x72, 0x12, 0xec, 0x63,
+    0xda, 0x9c, 0xf9, 0xa4, 0xcf, 0xa6, 0x2e, 0x97, 0x6f, 0x95, 0x18, 0xa1,
+    0xd5, 0x9d, 0x31, 0xb7
+  };
+
+  uint8_t key[32];
+  uint8_t lut0[256];
+  uint8_t lut1[256];
+
+  for (size_t i = 0; i < 32; i++) {
+    key[i] = static_cast<uint8_t>(i);
+  }
+
+  derive_lut<32>(key, 0x0102030405060708ul, lut0);
+
+  for (size_t i = 0; i < 256; i++) {
+    assert(lut0[i] == expected[i]);
+  }
+
+  for (const uint64_t id : { 0ul, 1ul, 1ul << 63 }) {
+    bool seen[256] = {};
+
+    derive_lut<16>(key, id, lut0);
+    derive_lut<16>(key, id, lut1);
+
+    for (size_t i = 0; i < 256; i++) {
+      assert(lut0[i] == lut1[i]);
+      assert(!seen[lut0[i]]);
+
+      seen[lut0[i]] = true;
+    }
+
+    derive_lut<16>(key, id + 1, lut1);
+    assert(std::memcmp(lut0, lut1, 256) != 0);
+
+    derive_lut<32>(key, id, lut1);
+    assert(std::memcmp(lut0, lut1, 256) != 0);
+  }
+
+  // cipher context, from derived look up table
+  const auto ctx = harpocrates_context::context::derive<32>(key, 7);
+  derive_lut<32>(key, 7, lut0);
+
+  assert(std::memcmp(ctx.lut(), lut0, 256) == 0);
+
+  uint8_t txt[16];
+  uint8_t enc[16];
+  uint8_t dec[16];
+
+  random_data(txt, sizeof(txt));
+
+  ctx.encrypt(txt, enc);
+  ctx.decrypt(enc, dec);
+
+  assert(std::memcmp(txt, dec, sizeof(txt)) == 0);
+}
@@ -0,0 +1,159 @@
+#pragma once
+#include "harpocrates.hpp"
+#include "harpocrates_keystore.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// Tests keystore of precomputed cipher contexts, by asserting that
+//
+// - context of each key, looked up in memory mapped keystore, holds same
+//   tables as context computed from its look up table & encrypts/ decrypts
+//   same way
+// - keystore is accessible only by its owner & concurrent builders of same
+//   keystore don't interfere
+// - unknown keys aren't found, while keys with duplicate identifiers &
+//   corrupted keystores are rejected, leaving keystore empty
+static inline void
+test_harpocrates_keystore(const size_t n_keys, const bool expanded)
+{
+  using namespace harpocrates_keystore;
+
+  constexpr size_t n_blocks = 33;
+  constexpr size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  // acquire memory resources
+  uint8_t* luts = static_cast<uint8_t*>(std::malloc(n_keys * 256 + 1));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc0 = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc1 = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  uint8_t key[32];
+  random_data(key, sizeof(key));
+  random_data(txt, ct_len);
+
+  // identifiers are spread out & given in descending order
+  std::vector<key_entry_t> keys(n_keys);
+  for (size_t i = 0; i < n_keys; i++) {
+    const uint64_t id = (n_keys - i) * 3;
+
+    harpocrates_kdf::derive_lut<32>(key, id, luts + i * 256);
+    keys[i] = { id, luts + i * 256 };
+  }
+
+  char path[] = "/tmp/harpocrates_keystore_XXXXXX";
+  const int fd = ::mkstemp(path);
+  assert(fd >= 0);
+  ::close(fd);
+
+  const bool built = build(path, keys.data(), n_keys, expanded);
+  assert(built);
+
+  // only owner can access keystore
+  {
+    struct stat st;
+    const int ret = ::stat(path, &st);
+    assert(ret == 0 && (st.st_mode & 0777) == 0600);
+  }
+
+  // concurrent builders of same keystore don't clobber each other's files
+  {
+    bool ok[4] = {};
+    std::vector<std::thread> builders;
+
+    for (size_t t = 0; t < 4; t++) {
+      builders.emplace_back(
+        [&, t]() { ok[t] = build(path, keys.data(), n_keys, expanded); });
+    }
+    for (auto& b : builders) {
+      b.join();
+    }
+
+    assert(ok[0] && ok[1] && ok[2] && ok[3]);
+  }
+
+  {
+    keystore ks;
+    const bool ok = ks.open(path);
+    assert(ok);
+    assert(ks.size() == n_keys);
+
+    for (size_t i = 0; i < n_keys; i++) {
+      const harpocrates_context::context_view view = ks.find(keys[i].id);
+      const harpocrates_context::context ctx(keys[i].lut);
+
+      assert(view);
+      assert(view.has_expanded() == expanded);
+      assert(!view.has_compiled());
+      assert(std::memcmp(view.tables(), ctx.tables(), sizeof(*ctx.tables())) ==
+             0);
+
+      const uintptr_t addr = reinterpret_cast<uintptr_t>(view.tables());
+      assert(addr % harpocrates_parallel::CACHE_LINE == 0);
+
+      harpocrates::encrypt_blocks(keys[i].lut, txt, enc0, n_blocks);
+
+      view.encrypt_blocks(txt, enc1, n_blocks);
+      assert(std::memcmp(enc0, enc1, ct_len) == 0);
+
+      view.decrypt_blocks(enc1, dec, n_blocks);
+      assert(std::memcmp(dec, txt, ct_len) == 0);
+
+      if (expanded) {
+        view.encrypt_blocks_expanded(txt, enc1, n_blocks);
+        assert(std::memcmp(enc0, enc1, ct_len) == 0);
+
+        view.decrypt_blocks_expanded(enc1, dec, n_blocks);
+        assert(std::memcmp(dec, txt, ct_len) == 0);
+      }
+
+      assert(!ks.find(keys[i].id + 1));
+    }
+
+    for (size_t i = 1; i < n_keys; i++) {
+      assert(ks.id(i - 1) < ks.id(i));
+    }
+  }
+
+  // duplicate identifiers
+  if (n_keys > 1) {
+    keys[1].id = keys[0].id;
+
+    errno = 0;
+    const bool ok = build(path, keys.data(), n_keys, expanded);
+    assert(!ok && errno == EINVAL);
+  }
+
+  // corrupted keystore
+  {
+    const int wfd = ::open(path, O_WRONLY);
+    const ssize_t n = ::pwrite(wfd, "X", 1, 0);
+    assert(wfd >= 0 && n == 1);
+    ::close(wfd);
+
+    keystore ks;
+
+    errno = 0;
+    const bool ok = ks.open(path);
+    assert(!ok && errno == EINVAL);
+
+    // keystore, which failed to open, holds no keys
+    assert(ks.size() == 0);
+    assert(!ks.find(keys[0].id));
+    assert(!ks.at(0));
+    assert(ks.id(0) == 0);
+  }
+
+  std::remove(path);
+
+  // deallocate all resources
+  std::free(luts);
+  std::free(txt);
+  std::free(enc0);
+  std::free(enc1);
+  std::free(dec);
+}
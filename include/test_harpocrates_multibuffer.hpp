@@ -0,0 +1,112 @@
+#pragma once
+#include "harpocrates.hpp"
+#include "harpocrates_ctr.hpp"
+#include "harpocrates_multibuffer.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <vector>
+
+// Tests functional correctness of multi-buffer API, by asserting that, for
+// N jobs of random lengths ( including empty ones ), it computes same bytes as
+// processing each job on its own, using
+//
+// - `harpocrates::encrypt_blocks`/ `decrypt_blocks`, for messages whose length
+//   is a multiple of 16 -bytes ( decrypting in-place )
+// - `harpocrates_ctr::crypt`, for messages of arbitrary length, starting at
+//   random byte offset, each with its own nonce
+static inline void
+test_harpocrates_multibuffer(const size_t n_jobs, const size_t max_len)
+{
+  using namespace harpocrates_multibuffer;
+
+  constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+
+  uint8_t lut[256];
+  uint8_t inv_lut[256];
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+
+  std::vector<uint32_t> rnd(n_jobs * 2);
+  random_data(reinterpret_cast<uint8_t*>(rnd.data()), rnd.size() * 4);
+
+  std::vector<size_t> lens(n_jobs);
+  std::vector<size_t> offs(n_jobs);
+
+  size_t total = 0;
+  for (size_t i = 0; i < n_jobs; i++) {
+    lens[i] = rnd[2 * i] % (max_len + 1);
+    offs[i] = rnd[2 * i + 1] % 1024;
+    total += lens[i];
+  }
+
+  // acquire memory resources
+  std::vector<uint8_t> txt(total);
+  std::vector<uint8_t> enc0(total);
+  std::vector<uint8_t> enc1(total);
+  std::vector<uint8_t> nonces(n_jobs * harpocrates_ctr::NONCE_LEN);
+
+  random_data(txt.data(), total);
+  random_data(nonces.data(), nonces.size());
+
+  std::vector<job_t> jobs(n_jobs);
+  std::vector<ctr_job_t> ctr_jobs(n_jobs);
+
+  // messages, whose length is a multiple of 16 -bytes
+  size_t off = 0;
+  for (size_t i = 0; i < n_jobs; i++) {
+    const size_t len = lens[i] - lens[i] % blk_len;
+
+    harpocrates::encrypt_blocks(
+      lut, txt.data() + off, enc0.data() + off, len / blk_len);
+    jobs[i] = { txt.data() + off, enc1.data() + off, len };
+
+    off += lens[i];
+  }
+
+  encrypt_jobs(lut, jobs.data(), n_jobs);
+
+  off = 0;
+  for (size_t i = 0; i < n_jobs; i++) {
+    const size_t len = lens[i] - lens[i] % blk_len;
+
+    for (size_t j = 0; j < len; j++) {
+      assert((enc0[off + j] ^ enc1[off + j]) == 0u);
+    }
+
+    jobs[i].in = jobs[i].out;
+    off += lens[i];
+  }
+
+  decrypt_jobs(inv_lut, jobs.data(), n_jobs);
+
+  off = 0;
+  for (size_t i = 0; i < n_jobs; i++) {
+    const size_t len = lens[i] - lens[i] % blk_len;
+
+    for (size_t j = 0; j < len; j++) {
+      assert((txt[off + j] ^ enc1[off + j]) == 0u);
+    }
+
+    off += lens[i];
+  }
+
+  // messages of arbitrary length, in counter mode
+  off = 0;
+  for (size_t i = 0; i < n_jobs; i++) {
+    const uint8_t* const nonce = nonces.data() + i * harpocrates_ctr::NONCE_LEN;
+
+    harpocrates_ctr::crypt(
+      lut, nonce, offs[i], txt.data() + off, enc0.data() + off, lens[i]);
+    ctr_jobs[i] = { nonce, offs[i], txt.data() + off, enc1.data() + off,
+                    lens[i] };
+
+    off += lens[i];
+  }
+
+  crypt_jobs(lut, ctr_jobs.data(), n_jobs);
+
+  for (size_t i = 0; i < total; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+  }
+}
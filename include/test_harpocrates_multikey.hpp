@@ -0,0 +1,65 @@
+#pragma once
+#include "harpocrates.hpp"
+#include "harpocrates_multikey.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <vector>
+
+// Tests functional correctness of multi-key batch encryption, by asserting
+// that it computes same encrypted bytes as encrypting each block using its own
+// look up table & that decryption ( in-place ) recovers message, when blocks
+// are assigned to `n_keys` look up tables, such that some keys own runs of
+// blocks, while others own blocks scattered all over the batch
+static inline void
+test_harpocrates_multikey(const size_t n_blocks, const size_t n_keys)
+{
+  constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+  const size_t ct_len = n_blocks * blk_len;
+
+  // acquire memory resources
+  std::vector<uint8_t> luts(n_keys * 256);
+  std::vector<uint8_t> inv_luts(n_keys * 256);
+  std::vector<const uint8_t*> blk_luts(n_blocks);
+  std::vector<const uint8_t*> blk_inv_luts(n_blocks);
+  std::vector<uint8_t> txt(ct_len);
+  std::vector<uint8_t> enc0(ct_len);
+  std::vector<uint8_t> enc1(ct_len);
+
+  for (size_t i = 0; i < n_keys; i++) {
+    harpocrates_utils::generate_lut(luts.data() + i * 256);
+    harpocrates_utils::generate_inv_lut(luts.data() + i * 256,
+                                        inv_luts.data() + i * 256);
+  }
+
+  std::vector<uint8_t> sel(n_blocks);
+  random_data(sel.data(), n_blocks);
+  random_data(txt.data(), ct_len);
+
+  for (size_t i = 0; i < n_blocks; i++) {
+    // first two keys own long & short runs, other blocks pick key at random
+    const size_t r = i % 197;
+    const size_t k = r < 80 ? 0 : r < 110 ? 1 % n_keys : sel[i] % n_keys;
+
+    blk_luts[i] = luts.data() + k * 256;
+    blk_inv_luts[i] = inv_luts.data() + k * 256;
+  }
+
+  for (size_t i = 0; i < n_blocks; i++) {
+    const size_t off = i * blk_len;
+    harpocrates::encrypt(blk_luts[i], txt.data() + off, enc0.data() + off);
+  }
+
+  using namespace harpocrates_multikey;
+
+  encrypt_blocks(blk_luts.data(), txt.data(), enc1.data(), n_blocks);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+  }
+
+  decrypt_blocks(blk_inv_luts.data(), enc1.data(), enc1.data(), n_blocks);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((txt[i] ^ enc1[i]) == 0u);
+  }
+}
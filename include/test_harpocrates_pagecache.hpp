@@ -0,0 +1,185 @@
+#pragma once
+#include "harpocrates_pagecache.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// Tests page cache over encrypted backing file, by asserting that, for random
+// reads & writes ( of random lengths, crossing page boundaries ) of a file of
+// N pages, through a cache holding fewer pages than that
+//
+// - reads return what was last written ( or zeros, for pages never written ),
+//   while pages get evicted & dirty ones get written back
+// - after flush, each page of backing file is encryption of that page, in
+//   XTS-like mode, under page number, which another cache decrypts back
+// - concurrent readers & writers ( of disjoint pages, from many threads ) are
+//   safe & invalid page lengths are rejected
+static inline void
+test_harpocrates_pagecache(const size_t n_pages,
+                           const size_t capacity,
+                           const size_t page_len,
+                           const size_t n_shards)
+{
+  using namespace harpocrates_pagecache;
+
+  constexpr size_t n_ops = 512;
+
+  const size_t file_len = n_pages * page_len;
+
+  uint8_t lut[256];
+  uint8_t inv_lut[256];
+  uint8_t tweak_lut[256];
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+  harpocrates_utils::generate_lut(tweak_lut);
+
+  // acquire memory resources
+  std::vector<uint8_t> model(file_len, 0);
+  std::vector<uint8_t> buf(file_len);
+
+  char path[] = "/tmp/harpocrates_pagecache_XXXXXX";
+  const int fd = ::mkstemp(path);
+  assert(fd >= 0);
+  ::close(fd);
+
+  // returns random value in [0, n)
+  auto rnd = [](const uint64_t n) {
+    uint64_t r;
+    random_data(reinterpret_cast<uint8_t*>(&r), sizeof(r));
+    return r % n;
+  };
+
+  {
+    page_cache cache(lut, tweak_lut, capacity, page_len, n_shards);
+    const bool ok_open = cache.open(path);
+    assert(ok_open);
+
+    for (size_t i = 0; i < n_ops; i++) {
+      const uint64_t off = rnd(file_len);
+      const size_t len = rnd(std::min(file_len - off, page_len * 3) + 1);
+
+      if (rnd(2) == 0) {
+        random_data(model.data() + off, len);
+        const bool ok_write = cache.write(off, model.data() + off, len);
+        assert(ok_write);
+      } else {
+        const bool ok_read = cache.read(off, buf.data(), len);
+        assert(ok_read);
+        assert(std::memcmp(model.data() + off, buf.data(), len) == 0);
+      }
+    }
+
+    // whole pages are overwritten, without being read
+    const uint64_t beg = rnd(n_pages) * page_len;
+    random_data(model.data() + beg, page_len);
+    const bool ok_whole = cache.write(beg, model.data() + beg, page_len);
+    assert(ok_whole);
+
+    const bool ok_read = cache.read(0, buf.data(), file_len);
+    assert(ok_read);
+    assert(std::memcmp(model.data(), buf.data(), file_len) == 0);
+
+    const stats_t st = cache.stats();
+    assert(st.misses > 0 && st.hits > 0);
+    if (n_pages > capacity) {
+      assert(st.evictions > 0 && st.writebacks > 0);
+    }
+
+    const bool ok_flush = cache.flush();
+    assert(ok_flush);
+  }
+
+  // backing file holds pages encrypted under their page numbers, except those
+  // never written, which are holes
+  {
+    const int rfd = ::open(path, O_RDONLY);
+    assert(rfd >= 0);
+
+    const ssize_t n = ::pread(rfd, buf.data(), file_len, 0);
+    ::close(rfd);
+
+    assert(n >= 0 && static_cast<size_t>(n) % page_len == 0);
+
+    for (size_t p = 0; p < static_cast<size_t>(n) / page_len; p++) {
+      uint8_t* const page = buf.data() + p * page_len;
+
+      uint8_t acc = 0;
+      for (size_t i = 0; i < page_len; i++) {
+        acc |= page[i];
+      }
+      if (acc == 0) {
+        continue;
+      }
+
+      harpocrates_xts::decrypt_sectors(
+        inv_lut, tweak_lut, p, page, page, page_len, 1);
+      assert(std::memcmp(model.data() + p * page_len, page, page_len) == 0);
+    }
+  }
+
+  // concurrent readers & writers, where i-th thread writes only pages p, such
+  // that p % n_threads == i, while reading any page
+  {
+    constexpr size_t n_threads = 4;
+
+    page_cache cache(lut, tweak_lut, capacity, page_len, n_shards);
+    const bool ok_open = cache.open(path);
+    assert(ok_open);
+
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < n_threads; t++) {
+      threads.emplace_back([&, t]() {
+        std::vector<uint8_t> page(page_len);
+
+        for (size_t i = 0; i < n_ops / n_threads; i++) {
+          const uint64_t p = rnd(n_pages);
+
+          const bool ok_read = cache.read(p * page_len, page.data(), page_len);
+          assert(ok_read);
+
+          if (p % n_threads == t) {
+            uint8_t* const dst = model.data() + p * page_len;
+
+            assert(std::memcmp(dst, page.data(), page_len) == 0);
+
+            random_data(dst, page_len);
+            const bool ok_write = cache.write(p * page_len, dst, page_len);
+            assert(ok_write);
+          }
+        }
+      });
+    }
+
+    for (auto& th : threads) {
+      th.join();
+    }
+
+    const bool ok_close = cache.close();
+    assert(ok_close);
+  }
+
+  {
+    page_cache cache(lut, tweak_lut, capacity, page_len, n_shards);
+
+    const bool ok_open = cache.open(path);
+    const bool ok_read = ok_open && cache.read(0, buf.data(), file_len);
+    assert(ok_read);
+    assert(std::memcmp(model.data(), buf.data(), file_len) == 0);
+  }
+
+  // invalid page length
+  {
+    page_cache cache(lut, tweak_lut, capacity, page_len + 1, n_shards);
+
+    errno = 0;
+    const bool ok_open = cache.open(path);
+    assert(!ok_open && errno == EINVAL);
+  }
+
+  std::remove(path);
+}
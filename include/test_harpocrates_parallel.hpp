@@ -0,0 +1,83 @@
+#pragma once
+#include "harpocrates.hpp"
+#include "harpocrates_parallel.hpp"
+#include "utils.hpp"
+#include <atomic>
+#include <cassert>
+#include <vector>
+
+// Tests that thread pool invokes task function exactly once, for each task
+// index, when same pool is reused across many calls & when tasks themselves
+// call `parallel_for` on same pool
+static inline void
+test_thread_pool(harpocrates_parallel::thread_pool& pool, const size_t n_tasks)
+{
+  std::vector<std::atomic<size_t>> cnts(n_tasks);
+
+  for (size_t itr = 0; itr < 4; itr++) {
+    pool.parallel_for(n_tasks, [&](const size_t i) {
+      cnts[i].fetch_add(1, std::memory_order_relaxed);
+    });
+  }
+
+  for (size_t i = 0; i < n_tasks; i++) {
+    assert(cnts[i].load() == 4);
+  }
+
+  // nested calls
+  constexpr size_t n_inner = 8;
+  std::vector<std::atomic<size_t>> nested(n_tasks * n_inner);
+
+  pool.parallel_for(n_tasks, [&](const size_t i) {
+    pool.parallel_for(n_inner, [&](const size_t j) {
+      nested[i * n_inner + j].fetch_add(1, std::memory_order_relaxed);
+    });
+  });
+
+  for (size_t i = 0; i < n_tasks * n_inner; i++) {
+    assert(nested[i].load() == 1);
+  }
+}
+
+// Tests functional correctness of multi-threaded Harpocrates cipher, by
+// asserting that it computes same encrypted/ decrypted bytes as single
+// threaded implementation, when buffer is split into chunks of `chunk_blocks`
+static inline void
+test_harpocrates_parallel(harpocrates_parallel::thread_pool& pool,
+                          const size_t n_blocks,
+                          const size_t chunk_blocks)
+{
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  // acquire memory resources
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc0 = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc1 = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+
+  random_data(txt, ct_len);
+
+  using namespace harpocrates_parallel;
+
+  harpocrates::encrypt_blocks(lut, txt, enc0, n_blocks);
+  encrypt_blocks(pool, lut, txt, enc1, n_blocks, chunk_blocks);
+  decrypt_blocks(pool, inv_lut, enc1, dec, n_blocks, chunk_blocks);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+    assert((txt[i] ^ dec[i]) == 0u);
+  }
+
+  // deallocate all resources
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(txt);
+  std::free(enc0);
+  std::free(enc1);
+  std::free(dec);
+}
@@ -0,0 +1,69 @@
+#pragma once
+#include "harpocrates.hpp"
+#include "harpocrates_simd.hpp"
+#include "utils.hpp"
+#include <cassert>
+
+#if defined __x86_64__
+
+// Tests functional correctness of vectorized Harpocrates cipher
+// implementations, by asserting that they compute same encrypted/ decrypted
+// bytes as scalar implementation, on random message blocks
+//
+// Implementations requiring CPU extensions, which are not available on
+// executing CPU, are skipped
+static inline void
+test_harpocrates_simd(const size_t n_blocks)
+{
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  // acquire memory resources
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc0 = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc1 = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+
+  random_data(txt, ct_len);
+
+  harpocrates::encrypt_blocks(lut, txt, enc0, n_blocks);
+
+  if (__builtin_cpu_supports("avx2")) {
+    using namespace harpocrates_simd;
+
+    avx2::encrypt_blocks(lut, txt, enc1, n_blocks);
+    avx2::decrypt_blocks(inv_lut, enc1, dec, n_blocks);
+
+    for (size_t i = 0; i < ct_len; i++) {
+      assert((enc0[i] ^ enc1[i]) == 0u);
+      assert((txt[i] ^ dec[i]) == 0u);
+    }
+  }
+
+  if (__builtin_cpu_supports("avx512bw") &&
+      __builtin_cpu_supports("avx512vbmi")) {
+    using namespace harpocrates_simd;
+
+    avx512::encrypt_blocks(lut, txt, enc1, n_blocks);
+    avx512::decrypt_blocks(inv_lut, enc1, dec, n_blocks);
+
+    for (size_t i = 0; i < ct_len; i++) {
+      assert((enc0[i] ^ enc1[i]) == 0u);
+      assert((txt[i] ^ dec[i]) == 0u);
+    }
+  }
+
+  // deallocate all resources
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(txt);
+  std::free(enc0);
+  std::free(enc1);
+  std::free(dec);
+}
+
+#endif
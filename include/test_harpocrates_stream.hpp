@@ -0,0 +1,68 @@
+#pragma once
+#include "harpocrates_ctr.hpp"
+#include "harpocrates_stream.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <vector>
+
+// Tests functional correctness of stream encryptor, by asserting that, when N
+// -bytes message ( starting at given byte offset ) is passed to it in pieces of
+// random lengths ( at most `max_piece` bytes, including empty ones ), it
+// computes same bytes as `harpocrates_ctr::crypt` does on whole message & that
+// another stream, fed with differently sized pieces, decrypts it in-place
+static inline void
+test_harpocrates_stream(const size_t msg_len,
+                        const size_t max_piece,
+                        const uint64_t offset)
+{
+  using namespace harpocrates_stream;
+
+  uint8_t lut[256];
+  uint8_t nonce[harpocrates_ctr::NONCE_LEN];
+
+  harpocrates_utils::generate_lut(lut);
+  random_data(nonce, sizeof(nonce));
+
+  // acquire memory resources
+  std::vector<uint8_t> txt(msg_len);
+  std::vector<uint8_t> enc0(msg_len);
+  std::vector<uint8_t> enc1(msg_len);
+
+  random_data(txt.data(), msg_len);
+
+  harpocrates_ctr::crypt(lut, nonce, offset, txt.data(), enc0.data(), msg_len);
+
+  // feeds whole message to stream, in randomly sized pieces
+  auto feed = [&](ctr_stream& s, const uint8_t* const in, uint8_t* const out) {
+    size_t off = 0;
+
+    while (off < msg_len) {
+      uint8_t r[2];
+      random_data(r, sizeof(r));
+
+      const size_t rnd = static_cast<size_t>((r[0] << 8) | r[1]);
+      const size_t len = std::min(rnd % (max_piece + 1), msg_len - off);
+
+      s.update(in + off, out + off, len);
+      off += len;
+
+      assert(s.position() == offset + off);
+    }
+
+    assert(s.finalize() == msg_len);
+  };
+
+  ctr_stream enc_stream(lut, nonce, offset);
+  feed(enc_stream, txt.data(), enc1.data());
+
+  for (size_t i = 0; i < msg_len; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+  }
+
+  ctr_stream dec_stream(lut, nonce, offset);
+  feed(dec_stream, enc1.data(), enc1.data());
+
+  for (size_t i = 0; i < msg_len; i++) {
+    assert((txt[i] ^ enc1[i]) == 0u);
+  }
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include "harpocrates.hpp"
+#include "harpocrates_ctr.hpp"
+#include "harpocrates_dispatch.hpp"
+#include "harpocrates_parallel.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <vector>
+
+// Tests functional correctness of fused re-encryption, by asserting that, for
+// N message blocks encrypted under old look up table, it computes same bytes
+// as encrypting them under new look up table, using
+//
+// - `harpocrates::transcrypt_blocks`, selected at compile time
+// - `harpocrates_dispatch::transcrypt_blocks`, with each kernel supported by
+//   executing CPU, in-place
+// - `harpocrates_parallel::transcrypt_blocks`, across workers of thread pool
+//
+// and that counter mode re-encryption ( under new nonce, starting at given
+// byte offset ) computes same bytes as `harpocrates_ctr::crypt`, under new
+// look up table & nonce
+static inline void
+test_harpocrates_transcrypt(harpocrates_parallel::thread_pool& pool,
+                            const size_t n_blocks,
+                            const uint64_t offset)
+{
+  using namespace harpocrates_dispatch;
+
+  const size_t ct_len = n_blocks * harpocrates_common::BLOCK_LEN;
+
+  uint8_t old_lut[256];
+  uint8_t old_inv_lut[256];
+  uint8_t new_lut[256];
+  uint8_t old_nonce[harpocrates_ctr::NONCE_LEN];
+  uint8_t new_nonce[harpocrates_ctr::NONCE_LEN];
+
+  harpocrates_utils::generate_lut(old_lut);
+  harpocrates_utils::generate_inv_lut(old_lut, old_inv_lut);
+  harpocrates_utils::generate_lut(new_lut);
+
+  random_data(old_nonce, sizeof(old_nonce));
+  random_data(new_nonce, sizeof(new_nonce));
+
+  // acquire memory resources
+  std::vector<uint8_t> txt(ct_len);
+  std::vector<uint8_t> enc(ct_len);
+  std::vector<uint8_t> enc0(ct_len);
+  std::vector<uint8_t> enc1(ct_len);
+
+  random_data(txt.data(), ct_len);
+
+  harpocrates::encrypt_blocks(old_lut, txt.data(), enc.data(), n_blocks);
+  harpocrates::encrypt_blocks(new_lut, txt.data(), enc0.data(), n_blocks);
+
+  harpocrates::transcrypt_blocks(
+    old_inv_lut, new_lut, enc.data(), enc1.data(), n_blocks);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+  }
+
+  for (size_t k = 0; k < N_KERNELS; k++) {
+    const kernel_t kernel = static_cast<kernel_t>(k);
+
+    if (!force_kernel(kernel)) {
+      continue;
+    }
+
+    enc1 = enc;
+    transcrypt_blocks(old_inv_lut, new_lut, enc1.data(), enc1.data(), n_blocks);
+
+    for (size_t i = 0; i < ct_len; i++) {
+      assert((enc0[i] ^ enc1[i]) == 0u);
+    }
+  }
+
+  reset_kernel();
+
+  harpocrates_parallel::transcrypt_blocks(
+    pool, old_inv_lut, new_lut, enc.data(), enc1.data(), n_blocks, 7);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+  }
+
+  // in counter mode, over message of arbitrary length
+  const size_t msg_len = ct_len + n_blocks % 11;
+
+  txt.resize(msg_len);
+  enc.resize(msg_len);
+  enc0.resize(msg_len);
+  enc1.resize(msg_len);
+
+  random_data(txt.data(), msg_len);
+
+  using harpocrates_ctr::crypt;
+  using harpocrates_ctr::transcrypt;
+
+  crypt(old_lut, old_nonce, offset, txt.data(), enc.data(), msg_len);
+  crypt(new_lut, new_nonce, offset, txt.data(), enc0.data(), msg_len);
+
+  transcrypt(old_lut,
+             old_nonce,
+             new_lut,
+             new_nonce,
+             offset,
+             enc.data(),
+             enc1.data(),
+             msg_len);
+
+  for (size_t i = 0; i < msg_len; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+  }
+
+  enc1 = enc;
+  transcrypt(pool,
+             old_lut,
+             old_nonce,
+             new_lut,
+             new_nonce,
+             offset,
+             enc1.data(),
+             enc1.data(),
+             msg_len,
+             1000);
+
+  for (size_t i = 0; i < msg_len; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+  }
+}
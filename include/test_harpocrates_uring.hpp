@@ -0,0 +1,281 @@
+#pragma once
+#include "harpocrates_ctr.hpp"
+#include "harpocrates_uring.hpp"
+#include "utils.hpp"
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// Reads whole file & asserts that it holds expected bytes
+static inline void
+assert_file_bytes(const int fd, const uint8_t* const expected, const size_t len)
+{
+  uint64_t flen = 0;
+  const bool ok = harpocrates_uring::fd_length(fd, &flen);
+  assert(ok);
+  assert(flen == len);
+
+  uint8_t* buf = static_cast<uint8_t*>(std::malloc(len + 1));
+  const ssize_t n = ::pread(fd, buf, len, 0);
+  assert(n == static_cast<ssize_t>(len));
+
+  for (size_t i = 0; i < len; i++) {
+    assert((buf[i] ^ expected[i]) == 0u);
+  }
+
+  std::free(buf);
+}
+
+// Writes N -bytes into pipe & closes its write end, so that reader sees end of
+// input
+static inline void
+feed_pipe(const int fd, const uint8_t* const data, const size_t len)
+{
+  size_t put = 0;
+
+  while (put < len) {
+    const ssize_t n = ::write(fd, data + put, len - put);
+    assert(n > 0);
+    put += static_cast<size_t>(n);
+  }
+
+  ::close(fd);
+}
+
+// Reads pipe, until its write end is closed, appending bytes to `out` &
+// closes its read end
+static inline void
+drain_pipe(const int fd, std::vector<uint8_t>& out)
+{
+  uint8_t buf[4096];
+
+  while (true) {
+    const ssize_t n = ::read(fd, buf, sizeof(buf));
+    assert(n >= 0);
+    if (n == 0) {
+      break;
+    }
+
+    out.insert(out.end(), buf, buf + n);
+  }
+
+  ::close(fd);
+}
+
+// Runs `fn(in_fd, out_fd)`, where input ( & output, when `out_pipe` is set ) is
+// read end ( write end ) of a pipe, which is fed with N -bytes of `txt` ( or
+// drained into `out` ) by another thread; when output isn't a pipe, `out_fd`
+// is used as is. Returns result of `fn`.
+template<typename F>
+static inline bool
+through_pipes(const bool in_pipe,
+              const bool out_pipe,
+              const int in_fd,
+              const int out_fd,
+              const uint8_t* const txt,
+              const size_t len,
+              std::vector<uint8_t>& out,
+              F&& fn)
+{
+  int in_p[2] = { -1, -1 };
+  int out_p[2] = { -1, -1 };
+
+  if (in_pipe) {
+    const int ret = ::pipe(in_p);
+    assert(ret == 0);
+  }
+  if (out_pipe) {
+    const int ret = ::pipe(out_p);
+    assert(ret == 0);
+  }
+
+  std::thread feeder;
+  std::thread drainer;
+
+  out.clear();
+
+  if (in_pipe) {
+    feeder = std::thread([&] { feed_pipe(in_p[1], txt, len); });
+  }
+  if (out_pipe) {
+    drainer = std::thread([&] { drain_pipe(out_p[0], out); });
+  }
+
+  const bool ok = fn(in_pipe ? in_p[0] : in_fd, out_pipe ? out_p[1] : out_fd);
+
+  if (in_pipe) {
+    feeder.join();
+    ::close(in_p[0]);
+  }
+  if (out_pipe) {
+    ::close(out_p[1]);
+    drainer.join();
+  }
+
+  return ok;
+}
+
+// Tests functional correctness of asynchronous ( io_uring based ) & synchronous
+// file encryption pipelines, by asserting that they compute same bytes as
+// counter mode encryption of in-memory buffer, both when writing to another
+// file & in-place, with `depth` buffers, each of `buf_len` -bytes, when input
+// and/ or output are pipes & when files are opened with O_DIRECT
+//
+// When io_uring isn't available, only synchronous pipeline is tested, as is
+// O_DIRECT, when file system doesn't support it.
+static inline void
+test_harpocrates_uring(const size_t file_len,
+                       const size_t depth,
+                       const size_t buf_len)
+{
+  using namespace harpocrates_uring;
+
+  // acquire memory resources
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* nonce = static_cast<uint8_t*>(std::malloc(8));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(file_len + 1));
+  uint8_t* enc = static_cast<uint8_t*>(std::malloc(file_len + 1));
+
+  harpocrates_utils::generate_lut(lut);
+
+  random_data(nonce, 8);
+  random_data(txt, file_len);
+
+  harpocrates_ctr::crypt(lut, nonce, 0, txt, enc, file_len);
+
+  char in_path[] = "/tmp/harpocrates_in_XXXXXX";
+  char out_path[] = "/tmp/harpocrates_out_XXXXXX";
+
+  const int in_fd = ::mkstemp(in_path);
+  const int out_fd = ::mkstemp(out_path);
+  assert(in_fd >= 0 && out_fd >= 0);
+
+  const ssize_t n = ::write(in_fd, txt, file_len);
+  assert(n == static_cast<ssize_t>(file_len));
+
+  // synchronous, to another file
+  const bool sync_ok = crypt_file_sync(lut, nonce, in_fd, out_fd, buf_len);
+  assert(sync_ok);
+  assert_file_bytes(out_fd, enc, file_len);
+
+  ring r;
+  if (r.open()) {
+    // asynchronous, to another file, which is longer than input file
+    const int ret = ::ftruncate(out_fd, static_cast<off_t>(file_len + buf_len));
+    const bool async_ok0 =
+      sync_wait(r, crypt_file(r, lut, nonce, in_fd, out_fd, depth, buf_len));
+    assert(ret == 0 && async_ok0);
+    assert_file_bytes(out_fd, enc, file_len);
+
+    // asynchronous, in-place, twice
+    const bool async_ok1 =
+      sync_wait(r, crypt_file(r, lut, nonce, in_fd, in_fd, depth, buf_len));
+    assert(async_ok1);
+    assert_file_bytes(in_fd, enc, file_len);
+
+    const bool async_ok2 =
+      sync_wait(r, crypt_file(r, lut, nonce, in_fd, in_fd, depth, buf_len));
+    assert(async_ok2);
+    assert_file_bytes(in_fd, txt, file_len);
+  }
+
+  // input and/ or output are pipes; regular output file is longer than input,
+  // so that it gets truncated
+  std::vector<uint8_t> piped;
+
+  for (size_t mode = 1; mode < 4; mode++) {
+    const bool in_pipe = (mode & 1) != 0;
+    const bool out_pipe = (mode & 2) != 0;
+
+    auto check = [&]() {
+      if (out_pipe) {
+        assert(piped.size() == file_len);
+        assert(std::memcmp(piped.data(), enc, file_len) == 0);
+      } else {
+        assert_file_bytes(out_fd, enc, file_len);
+      }
+    };
+
+    auto sync_fn = [&](const int in, const int out) {
+      return crypt_file_sync(lut, nonce, in, out, buf_len);
+    };
+    auto async_fn = [&](const int in, const int out) {
+      return sync_wait(r, crypt_file(r, lut, nonce, in, out, depth, buf_len));
+    };
+
+    const off_t longer = static_cast<off_t>(file_len + buf_len + 1);
+
+    const int ret0 = ::ftruncate(out_fd, longer);
+    const bool ok0 = through_pipes(
+      in_pipe, out_pipe, in_fd, out_fd, txt, file_len, piped, sync_fn);
+    assert(ret0 == 0 && ok0);
+    check();
+
+    if (r.is_open()) {
+      const int ret1 = ::ftruncate(out_fd, longer);
+      const bool ok1 = through_pipes(
+        in_pipe, out_pipe, in_fd, out_fd, txt, file_len, piped, async_fn);
+      assert(ret1 == 0 && ok1);
+      check();
+    }
+  }
+
+  // files opened with O_DIRECT, for reading & writing
+  const int in_dfd = ::open(in_path, O_RDONLY | O_DIRECT);
+  const int out_dfd = ::open(out_path, O_WRONLY | O_TRUNC | O_DIRECT);
+
+  if (in_dfd >= 0 && out_dfd >= 0) {
+    const bool ok0 = crypt_file_sync(lut, nonce, in_dfd, out_dfd, buf_len);
+    assert(ok0);
+    assert_file_bytes(out_fd, enc, file_len);
+
+    if (r.is_open()) {
+      const int ret = ::ftruncate(out_fd, 0);
+      const bool ok1 = sync_wait(
+        r, crypt_file(r, lut, nonce, in_dfd, out_dfd, depth, buf_len));
+      assert(ret == 0 && ok1);
+      assert_file_bytes(out_fd, enc, file_len);
+    }
+  } else {
+    assert(errno == EINVAL);
+  }
+
+  if (in_dfd >= 0) {
+    ::close(in_dfd);
+  }
+  if (out_dfd >= 0) {
+    ::close(out_dfd);
+  }
+
+  // io_uring_enter failing ( here, as ring's descriptor is replaced by one of
+  // /dev/null ) fails all pending requests, instead of aborting
+  if (r.is_open() && file_len > 0) {
+    const int probe = ::dup(in_fd); // lowest free descriptor, taken by ring
+    ::close(probe);
+
+    ring bad;
+    const bool opened = bad.open();
+    const int null_fd = ::open("/dev/null", O_RDONLY);
+    const int dup_fd = ::dup2(null_fd, probe);
+    assert(opened && null_fd >= 0 && dup_fd == probe);
+
+    const bool bad_ok = sync_wait(
+      bad, crypt_file(bad, lut, nonce, in_fd, out_fd, depth, buf_len));
+    assert(!bad_ok && errno == bad.error() && errno != 0);
+
+    ::close(null_fd);
+  }
+
+  ::close(in_fd);
+  ::close(out_fd);
+  std::remove(in_path);
+  std::remove(out_path);
+
+  // deallocate all resources
+  std::free(lut);
+  std::free(nonce);
+  std::free(txt);
+  std::free(enc);
+}
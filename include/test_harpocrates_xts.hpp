@@ -0,0 +1,152 @@
+#pragma once
+#include "harpocrates.hpp"
+#include "harpocrates_xts.hpp"
+#include "utils.hpp"
+#include <cassert>
+
+// Tests GF(2^128) doubling, used for computing tweaks of consecutive message
+// blocks of sector, on some hand computed values
+static inline void
+test_gf_double()
+{
+  using namespace harpocrates_xts;
+
+  uint8_t t[16] = {};
+
+  t[0] = 0x01;
+  gf_double(t);
+  assert(t[0] == 0x02);
+
+  std::memset(t, 0, sizeof(t));
+  t[7] = 0x80;
+  gf_double(t);
+  assert(t[7] == 0x00 && t[8] == 0x01);
+
+  std::memset(t, 0, sizeof(t));
+  t[15] = 0x80;
+  gf_double(t);
+  assert(t[0] == 0x87 && t[15] == 0x00);
+}
+
+// Tests functional correctness of Harpocrates in XTS-like mode, by asserting
+// that
+//
+// - encrypted sectors are same as computed using single block routines,
+//   following definition of mode
+// - any sector can be decrypted independently of others
+// - multi-threaded encryption/ decryption compute same bytes as single
+//   threaded ones
+// - sector lengths, which aren't non-zero multiples of 16 -bytes, are rejected
+static inline void
+test_harpocrates_xts(harpocrates_parallel::thread_pool& pool,
+                     const size_t sector_len,
+                     const size_t n_sectors)
+{
+  using namespace harpocrates_xts;
+
+  constexpr size_t blk_len = harpocrates_common::BLOCK_LEN;
+  const size_t ct_len = sector_len * n_sectors;
+  const uint64_t first = 1ul << 40;
+
+  // acquire memory resources
+  uint8_t* lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* inv_lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* tweak_lut = static_cast<uint8_t*>(std::malloc(256));
+  uint8_t* txt = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc0 = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* enc1 = static_cast<uint8_t*>(std::malloc(ct_len));
+  uint8_t* dec = static_cast<uint8_t*>(std::malloc(ct_len));
+
+  harpocrates_utils::generate_lut(lut);
+  harpocrates_utils::generate_inv_lut(lut, inv_lut);
+  harpocrates_utils::generate_lut(tweak_lut);
+
+  random_data(txt, ct_len);
+
+  // reference, using single block routines
+  for (size_t s = 0; s < n_sectors; s++) {
+    uint8_t sno[blk_len] = {};
+    uint8_t t[blk_len];
+
+    for (size_t j = 0; j < 8; j++) {
+      sno[j] = static_cast<uint8_t>((first + s) >> (j << 3));
+    }
+
+    harpocrates::encrypt(tweak_lut, sno, t);
+
+    for (size_t off = s * sector_len; off < (s + 1) * sector_len;
+         off += blk_len) {
+      uint8_t blk[blk_len];
+
+      for (size_t k = 0; k < blk_len; k++) {
+        blk[k] = txt[off + k] ^ t[k];
+      }
+
+      harpocrates::encrypt(lut, blk, enc0 + off);
+
+      for (size_t k = 0; k < blk_len; k++) {
+        enc0[off + k] ^= t[k];
+      }
+
+      gf_double(t);
+    }
+  }
+
+  encrypt_sectors(lut, tweak_lut, first, txt, enc1, sector_len, n_sectors);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+  }
+
+  // random access
+  for (size_t s = 0; s < n_sectors; s++) {
+    const size_t off = s * sector_len;
+    decrypt_sectors(
+      inv_lut, tweak_lut, first + s, enc1 + off, dec + off, sector_len, 1);
+  }
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0u);
+  }
+
+  // multi-threaded, in-place
+  std::memcpy(enc1, txt, ct_len);
+  encrypt_sectors(
+    pool, lut, tweak_lut, first, enc1, enc1, sector_len, n_sectors);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((enc0[i] ^ enc1[i]) == 0u);
+  }
+
+  decrypt_sectors(
+    pool, inv_lut, tweak_lut, first, enc1, dec, sector_len, n_sectors);
+
+  for (size_t i = 0; i < ct_len; i++) {
+    assert((txt[i] ^ dec[i]) == 0u);
+  }
+
+  // invalid sector lengths are rejected, leaving output untouched
+  for (const size_t bad : { 0ul, sector_len + 8 }) {
+    std::memcpy(enc1, enc0, ct_len);
+
+    errno = 0;
+    const bool ok0 = encrypt_sectors(lut, tweak_lut, first, txt, enc1, bad, 1);
+    assert(!ok0 && errno == EINVAL);
+
+    errno = 0;
+    const bool ok1 = decrypt_sectors(
+      pool, inv_lut, tweak_lut, first, txt, enc1, bad, n_sectors);
+    assert(!ok1 && errno == EINVAL);
+
+    assert(std::memcmp(enc0, enc1, ct_len) == 0);
+  }
+
+  // deallocate all resources
+  std::free(lut);
+  std::free(inv_lut);
+  std::free(tweak_lut);
+  std::free(txt);
+  std::free(enc0);
+  std::free(enc1);
+  std::free(dec);
+}
@@ -1,4 +1,27 @@
 #include "test_harpocrates.hpp"
+#include "test_harpocrates_aead.hpp"
+#include "test_harpocrates_archive.hpp"
+#include "test_harpocrates_array.hpp"
+#include "test_harpocrates_bitsliced.hpp"
+#include "test_harpocrates_cache.hpp"
+#include "test_harpocrates_context.hpp"
+#include "test_harpocrates_ctr.hpp"
+#include "test_harpocrates_dispatch.hpp"
+#include "test_harpocrates_expanded.hpp"
+#include "test_harpocrates_file.hpp"
+#include "test_harpocrates_fixed.hpp"
+#include "test_harpocrates_iov.hpp"
+#include "test_harpocrates_kdf.hpp"
+#include "test_harpocrates_keystore.hpp"
+#include "test_harpocrates_multibuffer.hpp"
+#include "test_harpocrates_multikey.hpp"
+#include "test_harpocrates_pagecache.hpp"
+#include "test_harpocrates_parallel.hpp"
+#include "test_harpocrates_simd.hpp"
+#include "test_harpocrates_stream.hpp"
+#include "test_harpocrates_transcrypt.hpp"
+#include "test_harpocrates_uring.hpp"
+#include "test_harpocrates_xts.hpp"
 #include <bit>
 #include <iostream>
 #include <string.h>
@@ -19,5 +42,251 @@ main()
   std::cout << "[test] Harpocrates random encrypt -> decrypt works !"
             << std::endl;
 
+  for (size_t n_blocks = 0; n_blocks < 64; n_blocks++) {
+    test_harpocrates_blocks(n_blocks);
+  }
+
+  std::cout << "[test] Harpocrates bulk encrypt -> decrypt works !"
+            << std::endl;
+
+  for (size_t n_blocks = 1; n_blocks < 64; n_blocks += 7) {
+    test_harpocrates_expanded(n_blocks);
+  }
+
+  std::cout << "[test] Harpocrates expanded table encrypt -> decrypt works !"
+            << std::endl;
+
+  for (size_t i = 0; i < itr_cnt; i++) {
+    test_column_substitution();
+  }
+
+  std::cout << "[test] Transpose based column substitution works !"
+            << std::endl;
+
+#if defined __x86_64__
+  for (size_t n_blocks = 1; n_blocks < 256; n_blocks += 13) {
+    test_harpocrates_simd(n_blocks);
+  }
+
+  std::cout << "[test] Vectorized Harpocrates encrypt -> decrypt works !"
+            << std::endl;
+
+  for (size_t n_blocks = 1; n_blocks < 512; n_blocks += 67) {
+    using namespace harpocrates_bitsliced;
+
+    test_harpocrates_bitsliced<word64>(n_blocks);
+    test_harpocrates_bitsliced<word128>(n_blocks);
+    test_harpocrates_bitsliced<word256>(n_blocks);
+  }
+
+  std::cout << "[test] Bitsliced Harpocrates encrypt -> decrypt works !"
+            << std::endl;
+
+#endif
+
+  for (size_t n_blocks = 1; n_blocks < 256; n_blocks += 29) {
+    test_harpocrates_dispatch(n_blocks);
+  }
+
+  std::cout << "[test] Harpocrates with kernel \""
+            << harpocrates_dispatch::selected_kernel_name()
+            << "\", selected at run time, works !" << std::endl;
+
+  for (size_t n_threads = 1; n_threads <= 4; n_threads <<= 1) {
+    harpocrates_parallel::thread_pool pool(n_threads);
+
+    for (size_t n_tasks = 0; n_tasks < 64; n_tasks += 3) {
+      test_thread_pool(pool, n_tasks);
+    }
+
+    for (size_t n_blocks = 1; n_blocks < 1024; n_blocks += 101) {
+      test_harpocrates_parallel(pool, n_blocks, 7);
+      test_harpocrates_parallel(pool, n_blocks, 64);
+    }
+  }
+
+  std::cout << "[test] Multi-threaded Harpocrates encrypt -> decrypt works !"
+            << std::endl;
+
+  {
+    harpocrates_parallel::thread_pool pool(4);
+
+    for (size_t msg_len = 1; msg_len < 8192; msg_len += 317) {
+      test_harpocrates_ctr(pool, msg_len, 0);
+      test_harpocrates_ctr(pool, msg_len, msg_len >> 1);
+      test_harpocrates_ctr(pool, msg_len, msg_len - 1);
+    }
+  }
+
+  std::cout << "[test] Harpocrates in counter mode works !" << std::endl;
+
+  test_gf_double();
+
+  {
+    harpocrates_parallel::thread_pool pool(4);
+
+    for (size_t n_sectors = 1; n_sectors < 160; n_sectors += 31) {
+      test_harpocrates_xts(pool, 512, n_sectors);
+      test_harpocrates_xts(pool, 4096, n_sectors);
+    }
+
+    test_harpocrates_xts(pool, 1ul << 16, 3);
+  }
+
+  std::cout << "[test] Harpocrates in XTS-like sector mode works !"
+            << std::endl;
+
+  {
+    harpocrates_parallel::thread_pool pool(4);
+
+    test_harpocrates_file(pool, 0);
+    test_harpocrates_file(pool, 1);
+    test_harpocrates_file(pool, 4095);
+    test_harpocrates_file(pool, (1ul << 20) + 17);
+  }
+
+  std::cout << "[test] Memory mapped file encryption works !" << std::endl;
+
+  test_harpocrates_uring(0, 4, 4096);
+  test_harpocrates_uring(1, 4, 4096);
+  test_harpocrates_uring(4097, 4, 4096);
+  test_harpocrates_uring((1ul << 20) + 17, 4, 8192);
+  test_harpocrates_uring((1ul << 20) + 17, 16, 65536);
+  test_harpocrates_uring((3ul << 20) + 9, 8, 1ul << 20);
+
+  std::cout << "[test] Asynchronous file encryption pipeline works !"
+            << std::endl;
+
+  {
+    harpocrates_parallel::thread_pool pool(4);
+
+    test_harpocrates_context(pool, 1);
+    test_harpocrates_context(pool, 257);
+    test_harpocrates_context(pool, 1ul << 12);
+  }
+
+  std::cout << "[test] Harpocrates cipher context works !" << std::endl;
+
+  test_chacha20_block();
+  test_chacha20_blocks<16>();
+  test_chacha20_blocks<32>();
+  test_harpocrates_kdf();
+
+  std::cout << "[test] Keyed look up table derivation works !" << std::endl;
+
+  test_harpocrates_keystore(0, false);
+  test_harpocrates_keystore(1, true);
+  test_harpocrates_keystore(3, true);
+  test_harpocrates_keystore(1000, false);
+
+  std::cout << "[test] Memory mapped keystore works !" << std::endl;
+
+  test_harpocrates_cache();
+
+  std::cout << "[test] Bounded cache of cipher contexts works !" << std::endl;
+
+  for (size_t n_blocks = 1; n_blocks < 3000; n_blocks += 373) {
+    test_harpocrates_multikey(n_blocks, 1);
+    test_harpocrates_multikey(n_blocks, 3);
+    test_harpocrates_multikey(n_blocks, 64);
+  }
+
+  std::cout << "[test] Multi-key batch encrypt -> decrypt works !"
+            << std::endl;
+
+  test_harpocrates_multibuffer(0, 0);
+  test_harpocrates_multibuffer(1, 100);
+  test_harpocrates_multibuffer(37, 64);
+  test_harpocrates_multibuffer(64, 3000);
+  test_harpocrates_multibuffer(16, 1ul << 16);
+
+  std::cout << "[test] Multi-buffer encrypt -> decrypt works !" << std::endl;
+
+  for (size_t msg_len = 0; msg_len < 20000; msg_len += 1999) {
+    test_harpocrates_iov(msg_len, 7, 0);
+    test_harpocrates_iov(msg_len, 100, 5);
+    test_harpocrates_iov(msg_len, 5000, 1ul << 20);
+  }
+
+  std::cout << "[test] Scatter-gather encrypt -> decrypt works !" << std::endl;
+
+  for (size_t msg_len = 0; msg_len < 20000; msg_len += 2333) {
+    test_harpocrates_stream(msg_len, 5, 0);
+    test_harpocrates_stream(msg_len, 100, 7);
+    test_harpocrates_stream(msg_len, 9000, 1ul << 20);
+  }
+
+  std::cout << "[test] Incremental stream encryption works !" << std::endl;
+
+  {
+    harpocrates_parallel::thread_pool pool(4);
+
+    for (size_t n_blocks = 0; n_blocks < 1024; n_blocks += 93) {
+      test_harpocrates_transcrypt(pool, n_blocks, 0);
+      test_harpocrates_transcrypt(pool, n_blocks, 13);
+    }
+  }
+
+  std::cout << "[test] Fused re-encryption under new look up table works !"
+            << std::endl;
+
+  for (size_t n_blocks = 0; n_blocks < 64; n_blocks += 5) {
+    test_harpocrates_fixed(n_blocks);
+  }
+
+  std::cout << "[test] Harpocrates with look up table fixed at compile time "
+               "works !"
+            << std::endl;
+
+  {
+    harpocrates_parallel::thread_pool pool(4);
+
+    test_harpocrates_archive(pool, 0, 4096);
+    test_harpocrates_archive(pool, 1, 16);
+    test_harpocrates_archive(pool, 4097, 4096);
+    test_harpocrates_archive(pool, (1ul << 20) + 17, 1ul << 16);
+    test_harpocrates_archive(pool, (1ul << 18) + 5, 48);
+  }
+
+  std::cout << "[test] Random-access encrypted archive works !" << std::endl;
+
+  test_harpocrates_pagecache(1, 1, 4096, 1);
+  test_harpocrates_pagecache(64, 8, 4096, 1);
+  test_harpocrates_pagecache(64, 16, 4096, 4);
+  test_harpocrates_pagecache(256, 1024, 512, 16);
+  test_harpocrates_pagecache(1024, 64, 48, 16);
+
+  std::cout << "[test] Encrypted page cache works !" << std::endl;
+
+  for (size_t n = 0; n < 300; n += 37) {
+    test_harpocrates_array<uint8_t, 1>(n);
+    test_harpocrates_array<uint32_t, 1>(n);
+    test_harpocrates_array<uint32_t, harpocrates_array::GROUP_BLOCKS>(n);
+    test_harpocrates_array<uint64_t, 8>(n);
+    test_harpocrates_array<record12_t, 1>(n);
+    test_harpocrates_array<record12_t, 3>(n);
+    test_harpocrates_array<record40_t, 1>(n);
+    test_harpocrates_array<record40_t, 64>(n);
+  }
+
+  std::cout << "[test] Lazily decrypting encrypted array works !" << std::endl;
+
+  test_gf_halve();
+
+  {
+    harpocrates_parallel::thread_pool pool(4);
+
+    const size_t lens[] = { 0, 1, 15, 16, 17, 32, 100, 4096, 70001 };
+
+    for (const size_t len : lens) {
+      for (const size_t ad_len : { 0, 1, 16, 31, 33 }) {
+        test_harpocrates_aead(pool, len, ad_len);
+      }
+    }
+  }
+
+  std::cout << "[test] Authenticated encryption ( CTR + PMAC ) works !"
+            << std::endl;
+
   return EXIT_SUCCESS;
 }